@@ -40,6 +40,10 @@
 # define rwlock_rdlock(lock)		RWLOCK_CALL (rdlock (&lock))
 # define rwlock_wrlock(lock)		RWLOCK_CALL (wrlock (&lock))
 # define rwlock_unlock(lock)		RWLOCK_CALL (unlock (&lock))
+/* For state which is initialized once and then read without a lock.  */
+# define atomic_load_acquire(ptr)	__atomic_load_n (ptr, __ATOMIC_ACQUIRE)
+# define atomic_store_release(ptr, val) \
+  __atomic_store_n (ptr, val, __ATOMIC_RELEASE)
 #else
 /* Eventually we will allow multi-threaded applications to use the
    libraries.  Therefore we will add the necessary locking although
@@ -50,6 +54,8 @@
 # define rwlock_rdlock(lock) ((void) (lock))
 # define rwlock_wrlock(lock) ((void) (lock))
 # define rwlock_unlock(lock) ((void) (lock))
+# define atomic_load_acquire(ptr) (*(ptr))
+# define atomic_store_release(ptr, val) ((void) (*(ptr) = (val)))
 #endif	/* USE_LOCKS */
 
 /* gettext helper macro.  */
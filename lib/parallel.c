@@ -0,0 +1,320 @@
+/* Process items in parallel, finishing them in order.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "system.h"
+
+/* How many items each thread may be ahead of the last one done.  */
+#define AHEAD	4
+
+struct ordered
+{
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  size_t n;
+  size_t next;			/* Next item to start.  */
+  size_t ndone;			/* Items passed to DONE.  */
+  size_t window;		/* Items allowed past NDONE.  */
+  bool *finished;		/* Ring of WINDOW flags.  */
+  void (*work) (size_t, void *);
+  void *arg;
+};
+
+
+static void *
+worker (void *p)
+{
+  struct ordered *o = p;
+
+  pthread_mutex_lock (&o->lock);
+  while (true)
+    {
+      while (o->next < o->n && o->next >= o->ndone + o->window)
+	pthread_cond_wait (&o->cond, &o->lock);
+      if (o->next >= o->n)
+	break;
+
+      size_t i = o->next++;
+      pthread_mutex_unlock (&o->lock);
+
+      o->work (i, o->arg);
+
+      pthread_mutex_lock (&o->lock);
+      o->finished[i % o->window] = true;
+      pthread_cond_broadcast (&o->cond);
+    }
+  pthread_mutex_unlock (&o->lock);
+
+  return NULL;
+}
+
+
+unsigned int
+parallel_jobs (unsigned int jobs)
+{
+  if (jobs == 0)
+    {
+      long int ncpus = sysconf (_SC_NPROCESSORS_ONLN);
+      jobs = ncpus > 0 ? ncpus : 1;
+    }
+  return jobs;
+}
+
+
+void
+parallel_ordered (size_t n, unsigned int jobs,
+		  void (*work) (size_t, void *),
+		  void (*done) (size_t, void *), void *arg)
+{
+  jobs = parallel_jobs (jobs);
+  if (jobs > n)
+    jobs = n;
+
+  struct ordered o =
+    {
+      .n = n,
+      .window = (size_t) jobs * AHEAD,
+      .work = work,
+      .arg = arg
+    };
+  pthread_t threads[jobs];
+  unsigned int nthreads = 0;
+
+  if (jobs > 1)
+    {
+      o.finished = calloc (o.window, sizeof (bool));
+      if (o.finished != NULL)
+	{
+	  pthread_mutex_init (&o.lock, NULL);
+	  pthread_cond_init (&o.cond, NULL);
+	  while (nthreads < jobs
+		 && pthread_create (&threads[nthreads], NULL, worker, &o) == 0)
+	    ++nthreads;
+	}
+    }
+
+  if (nthreads == 0)
+    {
+      /* Not worth it or not possible, do everything here.  */
+      free (o.finished);
+      for (size_t i = 0; i < n; ++i)
+	{
+	  work (i, arg);
+	  done (i, arg);
+	}
+      return;
+    }
+
+  pthread_mutex_lock (&o.lock);
+  while (o.ndone < n)
+    {
+      bool *finished = &o.finished[o.ndone % o.window];
+      while (! *finished)
+	pthread_cond_wait (&o.cond, &o.lock);
+      *finished = false;
+      pthread_mutex_unlock (&o.lock);
+
+      done (o.ndone, arg);
+
+      pthread_mutex_lock (&o.lock);
+      ++o.ndone;
+      pthread_cond_broadcast (&o.cond);
+    }
+  pthread_mutex_unlock (&o.lock);
+
+  while (nthreads > 0)
+    pthread_join (threads[--nthreads], NULL);
+
+  pthread_cond_destroy (&o.cond);
+  pthread_mutex_destroy (&o.lock);
+  free (o.finished);
+}
+
+
+struct child
+{
+  pid_t pid;
+  int fd;			/* Hung up when the child is gone.  */
+  FILE *out;			/* What the child wrote to stdout.  */
+  FILE *err;			/* And to stderr.  */
+  int status;			/* Its wait status, or -1.  */
+  int error;			/* Why there is no child.  */
+  bool finished;
+};
+
+
+static void
+start_child (struct child *c, size_t i, int (*work) (size_t, void *),
+	     void *arg)
+{
+  *c = (struct child) { .pid = -1, .fd = -1, .status = -1 };
+
+  /* Only the child holds the write end of the pipe, so we can wait for
+     it without reaping other children of the process.  */
+  int fds[2];
+  c->out = tmpfile ();
+  c->err = tmpfile ();
+  if (c->out != NULL && c->err != NULL && pipe2 (fds, O_CLOEXEC) == 0)
+    {
+      c->pid = fork ();
+      if (c->pid == 0)
+	{
+	  if (dup2 (fileno (c->out), STDOUT_FILENO) < 0
+	      || dup2 (fileno (c->err), STDERR_FILENO) < 0)
+	    _exit (EXIT_FAILURE);
+	  int status = work (i, arg);
+	  fflush (stdout);
+	  _exit (status);
+	}
+
+      int error = errno;
+      close (fds[1]);
+      if (c->pid == -1)
+	close (fds[0]);
+      else
+	c->fd = fds[0];
+      errno = error;
+    }
+
+  if (c->pid == -1)
+    {
+      c->error = errno;
+      c->finished = true;
+    }
+}
+
+
+static void
+reap_child (struct child *c)
+{
+  if (TEMP_FAILURE_RETRY (waitpid (c->pid, &c->status, 0)) != c->pid)
+    {
+      c->error = errno;
+      c->status = -1;
+    }
+  close (c->fd);
+  c->finished = true;
+}
+
+
+static void
+copy_output (FILE *from, int fd, bool keep)
+{
+  if (from == NULL)
+    return;
+
+  char buf[8192];
+  ssize_t n;
+  off_t off = 0;
+  while (keep && (n = pread_retry (fileno (from), buf, sizeof buf, off)) > 0)
+    {
+      if (write_retry (fd, buf, n) != n)
+	break;
+      off += n;
+    }
+  fclose (from);
+}
+
+
+void
+parallel_ordered_fork (size_t n, unsigned int jobs,
+		       int (*work) (size_t, void *),
+		       bool (*done) (size_t, int, void *), void *arg)
+{
+  jobs = parallel_jobs (jobs);
+
+  /* The children must not repeat what is still buffered.  */
+  fflush (stdout);
+  fflush (stderr);
+
+  size_t window = (size_t) jobs * AHEAD;
+  struct child *children = xcalloc (window, sizeof (struct child));
+  size_t next = 0;
+  size_t ndone = 0;
+  unsigned int running = 0;
+
+  while (ndone < n)
+    {
+      while (next < n && next < ndone + window && running < jobs)
+	{
+	  struct child *c = &children[next % window];
+	  start_child (c, next++, work, arg);
+	  if (c->pid != -1)
+	    ++running;
+	}
+
+      struct child *c = &children[ndone % window];
+      if (c->finished)
+	{
+	  errno = c->error;
+	  bool keep = done (ndone, c->status, arg);
+	  fflush (stdout);
+	  fflush (stderr);
+	  copy_output (c->out, STDOUT_FILENO, keep);
+	  copy_output (c->err, STDERR_FILENO, keep);
+	  ++ndone;
+	  continue;
+	}
+
+      /* Wait until one of our children is gone.  */
+      struct pollfd fds[running];
+      nfds_t nfds = 0;
+      for (size_t i = ndone; i < next; ++i)
+	if (! children[i % window].finished)
+	  fds[nfds++] = (struct pollfd) { .fd = children[i % window].fd,
+					  .events = POLLIN };
+      int ready = TEMP_FAILURE_RETRY (poll (fds, nfds, -1));
+
+      nfds = 0;
+      for (size_t i = ndone; i < next; ++i)
+	{
+	  struct child *r = &children[i % window];
+	  if (r->finished)
+	    continue;
+	  /* If we cannot poll, wait for the one we need next.  */
+	  if (ready < 0 ? r == c : fds[nfds].revents != 0)
+	    {
+	      reap_child (r);
+	      --running;
+	    }
+	  ++nfds;
+	}
+    }
+
+  free (children);
+}
@@ -0,0 +1,143 @@
+/* Print numbers and strings in columns without printf.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include "system.h"
+
+
+static void
+put_chars (FILE *fp, const char *chars, int n)
+{
+  while (n > 0)
+    {
+      int len = n < 32 ? n : 32;
+      fwrite_unlocked (chars, 1, len, fp);
+      n -= len;
+    }
+}
+
+static const char spaces[32] = "                                ";
+static const char zeros[32] = "00000000000000000000000000000000";
+
+
+void
+put_pad (FILE *fp, int n)
+{
+  put_chars (fp, spaces, n);
+}
+
+
+void
+put_str (FILE *fp, const char *s, int width)
+{
+  if (s == NULL)
+    s = "(null)";
+
+  size_t len = strlen (s);
+  if (width > 0 && len < (size_t) width)
+    put_chars (fp, spaces, width - len);
+  fwrite_unlocked (s, 1, len, fp);
+  if (width < 0 && len < (size_t) -width)
+    put_chars (fp, spaces, -width - len);
+}
+
+
+/* Print the digits from CP to the end of BUF, after PREFIX.  */
+static void
+put_digits (FILE *fp, const char *cp, const char *end, const char *prefix,
+	    int width, int flags)
+{
+  size_t ndigits = end - cp;
+  size_t nprefix = strlen (prefix);
+  int pad = (width < 0 ? -width : width) - (int) (nprefix + ndigits);
+
+  if (width > 0 && (flags & PUT_ZERO) == 0)
+    put_chars (fp, spaces, pad);
+  fwrite_unlocked (prefix, 1, nprefix, fp);
+  if (width > 0 && (flags & PUT_ZERO) != 0)
+    put_chars (fp, zeros, pad);
+  fwrite_unlocked (cp, 1, ndigits, fp);
+  if (width < 0)
+    put_chars (fp, spaces, pad);
+}
+
+
+static void
+put_decimal (FILE *fp, uintmax_t val, const char *prefix, int width,
+	     int flags)
+{
+  char buf[sizeof (uintmax_t) * 3];
+  char *cp = &buf[sizeof buf];
+  do
+    {
+      *--cp = '0' + val % 10;
+      val /= 10;
+    }
+  while (val != 0);
+
+  put_digits (fp, cp, &buf[sizeof buf], prefix, width, flags);
+}
+
+
+void
+put_unsigned (FILE *fp, uintmax_t val, int width, int flags)
+{
+  put_decimal (fp, val, "", width, flags);
+}
+
+
+void
+put_signed (FILE *fp, intmax_t val, int width, int flags)
+{
+  if (val < 0)
+    put_decimal (fp, -(uintmax_t) val, "-", width, flags);
+  else
+    put_decimal (fp, val, (flags & PUT_PLUS) ? "+" : "", width, flags);
+}
+
+
+void
+put_hex (FILE *fp, uintmax_t val, int width, int flags)
+{
+  const char *prefix = (flags & PUT_ALT) && val != 0 ? "0x" : "";
+
+  char buf[sizeof (uintmax_t) * 2];
+  char *cp = &buf[sizeof buf];
+  do
+    {
+      *--cp = "0123456789abcdef"[val & 0xf];
+      val >>= 4;
+    }
+  while (val != 0);
+
+  put_digits (fp, cp, &buf[sizeof buf], prefix, width, flags);
+}
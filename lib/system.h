@@ -30,8 +30,10 @@
 #define LIB_SYSTEM_H	1
 
 #include <argp.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <endian.h>
 #include <byteswap.h>
 #include <unistd.h>
@@ -61,6 +63,47 @@ extern char *xstrndup (const char *, size_t) __attribute__ ((__malloc__));
 extern uint32_t crc32 (uint32_t crc, unsigned char *buf, size_t len);
 extern int crc32_file (int fd, uint32_t *resp);
 
+/* Number of threads to use for JOBS, where 0 means one per CPU.  */
+extern unsigned int parallel_jobs (unsigned int jobs);
+
+/* Call WORK for the items 0 to N - 1 from up to JOBS threads.  DONE is
+   called in the calling thread for each item in ascending order once its
+   WORK has finished, so the results can be output in order.  Only a
+   few items per thread are started ahead of the last one done.  */
+extern void parallel_ordered (size_t n, unsigned int jobs,
+			      void (*work) (size_t, void *),
+			      void (*done) (size_t, void *), void *arg);
+
+/* Like parallel_ordered, but call WORK for each item in a child process
+   of its own, which exits with the result.  What the child writes to
+   stdout and stderr is collected.  DONE gets the wait status of the
+   child, or -1 with errno set if it could not be started.  Unless DONE
+   returns false, the output of the child is then copied to ours, after
+   anything DONE printed, so it appears in the same order as when
+   calling WORK for one item after the other.  Use this when WORK prints
+   with stdio or uses libraries which are not thread-safe, or must not
+   take the whole program down.  Other children of the process are not
+   waited for.  */
+extern void parallel_ordered_fork (size_t n, unsigned int jobs,
+				   int (*work) (size_t, void *),
+				   bool (*done) (size_t, int, void *),
+				   void *arg);
+
+/* Print to FP what fprintf would with the "%*s", "%*ju", "%*jd" and
+   "%*jx" formats, without parsing a format.  A negative WIDTH aligns
+   to the left as with the '-' flag.  FLAGS are the other flags.  */
+enum
+{
+  PUT_ALT = 1,			/* '#' */
+  PUT_ZERO = 2,			/* '0' */
+  PUT_PLUS = 4			/* '+' */
+};
+extern void put_pad (FILE *fp, int n);
+extern void put_str (FILE *fp, const char *s, int width);
+extern void put_unsigned (FILE *fp, uintmax_t val, int width, int flags);
+extern void put_signed (FILE *fp, intmax_t val, int width, int flags);
+extern void put_hex (FILE *fp, uintmax_t val, int width, int flags);
+
 /* A special gettext function we use if the strings are too short.  */
 #define sgettext(Str) \
   ({ const char *__res = strrchr (gettext (Str), '|');			      \
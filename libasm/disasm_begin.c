@@ -59,6 +59,16 @@ disasm_begin (Ebl *ebl, Elf *elf, DisasmGetSymCB_t symcb)
   ctx->ebl = ebl;
   ctx->elf = elf;
   ctx->symcb = symcb;
+  ctx->symtab = NULL;
+  ctx->nsymtab = 0;
+
+  /* Read all symbols of the ELF file now, once for all calls.  */
+  if (elf != NULL && __libasm_read_symtab (ctx) != 0)
+    {
+      free (ctx);
+      __libasm_seterrno (ASM_E_NOMEM);
+      return NULL;
+    }
 
   return ctx;
 }
@@ -30,6 +30,7 @@
 # include <config.h>
 #endif
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "libasmP.h"
@@ -58,32 +59,75 @@ default_elf_getsym (GElf_Addr addr, Elf32_Word scnndx, GElf_Addr value,
 	return res;
     }
 
-  // XXX Look up in ELF file.
+  /* Look up in ELF file.  */
+  const struct symaddrpair *symtab = symtoken->ctx->symtab;
+  size_t l = 0;
+  size_t u = symtoken->ctx->nsymtab;
+  while (l < u)
+    {
+      size_t idx = (l + u) / 2;
+      if (value < symtab[idx].addr)
+	u = idx;
+      else if (value > symtab[idx].addr)
+	l = idx + 1;
+      else
+	{
+	  size_t len = strlen (symtab[idx].name) + 1;
+	  if (len > *buflen)
+	    {
+	      char *newbuf = realloc (*buf, len);
+	      if (newbuf == NULL)
+		return -1;
+	      *buf = newbuf;
+	      *buflen = len;
+	    }
+	  memcpy (*buf, symtab[idx].name, len);
+	  return 0;
+	}
+    }
 
   return -1;
 }
 
 
-struct symaddrpair
+/* A symbol and its position in the order the symbols were read.  */
+struct symseq
 {
-  GElf_Addr addr;
-  const char *name;
+  struct symaddrpair pair;
+  size_t seq;
 };
 
 
-static void
+static int
+compare_symseq (const void *p1, const void *p2)
+{
+  const struct symseq *s1 = (const struct symseq *) p1;
+  const struct symseq *s2 = (const struct symseq *) p2;
+
+  if (s1->pair.addr != s2->pair.addr)
+    return s1->pair.addr < s2->pair.addr ? -1 : 1;
+  return s1->seq < s2->seq ? -1 : s1->seq > s2->seq;
+}
+
+
+static int
 read_symtab_exec (DisasmCtx_t *ctx)
 {
   /* We simply use all we can get our hands on.  This will produce
      some duplicate information but this is no problem, we simply
      ignore the latter definitions.  */
+  struct symseq *syms = NULL;
+  size_t nsyms = 0;
+  size_t maxsyms = 0;
+
   Elf_Scn *scn= NULL;
   while ((scn = elf_nextscn (ctx->elf, scn)) != NULL)
     {
       GElf_Shdr shdr_mem;
       GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
       Elf_Data *data;
-      if (shdr == NULL || shdr->sh_type != SHT_SYMTAB
+      if (shdr == NULL
+	  || (shdr->sh_type != SHT_SYMTAB && shdr->sh_type != SHT_DYNSYM)
 	  || (data = elf_getdata (scn, NULL)) == NULL)
 	continue;
 
@@ -93,8 +137,8 @@ read_symtab_exec (DisasmCtx_t *ctx)
 	xndxdata = elf_getdata (elf_getscn (ctx->elf, xndxscnidx), NULL);
 
       /* Iterate over all symbols.  Add all defined symbols.  */
-      int nsyms = shdr->sh_size / shdr->sh_entsize;
-      for (int cnt = 1; cnt < nsyms; ++cnt)
+      int nscnsyms = shdr->sh_size / shdr->sh_entsize;
+      for (int cnt = 1; cnt < nscnsyms; ++cnt)
 	{
 	  Elf32_Word xshndx;
 	  GElf_Sym sym_mem;
@@ -103,31 +147,76 @@ read_symtab_exec (DisasmCtx_t *ctx)
 	  if (sym == NULL)
 	    continue;
 
-	  /* Undefined symbols are useless here.  */
-	  if (sym->st_shndx == SHN_UNDEF)
+	  /* Undefined symbols are useless here, and so are absolute
+	     values and symbols which do not name an address.  */
+	  if (sym->st_shndx == SHN_UNDEF || sym->st_shndx == SHN_ABS
+	      || GELF_ST_TYPE (sym->st_info) == STT_SECTION
+	      || GELF_ST_TYPE (sym->st_info) == STT_FILE
+	      || GELF_ST_TYPE (sym->st_info) == STT_TLS)
 	    continue;
 
+	  const char *name = elf_strptr (ctx->elf, shdr->sh_link,
+					 sym->st_name);
+	  if (name == NULL || name[0] == '\0')
+	    continue;
 
+	  if (nsyms == maxsyms)
+	    {
+	      maxsyms = 2 * maxsyms + nscnsyms;
+	      struct symseq *newp = realloc (syms, maxsyms * sizeof (*syms));
+	      if (newp == NULL)
+		{
+		  free (syms);
+		  return -1;
+		}
+	      syms = newp;
+	    }
+
+	  syms[nsyms].pair.addr = sym->st_value;
+	  syms[nsyms].pair.name = name;
+	  syms[nsyms].seq = nsyms;
+	  ++nsyms;
 	}
     }
+
+  if (nsyms == 0)
+    return 0;
+
+  qsort (syms, nsyms, sizeof (syms[0]), compare_symseq);
+
+  ctx->symtab = malloc (nsyms * sizeof (ctx->symtab[0]));
+  if (ctx->symtab == NULL)
+    {
+      free (syms);
+      return -1;
+    }
+
+  /* Of the symbols with the same address the one read first is kept.  */
+  size_t n = 0;
+  for (size_t cnt = 0; cnt < nsyms; ++cnt)
+    if (n == 0 || syms[cnt].pair.addr != ctx->symtab[n - 1].addr)
+      ctx->symtab[n++] = syms[cnt].pair;
+  ctx->nsymtab = n;
+
+  free (syms);
+  return 0;
 }
 
 
-static void
-read_symtab (DisasmCtx_t *ctx)
+int
+__libasm_read_symtab (DisasmCtx_t *ctx)
 {
   /* Find the symbol table(s).  */
   GElf_Ehdr ehdr_mem;
   GElf_Ehdr *ehdr = gelf_getehdr (ctx->elf, &ehdr_mem);
   if (ehdr == NULL)
-    return;
+    return 0;
 
   switch (ehdr->e_type)
     {
     case ET_EXEC:
     case ET_DYN:
-      read_symtab_exec (ctx);
-      break;
+      return read_symtab_exec (ctx);
 
     case ET_REL:
       // XXX  Handle
@@ -136,6 +225,8 @@ read_symtab (DisasmCtx_t *ctx)
     default:
       break;
     }
+
+  return 0;
 }
 
 
@@ -161,10 +252,7 @@ disasm_cb (DisasmCtx_t *ctx, const uint8_t **startp, const uint8_t *end,
 
   if (ctx->elf != NULL)
     {
-      /* Read all symbols of the ELF file and stuff them into a hash
-	 table.  The key is the address and the section index.  */
-      read_symtab (ctx);
-
+      /* The symbols of the ELF file were read by disasm_begin.  */
       symtoken.ctx = ctx;
       symtoken.symcbarg = symcbarg;
 
@@ -39,6 +39,7 @@
 int
 disasm_end (DisasmCtx_t *ctx)
 {
+  free (ctx->symtab);
   free (ctx);
 
   return 0;
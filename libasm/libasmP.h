@@ -239,6 +239,14 @@ struct AsmScnGrp
 };
 
 
+/* Symbol of the file being disassembled.  */
+struct symaddrpair
+{
+  GElf_Addr addr;
+  const char *name;
+};
+
+
 /* Descriptor for disassembler.   */
 struct DisasmCtx
 {
@@ -251,6 +259,11 @@ struct DisasmCtx
 
   /* Callback function to determine symbol names.  */
   DisasmGetSymCB_t symcb;
+
+  /* The symbols of ELF sorted by address, one per address.  They are
+     only read, so several threads can disassemble with one context.  */
+  struct symaddrpair *symtab;
+  size_t nsymtab;
 };
 
 
@@ -297,6 +310,10 @@ extern int __disasm_cb_internal (DisasmCtx_t *ctx, const uint8_t **startp,
      attribute_hidden;
 
 
+/* Read the symbols of CTX->elf into CTX->symtab.  */
+extern int __libasm_read_symtab (DisasmCtx_t *ctx) internal_function;
+
+
 /* Test whether given symbol is an internal symbol and if yes, whether
    we should nevertheless emit it in the symbol table.  */
 // XXX The second part should probably be controlled by an option which
@@ -1075,8 +1075,12 @@ i386_disasm (const uint8_t **startp, const uint8_t *end, GElf_Addr addr,
 		      size_t bufavail = bufsize - bufcnt;
 		      int r = 0;
 		      if (symstr != NULL)
-			r = snprintf (&buf[bufcnt], bufavail, "# <%s>",
-				      symstr);
+			{
+			  r = snprintf (&buf[bufcnt], bufavail, "# <%s>",
+					symstr);
+			  /* The name is not a label for the next one.  */
+			  output_data.labelbuf[0] = '\0';
+			}
 		      else if (output_data.symaddr_use == addr_abs_always
 			       || output_data.symaddr_use == addr_rel_always)
 			r = snprintf (&buf[bufcnt], bufavail, "# %#" PRIx64,
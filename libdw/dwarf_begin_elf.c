@@ -252,8 +252,11 @@ check_section (Dwarf *result, GElf_Ehdr *ehdr, Elf_Scn *scn, bool inscngrp)
 	/* Get the section data.  */
 	Elf_Data *data = elf_getdata (scn, NULL);
 	if (data != NULL && data->d_size != 0)
-	  /* Yep, there is actually data available.  */
-	  result->sectiondata[cnt] = data;
+	  {
+	    /* Yep, there is actually data available.  */
+	    result->sectiondata[cnt] = data;
+	    result->sectionscn[cnt] = scn;
+	  }
 
 	break;
       }
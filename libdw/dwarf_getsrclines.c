@@ -137,6 +137,15 @@ dwarf_getsrclines (Dwarf_Die *cudie, Dwarf_Lines **lines, size_t *nlines)
 	goto invalid_data;
       lineendp = linep + unit_length;
 
+      /* Have the rest of the line program read in one go, not page by
+	 page as we go through it.  */
+      Elf_Data *linedata = dbg->sectiondata[IDX_debug_line];
+      if (dbg->sectionscn[IDX_debug_line] != NULL)
+	(void) elf_scncntl (dbg->sectionscn[IDX_debug_line],
+			    ELF_C_ADVISE_WILLNEED,
+			    linep - (const unsigned char *) linedata->d_buf,
+			    unit_length);
+
       /* The next element of the header is the version identifier.  */
       uint_fast16_t version = read_2ubyte_unaligned_inc (dbg, linep);
       if (unlikely (version < 2) || unlikely (version > 4))
@@ -135,6 +135,9 @@ struct Dwarf
   /* The section data.  */
   Elf_Data *sectiondata[IDX_last];
 
+  /* The sections of the uncompressed data, for elf_scncntl.  */
+  Elf_Scn *sectionscn[IDX_last];
+
 #if USE_ZLIB
   /* The 1 << N bit is set if sectiondata[N] is malloc'd decompressed data.  */
   unsigned int sectiondata_gzip_mask:IDX_last;
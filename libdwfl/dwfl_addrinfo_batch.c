@@ -0,0 +1,185 @@
+/* Symbolize a batch of addresses.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#include "libdwflP.h"
+#include "../libdw/libdwP.h"
+
+static int
+compare_addrinfo (const void *a, const void *b)
+{
+  const Dwfl_Addrinfo *const *p1 = a;
+  const Dwfl_Addrinfo *const *p2 = b;
+
+  if ((*p1)->addr < (*p2)->addr)
+    return -1;
+  if ((*p1)->addr > (*p2)->addr)
+    return 1;
+  /* Keep duplicates in input order so the first one does the work.  */
+  return *p1 < *p2 ? -1 : *p1 > *p2;
+}
+
+int
+dwfl_addrinfo_batch (Dwfl *dwfl, Dwfl_Addrinfo *infos, size_t n,
+		     bool inlines)
+{
+  if (dwfl == NULL)
+    return -1;
+
+  if (n == 0)
+    return 0;
+
+  Dwfl_Addrinfo **sorted = malloc (n * sizeof sorted[0]);
+  if (unlikely (sorted == NULL))
+    {
+      __libdwfl_seterrno (DWFL_E_NOMEM);
+      return -1;
+    }
+  for (size_t i = 0; i < n; ++i)
+    sorted[i] = &infos[i];
+  qsort (sorted, n, sizeof sorted[0], &compare_addrinfo);
+
+  /* The last symbol found and the address range it stays valid for.  */
+  Dwfl_Module *symmod = NULL;
+  GElf_Addr symvalue = 0;
+  GElf_Addr symend = 0;
+  const char *symname = NULL;
+  GElf_Sym sym;
+
+  /* The CU of the last address, the address where it might end, and the
+     first line in its table not below the last address.  */
+  Dwfl_Module *cumod = NULL;
+  struct dwfl_cu *cu = NULL;
+  Dwarf_Addr cuend = 0;
+  Dwarf_Addr bias = 0;
+  bool have_lines = false;
+  size_t lineidx = 0;
+
+  int result = 0;
+  const Dwfl_Addrinfo *last = NULL;
+  for (size_t i = 0; i < n; ++i)
+    {
+      Dwfl_Addrinfo *info = sorted[i];
+      const Dwarf_Addr addr = info->addr;
+
+      if (last != NULL && last->addr == addr)
+	{
+	  /* Duplicate address, share the answer.  */
+	  *info = *last;
+	  if (last->scopes != NULL)
+	    {
+	      size_t size = last->nscopes * sizeof last->scopes[0];
+	      info->scopes = malloc (size);
+	      if (unlikely (info->scopes == NULL))
+		{
+		  info->nscopes = 0;
+		  __libdwfl_seterrno (DWFL_E_NOMEM);
+		  result = -1;
+		}
+	      else
+		memcpy (info->scopes, last->scopes, size);
+	    }
+	  continue;
+	}
+      last = info;
+
+      info->name = NULL;
+      info->offset = 0;
+      info->line = NULL;
+      info->scopes = NULL;
+      info->nscopes = 0;
+
+      info->mod = INTUSE(dwfl_addrmodule) (dwfl, addr);
+      if (info->mod == NULL)
+	continue;
+
+      /* The addresses come in ascending order, so the symbol found for
+	 the previous one often still is the best match.  */
+      if (info->mod != symmod || addr >= symend)
+	{
+	  GElf_Off off = 0;
+	  symmod = info->mod;
+	  symend = addr + 1;
+	  symname = __libdwfl_addrsym (symmod, addr, &off, &sym, NULL, NULL,
+				       NULL, &symend, false);
+	  symvalue = addr - off;
+	}
+      if (symname != NULL)
+	{
+	  info->name = symname;
+	  info->sym = sym;
+	  info->offset = addr - symvalue;
+	}
+
+      /* Walk the line table of the CU along with the addresses as long
+	 as they stay in it.  */
+      if (info->mod != cumod || addr >= cuend)
+	{
+	  cumod = info->mod;
+	  cu = NULL;
+	  cuend = addr + 1;
+	  have_lines = false;
+	  lineidx = 0;
+
+	  struct dwfl_cu *addrcu;
+	  if (INTUSE(dwfl_module_getdwarf) (cumod, &bias) != NULL
+	      && __libdwfl_addrcu_end (cumod, addr, &addrcu,
+				       &cuend) == DWFL_E_NOERROR)
+	    {
+	      cu = addrcu;
+	      have_lines = __libdwfl_cu_getsrclines (cu) == DWFL_E_NOERROR;
+	    }
+	}
+
+      if (have_lines)
+	{
+	  const Dwarf_Lines *lines = cu->die.cu->lines;
+	  const Dwarf_Addr cuaddr = addr - bias;
+	  while (lineidx < lines->nlines && lines->info[lineidx].addr < cuaddr)
+	    ++lineidx;
+
+	  if (lineidx < lines->nlines && lines->info[lineidx].addr == cuaddr)
+	    /* Pick the same of several lines at CUADDR as
+	       dwfl_module_getsrc.  */
+	    info->line = __libdwfl_cu_getsrc (cu, cuaddr);
+	  else if (lineidx > 0 && lineidx < lines->nlines)
+	    info->line = &cu->lines->idx[lineidx - 1];
+	}
+
+      if (inlines && cu != NULL)
+	{
+	  int nscopes = dwarf_getscopes (&cu->die, addr - bias,
+					 &info->scopes);
+	  if (nscopes > 0)
+	    info->nscopes = nscopes;
+	  else
+	    info->scopes = NULL;
+	}
+    }
+
+  free (sorted);
+  return result;
+}
@@ -116,6 +116,7 @@ __libdwfl_process_free (Dwfl_Process *process)
   dwfl->process = NULL;
   if (process->ebl_close)
     ebl_closebackend (process->ebl);
+  pthread_mutex_destroy (&process->lock);
   free (process);
 }
 
@@ -126,6 +127,12 @@ process_alloc (Dwfl *dwfl)
   Dwfl_Process *process = malloc (sizeof (*process));
   if (process == NULL)
     return;
+  if (pthread_mutex_init (&process->lock, NULL) != 0)
+    {
+      free (process);
+      return;
+    }
+  process->parallel = false;
   process->dwfl = dwfl;
   dwfl->process = process;
 }
@@ -279,6 +286,187 @@ dwfl_getthreads (Dwfl *dwfl, int (*callback) (Dwfl_Thread *thread, void *arg),
 }
 INTDEF(dwfl_getthreads)
 
+struct parallel_arg
+{
+  Dwfl_Process *process;
+  pid_t *tids;
+  void **thread_args;
+  size_t nthreads;
+  int (*callback) (Dwfl_Thread *thread, size_t ndx, void *arg);
+  void *arg;
+
+  /* LOCK protects everything below.  */
+  pthread_mutex_t lock;
+  /* Index of the next thread to hand out to a worker.  */
+  size_t next;
+  /* Lowest index whose callback did not return DWARF_CB_OK, or NTHREADS.
+     Only threads below it still get handed out.  */
+  size_t stop;
+  int ret;
+  Dwfl_Error error;
+};
+
+static void *
+parallel_worker (void *arg)
+{
+  struct parallel_arg *pa = arg;
+  for (;;)
+    {
+      pthread_mutex_lock (&pa->lock);
+      size_t ndx = pa->next;
+      bool done = ndx >= pa->stop;
+      if (! done)
+	pa->next++;
+      pthread_mutex_unlock (&pa->lock);
+      if (done)
+	return NULL;
+
+      Dwfl_Thread thread;
+      thread.process = pa->process;
+      thread.tid = pa->tids[ndx];
+      thread.unwound = NULL;
+      thread.callbacks_arg = pa->thread_args[ndx];
+      int err = pa->callback (&thread, ndx, pa->arg);
+      Dwfl_Error error = dwfl_errno ();
+      thread_free_all_states (&thread);
+      if (err != DWARF_CB_OK)
+	{
+	  pthread_mutex_lock (&pa->lock);
+	  if (ndx < pa->stop)
+	    {
+	      pa->stop = ndx;
+	      pa->ret = err;
+	      pa->error = error;
+	    }
+	  pthread_mutex_unlock (&pa->lock);
+	}
+    }
+}
+
+static int
+serial_callback (Dwfl_Thread *thread, void *arg)
+{
+  struct parallel_arg *pa = arg;
+  return pa->callback (thread, pa->next++, pa->arg);
+}
+
+static void
+run_workers (struct parallel_arg *pa, unsigned int nworkers)
+{
+  pthread_t workers[nworkers];
+  unsigned int started = 0;
+  while (started < nworkers
+	 && pthread_create (&workers[started], NULL,
+			    &parallel_worker, pa) == 0)
+    started++;
+  /* If no worker could be started do all the work here.  */
+  if (started == 0)
+    parallel_worker (pa);
+  for (unsigned int i = 0; i < started; i++)
+    pthread_join (workers[i], NULL);
+}
+
+int
+dwfl_getthreads_parallel (Dwfl *dwfl, unsigned int nworkers,
+			  int (*callback) (Dwfl_Thread *thread, size_t ndx,
+					   void *arg),
+			  void *arg)
+{
+  Dwfl_Process *process = dwfl->process;
+  if (process == NULL)
+    {
+      __libdwfl_seterrno (DWFL_E_NO_ATTACH_STATE);
+      return -1;
+    }
+
+  /* Other backends than the ptrace one keep their thread iteration state
+     in the shared thread callbacks_arg and read the shared core Elf, run
+     them in order here.  Threads the caller has ptrace stopped itself can
+     only be read from the calling thread, the one that attached them.  */
+  struct __libdwfl_pid_arg *pid_arg = __libdwfl_get_pid_arg (dwfl);
+  if (pid_arg == NULL || pid_arg->assume_ptrace_stopped)
+    {
+      struct parallel_arg pa = { .callback = callback, .arg = arg };
+      return INTUSE(dwfl_getthreads) (dwfl, serial_callback, &pa);
+    }
+
+  /* Collect all threads first, next_thread need not be thread safe.  */
+  struct parallel_arg pa = { .process = process, .callback = callback,
+			     .arg = arg, .ret = DWARF_CB_OK,
+			     .error = DWFL_E_NOERROR };
+  size_t nalloc = 0;
+  void *thread_arg = NULL;
+  int result = 0;
+  for (;;)
+    {
+      pid_t tid = process->callbacks->next_thread (dwfl,
+						   process->callbacks_arg,
+						   &thread_arg);
+      if (tid < 0)
+	{
+	  result = -1;
+	  goto out;
+	}
+      if (tid == 0)
+	break;
+      if (pa.nthreads == nalloc)
+	{
+	  nalloc = nalloc == 0 ? 64 : nalloc * 2;
+	  pid_t *tids = realloc (pa.tids, nalloc * sizeof tids[0]);
+	  if (tids != NULL)
+	    pa.tids = tids;
+	  void **thread_args = realloc (pa.thread_args,
+					nalloc * sizeof thread_args[0]);
+	  if (thread_args != NULL)
+	    pa.thread_args = thread_args;
+	  if (tids == NULL || thread_args == NULL)
+	    {
+	      __libdwfl_seterrno (DWFL_E_NOMEM);
+	      result = -1;
+	      goto out;
+	    }
+	}
+      pa.tids[pa.nthreads] = tid;
+      pa.thread_args[pa.nthreads] = thread_arg;
+      pa.nthreads++;
+    }
+
+  if (nworkers == 0)
+    {
+      long ncpus = sysconf (_SC_NPROCESSORS_ONLN);
+      nworkers = ncpus > 0 ? ncpus : 1;
+    }
+  if (nworkers > pa.nthreads)
+    nworkers = pa.nthreads;
+  if (nworkers == 0)
+    goto out;
+
+  pa.next = 0;
+  pa.stop = pa.nthreads;
+  if (pthread_mutex_init (&pa.lock, NULL) != 0)
+    {
+      __libdwfl_seterrno (DWFL_E_NOMEM);
+      result = -1;
+      goto out;
+    }
+
+  /* The ptrace callbacks only use state of the calling thread.  */
+  process->parallel = true;
+
+  run_workers (&pa, nworkers);
+
+  process->parallel = false;
+  pthread_mutex_destroy (&pa.lock);
+
+  result = pa.ret;
+  __libdwfl_seterrno (pa.error);
+
+ out:
+  free (pa.tids);
+  free (pa.thread_args);
+  return result;
+}
+
 struct one_arg
 {
   pid_t tid;
@@ -35,7 +35,8 @@ const char *
 internal_function
 __libdwfl_addrsym (Dwfl_Module *mod, GElf_Addr addr, GElf_Off *off,
 		   GElf_Sym *closest_sym, GElf_Word *shndxp,
-		   Elf **elfp, Dwarf_Addr *biasp, bool adjust_st_value)
+		   Elf **elfp, Dwarf_Addr *biasp, GElf_Addr *validp,
+		   bool adjust_st_value)
 {
   int syments = INTUSE(dwfl_module_getsymtab) (mod);
   if (syments < 0)
@@ -106,6 +107,10 @@ __libdwfl_addrsym (Dwfl_Module *mod, GElf_Addr addr, GElf_Off *off,
   /* Keep track of the lowest address a relevant sizeless symbol could have.  */
   GElf_Addr min_label = 0;
 
+  /* Keep track of the lowest address above ADDR where a symbol starts or
+     ends.  Up to there the set of candidate symbols does not change.  */
+  GElf_Addr next_boundary = (GElf_Addr) -1;
+
   /* Try one symbol and associated value from the search table.  */
   inline void try_sym_value (GElf_Addr value, GElf_Sym *sym,
 			     const char *name, GElf_Word shndx,
@@ -117,6 +122,10 @@ __libdwfl_addrsym (Dwfl_Module *mod, GElf_Addr addr, GElf_Off *off,
     if (value + sym->st_size > min_label)
       min_label = value + sym->st_size;
 
+    if (sym->st_size != 0 && value + sym->st_size > addr
+	&& value + sym->st_size < next_boundary)
+      next_boundary = value + sym->st_size;
+
     if (sym->st_size == 0 || addr - value < sym->st_size)
       {
 	/* Return GELF_ST_BIND as higher-is-better integer.  */
@@ -202,11 +211,17 @@ __libdwfl_addrsym (Dwfl_Module *mod, GElf_Addr addr, GElf_Off *off,
 					       &resolved, adjust_st_value);
 	  if (name != NULL && name[0] != '\0'
 	      && sym.st_shndx != SHN_UNDEF
-	      && value <= addr
 	      && GELF_ST_TYPE (sym.st_info) != STT_SECTION
 	      && GELF_ST_TYPE (sym.st_info) != STT_FILE
 	      && GELF_ST_TYPE (sym.st_info) != STT_TLS)
 	    {
+	      if (value > addr)
+		{
+		  if (value < next_boundary)
+		    next_boundary = value;
+		  continue;
+		}
+
 	      try_sym_value (value, &sym, name, shndx, elf, resolved);
 
 	      /* If this is an addrinfo variant and the value could be
@@ -219,6 +234,9 @@ __libdwfl_addrsym (Dwfl_Module *mod, GElf_Addr addr, GElf_Off *off,
 		  if (value != adjusted_st_value && adjusted_st_value <= addr)
 		    try_sym_value (adjusted_st_value, &sym, name, shndx,
 				   elf, false);
+		  else if (adjusted_st_value > addr
+			   && adjusted_st_value < next_boundary)
+		    next_boundary = adjusted_st_value;
 		}
 	    }
 	}
@@ -244,6 +262,12 @@ __libdwfl_addrsym (Dwfl_Module *mod, GElf_Addr addr, GElf_Off *off,
       && (sizeless_name == NULL || sizeless_value != addr))
     search_table (1, first_global);
 
+  /* A proper sized symbol stays the best choice up to the next symbol
+     boundary.  A sizeless fallback also depends on the section of ADDR
+     and on exact matches, so don't promise anything for those.  */
+  if (validp != NULL)
+    *validp = closest_name != NULL ? next_boundary : addr + 1;
+
   /* If we found no proper sized symbol to use, fall back to the best
      candidate sizeless symbol we found, if any.  */
   if (closest_name == NULL
@@ -274,7 +298,7 @@ dwfl_module_addrsym (Dwfl_Module *mod, GElf_Addr addr,
 {
   GElf_Off off;
   return __libdwfl_addrsym (mod, addr, &off, closest_sym, shndxp,
-			    NULL, NULL, true);
+			    NULL, NULL, NULL, true);
 }
 INTDEF (dwfl_module_addrsym)
 
@@ -284,6 +308,6 @@ const char
 		       GElf_Word *shndxp, Elf **elfp, Dwarf_Addr *bias)
 {
   return __libdwfl_addrsym (mod, address, offset, sym, shndxp, elfp, bias,
-			    false);
+			    NULL, false);
 }
 INTDEF (dwfl_module_addrinfo)
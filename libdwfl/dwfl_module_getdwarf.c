@@ -552,6 +552,10 @@ find_debuginfo (Dwfl_Module *mod)
 							   debuglink_crc,
 							   &mod->debug.name);
   Dwfl_Error result = open_elf (mod, &mod->debug);
+  if (result == DWFL_E_NOERROR)
+    /* Usually only small parts of the separate debuginfo file are
+       needed to look up some addresses, so don't read ahead.  */
+    (void) elf_cntl (mod->debug.elf, ELF_C_ADVISE_RANDOM);
   if (result == DWFL_E_NOERROR && mod->debug.address_sync != 0)
     result = find_prelink_address_sync (mod, &mod->debug);
   return result;
@@ -903,75 +907,62 @@ find_aux_sym (Dwfl_Module *mod __attribute__ ((unused)),
   void *buffer = NULL;
   size_t size = 0;
   error = __libdw_unlzma (-1, 0, rawdata->d_buf, rawdata->d_size,
-			  &buffer, &size);
+			  &buffer, &size, &mod->aux_sym.elf);
+  free (buffer);
   if (error == DWFL_E_NOERROR)
     {
-      if (unlikely (size == 0))
-	free (buffer);
-      else
+      mod->aux_sym.fd = -1;
+      if (open_elf (mod, &mod->aux_sym) != DWFL_E_NOERROR)
+	return;
+      if (! find_aux_address_sync (mod))
 	{
-	  mod->aux_sym.elf = elf_memory (buffer, size);
-	  if (mod->aux_sym.elf == NULL)
-	    free (buffer);
-	  else
-	    {
-	      mod->aux_sym.fd = -1;
-	      mod->aux_sym.elf->flags |= ELF_F_MALLOCED;
-	      if (open_elf (mod, &mod->aux_sym) != DWFL_E_NOERROR)
-		return;
-	      if (! find_aux_address_sync (mod))
-		{
-		  elf_end (mod->aux_sym.elf);
-		  mod->aux_sym.elf = NULL;
-		  return;
-		}
+	  elf_end (mod->aux_sym.elf);
+	  mod->aux_sym.elf = NULL;
+	  return;
+	}
 
-	      /* So far, so good. Get minisymtab table data and cache it. */
-	      bool minisymtab = false;
-	      scn = NULL;
-	      while ((scn = elf_nextscn (mod->aux_sym.elf, scn)) != NULL)
-		{
-		  GElf_Shdr shdr_mem, *shdr = gelf_getshdr (scn, &shdr_mem);
-		  if (shdr != NULL)
-		    switch (shdr->sh_type)
-		      {
-		      case SHT_SYMTAB:
-			minisymtab = true;
-			*aux_symscn = scn;
-			*aux_strshndx = shdr->sh_link;
-			mod->aux_syments = shdr->sh_size / shdr->sh_entsize;
-			mod->aux_first_global = shdr->sh_info;
-			if (*aux_xndxscn != NULL)
-			  return;
-			break;
-
-		      case SHT_SYMTAB_SHNDX:
-			*aux_xndxscn = scn;
-			if (minisymtab)
-			  return;
-			break;
-
-		      default:
-			break;
-		      }
-		}
+      /* So far, so good. Get minisymtab table data and cache it. */
+      bool minisymtab = false;
+      scn = NULL;
+      while ((scn = elf_nextscn (mod->aux_sym.elf, scn)) != NULL)
+	{
+	  GElf_Shdr shdr_mem, *shdr = gelf_getshdr (scn, &shdr_mem);
+	  if (shdr != NULL)
+	    switch (shdr->sh_type)
+	      {
+	      case SHT_SYMTAB:
+		minisymtab = true;
+		*aux_symscn = scn;
+		*aux_strshndx = shdr->sh_link;
+		mod->aux_syments = shdr->sh_size / shdr->sh_entsize;
+		mod->aux_first_global = shdr->sh_info;
+		if (*aux_xndxscn != NULL)
+		  return;
+		break;
 
-	      if (minisymtab)
-		/* We found one, though no SHT_SYMTAB_SHNDX to go with it.  */
-		return;
+	      case SHT_SYMTAB_SHNDX:
+		*aux_xndxscn = scn;
+		if (minisymtab)
+		  return;
+		break;
 
-	      /* We found no SHT_SYMTAB, so everything else is bogus.  */
-	      *aux_xndxscn = NULL;
-	      *aux_strshndx = 0;
-	      mod->aux_syments = 0;
-	      elf_end (mod->aux_sym.elf);
-	      mod->aux_sym.elf = NULL;
-	      return;
-	    }
+	      default:
+		break;
+	      }
 	}
+
+      if (minisymtab)
+	/* We found one, though no SHT_SYMTAB_SHNDX to go with it.  */
+	return;
+
+      /* We found no SHT_SYMTAB, so everything else is bogus.  */
+      *aux_xndxscn = NULL;
+      *aux_strshndx = 0;
+      mod->aux_syments = 0;
+      elf_end (mod->aux_sym.elf);
+      mod->aux_sym.elf = NULL;
+      return;
     }
-  else
-    free (buffer);
 #endif
 }
 
@@ -29,6 +29,37 @@
 #include "libdwflP.h"
 #include "../libdw/libdwP.h"
 
+Dwfl_Line *
+internal_function
+__libdwfl_cu_getsrc (struct dwfl_cu *cu, Dwarf_Addr addr)
+{
+  /* The lines are sorted by address, so we can use binary search.  */
+  size_t l = 0, u = cu->die.cu->lines->nlines;
+  while (l < u)
+    {
+      size_t idx = (l + u) / 2;
+      if (addr < cu->die.cu->lines->info[idx].addr)
+	u = idx;
+      else if (addr > cu->die.cu->lines->info[idx].addr)
+	l = idx + 1;
+      else
+	return &cu->lines->idx[idx];
+    }
+
+  if (cu->die.cu->lines->nlines > 0)
+    assert (cu->die.cu->lines->info
+	    [cu->die.cu->lines->nlines - 1].end_sequence);
+
+  /* If none were equal, the closest one below is what we want.
+     We never want the last one, because it's the end-sequence
+     marker with an address at the high bound of the CU's code.  */
+  if (u > 0 && u < cu->die.cu->lines->nlines
+      && addr > cu->die.cu->lines->info[u - 1].addr)
+    return &cu->lines->idx[u - 1];
+
+  return NULL;
+}
+
 Dwfl_Line *
 dwfl_module_getsrc (Dwfl_Module *mod, Dwarf_Addr addr)
 {
@@ -43,31 +74,9 @@ dwfl_module_getsrc (Dwfl_Module *mod, Dwarf_Addr addr)
   if (likely (error == DWFL_E_NOERROR))
     {
       /* Now we look at the module-relative address.  */
-      addr -= bias;
-
-      /* The lines are sorted by address, so we can use binary search.  */
-      size_t l = 0, u = cu->die.cu->lines->nlines;
-      while (l < u)
-	{
-	  size_t idx = (l + u) / 2;
-	  if (addr < cu->die.cu->lines->info[idx].addr)
-	    u = idx;
-	  else if (addr > cu->die.cu->lines->info[idx].addr)
-	    l = idx + 1;
-	  else
-	    return &cu->lines->idx[idx];
-	}
-
-      if (cu->die.cu->lines->nlines > 0)
-	assert (cu->die.cu->lines->info
-		[cu->die.cu->lines->nlines - 1].end_sequence);
-
-      /* If none were equal, the closest one below is what we want.
-	 We never want the last one, because it's the end-sequence
-	 marker with an address at the high bound of the CU's code.  */
-      if (u > 0 && u < cu->die.cu->lines->nlines
-	  && addr > cu->die.cu->lines->info[u - 1].addr)
-	return &cu->lines->idx[u - 1];
+      Dwfl_Line *line = __libdwfl_cu_getsrc (cu, addr - bias);
+      if (line != NULL)
+	return line;
 
       error = DWFL_E_ADDR_OUTOFRANGE;
     }
@@ -522,8 +522,13 @@ new_unwound (Dwfl_Frame *state)
 static void
 handle_cfi (Dwfl_Frame *state, Dwarf_Addr pc, Dwarf_CFI *cfi, Dwarf_Addr bias)
 {
+  Dwfl_Thread *thread = state->thread;
+  Dwfl_Process *process = thread->process;
   Dwarf_Frame *frame;
-  if (INTUSE(dwarf_cfi_addrframe) (cfi, pc, &frame) != 0)
+  process_lock (process);
+  int result = INTUSE(dwarf_cfi_addrframe) (cfi, pc, &frame);
+  process_unlock (process);
+  if (result != 0)
     {
       __libdwfl_seterrno (DWFL_E_LIBDW);
       return;
@@ -531,8 +536,6 @@ handle_cfi (Dwfl_Frame *state, Dwarf_Addr pc, Dwarf_CFI *cfi, Dwarf_Addr bias)
   new_unwound (state);
   Dwfl_Frame *unwound = state->unwound;
   unwound->signal_frame = frame->fde->cie->signal_frame;
-  Dwfl_Thread *thread = state->thread;
-  Dwfl_Process *process = thread->process;
   Ebl *ebl = process->ebl;
   size_t nregs = ebl_frame_nregs (ebl);
   assert (nregs > 0);
@@ -677,20 +680,27 @@ __libdwfl_frame_unwind (Dwfl_Frame *state)
      Then we need to unwind from the original, unadjusted PC.  */
   if (! state->initial_frame && ! state->signal_frame)
     pc--;
-  Dwfl_Module *mod = INTUSE(dwfl_addrmodule) (state->thread->process->dwfl, pc);
+  Dwfl_Process *process = state->thread->process;
+  process_lock (process);
+  Dwfl_Module *mod = INTUSE(dwfl_addrmodule) (process->dwfl, pc);
+  process_unlock (process);
   if (mod == NULL)
     __libdwfl_seterrno (DWFL_E_NO_DWARF);
   else
     {
       Dwarf_Addr bias;
+      process_lock (process);
       Dwarf_CFI *cfi_eh = INTUSE(dwfl_module_eh_cfi) (mod, &bias);
+      process_unlock (process);
       if (cfi_eh)
 	{
 	  handle_cfi (state, pc - bias, cfi_eh, bias);
 	  if (state->unwound)
 	    return;
 	}
+      process_lock (process);
       Dwarf_CFI *cfi_dwarf = INTUSE(dwfl_module_dwarf_cfi) (mod, &bias);
+      process_unlock (process);
       if (cfi_dwarf)
 	{
 	  handle_cfi (state, pc - bias, cfi_dwarf, bias);
@@ -699,8 +709,6 @@ __libdwfl_frame_unwind (Dwfl_Frame *state)
 	}
     }
   assert (state->unwound == NULL);
-  Dwfl_Thread *thread = state->thread;
-  Dwfl_Process *process = thread->process;
   Ebl *ebl = process->ebl;
   new_unwound (state);
   state->unwound->pc_state = DWFL_FRAME_STATE_PC_UNDEFINED;
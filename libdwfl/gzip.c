@@ -29,7 +29,9 @@
 #include "libdwflP.h"
 #include "system.h"
 
+#include <limits.h>
 #include <unistd.h>
+#include <sys/param.h>
 
 #ifdef LZMA
 # define USE_INFLATE	1
@@ -67,89 +69,98 @@
 
 #define READ_SIZE		(1 << 20)
 
-/* If this is not a compressed image, return DWFL_E_BADELF.
-   If we uncompressed it into *WHOLE, *WHOLE_SIZE, return DWFL_E_NOERROR.
-   Otherwise return an error for bad compressed data or I/O failure.
-   If we return an error after reading the first part of the file,
-   leave that portion malloc'd in *WHOLE, *WHOLE_SIZE.  If *WHOLE
-   is not null on entry, we'll use it in lieu of repeating a read.  */
+/* The state of decompressing one file, read by libelf piece by piece.  */
+struct unzip_state
+{
+  int fd;
+  off64_t start_offset;
 
-Dwfl_Error internal_function
-unzip (int fd, off64_t start_offset,
-       void *mapped, size_t mapped_size,
-       void **whole, size_t *whole_size)
+  /* Our buffer for the input read from FD, or NULL if it is mapped.  */
+  void *input_buffer;
+  off_t input_pos;
+  size_t mapped_size;
+
+#if USE_INFLATE
+  z_stream z;
+  bool eof;
+#else
+  gzFile zf;
+#endif
+
+  /* The error of the decompressor, if reading failed.  */
+  int result;
+
+  /* The number of bytes decompressed so far.  */
+  size_t total;
+};
+
+/* Return FAILURE.  If all we read is the first part of the file, leave
+   that in *WHOLE, *WHOLE_SIZE for the next decompressor to try.  */
+static Dwfl_Error
+fail (struct unzip_state *state, void **whole, size_t *whole_size,
+      Dwfl_Error failure)
 {
-  void *buffer = NULL;
-  size_t size = 0;
-  inline bool bigger_buffer (size_t start)
-  {
-    size_t more = size ? size * 2 : start;
-    char *b = realloc (buffer, more);
-    while (unlikely (b == NULL) && more >= size + 1024)
-      b = realloc (buffer, more -= 1024);
-    if (unlikely (b == NULL))
-      return false;
-    buffer = b;
-    size = more;
-    return true;
-  }
-  inline void smaller_buffer (size_t end)
-  {
-    buffer = realloc (buffer, end) ?: end == 0 ? NULL : buffer;
-    size = end;
-  }
-
-  void *input_buffer = NULL;
-  off_t input_pos = 0;
-
-  inline Dwfl_Error fail (Dwfl_Error failure)
-  {
-    if (input_pos == (off_t) mapped_size)
-      *whole = input_buffer;
-    else
-      {
-	free (input_buffer);
-	*whole = NULL;
-      }
-    free (buffer);
-    return failure;
-  }
-
-  inline Dwfl_Error zlib_fail (int result)
-  {
-    switch (result)
-      {
-      case Z (MEM_ERROR):
-	return fail (DWFL_E_NOMEM);
-      case Z (ERRNO):
-	return fail (DWFL_E_ERRNO);
-      default:
-	return fail (DWFL_E_ZLIB);
-      }
-  }
+  if (state->input_buffer != NULL
+      && state->input_pos == (off_t) state->mapped_size)
+    {
+      *whole = state->input_buffer;
+      *whole_size = state->mapped_size;
+    }
+  else
+    {
+      free (state->input_buffer);
+      *whole = NULL;
+    }
+  return failure;
+}
+
+static Dwfl_Error
+zlib_error (int result)
+{
+  switch (result)
+    {
+    case Z (MEM_ERROR):
+      return DWFL_E_NOMEM;
+    case Z (ERRNO):
+      return DWFL_E_ERRNO;
+    default:
+      return DWFL_E_ZLIB;
+    }
+}
+
+/* Start decompressing.  If this is not a compressed image, return
+   DWFL_E_BADELF.  */
+static Dwfl_Error
+unzip_begin (struct unzip_state *state, int fd, off64_t start_offset,
+	     void *mapped, size_t mapped_size,
+	     void **whole, size_t *whole_size)
+{
+  *state = (struct unzip_state) { .fd = fd, .start_offset = start_offset };
 
   if (mapped == NULL)
     {
       if (*whole == NULL)
 	{
-	  input_buffer = malloc (READ_SIZE);
-	  if (unlikely (input_buffer == NULL))
+	  state->input_buffer = malloc (READ_SIZE);
+	  if (unlikely (state->input_buffer == NULL))
 	    return DWFL_E_NOMEM;
 
-	  ssize_t n = pread_retry (fd, input_buffer, READ_SIZE, start_offset);
+	  ssize_t n = pread_retry (fd, state->input_buffer, READ_SIZE,
+				   start_offset);
 	  if (unlikely (n < 0))
-	    return zlib_fail (Z (ERRNO));
+	    return fail (state, whole, whole_size, DWFL_E_ERRNO);
 
-	  input_pos = n;
-	  mapped = input_buffer;
+	  state->input_pos = n;
+	  mapped = state->input_buffer;
 	  mapped_size = n;
 	}
       else
 	{
-	  input_buffer = *whole;
-	  input_pos = mapped_size = *whole_size;
+	  state->input_buffer = mapped = *whole;
+	  state->input_pos = mapped_size = *whole_size;
 	}
     }
+  state->mapped_size = mapped_size;
 
 #define NOMAGIC(magic) \
   (mapped_size <= sizeof magic || memcmp (mapped, magic, sizeof magic - 1))
@@ -161,7 +172,7 @@ unzip (int fd, off64_t start_offset,
 #endif
       )
     /* Not a compressed file.  */
-    return DWFL_E_BADELF;
+    return fail (state, whole, whole_size, DWFL_E_BADELF);
 
 #if USE_INFLATE
 
@@ -169,127 +180,154 @@ unzip (int fd, off64_t start_offset,
      The stupid zlib interface has nothing to grok the
      gzip file headers except the slow gzFile interface.  */
 
-  z_stream z = { .next_in = mapped, .avail_in = mapped_size };
-  int result = inflateInit (&z);
+  state->z.next_in = mapped;
+  state->z.avail_in = mapped_size;
+  int result = inflateInit (&state->z);
   if (result != Z (OK))
     {
-      inflateEnd (&z);
-      return zlib_fail (result);
+      inflateEnd (&state->z);
+      return fail (state, whole, whole_size, zlib_error (result));
     }
 
-  do
+#else  /* gzip only.  */
+
+  /* Let the decompression library read the file directly.  */
+
+  int d = dup (fd);
+  if (unlikely (d < 0))
+    return fail (state, whole, whole_size, DWFL_E_BADELF);
+  if (start_offset != 0)
     {
-      if (z.avail_in == 0 && input_buffer != NULL)
-	{
-	  ssize_t n = pread_retry (fd, input_buffer, READ_SIZE,
-				   start_offset + input_pos);
-	  if (unlikely (n < 0))
-	    {
-	      inflateEnd (&z);
-	      return zlib_fail (Z (ERRNO));
-	    }
-	  z.next_in = input_buffer;
-	  z.avail_in = n;
-	  input_pos += n;
-	}
-      if (z.avail_out == 0)
+      off64_t off = lseek (d, start_offset, SEEK_SET);
+      if (off != start_offset)
 	{
-	  ptrdiff_t pos = (void *) z.next_out - buffer;
-	  if (!bigger_buffer (z.avail_in))
-	    {
-	      result = Z (MEM_ERROR);
-	      break;
-	    }
-	  z.next_out = buffer + pos;
-	  z.avail_out = size - pos;
+	  close (d);
+	  return fail (state, whole, whole_size, DWFL_E_BADELF);
 	}
     }
-  while ((result = do_inflate (&z)) == Z (OK));
-
-#ifdef BZLIB
-  uint64_t total_out = (((uint64_t) z.total_out_hi32 << 32)
-			| z.total_out_lo32);
-  smaller_buffer (total_out);
-#else
-  smaller_buffer (z.total_out);
-#endif
-
-  inflateEnd (&z);
-
-  if (result != Z (STREAM_END))
-    return zlib_fail (result);
-
-#else  /* gzip only.  */
+  state->zf = gzdopen (d, "r");
+  if (unlikely (state->zf == NULL))
+    {
+      close (d);
+      return fail (state, whole, whole_size, DWFL_E_NOMEM);
+    }
 
-  /* Let the decompression library read the file directly.  */
+  /* From here on, zlib will close D.  */
 
-  gzFile zf;
-  Dwfl_Error open_stream (void)
-  {
-    int d = dup (fd);
-    if (unlikely (d < 0))
-      return DWFL_E_BADELF;
-    if (start_offset != 0)
-      {
-	off64_t off = lseek (d, start_offset, SEEK_SET);
-	if (off != start_offset)
-	  {
-	    close (d);
-	    return DWFL_E_BADELF;
-	  }
-      }
-    zf = gzdopen (d, "r");
-    if (unlikely (zf == NULL))
-      {
-	close (d);
-	return zlib_fail (Z (MEM_ERROR));
-      }
-
-    /* From here on, zlib will close D.  */
-
-    return DWFL_E_NOERROR;
-  }
-
-  Dwfl_Error result = open_stream ();
-
-  if (result == DWFL_E_NOERROR && gzdirect (zf))
+  if (gzdirect (state->zf))
     {
-      gzclose (zf);
-      return fail (DWFL_E_BADELF);
+      gzclose (state->zf);
+      return fail (state, whole, whole_size, DWFL_E_BADELF);
     }
+#endif
+
+  return DWFL_E_NOERROR;
+}
 
-  if (result != DWFL_E_NOERROR)
-    return fail (result);
+/* Decompress up to SIZE bytes into BUF, for elf_begin_stream.  */
+static ssize_t
+unzip_read (void *arg, void *buf, size_t size)
+{
+  struct unzip_state *state = arg;
 
-  ptrdiff_t pos = 0;
-  while (1)
+#if USE_INFLATE
+  state->z.next_out = buf;
+  state->z.avail_out = MIN (size, (size_t) UINT_MAX);
+  size = state->z.avail_out;
+  while (state->z.avail_out > 0 && ! state->eof)
     {
-      if (!bigger_buffer (1024))
+      if (state->z.avail_in == 0 && state->input_buffer != NULL)
+	{
+	  ssize_t n = pread_retry (state->fd, state->input_buffer, READ_SIZE,
+				   state->start_offset + state->input_pos);
+	  if (unlikely (n < 0))
+	    {
+	      state->result = Z (ERRNO);
+	      return -1;
+	    }
+	  state->z.next_in = state->input_buffer;
+	  state->z.avail_in = n;
+	  state->input_pos += n;
+	}
+
+      size_t avail_in = state->z.avail_in;
+      size_t avail_out = state->z.avail_out;
+      int result = do_inflate (&state->z);
+      if (result == Z (STREAM_END))
+	state->eof = true;
+      else if (result != Z (OK))
 	{
-	  gzclose (zf);
-	  return zlib_fail (Z (MEM_ERROR));
+	  state->result = result;
+	  return -1;
 	}
-      int n = gzread (zf, buffer + pos, size - pos);
-      if (n < 0)
+      else if (avail_in == 0 && state->z.avail_out == avail_out)
 	{
-	  int code;
-	  gzerror (zf, &code);
-	  gzclose (zf);
-	  return zlib_fail (code);
+	  /* The input ends before the compressed data.  */
+	  state->result = Z (DATA_ERROR);
+	  return -1;
 	}
-      if (n == 0)
-	break;
-      pos += n;
     }
+  size -= state->z.avail_out;
+#else
+  int n = gzread (state->zf, buf, MIN (size, (size_t) INT_MAX));
+  if (n <= 0)
+    {
+      /* zlib reports a truncated file only through gzerror.  */
+      gzerror (state->zf, &state->result);
+      if (n < 0 || state->result != Z (OK))
+	return -1;
+    }
+  size = n;
+#endif
+
+  state->total += size;
+  return size;
+}
+
+/* If this is not a compressed image, return DWFL_E_BADELF.
+   If we uncompressed it into a new descriptor *ELF, return
+   DWFL_E_NOERROR.  Otherwise return an error for bad compressed data
+   or I/O failure.  If we return an error after reading the first part
+   of the file, leave that portion malloc'd in *WHOLE, *WHOLE_SIZE.
+   If *WHOLE is not null on entry, we'll use it in lieu of repeating a
+   read.
+
+   libelf keeps the uncompressed contents in a temporary file, so
+   neither they nor a copy of them need to fit into memory.  */
+
+Dwfl_Error internal_function
+unzip (int fd, off64_t start_offset,
+       void *mapped, size_t mapped_size,
+       void **whole, size_t *whole_size, Elf **elf)
+{
+  struct unzip_state state;
+  Dwfl_Error error = unzip_begin (&state, fd, start_offset,
+				  mapped, mapped_size, whole, whole_size);
+  if (error != DWFL_E_NOERROR)
+    return error;
 
-  gzclose (zf);
-  smaller_buffer (pos);
+  *elf = elf_begin_stream (&unzip_read, &state, ELF_C_READ_MMAP_PRIVATE);
+
+#if USE_INFLATE
+  inflateEnd (&state.z);
+#else
+  gzclose (state.zf);
 #endif
 
-  free (input_buffer);
+  if (*elf == NULL)
+    return fail (&state, whole, whole_size,
+		 state.result != Z (OK) ? zlib_error (state.result)
+		 : DWFL_E_LIBELF);
+
+  free (state.input_buffer);
+  *whole = NULL;
 
-  *whole = buffer;
-  *whole_size = size;
+  if (unlikely (state.total == 0))
+    {
+      elf_end (*elf);
+      *elf = NULL;
+      return DWFL_E_BADELF;
+    }
 
   return DWFL_E_NOERROR;
 }
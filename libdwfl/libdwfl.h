@@ -374,6 +374,23 @@ extern int dwfl_linux_proc_report (Dwfl *dwfl, pid_t pid);
    files giving module layout, not the file for a live process.  */
 extern int dwfl_linux_proc_maps_report (Dwfl *dwfl, FILE *);
 
+/* Bring the modules of DWFL up to date with the current contents of
+   /proc/PID/maps, for a DWFL previously filled by dwfl_linux_proc_report.
+   This is a complete report: do not call dwfl_report_begin or
+   dwfl_report_end around it.  If the mappings did not change since the
+   last report nothing is touched.  Otherwise only modules that were added
+   or removed are reported or freed, modules with an unchanged name and
+   address range keep everything already loaded for them.  Segments
+   reported by dwfl_report_segment are kept.  REMOVED and ARG are as for
+   dwfl_report_end.  Returns zero on success, -1 if dwfl_report_module
+   failed, an errno code if opening the proc files failed, or a nonzero
+   return value from REMOVED.  */
+extern int dwfl_linux_proc_refresh (Dwfl *dwfl, pid_t pid,
+				    int (*removed) (Dwfl_Module *, void *,
+						    const char *, Dwarf_Addr,
+						    void *arg),
+				    void *arg);
+
 /* Trivial find_elf callback for use with dwfl_linux_proc_report.
    This uses the module name as a file name directly and tries to open it
    if it begin with a slash, or handles the magic string "[vdso]".  */
@@ -600,6 +617,33 @@ extern Dwarf_Line *dwfl_dwarf_line (Dwfl_Line *line, Dwarf_Addr *bias);
 /* Return the compilation directory (AT_comp_dir) from this line's CU.  */
 extern const char *dwfl_line_comp_dir (Dwfl_Line *line);
 
+/* One address to symbolize with dwfl_addrinfo_batch.  The caller fills in
+   ADDR, all other fields are filled in by dwfl_addrinfo_batch.  */
+typedef struct
+{
+  Dwarf_Addr addr;
+  Dwfl_Module *mod;	/* Module containing ADDR, or NULL.  */
+  const char *name;	/* Symbol as for dwfl_module_addrinfo, or NULL.  */
+  GElf_Off offset;	/* ADDR minus the symbol value.  */
+  GElf_Sym sym;		/* The symbol, only valid if NAME is not NULL.  */
+  Dwfl_Line *line;	/* As for dwfl_module_getsrc, or NULL.  */
+  Dwarf_Die *scopes;	/* As for dwarf_getscopes, only if requested.  */
+  int nscopes;
+} Dwfl_Addrinfo;
+
+/* Symbolize the N addresses in INFOS in one go.  This gives the same
+   results as calling dwfl_addrmodule, dwfl_module_addrinfo and
+   dwfl_module_getsrc for each address, and dwarf_getscopes on the CU DIE
+   if INLINES is true, but handles the addresses in sorted order so that
+   duplicate addresses are only looked up once, nearby addresses in the
+   same symbol can share one symbol table search and the line table of a
+   CU is walked along with the addresses in it.  If INLINES is true each
+   nonzero SCOPES is a malloc'd array the caller must free.  Returns zero
+   on success or -1 for errors that are not specific to one address, like
+   running out of memory.  */
+extern int dwfl_addrinfo_batch (Dwfl *dwfl, Dwfl_Addrinfo *infos, size_t n,
+				bool inlines);
+
 
 /*** Machine backend access functions ***/
 
@@ -773,6 +817,24 @@ int dwfl_getthreads (Dwfl *dwfl,
 		     void *arg)
   __nonnull_attribute__ (1, 2);
 
+/* Like dwfl_getthreads, but call CALLBACK for the threads from up to NWORKERS
+   threads at once, NWORKERS zero means one per online CPU.  NDX is the
+   position of THREAD in the order dwfl_getthreads would use, callers that
+   store their per-thread results at NDX get a deterministic output order.
+   CALLBACK may call dwfl_thread_getframes and the Dwfl_Frame functions
+   concurrently; any other use of DWFL from CALLBACK must be serialized by
+   the caller.  When some callbacks do not return DWARF_CB_OK the result is
+   the one of the lowest NDX, threads after it may or may not have been
+   processed.  Only threads attached with dwfl_linux_proc_attach without
+   ASSUME_PTRACE_STOPPED are processed in parallel, for others CALLBACK is
+   called in order from the calling thread.  Returns zero, -1 on error or
+   that callback result.  */
+int dwfl_getthreads_parallel (Dwfl *dwfl, unsigned int nworkers,
+			      int (*callback) (Dwfl_Thread *thread,
+					       size_t ndx, void *arg),
+			      void *arg)
+  __nonnull_attribute__ (1, 3);
+
 /* Iterate through the frames for a thread.  Returns zero if all frames
    have been processed by the callback, returns -1 on error, or the value of
    the callback when not DWARF_CB_OK.  -1 returned on error will
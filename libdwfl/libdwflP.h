@@ -37,6 +37,7 @@
 #include <assert.h>
 #include <dirent.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -218,8 +219,27 @@ struct Dwfl_Process
   void *callbacks_arg;
   struct ebl *ebl;
   bool ebl_close:1;
+  /* Set while dwfl_getthreads_parallel runs.  Then LOCK serializes all
+     lazy setup of shared Dwfl state done while unwinding.  */
+  bool parallel:1;
+  pthread_mutex_t lock;
 };
 
+/* Take and release PROCESS->lock while unwinding in parallel.  */
+static inline void
+process_lock (Dwfl_Process *process)
+{
+  if (process->parallel)
+    pthread_mutex_lock (&process->lock);
+}
+
+static inline void
+process_unlock (Dwfl_Process *process)
+{
+  if (process->parallel)
+    pthread_mutex_unlock (&process->lock);
+}
+
 /* See its typedef in libdwfl.h.  */
 
 struct Dwfl_Thread
@@ -394,14 +414,16 @@ struct dwfl_arange
 struct __libdwfl_pid_arg
 {
   DIR *dir;
-  /* It is 0 if not used.  */
-  pid_t tid_attached;
-  /* Valid only if TID_ATTACHED is not zero.  */
-  bool tid_was_stopped;
   /* True if threads are ptrace stopped by caller.  */
   bool assume_ptrace_stopped;
 };
 
+/* Return the thread the calling thread is currently ptrace attached to
+   for unwinding, or 0 if none.  ptrace requests only work from the thread
+   that did PTRACE_ATTACH, so this is tracked per calling thread rather
+   than in struct __libdwfl_pid_arg.  */
+extern pid_t __libdwfl_tid_attached (void) internal_function;
+
 /* If DWfl is not NULL and a Dwfl_Process has been setup that has
    Dwfl_Thread_Callbacks set to pid_thread_callbacks, then return the
    callbacks_arg, which will be a struct __libdwfl_pid_arg.  Otherwise
@@ -432,11 +454,14 @@ extern const char *__libdwfl_getsym (Dwfl_Module *mod, int ndx, GElf_Sym *sym,
 
 /* Internal wrapper for old dwfl_module_addrsym and new dwfl_module_addrinfo.
    adjust_st_value set to true returns adjusted SYM st_value, set to false
-   it will not adjust SYM at all, but does match against resolved values. */
+   it will not adjust SYM at all, but does match against resolved values.
+   If VALIDP is not NULL it is set to the end of the address range starting
+   at ADDR for which the same symbol would be returned, or to ADDR + 1 if
+   that is not known.  */
 extern const char *__libdwfl_addrsym (Dwfl_Module *mod, GElf_Addr addr,
 				      GElf_Off *off, GElf_Sym *sym,
 				      GElf_Word *shndxp, Elf **elfp,
-				      Dwarf_Addr *bias,
+				      Dwarf_Addr *bias, GElf_Addr *validp,
 				      bool adjust_st_value) internal_function;
 
 extern void __libdwfl_module_free (Dwfl_Module *mod) internal_function;
@@ -494,10 +519,22 @@ extern Dwfl_Error __libdwfl_nextcu (Dwfl_Module *mod, struct dwfl_cu *lastcu,
 extern Dwfl_Error __libdwfl_addrcu (Dwfl_Module *mod, Dwarf_Addr addr,
 				    struct dwfl_cu **cu) internal_function;
 
+/* Like __libdwfl_addrcu, and set *END to the first address above ADDR
+   which may belong to another CU.  */
+extern Dwfl_Error __libdwfl_addrcu_end (Dwfl_Module *mod, Dwarf_Addr addr,
+					struct dwfl_cu **cu, Dwarf_Addr *end)
+  internal_function;
+
 /* Ensure that CU->lines (and CU->cu->lines) is set up.  */
 extern Dwfl_Error __libdwfl_cu_getsrclines (struct dwfl_cu *cu)
   internal_function;
 
+/* Return the line record of CU for the module-relative address ADDR, as
+   dwfl_module_getsrc does, or NULL if there is none.  CU->lines must be
+   set up.  */
+extern Dwfl_Line *__libdwfl_cu_getsrc (struct dwfl_cu *cu, Dwarf_Addr addr)
+  internal_function;
+
 /* Look in ELF for an NT_GNU_BUILD_ID note.  Store it to BUILD_ID_BITS,
    its vaddr in ELF to BUILD_ID_VADDR (it is unrelocated, even if MOD is not
    NULL) and store length to BUILD_ID_LEN.  Returns -1 for errors, 1 if it was
@@ -570,18 +607,22 @@ extern GElf_Addr __libdwfl_segment_start (Dwfl *dwfl, GElf_Addr start)
 extern GElf_Addr __libdwfl_segment_end (Dwfl *dwfl, GElf_Addr end)
   internal_function;
 
-/* Decompression wrappers: decompress whole file into memory.  */
+/* Decompression wrappers: decompress whole file into a new descriptor
+   *ELF, keeping the contents in a temporary file.  */
 extern Dwfl_Error __libdw_gunzip  (int fd, off64_t start_offset,
 				   void *mapped, size_t mapped_size,
-				   void **whole, size_t *whole_size)
+				   void **whole, size_t *whole_size,
+				   Elf **elf)
   internal_function;
 extern Dwfl_Error __libdw_bunzip2 (int fd, off64_t start_offset,
 				   void *mapped, size_t mapped_size,
-				   void **whole, size_t *whole_size)
+				   void **whole, size_t *whole_size,
+				   Elf **elf)
   internal_function;
 extern Dwfl_Error __libdw_unlzma (int fd, off64_t start_offset,
 				  void *mapped, size_t mapped_size,
-				  void **whole, size_t *whole_size)
+				  void **whole, size_t *whole_size,
+				  Elf **elf)
   internal_function;
 
 /* Skip the image header before a file image: updates *START_OFFSET.  */
@@ -714,6 +755,7 @@ INTDECL (dwfl_linux_kernel_module_section_address)
 INTDECL (dwfl_linux_proc_attach)
 INTDECL (dwfl_linux_proc_report)
 INTDECL (dwfl_linux_proc_maps_report)
+INTDECL (dwfl_linux_proc_refresh)
 INTDECL (dwfl_linux_proc_find_elf)
 INTDECL (dwfl_linux_kernel_report_kernel)
 INTDECL (dwfl_linux_kernel_report_modules)
@@ -74,21 +74,28 @@ core_memory_read (Dwfl *dwfl, Dwarf_Addr addr, Dwarf_Word *result,
       unsigned bytes = ebl_get_elfclass (process->ebl) == ELFCLASS64 ? 8 : 4;
       if (addr < start || addr + bytes > end)
 	continue;
-      Elf_Data *data;
-      data = elf_getdata_rawchunk (core, phdr->p_offset + addr - start,
-				   bytes, ELF_T_ADDR);
-      if (data == NULL)
+      /* This is called for every word read while unwinding, so read
+	 straight from the mapped core file if possible.  */
+      const GElf_Off offset = phdr->p_offset + addr - start;
+      const void *buf = elf_rawchunk (core, offset, bytes, ELF_T_ADDR);
+      if (buf == NULL)
 	{
-	  __libdwfl_seterrno (DWFL_E_LIBELF);
-	  return false;
+	  Elf_Data *data = elf_getdata_rawchunk (core, offset,
+						 bytes, ELF_T_ADDR);
+	  if (data == NULL)
+	    {
+	      __libdwfl_seterrno (DWFL_E_LIBELF);
+	      return false;
+	    }
+	  assert (data->d_size == bytes);
+	  buf = data->d_buf;
 	}
-      assert (data->d_size == bytes);
       /* FIXME: Currently any arch supported for unwinding supports
 	 unaligned access.  */
       if (bytes == 8)
-	*result = *(const uint64_t *) data->d_buf;
+	*result = *(const uint64_t *) buf;
       else
-	*result = *(const uint32_t *) data->d_buf;
+	*result = *(const uint32_t *) buf;
       return true;
     }
   __libdwfl_seterrno (DWFL_E_ADDR_OUTOFRANGE);
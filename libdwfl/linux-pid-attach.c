@@ -37,6 +37,18 @@
 # define MAX(a, b) ((a) > (b) ? (a) : (b))
 #endif
 
+/* The thread we are ptrace attached to, 0 if none.  */
+static __thread pid_t tid_attached;
+/* Valid only if TID_ATTACHED is not zero.  */
+static __thread bool tid_attached_was_stopped;
+
+pid_t
+internal_function
+__libdwfl_tid_attached (void)
+{
+  return tid_attached;
+}
+
 
 static bool
 linux_proc_pid_is_stopped (pid_t pid)
@@ -110,10 +122,10 @@ __libdwfl_ptrace_attach (pid_t tid, bool *tid_was_stoppedp)
 }
 
 static bool
-pid_memory_read (Dwfl *dwfl, Dwarf_Addr addr, Dwarf_Word *result, void *arg)
+pid_memory_read (Dwfl *dwfl, Dwarf_Addr addr, Dwarf_Word *result,
+		 void *arg __attribute__ ((unused)))
 {
-  struct __libdwfl_pid_arg *pid_arg = arg;
-  pid_t tid = pid_arg->tid_attached;
+  pid_t tid = tid_attached;
   assert (tid > 0);
   Dwfl_Process *process = dwfl->process;
   if (ebl_get_elfclass (process->ebl) == ELFCLASS64)
@@ -230,12 +242,12 @@ static bool
 pid_set_initial_registers (Dwfl_Thread *thread, void *thread_arg)
 {
   struct __libdwfl_pid_arg *pid_arg = thread_arg;
-  assert (pid_arg->tid_attached == 0);
+  assert (tid_attached == 0);
   pid_t tid = INTUSE(dwfl_thread_tid) (thread);
   if (! pid_arg->assume_ptrace_stopped
-      && ! __libdwfl_ptrace_attach (tid, &pid_arg->tid_was_stopped))
+      && ! __libdwfl_ptrace_attach (tid, &tid_attached_was_stopped))
     return false;
-  pid_arg->tid_attached = tid;
+  tid_attached = tid;
   Dwfl_Process *process = thread->process;
   Ebl *ebl = process->ebl;
   return ebl_set_initial_registers_tid (ebl, tid,
@@ -268,10 +280,10 @@ pid_thread_detach (Dwfl_Thread *thread, void *thread_arg)
 {
   struct __libdwfl_pid_arg *pid_arg = thread_arg;
   pid_t tid = INTUSE(dwfl_thread_tid) (thread);
-  assert (pid_arg->tid_attached == tid);
-  pid_arg->tid_attached = 0;
+  assert (tid_attached == tid);
+  tid_attached = 0;
   if (! pid_arg->assume_ptrace_stopped)
-    __libdwfl_ptrace_detach (tid, pid_arg->tid_was_stopped);
+    __libdwfl_ptrace_detach (tid, tid_attached_was_stopped);
 }
 
 static const Dwfl_Thread_Callbacks pid_thread_callbacks =
@@ -331,7 +343,6 @@ dwfl_linux_proc_attach (Dwfl *dwfl, pid_t pid, bool assume_ptrace_stopped)
       return ENOMEM;
     }
   pid_arg->dir = dir;
-  pid_arg->tid_attached = 0;
   pid_arg->assume_ptrace_stopped = assume_ptrace_stopped;
   if (! INTUSE(dwfl_attach_state) (dwfl, NULL, pid, &pid_thread_callbacks,
 				   pid_arg))
@@ -171,8 +171,14 @@ grovel_auxv (pid_t pid, Dwfl *dwfl, GElf_Addr *sysinfo_ehdr)
   return ENOEXEC;
 }
 
+/* Parse the /proc/PID/maps format from F, calling REPORT for each
+   module found with its name and address range.  REPORT returns true
+   for failure.  */
 static int
-proc_maps_report (Dwfl *dwfl, FILE *f, GElf_Addr sysinfo_ehdr, pid_t pid)
+proc_maps_scan (FILE *f, GElf_Addr sysinfo_ehdr, pid_t pid,
+		bool (*report_module) (void *arg, const char *name,
+				       Dwarf_Addr low, Dwarf_Addr high),
+		void *arg)
 {
   unsigned int last_dmajor = -1, last_dminor = -1;
   uint64_t last_ino = -1;
@@ -183,11 +189,10 @@ proc_maps_report (Dwfl *dwfl, FILE *f, GElf_Addr sysinfo_ehdr, pid_t pid)
     {
       if (last_file != NULL)
 	{
-	  Dwfl_Module *mod = INTUSE(dwfl_report_module) (dwfl, last_file,
-							 low, high);
+	  bool lose = (*report_module) (arg, last_file, low, high);
 	  free (last_file);
 	  last_file = NULL;
-	  if (unlikely (mod == NULL))
+	  if (unlikely (lose))
 	    return true;
 	}
       return false;
@@ -268,6 +273,19 @@ proc_maps_report (Dwfl *dwfl, FILE *f, GElf_Addr sysinfo_ehdr, pid_t pid)
   return result != 0 ? result : lose ? -1 : 0;
 }
 
+static bool
+report_module (void *arg, const char *name, Dwarf_Addr low, Dwarf_Addr high)
+{
+  Dwfl *dwfl = arg;
+  return INTUSE(dwfl_report_module) (dwfl, name, low, high) == NULL;
+}
+
+static int
+proc_maps_report (Dwfl *dwfl, FILE *f, GElf_Addr sysinfo_ehdr, pid_t pid)
+{
+  return proc_maps_scan (f, sysinfo_ehdr, pid, &report_module, dwfl);
+}
+
 int
 dwfl_linux_proc_maps_report (Dwfl *dwfl, FILE *f)
 {
@@ -275,15 +293,14 @@ dwfl_linux_proc_maps_report (Dwfl *dwfl, FILE *f)
 }
 INTDEF (dwfl_linux_proc_maps_report)
 
-int
-dwfl_linux_proc_report (Dwfl *dwfl, pid_t pid)
+/* Open /proc/PID/maps for reading, fetching the AT_SYSINFO_EHDR address
+   from the auxv on the way.  Returns zero with *FP set, or an errno code.  */
+static int
+open_proc_maps (Dwfl *dwfl, pid_t pid, GElf_Addr *sysinfo_ehdr, FILE **fp)
 {
-  if (dwfl == NULL)
-    return -1;
-
   /* We'll notice the AT_SYSINFO_EHDR address specially when we hit it.  */
-  GElf_Addr sysinfo_ehdr = 0;
-  int result = grovel_auxv (pid, dwfl, &sysinfo_ehdr);
+  *sysinfo_ehdr = 0;
+  int result = grovel_auxv (pid, dwfl, sysinfo_ehdr);
   if (result != 0)
     return result;
 
@@ -298,6 +315,22 @@ dwfl_linux_proc_report (Dwfl *dwfl, pid_t pid)
 
   (void) __fsetlocking (f, FSETLOCKING_BYCALLER);
 
+  *fp = f;
+  return 0;
+}
+
+int
+dwfl_linux_proc_report (Dwfl *dwfl, pid_t pid)
+{
+  if (dwfl == NULL)
+    return -1;
+
+  GElf_Addr sysinfo_ehdr;
+  FILE *f;
+  int result = open_proc_maps (dwfl, pid, &sysinfo_ehdr, &f);
+  if (result != 0)
+    return result;
+
   result = proc_maps_report (dwfl, f, sysinfo_ehdr, pid);
 
   fclose (f);
@@ -306,6 +339,117 @@ dwfl_linux_proc_report (Dwfl *dwfl, pid_t pid)
 }
 INTDEF (dwfl_linux_proc_report)
 
+/* One module range read from the maps file by dwfl_linux_proc_refresh.  */
+struct maps_module
+{
+  char *name;
+  Dwarf_Addr low;
+  Dwarf_Addr high;
+};
+
+struct maps_modules
+{
+  struct maps_module *mods;
+  size_t nmods;
+  size_t nalloc;
+};
+
+static bool
+collect_module (void *arg, const char *name, Dwarf_Addr low, Dwarf_Addr high)
+{
+  struct maps_modules *mm = arg;
+  if (mm->nmods == mm->nalloc)
+    {
+      size_t n = mm->nalloc == 0 ? 64 : mm->nalloc * 2;
+      struct maps_module *nmods = realloc (mm->mods, n * sizeof nmods[0]);
+      if (unlikely (nmods == NULL))
+	return true;
+      mm->mods = nmods;
+      mm->nalloc = n;
+    }
+
+  char *copy = strdup (name);
+  if (unlikely (copy == NULL))
+    return true;
+
+  mm->mods[mm->nmods].name = copy;
+  mm->mods[mm->nmods].low = low;
+  mm->mods[mm->nmods].high = high;
+  mm->nmods++;
+  return false;
+}
+
+/* Return true if the module list already matches MM exactly, in order.  */
+static bool
+maps_unchanged (Dwfl *dwfl, const struct maps_modules *mm)
+{
+  size_t i = 0;
+  for (Dwfl_Module *m = dwfl->modulelist; m != NULL; m = m->next, ++i)
+    if (i == mm->nmods
+	|| m->low_addr != mm->mods[i].low
+	|| m->high_addr != mm->mods[i].high
+	|| strcmp (m->name, mm->mods[i].name) != 0)
+      return false;
+  return i == mm->nmods;
+}
+
+int
+dwfl_linux_proc_refresh (Dwfl *dwfl, pid_t pid,
+			 int (*removed) (Dwfl_Module *, void *,
+					 const char *, Dwarf_Addr,
+					 void *arg),
+			 void *arg)
+{
+  if (dwfl == NULL)
+    return -1;
+
+  GElf_Addr sysinfo_ehdr;
+  FILE *f;
+  int result = open_proc_maps (dwfl, pid, &sysinfo_ehdr, &f);
+  if (result != 0)
+    return result;
+
+  struct maps_modules mm = { NULL, 0, 0 };
+  result = proc_maps_scan (f, sysinfo_ehdr, pid, &collect_module, &mm);
+  fclose (f);
+  if (result < 0)
+    __libdwfl_seterrno (DWFL_E_NOMEM);
+
+  /* The common case is that nothing was mapped or unmapped since the
+     last report.  Then leave the modules and the lookup tables alone.  */
+  if (result == 0 && ! maps_unchanged (dwfl, &mm))
+    {
+      /* Like dwfl_report_begin, but keep the segment table.  Modules
+	 reported again with the same name and range are reused by
+	 dwfl_report_module together with everything already loaded
+	 for them.  Only modules that went away get freed.  */
+      for (Dwfl_Module *m = dwfl->modulelist; m != NULL; m = m->next)
+	m->gc = true;
+
+      for (size_t i = 0; i < mm.nmods; ++i)
+	if (unlikely (INTUSE(dwfl_report_module) (dwfl, mm.mods[i].name,
+						  mm.mods[i].low,
+						  mm.mods[i].high) == NULL))
+	  {
+	    /* Keep whatever we had before rather than losing modules.  */
+	    for (Dwfl_Module *m = dwfl->modulelist; m != NULL; m = m->next)
+	      m->gc = false;
+	    result = -1;
+	    break;
+	  }
+
+      if (result == 0)
+	result = INTUSE(dwfl_report_end) (dwfl, removed, arg);
+    }
+
+  for (size_t i = 0; i < mm.nmods; ++i)
+    free (mm.mods[i].name);
+  free (mm.mods);
+
+  return result;
+}
+INTDEF (dwfl_linux_proc_refresh)
+
 static ssize_t
 read_proc_memory (void *arg, void *data, GElf_Addr address,
 		  size_t minread, size_t maxread)
@@ -384,7 +528,7 @@ dwfl_linux_proc_find_elf (Dwfl_Module *mod __attribute__ ((unused)),
 	  /* If any thread is already attached we are fine.  Read
 	     through that thread.  It doesn't have to be the main
 	     thread pid.  */
-	  pid_t tid = pid_arg->tid_attached;
+	  pid_t tid = __libdwfl_tid_attached ();
 	  if (tid != 0)
 	    pid = tid;
 	  else
@@ -49,10 +49,10 @@ static Dwfl_Error
 decompress (int fd __attribute__ ((unused)), Elf **elf)
 {
   Dwfl_Error error = DWFL_E_BADELF;
-  void *buffer = NULL;
-  size_t size = 0;
 
 #if USE_ZLIB || USE_BZLIB || USE_LZMA
+  void *buffer = NULL;
+  size_t size = 0;
   const off64_t offset = (*elf)->start_offset;
   void *const mapped = ((*elf)->map_address == NULL ? NULL
 			: (*elf)->map_address + offset);
@@ -60,38 +60,23 @@ decompress (int fd __attribute__ ((unused)), Elf **elf)
   if (mapped_size == 0)
     return error;
 
-  error = __libdw_gunzip (fd, offset, mapped, mapped_size, &buffer, &size);
+  Elf *memelf = NULL;
+  error = __libdw_gunzip (fd, offset, mapped, mapped_size, &buffer, &size,
+			  &memelf);
   if (error == DWFL_E_BADELF)
-    error = __libdw_bunzip2 (fd, offset, mapped, mapped_size, &buffer, &size);
+    error = __libdw_bunzip2 (fd, offset, mapped, mapped_size, &buffer, &size,
+			     &memelf);
   if (error == DWFL_E_BADELF)
-    error = __libdw_unlzma (fd, offset, mapped, mapped_size, &buffer, &size);
-#endif
+    error = __libdw_unlzma (fd, offset, mapped, mapped_size, &buffer, &size,
+			    &memelf);
+  free (buffer);
 
   if (error == DWFL_E_NOERROR)
     {
-      if (unlikely (size == 0))
-	{
-	  error = DWFL_E_BADELF;
-	  free (buffer);
-	}
-      else
-	{
-	  Elf *memelf = elf_memory (buffer, size);
-	  if (memelf == NULL)
-	    {
-	      error = DWFL_E_LIBELF;
-	      free (buffer);
-	    }
-	  else
-	    {
-	      memelf->flags |= ELF_F_MALLOCED;
-	      elf_end (*elf);
-	      *elf = memelf;
-	    }
-	}
+      elf_end (*elf);
+      *elf = memelf;
     }
-  else
-    free (buffer);
+#endif
 
   return error;
 }
@@ -68,7 +68,7 @@ load_shdr_wrlock (Elf_Scn *scn)
   /* Allocate memory for the section headers.  We know the number
      of entries from the ELF header.  */
   ElfW2(LIBELFBITS,Shdr) *shdr = elf->state.ELFW(elf,LIBELFBITS).shdr =
-    (ElfW2(LIBELFBITS,Shdr) *) malloc (size);
+    (ElfW2(LIBELFBITS,Shdr) *) __libelf_arena_malloc (elf->arena, size);
   if (elf->state.ELFW(elf,LIBELFBITS).shdr == NULL)
     {
       __libelf_seterrno (ELF_E_NOMEM);
@@ -192,17 +192,18 @@ load_shdr_wrlock (Elf_Scn *scn)
       __libelf_seterrno (ELF_E_FD_DISABLED);
 
     free_and_out:
-      free (shdr);
+      __libelf_arena_free (elf->arena, shdr);
       elf->state.ELFW(elf,LIBELFBITS).shdr = NULL;
       elf->state.ELFW(elf,LIBELFBITS).shdr_malloced = 0;
 
       goto out;
     }
 
-  /* Set the pointers in the `scn's.  */
+  /* Set the pointers in the `scn's.  They are read without a lock once
+     they are set, so the headers have to be complete before.  */
+  Elf_Scn *scns = elf->state.ELFW(elf,LIBELFBITS).scns.data;
   for (size_t cnt = 0; cnt < shnum; ++cnt)
-    elf->state.ELFW(elf,LIBELFBITS).scns.data[cnt].shdr.ELFW(e,LIBELFBITS)
-      = &elf->state.ELFW(elf,LIBELFBITS).shdr[cnt];
+    atomic_store_release (&scns[cnt].shdr.ELFW(e,LIBELFBITS), &shdr[cnt]);
 
   result = scn->shdr.ELFW(e,LIBELFBITS);
   assert (result != NULL);
@@ -279,6 +280,11 @@ elfw2(LIBELFBITS,getshdr) (scn)
   if (!scn_valid (scn))
     return NULL;
 
+  /* The headers do not move anymore once they are read.  */
+  result = atomic_load_acquire (&scn->shdr.ELFW(e,LIBELFBITS));
+  if (result != NULL)
+    return result;
+
   rwlock_rdlock (scn->elf->lock);
   result = __elfw2(LIBELFBITS,getshdr_rdlock) (scn);
   rwlock_unlock (scn->elf->lock);
@@ -38,8 +38,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <limits.h>
 #include <sys/mman.h>
 #include <sys/param.h>
+#include <sys/uio.h>
 
 #include <system.h>
 #include "libelfP.h"
@@ -101,6 +103,26 @@ sort_sections (Elf_Scn **scns, Elf_ScnList *list)
 }
 
 
+/* Return the file descriptor the contents of DL can be copied from
+   unchanged, or -1 if they have to be written from the buffer.  */
+static int
+data_source (Elf *elf, Elf_Data_List *dl)
+{
+  Elf *src = dl->srcelf;
+
+  if (src == NULL
+      || src->fildes == -1
+      || src->fildes == elf->fildes
+      || src->class != elf->class
+      || dl->srcsize != dl->data.d.d_size
+      || (src->state.ELFW(elf,LIBELFBITS).ehdr->e_ident[EI_DATA]
+	  != elf->state.ELFW(elf,LIBELFBITS).ehdr->e_ident[EI_DATA]))
+    return -1;
+
+  return src->fildes;
+}
+
+
 int
 internal_function
 __elfw2(LIBELFBITS,updatemmap) (Elf *elf, int change_bo, size_t shnum)
@@ -341,7 +363,18 @@ __elfw2(LIBELFBITS,updatemmap) (Elf *elf, int change_bo, size_t shnum)
 
 		    last_position = scn_start + dl->data.d.d_off;
 
-		    if (unlikely (change_bo))
+		    int srcfd = data_source (elf, dl);
+		    if (srcfd != -1
+			&& (__libelf_copy_range (srcfd, dl->srcoff,
+						 elf->fildes,
+						 last_position
+						 - (char *) elf->map_address,
+						 dl->data.d.d_size)
+			    == dl->data.d.d_size))
+		      /* The file contents are already in the right
+			 representation.  */
+		      last_position += dl->data.d.d_size;
+		    else if (unlikely (change_bo))
 		      {
 #if EV_NUM != 2
 			xfct_t fctp;
@@ -447,36 +480,123 @@ __elfw2(LIBELFBITS,updatemmap) (Elf *elf, int change_bo, size_t shnum)
 /* Size of the buffer we use to generate the blocks of fill bytes.  */
 #define FILLBUFSIZE	4096
 
-/* If we have to convert the section buffer contents we have to use
-   temporary buffer.  Only buffers up to MAX_TMPBUF bytes are allocated
-   on the stack.  */
-#define MAX_TMPBUF	32768
+/* Initial size of the buffer converted data is staged in.  */
+#define STAGEBUFSIZE	65536
+
+/* Maximum number of blocks written with one pwritev call.  */
+#if defined IOV_MAX && IOV_MAX < 1024
+# define OUT_IOV_MAX	IOV_MAX
+#else
+# define OUT_IOV_MAX	1024
+#endif
+
+/* Writing out the file one pwrite per header, data block and fill gap
+   makes many small system calls for files with many sections.  Instead
+   the blocks are collected in file order and written together with
+   pwritev once they stop being contiguous or the iovec list is full.  */
+struct out_state
+{
+  int fd;
+  /* File offset of the first collected block and size of all of them.  */
+  off_t start;
+  size_t len;
+  int iovcnt;
+  struct iovec iov[OUT_IOV_MAX];
+
+  /* Converted data which has to stay around until the blocks have been
+     written.  It is reused after each flush.  */
+  char *stage;
+  size_t stage_size;
+  size_t stage_used;
+
+  /* Block of fill bytes, all fill iovecs point into it.  */
+  size_t filled;
+  char fillbuf[FILLBUFSIZE];
+};
 
 
-/* Helper function to write out fill bytes.  */
+/* Write out all the collected blocks.  */
 static int
-fill (int fd, off_t pos, size_t len, char *fillbuf, size_t *filledp)
+out_flush (struct out_state *out)
+{
+  struct iovec *iov = out->iov;
+  int iovcnt = out->iovcnt;
+  off_t pos = out->start;
+
+  while (iovcnt > 0)
+    {
+      ssize_t n = TEMP_FAILURE_RETRY (pwritev (out->fd, iov, iovcnt, pos));
+      if (unlikely (n <= 0))
+	{
+	  __libelf_seterrno (ELF_E_WRITE_ERROR);
+	  return 1;
+	}
+      pos += n;
+
+      /* Skip what was written, maybe only part of a block.  */
+      while (iovcnt > 0 && (size_t) n >= iov->iov_len)
+	{
+	  n -= iov->iov_len;
+	  ++iov;
+	  --iovcnt;
+	}
+      if (n > 0)
+	{
+	  iov->iov_base = (char *) iov->iov_base + n;
+	  iov->iov_len -= n;
+	}
+    }
+
+  out->start += out->len;
+  out->len = 0;
+  out->iovcnt = 0;
+  out->stage_used = 0;
+  return 0;
+}
+
+/* Queue LEN bytes at BUF to be written at file offset POS.  BUF must
+   stay valid until the next out_flush.  */
+static int
+out_write (struct out_state *out, const void *buf, size_t len, off_t pos)
+{
+  if (len == 0)
+    return 0;
+
+  if (out->iovcnt > 0
+      && (pos != out->start + (off_t) out->len || out->iovcnt == OUT_IOV_MAX)
+      && unlikely (out_flush (out) != 0))
+    return 1;
+
+  if (out->iovcnt == 0)
+    out->start = pos;
+  out->iov[out->iovcnt].iov_base = (void *) buf;
+  out->iov[out->iovcnt].iov_len = len;
+  out->iovcnt++;
+  out->len += len;
+  return 0;
+}
+
+/* Queue LEN fill bytes to be written at file offset POS.  */
+static int
+out_fill (struct out_state *out, size_t len, off_t pos)
 {
-  size_t filled = *filledp;
   size_t fill_len = MIN (len, FILLBUFSIZE);
 
-  if (unlikely (fill_len > filled) && filled < FILLBUFSIZE)
+  if (unlikely (fill_len > out->filled))
     {
       /* Initialize a few more bytes.  */
-      memset (fillbuf + filled, __libelf_fill_byte, fill_len - filled);
-      *filledp = filled = fill_len;
+      memset (out->fillbuf + out->filled, __libelf_fill_byte,
+	      fill_len - out->filled);
+      out->filled = fill_len;
     }
 
   do
     {
       /* This many bytes we want to write in this round.  */
-      size_t n = MIN (filled, len);
+      size_t n = MIN (out->filled, len);
 
-      if (unlikely ((size_t) pwrite_retry (fd, fillbuf, n, pos) != n))
-	{
-	  __libelf_seterrno (ELF_E_WRITE_ERROR);
-	  return 1;
-	}
+      if (unlikely (out_write (out, out->fillbuf, n, pos) != 0))
+	return 1;
 
       pos += n;
       len -= n;
@@ -486,13 +606,79 @@ fill (int fd, off_t pos, size_t len, char *fillbuf, size_t *filledp)
   return 0;
 }
 
+/* Copy LEN bytes at SRCOFF in SRCFD to file offset POS without reading
+   them.  Returns false if that was not possible.  */
+static bool
+out_copy (struct out_state *out, int srcfd, off_t srcoff, size_t len,
+	  off_t pos)
+{
+  /* Keep the writes in file order.  */
+  if (out->iovcnt > 0 && unlikely (out_flush (out) != 0))
+    return false;
+
+  if (__libelf_copy_range (srcfd, srcoff, out->fd, pos, len) != len)
+    return false;
+
+  out->start = pos + len;
+  return true;
+}
+
+/* Return a buffer of LEN bytes which stays valid until it has been
+   written, to convert data into.  */
+static void *
+out_stage (struct out_state *out, size_t len)
+{
+  /* Keep the converted blocks aligned.  */
+  size_t used = (out->stage_used + 15) & ~(size_t) 15;
+
+  if (out->stage == NULL || used + len > out->stage_size)
+    {
+      /* The staged data still has to be written before the buffer can
+	 be reused.  */
+      if (out->iovcnt > 0 && unlikely (out_flush (out) != 0))
+	return NULL;
+      used = 0;
+
+      if (out->stage == NULL || len > out->stage_size)
+	{
+	  size_t size = MAX (len, MAX (STAGEBUFSIZE, 2 * out->stage_size));
+	  free (out->stage);
+	  out->stage = malloc (size);
+	  if (out->stage == NULL)
+	    {
+	      out->stage_size = 0;
+	      __libelf_seterrno (ELF_E_NOMEM);
+	      return NULL;
+	    }
+	  out->stage_size = size;
+	}
+    }
+
+  out->stage_used = used + len;
+  return out->stage + used;
+}
+
 
 int
 internal_function
 __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 {
-  char fillbuf[FILLBUFSIZE];
-  size_t filled = 0;
+  struct out_state *out = malloc (sizeof *out);
+  if (out == NULL)
+    {
+      __libelf_seterrno (ELF_E_NOMEM);
+      return 1;
+    }
+  out->fd = elf->fildes;
+  out->start = 0;
+  out->len = 0;
+  out->iovcnt = 0;
+  out->stage = NULL;
+  out->stage_size = 0;
+  out->stage_used = 0;
+  out->filled = 0;
+
+  int result = 1;
   bool previous_scn_changed = false;
 
   /* We need the ELF header several times.  */
@@ -501,7 +687,6 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
   /* Write out the ELF header.  */
   if ((elf->state.ELFW(elf,LIBELFBITS).ehdr_flags | elf->flags) & ELF_F_DIRTY)
     {
-      ElfW2(LIBELFBITS,Ehdr) tmp_ehdr;
       ElfW2(LIBELFBITS,Ehdr) *out_ehdr = ehdr;
 
       /* If the type sizes should be different at some time we have to
@@ -521,20 +706,16 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 #endif
 
 	  /* Write the converted ELF header in a temporary buffer.  */
-	  (*fctp) (&tmp_ehdr, ehdr, sizeof (ElfW2(LIBELFBITS,Ehdr)), 1);
-
-	  /* This is the buffer we want to write.  */
-	  out_ehdr = &tmp_ehdr;
+	  out_ehdr = out_stage (out, sizeof (ElfW2(LIBELFBITS,Ehdr)));
+	  if (out_ehdr == NULL)
+	    goto out;
+	  (*fctp) (out_ehdr, ehdr, sizeof (ElfW2(LIBELFBITS,Ehdr)), 1);
 	}
 
       /* Write out the ELF header.  */
-      if (unlikely (pwrite_retry (elf->fildes, out_ehdr,
-				  sizeof (ElfW2(LIBELFBITS,Ehdr)), 0)
-		    != sizeof (ElfW2(LIBELFBITS,Ehdr))))
-	{
-	  __libelf_seterrno (ELF_E_WRITE_ERROR);
-	  return 1;
-	}
+      if (unlikely (out_write (out, out_ehdr,
+			       sizeof (ElfW2(LIBELFBITS,Ehdr)), 0) != 0))
+	goto out;
 
       elf->state.ELFW(elf,LIBELFBITS).ehdr_flags &= ~ELF_F_DIRTY;
 
@@ -550,24 +731,26 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 
   size_t phnum;
   if (unlikely (__elf_getphdrnum_rdlock (elf, &phnum) != 0))
-    return -1;
+    {
+      result = -1;
+      goto out;
+    }
 
   /* Write out the program header table.  */
   if (elf->state.ELFW(elf,LIBELFBITS).phdr != NULL
       && ((elf->state.ELFW(elf,LIBELFBITS).phdr_flags | elf->flags)
 	  & ELF_F_DIRTY))
     {
-      ElfW2(LIBELFBITS,Phdr) *tmp_phdr = NULL;
       ElfW2(LIBELFBITS,Phdr) *out_phdr = elf->state.ELFW(elf,LIBELFBITS).phdr;
 
       /* Maybe the user wants a gap between the ELF header and the program
 	 header.  */
       if (ehdr->e_phoff > ehdr->e_ehsize
-	  && unlikely (fill (elf->fildes, ehdr->e_ehsize,
-			     ehdr->e_phoff - ehdr->e_ehsize, fillbuf, &filled)
-		       != 0))
-	return 1;
+	  && unlikely (out_fill (out, ehdr->e_phoff - ehdr->e_ehsize,
+				 ehdr->e_ehsize) != 0))
+	goto out;
 
+      size_t phdr_size = sizeof (ElfW2(LIBELFBITS,Phdr)) * phnum;
       if (unlikely (change_bo))
 	{
 	  /* Today there is only one version of the ELF header.  */
@@ -579,35 +762,18 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 # define fctp __elf_xfctstom[0][EV_CURRENT - 1][ELFW(ELFCLASS, LIBELFBITS) - 1][ELF_T_PHDR]
 #endif
 
-	  /* Allocate sufficient memory.  */
-	  tmp_phdr = (ElfW2(LIBELFBITS,Phdr) *)
-	    malloc (sizeof (ElfW2(LIBELFBITS,Phdr)) * phnum);
-	  if (tmp_phdr == NULL)
-	    {
-	      __libelf_seterrno (ELF_E_NOMEM);
-	      return 1;
-	    }
-
 	  /* Write the converted ELF header in a temporary buffer.  */
-	  (*fctp) (tmp_phdr, elf->state.ELFW(elf,LIBELFBITS).phdr,
-		   sizeof (ElfW2(LIBELFBITS,Phdr)) * phnum, 1);
-
-	  /* This is the buffer we want to write.  */
-	  out_phdr = tmp_phdr;
+	  out_phdr = out_stage (out, phdr_size);
+	  if (out_phdr == NULL)
+	    goto out;
+	  (*fctp) (out_phdr, elf->state.ELFW(elf,LIBELFBITS).phdr,
+		   phdr_size, 1);
 	}
 
       /* Write out the ELF header.  */
-      size_t phdr_size = sizeof (ElfW2(LIBELFBITS,Phdr)) * phnum;
-      if (unlikely ((size_t) pwrite_retry (elf->fildes, out_phdr,
-					   phdr_size, ehdr->e_phoff)
-		    != phdr_size))
-	{
-	  __libelf_seterrno (ELF_E_WRITE_ERROR);
-	  return 1;
-	}
-
-      /* This is a no-op we we have not allocated any memory.  */
-      free (tmp_phdr);
+      if (unlikely (out_write (out, out_phdr, phdr_size,
+			       ehdr->e_phoff) != 0))
+	goto out;
 
       elf->state.ELFW(elf,LIBELFBITS).phdr_flags &= ~ELF_F_DIRTY;
 
@@ -629,7 +795,7 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
     {
       if (unlikely (shnum > SIZE_MAX / (sizeof (Elf_Scn *)
 					+ sizeof (ElfW2(LIBELFBITS,Shdr)))))
-	return 1;
+	goto out;
 
       off_t shdr_offset = elf->start_offset + ehdr->e_shoff;
 #if EV_NUM != 2
@@ -681,16 +847,14 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 			|| ((scn->flags | dl->flags | elf->flags)
 			    & ELF_F_DIRTY) != 0))
 		  {
-		    if (unlikely (fill (elf->fildes, last_offset,
-					(scn_start + dl->data.d.d_off)
-					- last_offset, fillbuf,
-					&filled) != 0))
-		      return 1;
+		    if (unlikely (out_fill (out, (scn_start + dl->data.d.d_off)
+						 - last_offset,
+					    last_offset) != 0))
+		      goto out;
 		  }
 
 		if ((scn->flags | dl->flags | elf->flags) & ELF_F_DIRTY)
 		  {
-		    char tmpbuf[MAX_TMPBUF];
 		    void *buf = dl->data.d.d_buf;
 
 		    /* Let it go backward if the sections use a bogus
@@ -700,7 +864,15 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 
 		    last_offset = scn_start + dl->data.d.d_off;
 
-		    if (unlikely (change_bo))
+		    /* The file contents are already in the right
+		       representation.  */
+		    int srcfd = data_source (elf, dl);
+		    bool copied = (srcfd != -1
+				   && out_copy (out, srcfd, dl->srcoff,
+						dl->data.d.d_size,
+						last_offset));
+
+		    if (! copied && unlikely (change_bo))
 		      {
 #if EV_NUM != 2
 			xfct_t fctp;
@@ -710,35 +882,18 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 # define fctp __elf_xfctstom[0][EV_CURRENT - 1][ELFW(ELFCLASS, LIBELFBITS) - 1][dl->data.d.d_type]
 #endif
 
-			buf = tmpbuf;
-			if (dl->data.d.d_size > MAX_TMPBUF)
-			  {
-			    buf = malloc (dl->data.d.d_size);
-			    if (buf == NULL)
-			      {
-				__libelf_seterrno (ELF_E_NOMEM);
-				return 1;
-			      }
-			  }
+			buf = out_stage (out, dl->data.d.d_size);
+			if (buf == NULL)
+			  goto out;
 
 			/* Do the real work.  */
 			(*fctp) (buf, dl->data.d.d_buf, dl->data.d.d_size, 1);
 		      }
 
-		    ssize_t n = pwrite_retry (elf->fildes, buf,
-					      dl->data.d.d_size,
-					      last_offset);
-		    if (unlikely ((size_t) n != dl->data.d.d_size))
-		      {
-			if (buf != dl->data.d.d_buf && buf != tmpbuf)
-			  free (buf);
-
-			__libelf_seterrno (ELF_E_WRITE_ERROR);
-			return 1;
-		      }
-
-		    if (buf != dl->data.d.d_buf && buf != tmpbuf)
-		      free (buf);
+		    if (! copied
+			&& unlikely (out_write (out, buf, dl->data.d.d_size,
+						last_offset) != 0))
+		      goto out;
 
 		    scn_changed = true;
 		  }
@@ -756,10 +911,9 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 		 header) changed we might have to fill the gap.  */
 	      if (scn_start > last_offset && previous_scn_changed)
 		{
-		  if (unlikely (fill (elf->fildes, last_offset,
-				      scn_start - last_offset, fillbuf,
-				      &filled) != 0))
-		    return 1;
+		  if (unlikely (out_fill (out, scn_start - last_offset,
+					  last_offset) != 0))
+		    goto out;
 		}
 
 	      last_offset = scn_start + shdr->sh_size;
@@ -784,25 +938,32 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
       /* Fill the gap between last section and section header table if
 	 necessary.  */
       if ((elf->flags & ELF_F_DIRTY) && last_offset < shdr_offset
-	  && unlikely (fill (elf->fildes, last_offset,
-			     shdr_offset - last_offset,
-			     fillbuf, &filled) != 0))
-	return 1;
+	  && unlikely (out_fill (out, shdr_offset - last_offset,
+				 last_offset) != 0))
+	goto out;
 
-      /* Write out the section header table.  */
+      /* Write out the section header table.  SHDR_DATA might be on the
+	 stack, so flush before it goes away.  */
       if (shdr_flags & ELF_F_DIRTY
-	  && unlikely ((size_t) pwrite_retry (elf->fildes, shdr_data,
-					      sizeof (ElfW2(LIBELFBITS,Shdr))
-					      * shnum, shdr_offset)
-		       != sizeof (ElfW2(LIBELFBITS,Shdr)) * shnum))
-	{
-	  __libelf_seterrno (ELF_E_WRITE_ERROR);
-	  return 1;
-	}
+	  && unlikely (out_write (out, shdr_data,
+				  sizeof (ElfW2(LIBELFBITS,Shdr)) * shnum,
+				  shdr_offset) != 0))
+	goto out;
+      if (unlikely (out_flush (out) != 0))
+	goto out;
     }
 
+  /* Write out whatever is left.  */
+  if (unlikely (out_flush (out) != 0))
+    goto out;
+
   /* That was the last part.  Clear the overall flag.  */
   elf->flags &= ~ELF_F_DIRTY;
 
-  return 0;
+  result = 0;
+
+ out:
+  free (out->stage);
+  free (out);
+  return result;
 }
@@ -0,0 +1,255 @@
+/* Pool memory for ELF descriptors.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libelf.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libelfP.h"
+
+
+/* Blocks are kept in size classes of powers of two, from 256 bytes
+   for a descriptor with a few sections up to 512 kB.  Larger blocks
+   are freed right away.  */
+#define ARENA_MIN_SHIFT	8
+#define ARENA_NCLASSES	12
+
+/* The header of every block handed out by an arena.  */
+struct arena_block
+{
+  /* The next free block of the same size class.  */
+  struct arena_block *next;
+
+  /* The size class, ARENA_NCLASSES if the block is not kept.  */
+  size_t class;
+} __attribute__ ((aligned (16)));
+
+struct Elf_Arena
+{
+  /* Protects everything else.  */
+  rwlock_define (, lock);
+
+  /* The free blocks of each size class.  */
+  struct arena_block *free[ARENA_NCLASSES];
+
+  /* The descriptors still in use.  */
+  Elf *live;
+};
+
+/* The arena new descriptors of this thread are allocated in.  */
+static __thread Elf_Arena *current_arena;
+
+
+void *
+internal_function
+__libelf_arena_malloc (Elf_Arena *arena, size_t size)
+{
+  if (arena == NULL)
+    return malloc (size);
+
+  size_t class = 0;
+  while (class < ARENA_NCLASSES
+	 && ((size_t) 1 << (ARENA_MIN_SHIFT + class)) < size)
+    ++class;
+
+  struct arena_block *block = NULL;
+  if (class < ARENA_NCLASSES)
+    {
+      rwlock_wrlock (arena->lock);
+      block = arena->free[class];
+      if (block != NULL)
+	arena->free[class] = block->next;
+      rwlock_unlock (arena->lock);
+
+      size = (size_t) 1 << (ARENA_MIN_SHIFT + class);
+    }
+
+  if (block == NULL)
+    {
+      if (unlikely (size > SIZE_MAX - sizeof (struct arena_block)))
+	return NULL;
+      block = malloc (sizeof (struct arena_block) + size);
+      if (block == NULL)
+	return NULL;
+      block->class = class;
+    }
+
+  return block + 1;
+}
+
+
+void
+internal_function
+__libelf_arena_free (Elf_Arena *arena, void *ptr)
+{
+  if (arena == NULL || ptr == NULL)
+    {
+      free (ptr);
+      return;
+    }
+
+  struct arena_block *block = (struct arena_block *) ptr - 1;
+  if (block->class == ARENA_NCLASSES)
+    {
+      free (block);
+      return;
+    }
+
+  rwlock_wrlock (arena->lock);
+  block->next = arena->free[block->class];
+  arena->free[block->class] = block;
+  rwlock_unlock (arena->lock);
+}
+
+
+Elf *
+internal_function
+__libelf_allocate_elf (size_t size)
+{
+  Elf_Arena *arena = current_arena;
+  if (arena == NULL)
+    return calloc (1, size);
+
+  Elf *elf = __libelf_arena_malloc (arena, size);
+  if (elf != NULL)
+    {
+      memset (elf, '\0', size);
+      elf->arena = arena;
+
+      rwlock_wrlock (arena->lock);
+      elf->arena_next = arena->live;
+      if (arena->live != NULL)
+	arena->live->arena_prev = elf;
+      arena->live = elf;
+      rwlock_unlock (arena->lock);
+    }
+
+  return elf;
+}
+
+
+void
+internal_function
+__libelf_free_elf (Elf *elf)
+{
+  Elf_Arena *arena = elf->arena;
+  if (arena != NULL)
+    {
+      rwlock_wrlock (arena->lock);
+      if (elf->arena_prev != NULL)
+	elf->arena_prev->arena_next = elf->arena_next;
+      else
+	arena->live = elf->arena_next;
+      if (elf->arena_next != NULL)
+	elf->arena_next->arena_prev = elf->arena_prev;
+      rwlock_unlock (arena->lock);
+    }
+
+  __libelf_arena_free (arena, elf);
+}
+
+
+Elf_Arena *
+elf_arena_begin (void)
+{
+  Elf_Arena *arena = calloc (1, sizeof (Elf_Arena));
+  if (arena == NULL)
+    {
+      __libelf_seterrno (ELF_E_NOMEM);
+      return NULL;
+    }
+
+  rwlock_init (arena->lock);
+
+  return arena;
+}
+
+
+Elf_Arena *
+elf_arena_use (Elf_Arena *arena)
+{
+  Elf_Arena *old = current_arena;
+  current_arena = arena;
+  return old;
+}
+
+
+int
+elf_arena_release (Elf_Arena *arena)
+{
+  if (arena == NULL)
+    return 0;
+
+  int result = 0;
+
+  /* An archive goes away with its last member, so end the members
+     first.  Ending the descriptor removes it from the list.  */
+  while (arena->live != NULL)
+    {
+      Elf *elf = arena->live;
+      while (elf->kind == ELF_K_AR && elf->state.ar.children != NULL)
+	elf = elf->state.ar.children;
+
+      /* All the references go at once.  */
+      elf->ref_count = 1;
+      if (INTUSE(elf_end) (elf) != 0)
+	result = -1;
+    }
+
+  return result;
+}
+
+
+int
+elf_arena_end (Elf_Arena *arena)
+{
+  if (arena == NULL)
+    return 0;
+
+  int result = elf_arena_release (arena);
+
+  for (size_t class = 0; class < ARENA_NCLASSES; ++class)
+    while (arena->free[class] != NULL)
+      {
+	struct arena_block *block = arena->free[class];
+	arena->free[class] = block->next;
+	free (block);
+      }
+
+  if (current_arena == arena)
+    current_arena = NULL;
+
+  rwlock_fini (arena->lock);
+  free (arena);
+
+  return result;
+}
@@ -320,7 +320,7 @@ file_read_elf (int fildes, void *map_address, unsigned char *e_ident,
 			   < scncnt * sizeof (Elf32_Shdr)))
 	    {
 	    free_and_out:
-	      free (elf);
+	      __libelf_free_elf (elf);
 	      __libelf_seterrno (ELF_E_INVALID_FILE);
 	      return NULL;
 	    }
@@ -334,6 +334,7 @@ file_read_elf (int fildes, void *map_address, unsigned char *e_ident,
 	    {
 	      elf->state.elf32.scns.data[cnt].index = cnt;
 	      elf->state.elf32.scns.data[cnt].elf = elf;
+	      rwlock_init (elf->state.elf32.scns.data[cnt].lock);
 	      elf->state.elf32.scns.data[cnt].shdr.e32 =
 		&elf->state.elf32.shdr[cnt];
 	      if (likely (elf->state.elf32.shdr[cnt].sh_offset < maxsize)
@@ -386,6 +387,7 @@ file_read_elf (int fildes, void *map_address, unsigned char *e_ident,
 	    {
 	      elf->state.elf32.scns.data[cnt].index = cnt;
 	      elf->state.elf32.scns.data[cnt].elf = elf;
+	      rwlock_init (elf->state.elf32.scns.data[cnt].lock);
 	      elf->state.elf32.scns.data[cnt].list = &elf->state.elf32.scns;
 	    }
 	}
@@ -425,6 +427,7 @@ file_read_elf (int fildes, void *map_address, unsigned char *e_ident,
 	    {
 	      elf->state.elf64.scns.data[cnt].index = cnt;
 	      elf->state.elf64.scns.data[cnt].elf = elf;
+	      rwlock_init (elf->state.elf64.scns.data[cnt].lock);
 	      elf->state.elf64.scns.data[cnt].shdr.e64 =
 		&elf->state.elf64.shdr[cnt];
 	      if (likely (elf->state.elf64.shdr[cnt].sh_offset < maxsize)
@@ -477,6 +480,7 @@ file_read_elf (int fildes, void *map_address, unsigned char *e_ident,
 	    {
 	      elf->state.elf64.scns.data[cnt].index = cnt;
 	      elf->state.elf64.scns.data[cnt].elf = elf;
+	      rwlock_init (elf->state.elf64.scns.data[cnt].lock);
 	      elf->state.elf64.scns.data[cnt].list = &elf->state.elf64.scns;
 	    }
 	}
@@ -550,9 +554,14 @@ read_unmmaped_file (int fildes, off_t offset, size_t maxsize, Elf_Cmd cmd,
 				    maxsize),
 			       offset);
   if (unlikely (nread == -1))
-    /* We cannot even read the head of the file.  Maybe FILDES is associated
-       with an unseekable device.  This is nothing we can handle.  */
-    return NULL;
+    {
+      /* We cannot even read the head of the file.  Maybe FILDES is
+	 associated with an unseekable device like a pipe.  Then we
+	 read all of it once, in order.  */
+      if (errno == ESPIPE && parent == NULL)
+	return __libelf_read_stream (fildes, NULL, NULL, cmd);
+      return NULL;
+    }
 
   /* See what kind of object we have here.  */
   Elf_Kind kind = determine_kind (mem.header, nread);
@@ -662,8 +671,9 @@ read_file (int fildes, off_t offset, size_t maxsize,
 
 
 /* Find the entry with the long names for the content of this archive.  */
-static const char *
-read_long_names (Elf *elf)
+const char *
+internal_function
+__libelf_read_long_names (Elf *elf)
 {
   off_t offset = SARMAG;	/* This is the first entry.  */
   struct ar_hdr hdrm;
@@ -828,7 +838,7 @@ __libelf_next_arhdr_wrlock (elf)
 	  /* This is a long name.  First we have to read the long name
 	     table, if this hasn't happened already.  */
 	  if (unlikely (elf->state.ar.long_names == NULL
-			&& read_long_names (elf) == NULL))
+			&& __libelf_read_long_names (elf) == NULL))
 	    {
 	      /* No long name table although it is reference.  The archive is
 		 broken.  */
@@ -1117,3 +1127,88 @@ elf_begin (fildes, cmd, ref)
   return retval;
 }
 INTDEF(elf_begin)
+
+
+Elf *
+elf_begin_armember (Elf *elf, size_t offset, Elf_Cmd cmd)
+{
+  if (elf == NULL)
+    return NULL;
+
+  if (unlikely (elf->kind != ELF_K_AR))
+    {
+      __libelf_seterrno (ELF_E_NO_ARCHIVE);
+      return NULL;
+    }
+
+  /* Only descriptors for reading, the member is shared with others.  */
+  if (unlikely (cmd != ELF_C_READ && cmd != ELF_C_READ_MMAP
+		&& cmd != ELF_C_READ_MMAP_PRIVATE)
+      || unlikely (cmd == ELF_C_READ_MMAP_PRIVATE
+		   && elf->cmd != ELF_C_READ_MMAP_PRIVATE))
+    {
+      __libelf_seterrno (ELF_E_INVALID_CMD);
+      return NULL;
+    }
+
+  rwlock_rdlock (elf->lock);
+
+  /* Read the header of the member.  Unlike elf_rand this must not
+     touch the archive state used by elf_begin and elf_next.  */
+  struct ar_hdr hdrm;
+  struct ar_hdr *ar_hdr;
+  Elf *result = NULL;
+  if (unlikely (offset < SARMAG
+		|| offset > elf->maximum_size
+		|| elf->maximum_size - offset < sizeof (struct ar_hdr)))
+    {
+      __libelf_seterrno (ELF_E_RANGE);
+      goto out;
+    }
+  if (elf->map_address != NULL)
+    ar_hdr = (struct ar_hdr *) (elf->map_address + elf->start_offset
+				+ offset);
+  else if (unlikely (pread_retry (elf->fildes, &hdrm, sizeof (hdrm),
+				  elf->start_offset + offset)
+		     != sizeof (hdrm)))
+    {
+      __libelf_seterrno (ELF_E_RANGE);
+      goto out;
+    }
+  else
+    ar_hdr = &hdrm;
+
+  if (unlikely (memcmp (ar_hdr->ar_fmag, ARFMAG, 2) != 0))
+    {
+      __libelf_seterrno (ELF_E_ARCHIVE_FMAG);
+      goto out;
+    }
+
+  char buf[sizeof (ar_hdr->ar_size) + 1];
+  *((char *) __mempcpy (buf, ar_hdr->ar_size, sizeof (ar_hdr->ar_size)))
+    = '\0';
+  size_t size = atoll (buf);
+  offset += sizeof (struct ar_hdr);
+  if (unlikely (ar_hdr->ar_size[0] == ' ')
+      || unlikely (elf->maximum_size - offset < size))
+    {
+      __libelf_seterrno (ELF_E_INVALID_ARCHIVE);
+      goto out;
+    }
+
+  rwlock_unlock (elf->lock);
+
+  result = read_file (elf->fildes, elf->start_offset + offset, size, cmd,
+		      elf);
+  if (result == NULL)
+    return NULL;
+
+  /* Enlist this new descriptor in the list of children.  */
+  rwlock_wrlock (elf->lock);
+  result->next = elf->state.ar.children;
+  elf->state.ar.children = result;
+
+ out:
+  rwlock_unlock (elf->lock);
+  return result;
+}
@@ -0,0 +1,268 @@
+/* Create descriptor for a file read from a stream.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <libelf.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <system.h>
+#include "libelfP.h"
+#include "common.h"
+
+/* The size of the pieces copied from the stream.  */
+#define STREAM_BUFSIZE	(64 * 1024)
+
+
+/* Create an unlinked temporary file.  */
+static int
+spill_file (void)
+{
+  const char *dir = getenv ("TMPDIR");
+  if (dir == NULL || dir[0] == '\0')
+    dir = P_tmpdir;
+
+  int fd;
+#ifdef O_TMPFILE
+  fd = open (dir, O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+  if (fd != -1)
+    return fd;
+#endif
+
+  static const char templ[] = "/libelf.XXXXXX";
+  size_t len = strlen (dir);
+  char name[len + sizeof templ];
+  memcpy (mempcpy (name, dir, len), templ, sizeof templ);
+  fd = mkostemp (name, O_CLOEXEC);
+  if (fd != -1)
+    unlink (name);
+  return fd;
+}
+
+
+/* Copy the rest of FILDES to FD.  Pipes are moved in the kernel,
+   everything else goes through BUF.  */
+static ssize_t
+copy_fd (int fildes, int fd, char *buf)
+{
+  size_t size = 0;
+
+#ifdef SPLICE_F_MOVE
+  ssize_t n;
+  while ((n = TEMP_FAILURE_RETRY (splice (fildes, NULL, fd, NULL,
+					  STREAM_BUFSIZE * 16,
+					  SPLICE_F_MOVE))) > 0)
+    size += n;
+  if (n == 0)
+    return size;
+  if (size != 0 || errno != EINVAL)
+    return -1;
+#endif
+
+  while (1)
+    {
+      ssize_t nread = TEMP_FAILURE_RETRY (read (fildes, buf, STREAM_BUFSIZE));
+      if (nread <= 0)
+	return nread < 0 ? -1 : (ssize_t) size;
+      if (write_retry (fd, buf, nread) != nread)
+	return -1;
+      size += nread;
+    }
+}
+
+
+/* Copy the rest of the stream to FD.  */
+static ssize_t
+copy_stream (Elf_Stream_Read *read, void *arg, int fd, char *buf)
+{
+  size_t size = 0;
+
+  while (1)
+    {
+      ssize_t n = read (arg, buf, STREAM_BUFSIZE);
+      if (n <= 0)
+	return n < 0 ? -1 : (ssize_t) size;
+      if (write_retry (fd, buf, n) != n)
+	return -1;
+      size += n;
+    }
+}
+
+
+/* Read from the file descriptor ARG points to, like a stream.  */
+static ssize_t
+read_fd (void *arg, void *buf, size_t size)
+{
+  return TEMP_FAILURE_RETRY (read (*(int *) arg, buf, size));
+}
+
+
+/* Read the rest of the stream into memory, for when there is no
+   temporary file to copy it to.  */
+static Elf *
+read_memory (Elf_Stream_Read *read, void *arg, Elf_Cmd cmd)
+{
+  char *buffer = NULL;
+  size_t size = 0;
+  size_t alloc = 0;
+
+  while (1)
+    {
+      if (alloc - size < STREAM_BUFSIZE)
+	{
+	  alloc = alloc == 0 ? 4 * STREAM_BUFSIZE : alloc * 2;
+	  char *b = realloc (buffer, alloc);
+	  if (unlikely (b == NULL))
+	    {
+	      free (buffer);
+	      __libelf_seterrno (ELF_E_NOMEM);
+	      return NULL;
+	    }
+	  buffer = b;
+	}
+
+      ssize_t n = read (arg, buffer + size, alloc - size);
+      if (n == 0)
+	break;
+      if (unlikely (n < 0))
+	{
+	  free (buffer);
+	  __libelf_seterrno (ELF_E_READ_ERROR);
+	  return NULL;
+	}
+      size += n;
+    }
+
+  if (size == 0)
+    {
+      free (buffer);
+      return allocate_elf (-1, NULL, 0, 0, cmd, NULL, ELF_K_NONE, 0);
+    }
+
+  /* Give back what we did not use.  */
+  char *b = realloc (buffer, size);
+  if (b != NULL)
+    buffer = b;
+
+  Elf *elf = __libelf_read_mmaped_file (-1, buffer, 0, size, cmd, NULL);
+  if (elf == NULL)
+    free (buffer);
+  else
+    elf->flags |= ELF_F_MALLOCED;
+  return elf;
+}
+
+
+Elf *
+internal_function
+__libelf_read_stream (int fildes, Elf_Stream_Read *read, void *arg,
+		      Elf_Cmd cmd)
+{
+  if (cmd == ELF_C_READ)
+    cmd = ELF_C_READ_MMAP;
+  else if (unlikely (cmd != ELF_C_READ_MMAP
+		     && cmd != ELF_C_READ_MMAP_PRIVATE))
+    {
+      __libelf_seterrno (ELF_E_INVALID_CMD);
+      return NULL;
+    }
+
+  int fd = spill_file ();
+  if (unlikely (fd == -1))
+    /* Without a temporary file the stream has to fit into memory.  */
+    return (read == NULL ? read_memory (&read_fd, &fildes, cmd)
+	    : read_memory (read, arg, cmd));
+
+  char *buf = malloc (STREAM_BUFSIZE);
+  if (unlikely (buf == NULL))
+    {
+      __libelf_seterrno (ELF_E_NOMEM);
+      close (fd);
+      return NULL;
+    }
+
+  ssize_t size = (read == NULL ? copy_fd (fildes, fd, buf)
+		  : copy_stream (read, arg, fd, buf));
+  free (buf);
+
+  Elf *elf = NULL;
+  if (unlikely (size < 0))
+    __libelf_seterrno (ELF_E_READ_ERROR);
+  else if (size == 0)
+    /* Nothing to map, and nothing we could handle.  */
+    elf = allocate_elf (-1, NULL, 0, 0, cmd, NULL, ELF_K_NONE, 0);
+  else
+    {
+      /* From now on the pages are read from the file only when they
+	 are used.  */
+      void *map_address = mmap (NULL, size,
+				cmd == ELF_C_READ_MMAP
+				? PROT_READ : PROT_READ | PROT_WRITE,
+				MAP_PRIVATE, fd, 0);
+      if (unlikely (map_address == MAP_FAILED))
+	__libelf_seterrno (ELF_E_NOMEM);
+      else
+	{
+	  elf = __libelf_read_mmaped_file (-1, map_address, 0, size, cmd,
+					   NULL);
+	  if (elf == NULL)
+	    munmap (map_address, size);
+	  else
+	    elf->flags |= ELF_F_MMAPPED;
+	}
+    }
+
+  /* The mapping keeps the file alive.  */
+  close (fd);
+
+  return elf;
+}
+
+
+Elf *
+elf_begin_stream (Elf_Stream_Read *read, void *arg, Elf_Cmd cmd)
+{
+  if (unlikely (! __libelf_version_initialized))
+    {
+      /* Version wasn't set so far.  */
+      __libelf_seterrno (ELF_E_NO_VERSION);
+      return NULL;
+    }
+
+  if (read == NULL)
+    return NULL;
+
+  return __libelf_read_stream (-1, read, arg, cmd);
+}
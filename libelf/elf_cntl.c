@@ -31,11 +31,84 @@
 # include <config.h>
 #endif
 
+#include <fcntl.h>
+#include <stdint.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/param.h>
 
 #include "libelfP.h"
 
 
+int
+internal_function
+__libelf_advise (Elf *elf, Elf_Cmd cmd, size_t offset, size_t len)
+{
+  int madv;
+  int fadv;
+  switch (cmd)
+    {
+    case ELF_C_ADVISE_NORMAL:
+      madv = MADV_NORMAL;
+      fadv = POSIX_FADV_NORMAL;
+      break;
+    case ELF_C_ADVISE_SEQUENTIAL:
+      madv = MADV_SEQUENTIAL;
+      fadv = POSIX_FADV_SEQUENTIAL;
+      break;
+    case ELF_C_ADVISE_RANDOM:
+      madv = MADV_RANDOM;
+      fadv = POSIX_FADV_RANDOM;
+      break;
+    case ELF_C_ADVISE_WILLNEED:
+      madv = MADV_WILLNEED;
+      fadv = POSIX_FADV_WILLNEED;
+      break;
+    case ELF_C_ADVISE_DONTNEED:
+      madv = MADV_DONTNEED;
+      fadv = POSIX_FADV_DONTNEED;
+      break;
+    default:
+      __libelf_seterrno (ELF_E_INVALID_CMD);
+      return -1;
+    }
+
+  /* A new file has no contents to read yet.  */
+  if (elf->cmd == ELF_C_WRITE || elf->cmd == ELF_C_WRITE_MMAP
+      || offset >= elf->maximum_size)
+    return 0;
+  len = MIN (len, elf->maximum_size - offset);
+  if (len == 0)
+    return 0;
+
+  /* Only memory we mapped ourselves is advised, not the buffer passed
+     to elf_memory.  Archive members use the mapping of the archive.  */
+  Elf *top = elf;
+  while (top->parent != NULL)
+    top = top->parent;
+
+  /* The results are only hints, errors do not matter.  */
+  if (elf->map_address != NULL && (top->flags & ELF_F_MMAPPED) != 0
+      /* Dropping pages of a writable mapping would lose the changes.  */
+      && (cmd != ELF_C_ADVISE_DONTNEED || elf->cmd == ELF_C_READ_MMAP))
+    {
+      uintptr_t start = ((uintptr_t) elf->map_address + elf->start_offset
+			 + offset);
+      uintptr_t page = start & ~((uintptr_t) sysconf (_SC_PAGESIZE) - 1);
+      (void) madvise ((void *) page, len + (start - page), madv);
+
+      /* The page cache still holds what was unmapped.  */
+      if (cmd != ELF_C_ADVISE_DONTNEED)
+	return 0;
+    }
+
+  if (elf->fildes != -1)
+    (void) posix_fadvise (elf->fildes, elf->start_offset + offset, len, fadv);
+
+  return 0;
+}
+
+
 int
 elf_cntl (elf, cmd)
      Elf *elf;
@@ -46,6 +119,14 @@ elf_cntl (elf, cmd)
   if (elf == NULL)
     return -1;
 
+  if (cmd >= ELF_C_ADVISE_NORMAL && cmd <= ELF_C_ADVISE_DONTNEED)
+    {
+      rwlock_rdlock (elf->lock);
+      result = __libelf_advise (elf, cmd, 0, elf->maximum_size);
+      rwlock_unlock (elf->lock);
+      return result;
+    }
+
   if (elf->fildes == -1)
     {
       __libelf_seterrno (ELF_E_INVALID_HANDLE);
@@ -71,6 +71,10 @@ elf_end (elf)
       if (elf->state.ar.ar_sym != (Elf_Arsym *) -1l)
 	free (elf->state.ar.ar_sym);
       elf->state.ar.ar_sym = NULL;
+      free (elf->state.ar.ar_sym_hash);
+      elf->state.ar.ar_sym_hash = NULL;
+      free (elf->state.ar.members);
+      elf->state.ar.members = NULL;
 
       if (elf->state.ar.children != NULL)
 	return 0;
@@ -86,7 +90,7 @@ elf_end (elf)
 	 state of REF_COUNT==0 is handled all over the library, so
 	 this should be ok.  */
       rwlock_unlock (elf->lock);
-      rwlock_rdlock (parent->lock);
+      rwlock_wrlock (parent->lock);
       rwlock_wrlock (elf->lock);
 
       if (parent->state.ar.children == elf)
@@ -128,6 +132,9 @@ elf_end (elf)
 	    free (rawchunks);
 	    rawchunks = next;
 	  }
+	Elf_Data_Chunk_Hash_free (elf->class == ELFCLASS32
+				  ? &elf->state.elf32.rawchunk_hash
+				  : &elf->state.elf64.rawchunk_hash);
 
 	Elf_ScnList *list = (elf->class == ELFCLASS32
 			     || (offsetof (struct Elf, state.elf32.scns)
@@ -174,6 +181,8 @@ elf_end (elf)
 		    if ((oldp->flags & ELF_F_MALLOCED) != 0)
 		      free (oldp);
 		  }
+
+		rwlock_fini (scn->lock);
 	      }
 
 	    /* Free the memory for the array.  */
@@ -192,11 +201,12 @@ elf_end (elf)
 
       /* Free the section header.  */
       if (elf->state.elf.shdr_malloced  != 0)
-	free (elf->class == ELFCLASS32
-	      || (offsetof (struct Elf, state.elf32.shdr)
-		  == offsetof (struct Elf, state.elf64.shdr))
-	      ? (void *) elf->state.elf32.shdr
-	      : (void *) elf->state.elf64.shdr);
+	__libelf_arena_free (elf->arena,
+			     elf->class == ELFCLASS32
+			     || (offsetof (struct Elf, state.elf32.shdr)
+				 == offsetof (struct Elf, state.elf64.shdr))
+			     ? (void *) elf->state.elf32.shdr
+			     : (void *) elf->state.elf64.shdr);
 
       /* Free the program header.  */
       if ((elf->state.elf.phdr_flags & ELF_F_MALLOCED) != 0)
@@ -224,7 +234,7 @@ elf_end (elf)
   rwlock_fini (elf->lock);
 
   /* Finally the descriptor itself.  */
-  free (elf);
+  __libelf_free_elf (elf);
 
   return (parent != NULL && parent->ref_count == 0
 	  ? INTUSE(elf_end) (parent) : 0);
@@ -0,0 +1,137 @@
+/* Look up symbols in the archive symbol table.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libelf.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <system.h>
+#include <dl-hash.h>
+#include "libelfP.h"
+
+
+/* Build the hash table for the N entries of the archive symbol table.
+   The buckets are followed by one chain link for each entry.  Entries
+   on a chain are kept in the order of the symbol table, the end is
+   marked by N which is the index of the terminating entry.  */
+static size_t *
+build_index (Elf_Arsym *arsym, size_t n, size_t *nbucketsp)
+{
+  size_t nbuckets = __libelf_next_prime (n ?: 1);
+  size_t *buckets = malloc ((nbuckets + n) * sizeof (size_t));
+  if (unlikely (buckets == NULL))
+    {
+      __libelf_seterrno (ELF_E_NOMEM);
+      return NULL;
+    }
+  size_t *chain = buckets + nbuckets;
+
+  for (size_t cnt = 0; cnt < nbuckets; ++cnt)
+    buckets[cnt] = n;
+
+  /* Going backwards keeps the chains in ascending order.  */
+  for (size_t cnt = n; cnt-- > 0; )
+    {
+      size_t idx = arsym[cnt].as_hash % nbuckets;
+      chain[cnt] = buckets[idx];
+      buckets[idx] = cnt;
+    }
+
+  *nbucketsp = nbuckets;
+  return buckets;
+}
+
+
+Elf_Arsym *
+elf_findarsym (Elf *elf, const char *name, Elf_Arsym *prev)
+{
+  if (elf == NULL || name == NULL)
+    return NULL;
+
+  /* This reports all the problems with the symbol table itself.  */
+  size_t n;
+  Elf_Arsym *arsym = INTUSE(elf_getarsym) (elf, &n);
+  if (arsym == NULL)
+    return NULL;
+  /* Not counting the terminating entry.  */
+  --n;
+
+  if (unlikely (prev != NULL && (prev < arsym || prev >= arsym + n)))
+    {
+      __libelf_seterrno (ELF_E_INVALID_OP);
+      return NULL;
+    }
+
+  /* The table is published only once the number of buckets is set,
+     so that is valid whenever the table is seen.  */
+  size_t *buckets = atomic_load_acquire (&elf->state.ar.ar_sym_hash);
+  if (buckets == NULL)
+    {
+      rwlock_wrlock (elf->lock);
+
+      buckets = elf->state.ar.ar_sym_hash;
+      if (buckets == NULL)
+	{
+	  size_t nbuckets;
+	  buckets = build_index (arsym, n, &nbuckets);
+	  if (buckets != NULL)
+	    {
+	      elf->state.ar.ar_sym_nbuckets = nbuckets;
+	      atomic_store_release (&elf->state.ar.ar_sym_hash, buckets);
+	    }
+	}
+
+      rwlock_unlock (elf->lock);
+
+      if (buckets == NULL)
+	return NULL;
+    }
+  const size_t *chain = buckets + elf->state.ar.ar_sym_nbuckets;
+
+  unsigned long int hval;
+  size_t idx;
+  if (prev == NULL)
+    {
+      hval = _dl_elf_hash (name);
+      idx = buckets[hval % elf->state.ar.ar_sym_nbuckets];
+    }
+  else
+    {
+      hval = prev->as_hash;
+      idx = chain[prev - arsym];
+    }
+
+  for (; idx != n; idx = chain[idx])
+    if (arsym[idx].as_hash == hval && strcmp (arsym[idx].as_name, name) == 0)
+      return &arsym[idx];
+
+  return NULL;
+}
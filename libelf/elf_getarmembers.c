@@ -0,0 +1,210 @@
+/* Return the list of members of an archive.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <ctype.h>
+#include <libelf.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <system.h>
+#include "libelfP.h"
+
+
+/* Read the header at OFFSET into *HDRM if the archive is not mapped.
+   Return NULL if there is none.  */
+static struct ar_hdr *
+get_hdr (Elf *elf, size_t offset, struct ar_hdr *hdrm)
+{
+  if (offset > elf->maximum_size
+      || elf->maximum_size - offset < sizeof (struct ar_hdr))
+    return NULL;
+
+  if (elf->map_address != NULL)
+    return (struct ar_hdr *) (elf->map_address + elf->start_offset + offset);
+
+  if (unlikely (pread_retry (elf->fildes, hdrm, sizeof (*hdrm),
+			     elf->start_offset + offset) != sizeof (*hdrm)))
+    return NULL;
+  return hdrm;
+}
+
+
+/* Fill in the name of the member with header AR_HDR.  Short names are
+   copied to NAMEBUF.  Return -1 for broken archives, 1 for the special
+   members which are not reported.  */
+static int
+get_name (Elf *elf, struct ar_hdr *ar_hdr, char namebuf[16], char **namep)
+{
+  if (ar_hdr->ar_name[0] == '/')
+    {
+      if (memcmp (ar_hdr->ar_name, "/               ", 16) == 0
+	  || memcmp (ar_hdr->ar_name, "/SYM64/         ", 16) == 0
+	  || memcmp (ar_hdr->ar_name, "//              ", 16) == 0)
+	return 1;
+
+      if (unlikely (! isdigit (ar_hdr->ar_name[1])))
+	return -1;
+
+      /* This is a long name.  */
+      if (unlikely (elf->state.ar.long_names == NULL
+		    && __libelf_read_long_names (elf) == NULL))
+	return -1;
+
+      size_t offset = atol (ar_hdr->ar_name + 1);
+      if (unlikely (offset >= elf->state.ar.long_names_len))
+	return -1;
+      *namep = elf->state.ar.long_names + offset;
+      return 0;
+    }
+
+  char *endp = (char *) memccpy (namebuf, ar_hdr->ar_name, '/', 16);
+  if (endp != NULL)
+    endp[-1] = '\0';
+  else
+    {
+      /* In the old BSD style of archive, there is no / terminator.
+	 Instead, there is space padding at the end of the name.  */
+      size_t i = 15;
+      do
+	namebuf[i] = '\0';
+      while (i > 0 && namebuf[--i] == ' ');
+    }
+  *namep = namebuf;
+  return 0;
+}
+
+
+/* Go through the archive.  Without MEMBERS just count.  */
+static ssize_t
+read_members (Elf *elf, Elf_Armember *members, char (*names)[16])
+{
+  size_t n = 0;
+  size_t offset = SARMAG;
+  struct ar_hdr hdrm;
+  struct ar_hdr *ar_hdr;
+
+  while ((ar_hdr = get_hdr (elf, offset, &hdrm)) != NULL)
+    {
+      if (unlikely (memcmp (ar_hdr->ar_fmag, ARFMAG, 2) != 0))
+	{
+	  __libelf_seterrno (ELF_E_ARCHIVE_FMAG);
+	  return -1;
+	}
+
+      char buf[sizeof (ar_hdr->ar_size) + 1];
+      *((char *) __mempcpy (buf, ar_hdr->ar_size, sizeof (ar_hdr->ar_size)))
+	= '\0';
+      size_t size = atoll (buf);
+      if (unlikely (ar_hdr->ar_size[0] == ' ')
+	  || unlikely (elf->maximum_size - offset - sizeof (struct ar_hdr)
+		       < size))
+	{
+	  __libelf_seterrno (ELF_E_INVALID_ARCHIVE);
+	  return -1;
+	}
+
+      char scratch[16];
+      char *name = NULL;
+      int res = get_name (elf, ar_hdr, members != NULL ? names[n] : scratch,
+			  &name);
+      if (unlikely (res < 0))
+	{
+	  __libelf_seterrno (ELF_E_INVALID_ARCHIVE);
+	  return -1;
+	}
+      if (res == 0)
+	{
+	  if (members != NULL)
+	    {
+	      members[n].am_name = name;
+	      members[n].am_off = offset;
+	      members[n].am_size = size;
+	    }
+	  ++n;
+	}
+
+      offset += sizeof (struct ar_hdr) + ((size + 1) & ~(size_t) 1);
+    }
+
+  return n;
+}
+
+
+Elf_Armember *
+elf_getarmembers (Elf *elf, size_t *nmembers)
+{
+  if (elf == NULL)
+    return NULL;
+
+  if (unlikely (elf->kind != ELF_K_AR))
+    {
+      __libelf_seterrno (ELF_E_NO_ARCHIVE);
+      return NULL;
+    }
+
+  Elf_Armember *result = elf->state.ar.members;
+  if (result == NULL)
+    {
+      rwlock_wrlock (elf->lock);
+
+      result = elf->state.ar.members;
+      if (result == NULL)
+	{
+	  /* First count the members, then fill in the array followed by
+	     the buffers for the short names.  */
+	  ssize_t n = read_members (elf, NULL, NULL);
+	  if (n >= 0)
+	    {
+	      result = malloc (n * (sizeof (Elf_Armember) + 16) ?: 1);
+	      if (unlikely (result == NULL))
+		__libelf_seterrno (ELF_E_NOMEM);
+	      else if (read_members (elf, result,
+				     (char (*)[16]) (result + n)) != n)
+		{
+		  free (result);
+		  result = NULL;
+		}
+	      else
+		{
+		  elf->state.ar.nmembers = n;
+		  elf->state.ar.members = result;
+		}
+	    }
+	}
+
+      rwlock_unlock (elf->lock);
+    }
+
+  if (nmembers != NULL)
+    *nmembers = result != NULL ? elf->state.ar.nmembers : 0;
+
+  return result;
+}
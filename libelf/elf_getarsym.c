@@ -306,3 +306,4 @@ elf_getarsym (elf, ptr)
 
   return result;
 }
+INTDEF(elf_getarsym)
@@ -311,14 +311,41 @@ __libelf_set_rawdata_wrlock (Elf_Scn *scn)
 
   scn->rawdata.s = scn;
 
-  scn->data_read = 1;
-
   /* We actually read data from the file.  At least we tried.  */
   scn->flags |= ELF_F_FILEDATA;
 
+  /* Now readers not holding any lock can use the data.  */
+  atomic_store_release (&scn->data_read, 1);
+
   return 0;
 }
 
+/* Like __libelf_set_rawdata_wrlock, but with only the read lock of the
+   file held.  Other sections can be loaded at the same time.  */
+int
+internal_function
+__libelf_set_rawdata_rdlock (Elf_Scn *scn)
+{
+  if (atomic_load_acquire (&scn->data_read) != 0)
+    return 0;
+
+  /* The section headers are read for all sections at once, which needs
+     the write lock of the file.  */
+  if ((scn->elf->class == ELFCLASS32
+       ? (void *) __elf32_getshdr_rdlock (scn)
+       : (void *) __elf64_getshdr_rdlock (scn)) == NULL)
+    return 1;
+
+  int result = 0;
+
+  rwlock_wrlock (scn->lock);
+  if (scn->data_read == 0)
+    result = __libelf_set_rawdata_wrlock (scn);
+  rwlock_unlock (scn->lock);
+
+  return result;
+}
+
 int
 internal_function
 __libelf_set_rawdata (Elf_Scn *scn)
@@ -328,8 +355,8 @@ __libelf_set_rawdata (Elf_Scn *scn)
   if (scn == NULL)
     return 1;
 
-  rwlock_wrlock (scn->elf->lock);
-  result = __libelf_set_rawdata_wrlock (scn);
+  rwlock_rdlock (scn->elf->lock);
+  result = __libelf_set_rawdata_rdlock (scn);
   rwlock_unlock (scn->elf->lock);
 
   return result;
@@ -343,7 +370,6 @@ __elf_getdata_rdlock (scn, data)
 {
   Elf_Data *result = NULL;
   Elf *elf;
-  int locked = 0;
 
   if (scn == NULL)
     return NULL;
@@ -402,40 +428,27 @@ __elf_getdata_rdlock (scn, data)
       goto out;
     }
 
-  /* If the data for this section was not yet initialized do it now.  */
-  if (scn->data_read == 0)
-    {
-      /* We cannot acquire a write lock while we are holding a read
-         lock.  Therefore give up the read lock and then get the write
-         lock.  But this means that the data could meanwhile be
-         modified, therefore start the tests again.  */
-      rwlock_unlock (elf->lock);
-      rwlock_wrlock (elf->lock);
-      locked = 1;
-
-      /* Read the data from the file.  There is always a file (or
-	 memory region) associated with this descriptor since
-	 otherwise the `data_read' flag would be set.  */
-      if (scn->data_read == 0 && __libelf_set_rawdata_wrlock (scn) != 0)
-	/* Something went wrong.  The error value is already set.  */
-	goto out;
-    }
+  if (atomic_load_acquire (&scn->data_list_rear) != NULL)
+    goto pass;
+
+  /* If the data for this section was not yet initialized do it now.
+     Read the data from the file.  There is always a file (or memory
+     region) associated with this descriptor since otherwise the
+     `data_read' flag would be set.  */
+  if (__libelf_set_rawdata_rdlock (scn) != 0)
+    /* Something went wrong.  The error value is already set.  */
+    goto out;
 
   /* At this point we know the raw data is available.  But it might be
      empty in case the section has size zero (for whatever reason).
-     Now create the converted data in case this is necessary.  */
+     Now create the converted data in case this is necessary.  Only
+     this section is locked, so other threads can load other sections
+     at the same time.  */
+  rwlock_wrlock (scn->lock);
   if (scn->data_list_rear == NULL)
     {
       if (scn->rawdata.d.d_buf != NULL && scn->rawdata.d.d_size > 0)
 	{
-	  if (!locked)
-	    {
-	      rwlock_unlock (elf->lock);
-	      rwlock_wrlock (elf->lock);
-	      if (scn->data_list_rear != NULL)
-		goto pass;
-	    }
-
 	  /* Convert according to the version and the type.   */
 	  convert_data (scn, __libelf_version, elf->class,
 			(elf->class == ELFCLASS32
@@ -453,14 +466,13 @@ __elf_getdata_rdlock (scn, data)
 	  scn->data_list.data.s = scn;
 	}
 
-      scn->data_list_rear = &scn->data_list;
+      atomic_store_release (&scn->data_list_rear, &scn->data_list);
     }
+  rwlock_unlock (scn->lock);
 
-  /* If no data is present we cannot return any.  */
-  if (scn->data_list_rear != NULL)
-  pass:
-    /* Return the first data element in the list.  */
-    result = &scn->data_list.data.d;
+ pass:
+  /* Return the first data element in the list.  */
+  result = &scn->data_list.data.d;
 
  out:
   return result;
@@ -476,6 +488,11 @@ elf_getdata (scn, data)
   if (scn == NULL)
     return NULL;
 
+  /* Once the data is there it only changes with the write lock held, by
+     functions which cannot be used at the same time as this one.  */
+  if (data == NULL && atomic_load_acquire (&scn->data_list_rear) != NULL)
+    return &scn->data_list.data.d;
+
   rwlock_rdlock (scn->elf->lock);
   result = __elf_getdata_rdlock (scn, data);
   rwlock_unlock (scn->elf->lock);
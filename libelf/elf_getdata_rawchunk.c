@@ -40,6 +40,42 @@
 #include "libelfP.h"
 #include "common.h"
 
+#define NAME Elf_Data_Chunk_Hash
+#define TYPE Elf_Data_Chunk *
+#define COMPARE(a, b) \
+  ((a)->offset != (b)->offset						      \
+   || (a)->data.d.d_size != (b)->data.d.d_size				      \
+   || (a)->data.d.d_type != (b)->data.d.d_type)
+#define next_prime __libelf_next_prime
+extern size_t next_prime (size_t) attribute_hidden;
+#include "../lib/dynamicsizehash.c"
+
+
+/* Hash value for a chunk request, nonzero as the table requires.  */
+static inline unsigned long int
+chunk_hash (off64_t offset, size_t size, Elf_Type type)
+{
+  unsigned long int hval = (unsigned long int) offset * 0x9e3779b1UL;
+  hval ^= size + (hval << 6) + (hval >> 2);
+  hval ^= type + (hval << 6) + (hval >> 2);
+  return hval ?: 1;
+}
+
+/* Find an earlier result for the same request.  */
+static Elf_Data_Chunk *
+find_chunk (Elf *elf, unsigned long int hval,
+	    off64_t offset, size_t size, Elf_Type type)
+{
+  if (elf->state.elf.rawchunk_hash.size == 0)
+    return NULL;
+
+  Elf_Data_Chunk key;
+  key.offset = offset;
+  key.data.d.d_size = size;
+  key.data.d.d_type = type;
+  return Elf_Data_Chunk_Hash_find (&elf->state.elf.rawchunk_hash, hval, &key);
+}
+
 Elf_Data *
 elf_getdata_rawchunk (elf, offset, size, type)
      Elf *elf;
@@ -78,6 +114,16 @@ elf_getdata_rawchunk (elf, offset, size, type)
 
   rwlock_rdlock (elf->lock);
 
+  /* The same chunk is often asked for repeatedly, hand out the first
+     result again rather than making another copy.  */
+  const unsigned long int hval = chunk_hash (offset, size, type);
+  Elf_Data_Chunk *chunk = find_chunk (elf, hval, offset, size, type);
+  if (chunk != NULL)
+    {
+      result = &chunk->data.d;
+      goto out;
+    }
+
   /* If the file is mmap'ed we can use it directly.  */
   if (elf->map_address != NULL)
     rawchunk = elf->map_address + elf->start_offset + offset;
@@ -146,7 +192,7 @@ elf_getdata_rawchunk (elf, offset, size, type)
     }
 
   /* Allocate the dummy container to point at this buffer.  */
-  Elf_Data_Chunk *chunk = calloc (1, sizeof *chunk);
+  chunk = calloc (1, sizeof *chunk);
   if (chunk == NULL)
     {
       if (flags)
@@ -162,10 +208,28 @@ elf_getdata_rawchunk (elf, offset, size, type)
   chunk->data.d.d_type = type;
   chunk->data.d.d_align = align;
   chunk->data.d.d_version = __libelf_version;
+  chunk->offset = offset;
 
   rwlock_unlock (elf->lock);
   rwlock_wrlock (elf->lock);
 
+  /* Another thread might have added the same chunk meanwhile.  */
+  Elf_Data_Chunk *other = find_chunk (elf, hval, offset, size, type);
+  if (other != NULL)
+    {
+      if (flags)
+	free (buffer);
+      free (chunk);
+      result = &other->data.d;
+      goto out;
+    }
+
+  /* If the table cannot be set up the chunk is just not shared.  */
+  if (elf->state.elf.rawchunk_hash.size != 0
+      || Elf_Data_Chunk_Hash_init (&elf->state.elf.rawchunk_hash, 31) == 0)
+    (void) Elf_Data_Chunk_Hash_insert (&elf->state.elf.rawchunk_hash,
+				       hval, chunk);
+
   chunk->next = elf->state.elf.rawchunks;
   elf->state.elf.rawchunks = chunk;
   result = &chunk->data.d;
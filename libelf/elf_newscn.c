@@ -141,6 +141,7 @@ elf_newscn (elf)
     }
 
   result->elf = elf;
+  rwlock_init (result->lock);
   result->shdr_flags = ELF_F_DIRTY | ELF_F_MALLOCED;
   result->list = elf->state.elf.scns_last;
 
@@ -0,0 +1,88 @@
+/* Return a pointer to a chunk of the mapped file contents.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libelf.h>
+#include <stdint.h>
+
+#include <system.h>
+#include "libelfP.h"
+#include "common.h"
+
+
+const void *
+elf_rawchunk (Elf *elf, off64_t offset, size_t size, Elf_Type type)
+{
+  if (unlikely (elf == NULL))
+    return NULL;
+
+  if (unlikely (elf->kind != ELF_K_ELF))
+    {
+      /* No valid descriptor.  */
+      __libelf_seterrno (ELF_E_INVALID_HANDLE);
+      return NULL;
+    }
+
+  if (unlikely (offset < 0 || offset + (off64_t) size < offset
+		|| offset + size > elf->maximum_size))
+    {
+      /* Invalid request.  */
+      __libelf_seterrno (ELF_E_INVALID_OP);
+      return NULL;
+    }
+
+  if (type >= ELF_T_NUM)
+    {
+      __libelf_seterrno (ELF_E_UNKNOWN_TYPE);
+      return NULL;
+    }
+
+  const void *result = NULL;
+
+  rwlock_rdlock (elf->lock);
+
+  /* Only file contents which are mapped and usable as they are can be
+     handed out.  Everything else needs elf_getdata_rawchunk, which
+     allocates the memory for the copy.  */
+  if (elf->map_address != NULL
+      && (type == ELF_T_BYTE
+	  || elf->state.elf32.ehdr->e_ident[EI_DATA] == MY_ELFDATA))
+    {
+      const char *rawchunk = ((const char *) elf->map_address
+			      + elf->start_offset + offset);
+      size_t align = __libelf_type_align (elf->class, type);
+      if (((uintptr_t) rawchunk & (align - 1)) == 0)
+	result = rawchunk;
+    }
+
+  rwlock_unlock (elf->lock);
+
+  return result;
+}
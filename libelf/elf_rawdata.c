@@ -52,8 +52,9 @@ elf_rawdata (scn, data)
      (since otherwise it is not possible to have a valid `data' pointer)
      and all the data structures are initialized as well.  In this case
      we can simply walk the list of data records.  */
+  int data_read = atomic_load_acquire (&scn->data_read);
   if (data != NULL
-      || (scn->data_read != 0 && (scn->flags & ELF_F_FILEDATA) == 0))
+      || (data_read != 0 && (scn->flags & ELF_F_FILEDATA) == 0))
     {
       /* We don't allow accessing any but the data read from the file
 	 as raw.  */
@@ -62,7 +63,7 @@ elf_rawdata (scn, data)
     }
 
   /* If the data for this section was not yet initialized do it now.  */
-  if (scn->data_read == 0)
+  if (data_read == 0)
     {
       /* First thing we do is to read the data from the file.  There is
 	 always a file (or memory region) associated with this descriptor
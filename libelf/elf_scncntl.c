@@ -0,0 +1,91 @@
+/* Give access hints for the contents of a section.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libelf.h>
+#include <stdbool.h>
+
+#include "libelfP.h"
+
+
+int
+elf_scncntl (Elf_Scn *scn, Elf_Cmd cmd, size_t offset, size_t size)
+{
+  if (scn == NULL)
+    return -1;
+
+  Elf *elf = scn->elf;
+  int result = -1;
+
+  rwlock_rdlock (elf->lock);
+
+  GElf_Word type;
+  GElf_Off scnoff;
+  GElf_Xword scnsize;
+  bool ok;
+  if (elf->class == ELFCLASS32)
+    {
+      Elf32_Shdr *shdr = __elf32_getshdr_rdlock (scn);
+      ok = shdr != NULL;
+      if (ok)
+	{
+	  type = shdr->sh_type;
+	  scnoff = shdr->sh_offset;
+	  scnsize = shdr->sh_size;
+	}
+    }
+  else
+    {
+      Elf64_Shdr *shdr = __elf64_getshdr_rdlock (scn);
+      ok = shdr != NULL;
+      if (ok)
+	{
+	  type = shdr->sh_type;
+	  scnoff = shdr->sh_offset;
+	  scnsize = shdr->sh_size;
+	}
+    }
+
+  if (ok)
+    {
+      /* Nothing to do for sections without contents in the file, but
+	 CMD is checked all the same.  */
+      size_t len = 0;
+      if (type != SHT_NOBITS && offset < scnsize
+	  && scnoff <= elf->maximum_size)
+	len = (size == 0 || size > scnsize - offset
+	       ? scnsize - offset : size);
+      result = __libelf_advise (elf, cmd, scnoff + offset, len);
+    }
+
+  rwlock_unlock (elf->lock);
+
+  return result;
+}
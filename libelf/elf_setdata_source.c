@@ -0,0 +1,187 @@
+/* Let elf_update copy section data directly from another file.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <errno.h>
+#include <libelf.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+
+#include <system.h>
+#include "libelfP.h"
+
+
+int
+elf_setdata_source (Elf_Data *data, Elf_Scn *scn)
+{
+  if (data == NULL)
+    return -1;
+
+  Elf_Data_Scn *data_scn = (Elf_Data_Scn *) data;
+  if (unlikely (data_scn->s == NULL || data_scn->s->elf->kind != ELF_K_ELF)
+      || (scn != NULL && unlikely (scn->elf->kind != ELF_K_ELF)))
+    {
+      __libelf_seterrno (ELF_E_INVALID_HANDLE);
+      return -1;
+    }
+
+  Elf *elf = data_scn->s->elf;
+  int result = -1;
+
+  rwlock_wrlock (elf->lock);
+
+  /* Only data in the list of the section can carry a source, not the
+     raw data or a chunk.  */
+  Elf_Data_List *dl = &data_scn->s->data_list;
+  if (data_scn->s->data_list_rear == NULL)
+    dl = NULL;
+  while (dl != NULL && &dl->data.d != data)
+    dl = dl->next;
+  if (unlikely (dl == NULL))
+    {
+      __libelf_seterrno (ELF_E_INVALID_HANDLE);
+      goto out;
+    }
+
+  if (scn == NULL)
+    {
+      dl->srcelf = NULL;
+      result = 0;
+      goto out;
+    }
+
+  /* The contents have to be read from a file.  */
+  if (unlikely (scn->elf->fildes == -1))
+    {
+      __libelf_seterrno (ELF_E_FD_DISABLED);
+      goto out;
+    }
+
+  if (scn->elf != elf)
+    rwlock_rdlock (scn->elf->lock);
+
+  GElf_Word type;
+  GElf_Off offset;
+  GElf_Xword size;
+  bool ok;
+  if (scn->elf->class == ELFCLASS32)
+    {
+      Elf32_Shdr *shdr = __elf32_getshdr_rdlock (scn);
+      ok = shdr != NULL;
+      if (ok)
+	{
+	  type = shdr->sh_type;
+	  offset = shdr->sh_offset;
+	  size = shdr->sh_size;
+	}
+    }
+  else
+    {
+      Elf64_Shdr *shdr = __elf64_getshdr_rdlock (scn);
+      ok = shdr != NULL;
+      if (ok)
+	{
+	  type = shdr->sh_type;
+	  offset = shdr->sh_offset;
+	  size = shdr->sh_size;
+	}
+    }
+
+  if (scn->elf != elf)
+    rwlock_unlock (scn->elf->lock);
+
+  if (! ok)
+    goto out;
+
+  if (unlikely (type == SHT_NOBITS)
+      || unlikely (offset > scn->elf->maximum_size
+		   || scn->elf->maximum_size - offset < size))
+    {
+      __libelf_seterrno (ELF_E_INVALID_SECTION);
+      goto out;
+    }
+
+  dl->srcelf = scn->elf;
+  dl->srcoff = scn->elf->start_offset + offset;
+  dl->srcsize = size;
+  result = 0;
+
+ out:
+  rwlock_unlock (elf->lock);
+
+  return result;
+}
+
+
+size_t
+internal_function
+__libelf_copy_range (int srcfd, off_t srcoff, int dstfd, off_t dstoff,
+		     size_t len)
+{
+  size_t done = 0;
+
+#ifdef HAVE_COPY_FILE_RANGE
+  /* This can share the blocks on file systems supporting it.  */
+  while (done < len)
+    {
+      ssize_t n = TEMP_FAILURE_RETRY (copy_file_range (srcfd, &srcoff,
+						       dstfd, &dstoff,
+						       len - done, 0));
+      if (n <= 0)
+	break;
+      done += n;
+    }
+
+  if (done == len)
+    return done;
+#endif
+
+  /* Otherwise splice through a pipe in the kernel.  This needs the file
+     position of DSTFD, which we restore since we usually use pwrite.  */
+  off_t pos = lseek (dstfd, 0, SEEK_CUR);
+  if (pos == -1 || lseek (dstfd, dstoff, SEEK_SET) != dstoff)
+    return done;
+
+  while (done < len)
+    {
+      ssize_t n = TEMP_FAILURE_RETRY (sendfile (dstfd, srcfd, &srcoff,
+						len - done));
+      if (n <= 0)
+	break;
+      done += n;
+    }
+
+  if (lseek (dstfd, pos, SEEK_SET) != pos)
+    /* Better write it all again than leave the position wrong.  */
+    return 0;
+
+  return done;
+}
@@ -32,32 +32,18 @@
 #endif
 
 #include <libelf.h>
+#include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
+#include <sys/param.h>
 
 #include "libelfP.h"
 
 
-char *
-elf_strptr (elf, idx, offset)
-     Elf *elf;
-     size_t idx;
-     size_t offset;
+/* Find section IDX of ELF, the lock must be held.  */
+static Elf_Scn *
+find_scn (Elf *elf, size_t idx)
 {
-  if (elf == NULL)
-    return NULL;
-
-  if (elf->kind != ELF_K_ELF)
-    {
-      __libelf_seterrno (ELF_E_INVALID_HANDLE);
-      return NULL;
-    }
-
-  rwlock_rdlock (elf->lock);
-
-  char *result = NULL;
-  Elf_Scn *strscn;
-
-  /* Find the section in the list.  */
   Elf_ScnList *runp = (elf->class == ELFCLASS32
 		       || (offsetof (struct Elf, state.elf32.scns)
 			   == offsetof (struct Elf, state.elf64.scns))
@@ -67,12 +53,7 @@ elf_strptr (elf, idx, offset)
       if (idx < runp->max)
 	{
 	  if (idx < runp->cnt)
-	    strscn = &runp->data[idx];
-	  else
-	    {
-	      __libelf_seterrno (ELF_E_INVALID_INDEX);
-	      goto out;
-	    }
+	    return &runp->data[idx];
 	  break;
 	}
 
@@ -80,61 +61,158 @@ elf_strptr (elf, idx, offset)
 
       runp = runp->next;
       if (runp == NULL)
-	{
-	  __libelf_seterrno (ELF_E_INVALID_INDEX);
-	  goto out;
-	}
+	break;
     }
 
+  __libelf_seterrno (ELF_E_INVALID_INDEX);
+  return NULL;
+}
+
+
+/* Return the string table validated earlier for section IDX of ELF,
+   without taking any lock.  */
+static const char *
+cached_strtab (Elf *elf, size_t idx, size_t *sizep)
+{
+  if (elf == NULL || unlikely (elf->kind != ELF_K_ELF))
+    return NULL;
+
+  /* Only the first block of sections, it cannot change anymore in files
+     which are only read.  */
+  Elf_ScnList *runp = (elf->class == ELFCLASS32
+		       || (offsetof (struct Elf, state.elf32.scns)
+			   == offsetof (struct Elf, state.elf64.scns))
+		       ? &elf->state.elf32.scns : &elf->state.elf64.scns);
+  if (idx >= runp->cnt)
+    return NULL;
+
+  Elf_Scn *strscn = &runp->data[idx];
+  const char *base = atomic_load_acquire (&strscn->strtab_base);
+  if (base != NULL)
+    *sizep = strscn->strtab_size;
+  return base;
+}
+
+
+/* Check that STRSCN is a string table and load its data.  Return the
+   size from the section header.  The lock must be held.  */
+static bool
+load_strtab_rdlock (Elf *elf, Elf_Scn *strscn, size_t *sizep)
+{
+  GElf_Word type;
   if (elf->class == ELFCLASS32)
     {
-      if (unlikely (strscn->shdr.e32->sh_type != SHT_STRTAB))
-	{
-	  /* This is no string section.  */
-	  __libelf_seterrno (ELF_E_INVALID_SECTION);
-	  goto out;
-	}
-
-      if (unlikely (offset >= strscn->shdr.e32->sh_size))
-	{
-	  /* The given offset is too big, it is beyond this section.  */
-	  __libelf_seterrno (ELF_E_OFFSET_RANGE);
-	  goto out;
-	}
+      Elf32_Shdr *shdr = __elf32_getshdr_rdlock (strscn);
+      if (unlikely (shdr == NULL))
+	return false;
+      type = shdr->sh_type;
+      *sizep = shdr->sh_size;
     }
   else
     {
-      if (unlikely (strscn->shdr.e64->sh_type != SHT_STRTAB))
-	{
-	  /* This is no string section.  */
-	  __libelf_seterrno (ELF_E_INVALID_SECTION);
-	  goto out;
-	}
+      Elf64_Shdr *shdr = __elf64_getshdr_rdlock (strscn);
+      if (unlikely (shdr == NULL))
+	return false;
+      type = shdr->sh_type;
+      *sizep = shdr->sh_size;
+    }
+
+  if (unlikely (type != SHT_STRTAB))
+    {
+      /* This is no string section.  */
+      __libelf_seterrno (ELF_E_INVALID_SECTION);
+      return false;
+    }
 
-      if (unlikely (offset >= strscn->shdr.e64->sh_size))
+  /* Read the section data.  */
+  return __libelf_set_rawdata_rdlock (strscn) == 0;
+}
+
+
+/* Return the data of STRSCN read from the file if it ends with a NUL
+   byte, so every offset in it gives a terminated string.  SIZE is
+   limited to what was read.  The lock must be held.  */
+static const char *
+validate_strtab_rdlock (Elf *elf, Elf_Scn *strscn, size_t *sizep)
+{
+  const char *base = strscn->rawdata_base;
+  if (base == NULL)
+    return NULL;
+
+  size_t size = MIN (*sizep, strscn->rawdata.d.d_size);
+  if (unlikely (size == 0) || unlikely (base[size - 1] != '\0'))
+    return NULL;
+  *sizep = size;
+
+  /* Unless the file is changed the check does not have to be repeated.
+     Remember the result for later lookups without the lock.  */
+  if (elf->cmd == ELF_C_READ || elf->cmd == ELF_C_READ_MMAP
+      || elf->cmd == ELF_C_READ_MMAP_PRIVATE)
+    {
+      rwlock_wrlock (strscn->lock);
+      if (strscn->strtab_base == NULL)
 	{
-	  /* The given offset is too big, it is beyond this section.  */
-	  __libelf_seterrno (ELF_E_OFFSET_RANGE);
-	  goto out;
+	  strscn->strtab_size = size;
+	  atomic_store_release (&strscn->strtab_base, base);
 	}
+      rwlock_unlock (strscn->lock);
+    }
+
+  return base;
+}
+
+
+char *
+elf_strptr (elf, idx, offset)
+     Elf *elf;
+     size_t idx;
+     size_t offset;
+{
+  size_t size;
+  const char *base = cached_strtab (elf, idx, &size);
+  if (likely (base != NULL) && likely (offset < size))
+    return (char *) base + offset;
+
+  if (elf == NULL)
+    return NULL;
+
+  if (elf->kind != ELF_K_ELF)
+    {
+      __libelf_seterrno (ELF_E_INVALID_HANDLE);
+      return NULL;
     }
 
-  if (strscn->rawdata_base == NULL && ! strscn->data_read)
+  rwlock_rdlock (elf->lock);
+
+  char *result = NULL;
+  Elf_Scn *strscn = find_scn (elf, idx);
+  if (strscn == NULL || ! load_strtab_rdlock (elf, strscn, &size))
+    goto out;
+
+  if (unlikely (offset >= size))
     {
-      rwlock_unlock (elf->lock);
-      rwlock_wrlock (elf->lock);
-      if (strscn->rawdata_base == NULL && ! strscn->data_read
-	/* Read the section data.  */
-	  && __libelf_set_rawdata_wrlock (strscn) != 0)
-	goto out;
+      /* The given offset is too big, it is beyond this section.  */
+      __libelf_seterrno (ELF_E_OFFSET_RANGE);
+      goto out;
     }
 
   if (likely (strscn->rawdata_base != NULL))
-    // XXX Is this correct if a file is read and then new data is added
-    // XXX to the string section?  Likely needs to check offset against
-    // XXX size of rawdata_base buffer and then iterate over rest of the
-    // XXX list.
-    result = &strscn->rawdata_base[offset];
+    {
+      // XXX Is this correct if a file is read and then new data is added
+      // XXX to the string section?  Likely needs to check offset against
+      // XXX size of rawdata_base buffer and then iterate over rest of the
+      // XXX list.
+      base = validate_strtab_rdlock (elf, strscn, &size);
+      if (likely (base != NULL))
+	result = (char *) base + offset;
+      else if (offset < strscn->rawdata.d.d_size
+	       && memchr (&strscn->rawdata_base[offset], '\0',
+			  strscn->rawdata.d.d_size - offset) != NULL)
+	/* A broken table, but this string is fine.  */
+	result = &strscn->rawdata_base[offset];
+      else
+	__libelf_seterrno (ELF_E_INVALID_DATA);
+    }
   else
     {
       /* This is a file which is currently created.  Use the list of
@@ -145,7 +223,12 @@ elf_strptr (elf, idx, offset)
 	  if (offset >= (size_t) dl->data.d.d_off
 	      && offset < dl->data.d.d_off + dl->data.d.d_size)
 	    {
-	      result = (char *) dl->data.d.d_buf + (offset - dl->data.d.d_off);
+	      size_t ndx = offset - dl->data.d.d_off;
+	      if (memchr ((char *) dl->data.d.d_buf + ndx, '\0',
+			  dl->data.d.d_size - ndx) != NULL)
+		result = (char *) dl->data.d.d_buf + ndx;
+	      else
+		__libelf_seterrno (ELF_E_INVALID_DATA);
 	      break;
 	    }
 
@@ -159,3 +242,53 @@ elf_strptr (elf, idx, offset)
   return result;
 }
 INTDEF(elf_strptr)
+
+
+const char *
+elf_strtab (Elf *elf, size_t idx, size_t *sizep)
+{
+  size_t size;
+  const char *result = cached_strtab (elf, idx, &size);
+  if (likely (result != NULL))
+    {
+      *sizep = size;
+      return result;
+    }
+
+  if (elf == NULL)
+    return NULL;
+
+  if (elf->kind != ELF_K_ELF)
+    {
+      __libelf_seterrno (ELF_E_INVALID_HANDLE);
+      return NULL;
+    }
+
+  rwlock_rdlock (elf->lock);
+
+  Elf_Scn *strscn = find_scn (elf, idx);
+  if (strscn == NULL || ! load_strtab_rdlock (elf, strscn, &size))
+    goto out;
+
+  if (strscn->rawdata_base != NULL)
+    result = validate_strtab_rdlock (elf, strscn, &size);
+  else if (strscn->data_list_rear == &strscn->data_list
+	   && strscn->data_list.data.d.d_off == 0)
+    {
+      /* A string table created in one piece.  */
+      result = strscn->data_list.data.d.d_buf;
+      size = MIN (size, strscn->data_list.data.d.d_size);
+      if (size == 0 || result[size - 1] != '\0')
+	result = NULL;
+    }
+
+  if (result == NULL)
+    __libelf_seterrno (ELF_E_INVALID_DATA);
+  else
+    *sizep = size;
+
+ out:
+  rwlock_unlock (elf->lock);
+
+  return result;
+}
@@ -99,6 +99,11 @@ typedef enum
   ELF_C_READ_MMAP_PRIVATE,	/* Read, but memory is writable, results are
 				   not written to the file.  */
   ELF_C_EMPTY,			/* Copy basic file data but not the content. */
+  ELF_C_ADVISE_NORMAL,		/* No special access pattern.  */
+  ELF_C_ADVISE_SEQUENTIAL,	/* Contents are read from start to end.  */
+  ELF_C_ADVISE_RANDOM,		/* Contents are read at random places.  */
+  ELF_C_ADVISE_WILLNEED,	/* Contents are needed soon.  */
+  ELF_C_ADVISE_DONTNEED,	/* Contents are not needed anymore.  */
   /* Keep this the last entry.  */
   ELF_C_NUM
 } Elf_Cmd;
@@ -150,12 +155,24 @@ typedef struct
 } Elf_Arsym;
 
 
+/* Archive member, as returned by elf_getarmembers.  */
+typedef struct
+{
+  char *am_name;		/* Name of the member.  */
+  size_t am_off;		/* Offset of its header in the archive.  */
+  loff_t am_size;		/* Size of the member.  */
+} Elf_Armember;
+
+
 /* Descriptor for the ELF file.  */
 typedef struct Elf Elf;
 
 /* Descriptor for ELF file section.  */
 typedef struct Elf_Scn Elf_Scn;
 
+/* Memory pool for ELF descriptors.  */
+typedef struct Elf_Arena Elf_Arena;
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -170,12 +187,45 @@ extern Elf *elf_begin (int __fildes, Elf_Cmd __cmd, Elf *__ref);
 /* Create descriptor for memory region.  */
 extern Elf *elf_memory (char *__image, size_t __size);
 
+/* Function reading up to SIZE bytes of a stream into BUF.  It returns
+   the number of bytes read, zero at the end of the stream or -1 for
+   an error.  */
+typedef ssize_t Elf_Stream_Read (void *__arg, void *__buf, size_t __size);
+
+/* Create descriptor for the file read from start to end with READ,
+   passing ARG, for example from a pipe or a decompressor.  The
+   contents are kept in an unlinked temporary file and read back only
+   as they are used, or in memory if no such file can be created.  CMD
+   must be ELF_C_READ, ELF_C_READ_MMAP or ELF_C_READ_MMAP_PRIVATE.
+   elf_begin does the same for a file descriptor which does not support
+   pread.  */
+extern Elf *elf_begin_stream (Elf_Stream_Read *__read, void *__arg,
+			      Elf_Cmd __cmd);
+
 /* Advance archive descriptor to next element.  */
 extern Elf_Cmd elf_next (Elf *__elf);
 
 /* Free resources allocated for ELF.  */
 extern int elf_end (Elf *__elf);
 
+/* Create a pool for ELF descriptors.  Memory of descriptors ended with
+   elf_end is kept in the pool for the next descriptors instead of
+   being freed.  */
+extern Elf_Arena *elf_arena_begin (void);
+
+/* Create the descriptors of the calling thread in ARENA from now on,
+   or in memory of their own again if ARENA is NULL.  Return the arena
+   used before.  */
+extern Elf_Arena *elf_arena_use (Elf_Arena *__arena);
+
+/* Call elf_end for all descriptors of ARENA which are still in use.
+   Their memory is kept for new descriptors.  None of the descriptors
+   must be used by other threads at the same time.  */
+extern int elf_arena_release (Elf_Arena *__arena);
+
+/* Like elf_arena_release, but free all memory of ARENA.  */
+extern int elf_arena_end (Elf_Arena *__arena);
+
 /* Update ELF descriptor and write file to disk.  */
 extern loff_t elf_update (Elf *__elf, Elf_Cmd __cmd);
 
@@ -304,10 +354,32 @@ extern Elf_Data *elf_getdata_rawchunk (Elf *__elf,
 				       loff_t __offset, size_t __size,
 				       Elf_Type __type);
 
+/* Return a pointer to SIZE bytes at OFFSET in the file as they would
+   be in the result of elf_getdata_rawchunk for TYPE, without allocating
+   anything.  This is only possible if the file is mapped and the data
+   need neither conversion nor realignment; otherwise NULL is returned
+   and elf_getdata_rawchunk has to be used.  The pointer is valid until
+   elf_end (ELF) is called.  */
+extern const void *elf_rawchunk (Elf *__elf, loff_t __offset, size_t __size,
+				 Elf_Type __type);
+
+/* Declare that the contents of DATA are the unmodified contents of
+   section SCN of another file.  elf_update then copies them from that
+   file inside the kernel where possible instead of writing the buffer.
+   The Elf descriptor of SCN must stay open until then.  Passing a null
+   SCN removes the source.  */
+extern int elf_setdata_source (Elf_Data *__data, Elf_Scn *__scn);
+
 
 /* Return pointer to string at OFFSET in section INDEX.  */
 extern char *elf_strptr (Elf *__elf, size_t __index, size_t __offset);
 
+/* Return the string table in section INDEX and store its size in
+   *SIZE.  The last byte is NUL, so every offset below *SIZE is the
+   start of a terminated string.  Once checked, later calls for the
+   table and elf_strptr on it do not need to take a lock.  */
+extern const char *elf_strtab (Elf *__elf, size_t __index, size_t *__size);
+
 
 /* Return header of archive.  */
 extern Elf_Arhdr *elf_getarhdr (Elf *__elf);
@@ -321,10 +393,38 @@ extern size_t elf_rand (Elf *__elf, size_t __offset);
 /* Get symbol table of archive.  */
 extern Elf_Arsym *elf_getarsym (Elf *__elf, size_t *__narsyms);
 
+/* Return the entry of the archive symbol table of ELF for NAME.  If
+   PREV is NULL the first such entry is returned, otherwise the next one
+   after PREV, which must be a previous result for NAME.  The result is
+   NULL if there is no (further) entry.  A hash table for the lookups is
+   built on the first call.  */
+extern Elf_Arsym *elf_findarsym (Elf *__elf, const char *__name,
+				 Elf_Arsym *__prev);
+
+/* Get all members of the archive ELF in file order, except for the
+   symbol table and the long name table.  The array is valid until
+   elf_end (ELF) is called.  */
+extern Elf_Armember *elf_getarmembers (Elf *__elf, size_t *__nmembers);
+
+/* Return a descriptor for reading the member of the archive ELF whose
+   header is at OFFSET, as passed to elf_rand.  The member elf_begin
+   and elf_next work on is not changed, so members can be opened this
+   way from several threads at once if libelf is thread-safe.  CMD must
+   be ELF_C_READ, ELF_C_READ_MMAP or ELF_C_READ_MMAP_PRIVATE.  Neither
+   elf_getarhdr nor elf_next can be used with the result.  */
+extern Elf *elf_begin_armember (Elf *__elf, size_t __offset, Elf_Cmd __cmd);
+
 
 /* Control ELF descriptor.  */
 extern int elf_cntl (Elf *__elf, Elf_Cmd __cmd);
 
+/* Tell the system how SIZE bytes at OFFSET in the contents of section
+   SCN will be accessed.  CMD is one of the ELF_C_ADVISE_* commands,
+   which elf_cntl also accepts for the whole file.  A SIZE of zero means
+   up to the end of the section.  */
+extern int elf_scncntl (Elf_Scn *__scn, Elf_Cmd __cmd, size_t __offset,
+			size_t __size);
+
 /* Retrieve uninterpreted file contents.  */
 extern char *elf_rawfile (Elf *__elf, size_t *__nbytes);
 
@@ -160,6 +160,11 @@ typedef struct Elf_Data_List
   Elf_Data_Scn data;
   struct Elf_Data_List *next;
   int flags;
+  /* If not NULL the contents are the SRCSIZE bytes at SRCOFF in the
+     file of SRCELF, see elf_setdata_source.  */
+  Elf *srcelf;
+  off_t srcoff;
+  size_t srcsize;
 } Elf_Data_List;
 
 
@@ -232,6 +237,17 @@ struct Elf_Scn
 
   struct Elf_ScnList *list;	/* Pointer to the section list element the
 				   data is in.  */
+
+  /* Loading the raw and the converted data only needs a read lock for
+     the file and this lock.  Once `data_read' and `data_list_rear' are
+     set they are only changed while holding the write lock of the
+     file, so readers can use them without a lock.  */
+  rwlock_define (,lock);
+
+  /* The string table in this section once elf_strptr or elf_strtab
+     checked that it ends with a NUL byte.  */
+  const char *strtab_base;
+  size_t strtab_size;
 };
 
 
@@ -254,8 +270,12 @@ typedef struct Elf_Data_Chunk
     Elf_Scn dummy_scn;
     struct Elf_Data_Chunk *next;
   };
+  off64_t offset;		/* Offset of the chunk in the file.  */
 } Elf_Data_Chunk;
 
+/* Hash table to find identical elf_getdata_rawchunk requests.  */
+#include "elf_rawchunk_hash.h"
+
 
 /* The ELF descriptor.  */
 struct Elf
@@ -295,6 +315,12 @@ struct Elf
   /* Reference counting for the descriptor.  */
   int ref_count;
 
+  /* The arena the descriptor was allocated in, or NULL.  The
+     descriptors of an arena which are still in use are linked.  */
+  Elf_Arena *arena;
+  Elf *arena_prev;
+  Elf *arena_next;
+
   /* Lock to handle multithreaded programs.  */
   rwlock_define (,lock);
 
@@ -311,6 +337,8 @@ struct Elf
 				   If NULL the data has not yet been
 				   read from the file.  */
       Elf_Data_Chunk *rawchunks; /* List of elf_getdata_rawchunk results.  */
+      Elf_Data_Chunk_Hash rawchunk_hash; /* The same, indexed by offset,
+					    size and type.  */
       unsigned int scnincr;	/* Number of sections allocate the last
 				   time.  */
       int ehdr_flags;		/* Flags (dirty) for ELF header.  */
@@ -330,6 +358,8 @@ struct Elf
 				   If NULL the data has not yet been
 				   read from the file.  */
       Elf_Data_Chunk *rawchunks; /* List of elf_getdata_rawchunk results.  */
+      Elf_Data_Chunk_Hash rawchunk_hash; /* The same, indexed by offset,
+					    size and type.  */
       unsigned int scnincr;	/* Number of sections allocate the last
 				   time.  */
       int ehdr_flags;		/* Flags (dirty) for ELF header.  */
@@ -355,6 +385,8 @@ struct Elf
 				   If NULL the data has not yet been
 				   read from the file.  */
       Elf_Data_Chunk *rawchunks; /* List of elf_getdata_rawchunk results.  */
+      Elf_Data_Chunk_Hash rawchunk_hash; /* The same, indexed by offset,
+					    size and type.  */
       unsigned int scnincr;	/* Number of sections allocate the last
 				   time.  */
       int ehdr_flags;		/* Flags (dirty) for ELF header.  */
@@ -374,6 +406,10 @@ struct Elf
       Elf *children;		/* List of all descriptors for this archive. */
       Elf_Arsym *ar_sym;	/* Symbol table returned by elf_getarsym.  */
       size_t ar_sym_num;	/* Number of entries in `ar_sym'.  */
+      size_t *ar_sym_hash;	/* Hash table for elf_findarsym.  */
+      size_t ar_sym_nbuckets;	/* Number of buckets in `ar_sym_hash'.  */
+      Elf_Armember *members;	/* Result of elf_getarmembers.  */
+      size_t nmembers;		/* Number of entries in `members'.  */
       char *long_names;		/* If no index is available but long names
 				   are used this elements points to the data.*/
       size_t long_names_len;	/* Length of the long name table.  */
@@ -455,21 +491,50 @@ extern Elf *__libelf_read_mmaped_file (int fildes, void *map_address,
 				       Elf_Cmd cmd, Elf *parent)
      internal_function;
 
+/* Create Elf descriptor from the contents of the stream READ with ARG
+   reads, or of FILDES if READ is NULL.  */
+extern Elf *__libelf_read_stream (int fildes, Elf_Stream_Read *read,
+				  void *arg, Elf_Cmd cmd) internal_function;
+
 /* Set error value.  */
 extern void __libelf_seterrno (int value) internal_function;
 
 /* Get the next archive header.  */
 extern int __libelf_next_arhdr_wrlock (Elf *elf) internal_function;
 
+/* Read the long name table of the archive ELF, the lock must be held.  */
+extern const char *__libelf_read_long_names (Elf *elf) internal_function;
+
 /* Read all of the file associated with the descriptor.  */
 extern char *__libelf_readall (Elf *elf) internal_function;
 
+/* Allocate a zeroed descriptor of SIZE bytes in the arena of the
+   calling thread.  */
+extern Elf *__libelf_allocate_elf (size_t size) internal_function;
+
+/* Release the memory of ELF.  */
+extern void __libelf_free_elf (Elf *elf) internal_function;
+
+/* Allocate SIZE bytes in ARENA, or with malloc if ARENA is NULL.  */
+extern void *__libelf_arena_malloc (Elf_Arena *arena, size_t size)
+     internal_function;
+
+/* Release PTR allocated with __libelf_arena_malloc.  */
+extern void __libelf_arena_free (Elf_Arena *arena, void *ptr)
+     internal_function;
+
+/* Apply the ELF_C_ADVISE_* command CMD to LEN bytes at OFFSET in the
+   file of ELF.  */
+extern int __libelf_advise (Elf *elf, Elf_Cmd cmd, size_t offset,
+			    size_t len) internal_function;
+
 /* Read the complete section table and convert the byte order if necessary.  */
 extern int __libelf_readsections (Elf *elf) internal_function;
 
 /* Store the information for the raw data in the `rawdata_list' element.  */
 extern int __libelf_set_rawdata (Elf_Scn *scn) internal_function;
 extern int __libelf_set_rawdata_wrlock (Elf_Scn *scn) internal_function;
+extern int __libelf_set_rawdata_rdlock (Elf_Scn *scn) internal_function;
 
 
 /* Helper functions for elf_update.  */
@@ -487,6 +552,13 @@ extern int __elf32_updatefile (Elf *elf, int change_bo, size_t shnum)
 extern int __elf64_updatefile (Elf *elf, int change_bo, size_t shnum)
      internal_function;
 
+/* Copy LEN bytes at SRCOFF in SRCFD to DSTOFF in DSTFD without passing
+   them through user space.  Returns the number of bytes copied, the
+   caller has to write the rest itself.  */
+extern size_t __libelf_copy_range (int srcfd, off_t srcoff, int dstfd,
+				   off_t dstoff, size_t len)
+     internal_function;
+
 
 /* Alias for exported functions to avoid PLT entries, and
    rdlock/wrlock variants of these functions.  */
@@ -550,6 +622,8 @@ extern Elf_Data *__elf64_xlatetof_internal (Elf_Data *__dest,
      attribute_hidden;
 extern unsigned int __elf_version_internal (unsigned int __version)
      attribute_hidden;
+extern Elf_Arsym *__elf_getarsym_internal (Elf *__elf, size_t *__narsyms)
+     attribute_hidden;
 extern unsigned long int __elf_hash_internal (const char *__string)
        __attribute__ ((__pure__, visibility ("hidden")));
 extern long int __elf32_checksum_internal (Elf *__elf) attribute_hidden;
@@ -570,6 +644,8 @@ extern GElf_Sym *__gelf_getsym_internal (Elf_Data *__data, int __ndx,
 extern uint32_t __libelf_crc32 (uint32_t crc, unsigned char *buf, size_t len)
      attribute_hidden;
 
+extern size_t __libelf_next_prime (size_t seed) attribute_hidden;
+
 
 /* We often have to update a flag iff a value changed.  Make this
    convenient.  */
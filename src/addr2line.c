@@ -31,6 +31,8 @@
 #include <libintl.h>
 #include <locale.h>
 #include <mcheck.h>
+#include <poll.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdio_ext.h>
@@ -51,6 +53,8 @@ ARGP_PROGRAM_BUG_ADDRESS_DEF = PACKAGE_BUGREPORT;
 
 /* Values for the parameters which have no short form.  */
 #define OPT_DEMANGLER 0x100
+#define OPT_BATCH 0x101
+#define OPT_THREADS 0x102
 
 /* Definitions of arguments for argp functions.  */
 static const struct argp_option options[] =
@@ -69,6 +73,13 @@ static const struct argp_option options[] =
     N_("Show all source locations that caused inline expansion of subroutines at the address."),
     0 },
 
+  { NULL, 0, NULL, 0, N_("Batch mode options:"), 3 },
+  { "batch", OPT_BATCH, "LINES", OPTION_ARG_OPTIONAL,
+    N_("Resolve addresses read from stdin in sorted chunks of up to LINES \
+addresses (default 65536), remembering the result for each address"), 0 },
+  { "threads", OPT_THREADS, "N", 0,
+    N_("Use up to N threads for large --batch chunks (default 1)"), 0 },
+
   { NULL, 0, NULL, 0, N_("Miscellaneous:"), 0 },
   /* Unsupported options.  */
   { "target", 'b', "ARG", OPTION_HIDDEN, NULL, 0 },
@@ -99,6 +110,9 @@ static const struct argp argp =
 /* Handle ADDR.  */
 static int handle_address (const char *addr, Dwfl *dwfl);
 
+/* Handle the addresses on stdin in --batch mode.  */
+static int handle_batch (Dwfl *dwfl, int argc, char *argv[]);
+
 
 /* True if only base names of files should be shown.  */
 static bool only_basenames;
@@ -124,6 +138,12 @@ static const char *just_section;
 /* True if all inlined subroutines of the current address should be shown.  */
 static bool show_inlines;
 
+/* Number of addresses read per chunk in --batch mode, zero if not used.  */
+static size_t batch_lines;
+
+/* Number of threads resolving a --batch chunk.  */
+static unsigned int batch_threads = 1;
+
 
 int
 main (int argc, char *argv[])
@@ -155,7 +175,9 @@ main (int argc, char *argv[])
 
   /* Now handle the addresses.  In case none are given on the command
      line, read from stdin.  */
-  if (remaining == argc)
+  if (remaining == argc && batch_lines != 0)
+    result = handle_batch (dwfl, argc, argv);
+  else if (remaining == argc)
     {
       /* We use no threads here which can interfere with handling a stream.  */
       (void) __fsetlocking (stdin, FSETLOCKING_BYCALLER);
@@ -251,6 +273,18 @@ parse_opt (int key, char *arg, struct argp_state *state)
       show_inlines = true;
       break;
 
+    case OPT_BATCH:
+      batch_lines = arg == NULL ? 65536 : strtoul (arg, NULL, 0);
+      if (batch_lines == 0)
+	argp_error (state, gettext ("--batch LINES should be positive"));
+      break;
+
+    case OPT_THREADS:
+      batch_threads = strtoul (arg, NULL, 0);
+      if (batch_threads == 0)
+	argp_error (state, gettext ("--threads N should be positive"));
+      break;
+
     default:
       return ARGP_ERR_UNKNOWN;
     }
@@ -259,7 +293,7 @@ parse_opt (int key, char *arg, struct argp_state *state)
 
 
 static bool
-print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr)
+print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr, FILE *out)
 {
   Dwarf_Addr bias = 0;
   Dwarf_Die *cudie = dwfl_module_addrdie (mod, addr, &bias);
@@ -277,7 +311,7 @@ print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr)
 	  const char *name = dwarf_diename (&scopes[i]);
 	  if (name == NULL)
 	    return false;
-	  puts (name);
+	  fprintf (out, "%s\n", name);
 	  return true;
 	}
 
@@ -286,7 +320,7 @@ print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr)
 	  const char *name = dwarf_diename (&scopes[i]);
 	  if (name == NULL)
 	    return false;
-	  printf ("%s inlined", name);
+	  fprintf (out, "%s inlined", name);
 
 	  Dwarf_Files *files;
 	  if (dwarf_getsrcfiles (cudie, &files, NULL) == 0)
@@ -329,17 +363,17 @@ print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr)
 		    }
 
 		  if (lineno == 0)
-		    printf (" from %s%s%s",
+		    fprintf (out, " from %s%s%s",
 			    comp_dir, comp_dir_sep, file);
 		  else if (colno == 0)
-		    printf (" at %s%s%s:%u",
+		    fprintf (out, " at %s%s%s:%u",
 			    comp_dir, comp_dir_sep, file, lineno);
 		  else
-		    printf (" at %s%s%s:%u:%u",
+		    fprintf (out, " at %s%s%s:%u:%u",
 			    comp_dir, comp_dir_sep, file, lineno, colno);
 		}
 	    }
-	  printf (" in ");
+	  fprintf (out, " in ");
 	  continue;
 	}
       }
@@ -348,7 +382,7 @@ print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr)
 }
 
 static void
-print_addrsym (Dwfl_Module *mod, GElf_Addr addr)
+print_addrsym (Dwfl_Module *mod, GElf_Addr addr, FILE *out)
 {
   GElf_Sym s;
   GElf_Off off;
@@ -361,16 +395,16 @@ print_addrsym (Dwfl_Module *mod, GElf_Addr addr)
       if (i >= 0)
 	name = dwfl_module_relocation_info (mod, i, NULL);
       if (name == NULL)
-	puts ("??");
+	fputs ("??\n", out);
       else
-	printf ("(%s)+%#" PRIx64 "\n", name, addr);
+	fprintf (out, "(%s)+%#" PRIx64 "\n", name, addr);
     }
   else
     {
       if (off == 0)
-	printf ("%s", name);
+	fprintf (out, "%s", name);
       else
-	printf ("%s+%#" PRIx64 "", name, off);
+	fprintf (out, "%s+%#" PRIx64 "", name, off);
 
       // Also show section name for address.
       if (show_symbol_sections)
@@ -386,17 +420,17 @@ print_addrsym (Dwfl_Module *mod, GElf_Addr addr)
 		  Elf *elf = dwfl_module_getelf (mod, &ebias);
 		  GElf_Ehdr ehdr;
 		  if (gelf_getehdr (elf, &ehdr) != NULL)
-		    printf (" (%s)", elf_strptr (elf, ehdr.e_shstrndx,
-						 shdr->sh_name));
+		    fprintf (out, " (%s)", elf_strptr (elf, ehdr.e_shstrndx,
+						       shdr->sh_name));
 		}
 	    }
 	}
-      puts ("");
+      putc ('\n', out);
     }
 }
 
 static void
-print_diesym (Dwarf_Die *die)
+print_diesym (Dwarf_Die *die, FILE *out)
 {
   Dwarf_Attribute attr;
   const char *name;
@@ -409,7 +443,7 @@ print_diesym (Dwarf_Die *die)
   if (name == NULL)
     name = dwarf_diename (die) ?: "??";
 
-  puts (name);
+  fprintf (out, "%s\n", name);
 }
 
 static int
@@ -507,7 +541,8 @@ adjust_to_section (const char *name, uintmax_t *addr, Dwfl *dwfl)
 }
 
 static void
-print_src (const char *src, int lineno, int linecol, Dwarf_Die *cu)
+print_src (const char *src, int lineno, int linecol, Dwarf_Die *cu,
+	   FILE *out)
 {
   const char *comp_dir = "";
   const char *comp_dir_sep = "";
@@ -523,15 +558,16 @@ print_src (const char *src, int lineno, int linecol, Dwarf_Die *cu)
     }
 
   if (linecol != 0)
-    printf ("%s%s%s:%d:%d",
+    fprintf (out, "%s%s%s:%d:%d",
 	    comp_dir, comp_dir_sep, src, lineno, linecol);
   else
-    printf ("%s%s%s:%d",
+    fprintf (out, "%s%s%s:%d",
 	    comp_dir, comp_dir_sep, src, lineno);
 }
 
-static int
-handle_address (const char *string, Dwfl *dwfl)
+/* Parse STRING into *ADDRP.  */
+static bool
+parse_address (const char *string, Dwfl *dwfl, uintmax_t *addrp)
 {
   char *endp;
   uintmax_t addr = strtoumax (string, &endp, 0);
@@ -576,24 +612,32 @@ handle_address (const char *string, Dwfl *dwfl)
 
       free (name);
       if (!parsed)
-	return 1;
+	return false;
     }
   else if (just_section != NULL
 	   && !adjust_to_section (just_section, &addr, dwfl))
-    return 1;
+    return false;
 
+  *addrp = addr;
+  return true;
+}
+
+/* Print the information for ADDR to OUT.  */
+static int
+print_address (Dwarf_Addr addr, Dwfl *dwfl, FILE *out)
+{
   Dwfl_Module *mod = dwfl_addrmodule (dwfl, addr);
 
   if (show_functions)
     {
       /* First determine the function name.  Use the DWARF information if
 	 possible.  */
-      if (! print_dwarf_function (mod, addr) && !show_symbols)
-	puts (dwfl_module_addrname (mod, addr) ?: "??");
+      if (! print_dwarf_function (mod, addr, out) && !show_symbols)
+	fprintf (out, "%s\n", dwfl_module_addrname (mod, addr) ?: "??");
     }
 
   if (show_symbols)
-    print_addrsym (mod, addr);
+    print_addrsym (mod, addr, out);
 
   Dwfl_Line *line = dwfl_module_getsrc (mod, addr);
 
@@ -603,7 +647,7 @@ handle_address (const char *string, Dwfl *dwfl)
   if (line != NULL && (src = dwfl_lineinfo (line, &addr, &lineno, &linecol,
 					    NULL, NULL)) != NULL)
     {
-      print_src (src, lineno, linecol, dwfl_linecu (line));
+      print_src (src, lineno, linecol, dwfl_linecu (line), out);
       if (show_flags)
 	{
 	  Dwarf_Addr bias;
@@ -615,14 +659,14 @@ handle_address (const char *string, Dwfl *dwfl)
 	  {
 	    bool flag;
 	    if ((*get) (info, &flag) == 0 && flag)
-	      fputs (note, stdout);
+	      fputs (note, out);
 	  }
 	  inline void show_int (int (*get) (Dwarf_Line *, unsigned int *),
 				const char *name)
 	  {
 	    unsigned int val;
 	    if ((*get) (info, &val) == 0 && val != 0)
-	      printf (" (%s %u)", name, val);
+	      fprintf (out, " (%s %u)", name, val);
 	  }
 
 	  show (&dwarf_linebeginstatement, " (is_stmt)");
@@ -632,10 +676,10 @@ handle_address (const char *string, Dwfl *dwfl)
 	  show_int (&dwarf_lineisa, "isa");
 	  show_int (&dwarf_linediscriminator, "discriminator");
 	}
-      putchar ('\n');
+      putc ('\n', out);
     }
   else
-    puts ("??:0");
+    fputs ("??:0\n", out);
 
   if (show_inlines)
     {
@@ -672,7 +716,7 @@ handle_address (const char *string, Dwfl *dwfl)
 			continue;
 
 		      if (show_functions)
-			print_diesym (&scopes[i + 1]);
+			print_diesym (&scopes[i + 1], out);
 
 		      src = NULL;
 		      lineno = 0;
@@ -691,11 +735,11 @@ handle_address (const char *string, Dwfl *dwfl)
 
 		      if (src != NULL)
 			{
-			  print_src (src, lineno, linecol, &cu);
-			  putchar ('\n');
+			  print_src (src, lineno, linecol, &cu, out);
+			  putc ('\n', out);
 			}
 		      else
-			puts ("??:0");
+			fputs ("??:0\n", out);
 		    }
 		}
 	    }
@@ -706,5 +750,311 @@ handle_address (const char *string, Dwfl *dwfl)
   return 0;
 }
 
+static int
+handle_address (const char *string, Dwfl *dwfl)
+{
+  uintmax_t addr;
+  if (! parse_address (string, dwfl, &addr))
+    return 1;
+  return print_address (addr, dwfl, stdout);
+}
+
+
+/* The result of a lookup in --batch mode.  */
+struct response
+{
+  uintmax_t addr;
+  int result;
+  /* Offset into the output buffer while resolving, then TEXT is set.  */
+  size_t off;
+  size_t len;
+  char *text;
+};
+
+#define NAME response_tab
+#define TYPE struct response *
+#define COMPARE(a, b) ((a)->addr != (b)->addr)
+#define NO_UNDEF
+#include <dynamicsizehash.h>
+#undef NO_UNDEF
+#include "../lib/dynamicsizehash.c"
+#undef NAME
+#undef TYPE
+#undef COMPARE
+
+/* All responses, kept for the whole run.  */
+static response_tab responses;
+
+/* The output buffers the response texts point into.  */
+static char **buffers;
+static size_t nbuffers;
+
+/* Don't bother starting threads for fewer new addresses per thread.  */
+#define BATCH_THREAD_MIN 1024
+
+/* One thread resolving a part of a chunk, with its own Dwfl since
+   libdwfl is not thread safe.  */
+struct batch_worker
+{
+  pthread_t thread;
+  Dwfl *dwfl;
+  struct response **todo;
+  size_t ntodo;
+  char *buf;
+};
+
+static unsigned long int
+hash_address (uintmax_t addr)
+{
+  unsigned long int hval = addr ^ (addr >> 31);
+  /* Zero marks an empty hash table entry.  */
+  return hval ?: 1;
+}
+
+static int
+compare_response_addr (const void *a, const void *b)
+{
+  const struct response *r1 = *(const struct response **) a;
+  const struct response *r2 = *(const struct response **) b;
+  return r1->addr < r2->addr ? -1 : r1->addr > r2->addr;
+}
+
+/* Print the TODO responses, sorted by address, into one new buffer.  */
+static char *
+resolve_responses (Dwfl *dwfl, struct response **todo, size_t ntodo)
+{
+  char *buf = NULL;
+  size_t size = 0;
+  FILE *out = open_memstream (&buf, &size);
+  if (out == NULL)
+    error (EXIT_FAILURE, errno, gettext ("cannot create output buffer"));
+  __fsetlocking (out, FSETLOCKING_BYCALLER);
+  for (size_t i = 0; i < ntodo; ++i)
+    {
+      todo[i]->off = ftell (out);
+      todo[i]->result = print_address (todo[i]->addr, dwfl, out);
+      todo[i]->len = ftell (out) - todo[i]->off;
+    }
+  fclose (out);
+  for (size_t i = 0; i < ntodo; ++i)
+    todo[i]->text = buf + todo[i]->off;
+  return buf;
+}
+
+static void *
+batch_worker_run (void *arg)
+{
+  struct batch_worker *worker = arg;
+  worker->buf = resolve_responses (worker->dwfl, worker->todo,
+				   worker->ntodo);
+  return NULL;
+}
+
+static void
+add_buffer (char *buf)
+{
+  buffers = realloc (buffers, (nbuffers + 1) * sizeof buffers[0]);
+  if (buffers == NULL)
+    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+  buffers[nbuffers++] = buf;
+}
+
+/* Resolve the TODO responses, using threads when there are enough.  */
+static void
+resolve_chunk (Dwfl *dwfl, struct response **todo, size_t ntodo,
+	       struct batch_worker *workers, int argc, char *argv[])
+{
+  /* Looking up the addresses in order makes consecutive lookups hit
+     the same module, CU and line table.  */
+  qsort (todo, ntodo, sizeof todo[0], compare_response_addr);
+
+  unsigned int nworkers = batch_threads;
+  if (nworkers > ntodo / BATCH_THREAD_MIN)
+    nworkers = ntodo / BATCH_THREAD_MIN;
+  if (nworkers <= 1)
+    {
+      add_buffer (resolve_responses (dwfl, todo, ntodo));
+      return;
+    }
+
+  /* Give each thread a consecutive range of addresses.  */
+  size_t per_worker = (ntodo + nworkers - 1) / nworkers;
+  unsigned int started = 0;
+  for (unsigned int i = 0; i < nworkers && i * per_worker < ntodo; ++i)
+    {
+      struct batch_worker *worker = &workers[i];
+      if (worker->dwfl == NULL)
+	{
+	  /* Report the same modules again for this thread.  */
+	  argp_parse (&argp, argc, argv, ARGP_SILENT, NULL, &worker->dwfl);
+	  if (worker->dwfl == NULL)
+	    error (EXIT_FAILURE, 0, gettext ("cannot set up thread: %s"),
+		   dwfl_errmsg (-1));
+	}
+      worker->todo = &todo[i * per_worker];
+      worker->ntodo = ntodo - i * per_worker;
+      if (worker->ntodo > per_worker)
+	worker->ntodo = per_worker;
+      worker->buf = NULL;
+      if (pthread_create (&worker->thread, NULL, batch_worker_run,
+			  worker) != 0)
+	break;
+      started++;
+    }
+
+  for (unsigned int i = 0; i < started; ++i)
+    {
+      pthread_join (workers[i].thread, NULL);
+      add_buffer (workers[i].buf);
+    }
+
+  /* Whatever could not be handed to a thread is done here.  */
+  size_t done = started * per_worker;
+  if (done < ntodo)
+    add_buffer (resolve_responses (dwfl, &todo[done], ntodo - done));
+}
+
+/* Reads lines from stdin, without blocking if asked to.  */
+struct line_reader
+{
+  char *buf;
+  size_t size;
+  size_t start;
+  size_t end;
+  bool eof;
+};
+
+/* Return the next line, or NULL at the end of the input.  If BLOCK is
+   false, also return NULL when no complete line is available yet.  */
+static char *
+next_line (struct line_reader *r, bool block)
+{
+  while (true)
+    {
+      char *nl = memchr (r->buf + r->start, '\n', r->end - r->start);
+      if (nl != NULL || (r->eof && r->start < r->end))
+	{
+	  char *line = r->buf + r->start;
+	  if (nl == NULL)
+	    {
+	      /* Last line without newline, there is always room for NUL.  */
+	      nl = r->buf + r->end;
+	      r->end++;
+	    }
+	  *nl = '\0';
+	  r->start = nl + 1 - r->buf;
+	  return line;
+	}
+      if (r->eof)
+	return NULL;
+
+      if (! block)
+	{
+	  struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+	  if (poll (&pfd, 1, 0) <= 0)
+	    return NULL;
+	}
+
+      if (r->start > 0)
+	{
+	  memmove (r->buf, r->buf + r->start, r->end - r->start);
+	  r->end -= r->start;
+	  r->start = 0;
+	}
+      if (r->end + 1 >= r->size)
+	{
+	  r->size = r->size == 0 ? 65536 : r->size * 2;
+	  r->buf = realloc (r->buf, r->size);
+	  if (r->buf == NULL)
+	    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+	}
+      ssize_t n = TEMP_FAILURE_RETRY (read (STDIN_FILENO, r->buf + r->end,
+					    r->size - r->end - 1));
+      if (n < 0)
+	error (EXIT_FAILURE, errno, gettext ("cannot read input"));
+      if (n == 0)
+	r->eof = true;
+      r->end += n;
+    }
+}
+
+static int
+handle_batch (Dwfl *dwfl, int argc, char *argv[])
+{
+  if (response_tab_init (&responses, 4093) != 0)
+    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+
+  struct response **chunk = malloc (batch_lines * sizeof chunk[0]);
+  struct response **todo = malloc (batch_lines * sizeof todo[0]);
+  struct batch_worker *workers = calloc (batch_threads, sizeof workers[0]);
+  if (chunk == NULL || todo == NULL || workers == NULL)
+    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+
+  struct line_reader reader = { .buf = NULL };
+  int result = 0;
+  char *line = next_line (&reader, true);
+  while (line != NULL)
+    {
+      /* Collect lines until the chunk is full or the input pauses, so
+	 that a client waiting for its answers gets them.  */
+      size_t nlines = 0;
+      size_t ntodo = 0;
+      do
+	{
+	  struct response *resp = NULL;
+	  uintmax_t addr;
+	  if (parse_address (line, dwfl, &addr))
+	    {
+	      struct response key = { .addr = addr };
+	      unsigned long int hval = hash_address (addr);
+	      resp = response_tab_find (&responses, hval, &key);
+	      if (resp == NULL)
+		{
+		  resp = calloc (1, sizeof *resp);
+		  if (resp == NULL
+		      || response_tab_insert (&responses, hval, resp) != 0)
+		    error (EXIT_FAILURE, errno,
+			   gettext ("memory exhausted"));
+		  resp->addr = addr;
+		  todo[ntodo++] = resp;
+		}
+	    }
+	  chunk[nlines++] = resp;
+	}
+      while (nlines < batch_lines
+	     && (line = next_line (&reader, false)) != NULL);
+
+      resolve_chunk (dwfl, todo, ntodo, workers, argc, argv);
+
+      for (size_t i = 0; i < nlines; ++i)
+	if (chunk[i] == NULL)
+	  result = 1;
+	else
+	  {
+	    fwrite_unlocked (chunk[i]->text, 1, chunk[i]->len, stdout);
+	    result = chunk[i]->result;
+	  }
+      fflush_unlocked (stdout);
+
+      line = next_line (&reader, true);
+    }
+
+  for (unsigned int i = 0; i < batch_threads; ++i)
+    if (workers[i].dwfl != NULL)
+      dwfl_end (workers[i].dwfl);
+  for (size_t i = 0; i < nbuffers; ++i)
+    free (buffers[i]);
+  free (buffers);
+  for (size_t i = 1; i <= responses.size; ++i)
+    if (responses.table[i].hashval != 0)
+      free (responses.table[i].data);
+  response_tab_free (&responses);
+  free (reader.buf);
+  free (workers);
+  free (todo);
+  free (chunk);
+  return result;
+}
+
 
 #include "debugpred.h"
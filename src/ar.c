@@ -440,13 +440,30 @@ not_found (int argc, char *argv[argc], bool found[argc])
 
 
 static int
-copy_content (Elf *elf, int newfd, off_t off, size_t n)
+copy_content (Elf *elf, int fd, int newfd, off_t off, size_t n)
 {
   size_t len;
   char *rawfile = elf_rawfile (elf, &len);
 
   assert (off + n <= len);
 
+#ifdef HAVE_COPY_FILE_RANGE
+  /* Let the kernel copy the data without reading it, this even shares
+     the blocks on some file systems.  */
+  while (n > 0)
+    {
+      ssize_t r = TEMP_FAILURE_RETRY (copy_file_range (fd, &off, newfd, NULL,
+						       n, 0));
+      if (r <= 0)
+	break;
+      n -= r;
+    }
+  if (n == 0)
+    return 0;
+#else
+  (void) fd;
+#endif
+
   /* Tell the kernel we will read all the pages sequentially.  */
   size_t ps = sysconf (_SC_PAGESIZE);
   if (n > 2 * ps)
@@ -810,8 +827,10 @@ cannot rename temporary file to %.*s"),
 		  /* Even if the original file had content before the
 		     symbol table, we write it in the correct order.  */
 		  || (index_off != SARMAG
-		      && copy_content (elf, newfd, SARMAG, index_off - SARMAG))
-		  || copy_content (elf, newfd, rest_off, st.st_size - rest_off)
+		      && copy_content (elf, fd, newfd, SARMAG,
+				       index_off - SARMAG))
+		  || copy_content (elf, fd, newfd, rest_off,
+				   st.st_size - rest_off)
 		  /* Set the mode of the new file to the same values the
 		     original file has.  */
 		  || fchmod (newfd, st.st_mode & ALLPERMS) != 0
@@ -854,7 +873,7 @@ struct armem
 
 static int
 write_member (struct armem *memb, off_t *startp, off_t *lenp, Elf *elf,
-	      off_t end_off, int newfd)
+	      int fd, off_t end_off, int newfd)
 {
   struct ar_hdr arhdr;
   char tmpbuf[sizeof (arhdr.ar_name) + 1];
@@ -882,7 +901,7 @@ write_member (struct armem *memb, off_t *startp, off_t *lenp, Elf *elf,
     }
 
   /* Write out the old range.  */
-  if (*startp != -1 && copy_content (elf, newfd, *startp, *lenp))
+  if (*startp != -1 && copy_content (elf, fd, newfd, *startp, *lenp))
     return -1;
 
   *startp = memb->old_off;
@@ -1052,12 +1071,13 @@ do_oper_delete (const char *arfname, char **argv, int argc,
       off_t len = -1;
 
       do
-	if (write_member (to_copy, &start, &len, elf, cur_off, newfd) != 0)
+	if (write_member (to_copy, &start, &len, elf, fd, cur_off,
+			  newfd) != 0)
 	  goto nonew_unlink;
       while ((to_copy = to_copy->next) != NULL);
 
       /* Write the last part.  */
-      if (copy_content (elf, newfd, start, len))
+      if (copy_content (elf, fd, newfd, start, len))
 	goto nonew_unlink;
     }
 
@@ -1451,7 +1471,7 @@ do_oper_insert (int oper, const char *arfname, char **argv, int argc,
 	    {
 	      /* This is a new file.  If there is anything from the
 		 archive left to be written do it now.  */
-	      if (start != -1  && copy_content (elf, newfd, start, len))
+	      if (start != -1  && copy_content (elf, fd, newfd, start, len))
 		goto nonew_unlink;
 
 	      start = -1;
@@ -1501,7 +1521,7 @@ do_oper_insert (int oper, const char *arfname, char **argv, int argc,
 	  else
 	    {
 	      /* This is a member from the archive.  */
-	      if (write_member (all, &start, &len, elf, cur_off, newfd)
+	      if (write_member (all, &start, &len, elf, fd, cur_off, newfd)
 		  != 0)
 		goto nonew_unlink;
 	    }
@@ -1510,7 +1530,7 @@ do_oper_insert (int oper, const char *arfname, char **argv, int argc,
 	}
 
       /* Write the last part.  */
-      if (start != -1 && copy_content (elf, newfd, start, len))
+      if (start != -1 && copy_content (elf, fd, newfd, start, len))
 	goto nonew_unlink;
     }
 
@@ -27,11 +27,14 @@
 #include <fcntl.h>
 #include <locale.h>
 #include <libintl.h>
+#include <pthread.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/param.h>
 
 #include <system.h>
 #include "../libelf/elf-knowledge.h"
@@ -68,6 +71,8 @@ static const struct argp_option options[] =
   { "ignore-build-id", OPT_IGNORE_BUILD_ID, NULL, 0,
     N_("Ignore differences in build ID"), 0 },
   { "quiet", 'q', NULL, 0, N_("Output nothing; yield exit status only"), 0 },
+  { "jobs", 'j', "JOBS", 0,
+    N_("Compare up to JOBS sections at once (default 1, use 0 for one per CPU)"), 0 },
 
   { NULL, 0, NULL, 0, N_("Miscellaneous:"), 0 },
   { NULL, 0, NULL, 0, NULL, 0 }
@@ -118,6 +123,51 @@ static bool hash_inexact;
 /* True iff build ID notes should be ignored.  */
 static bool ignore_build_id;
 
+/* Number of sections to compare at once.  */
+static int jobs = 1;
+
+/* A pair of sections to compare and the messages about them, which are
+   output in order of the sections when several are compared at
+   once.  */
+struct section_pair
+{
+  Elf_Scn *scn1;
+  Elf_Scn *scn2;
+  const char *sname1;
+  const char *sname2;
+  GElf_Shdr shdr1;
+  GElf_Shdr shdr2;
+  FILE *out;
+  char *buf;
+  size_t len;
+  bool differ;
+};
+
+struct section_compare
+{
+  const char *fname1;
+  const char *fname2;
+  Elf *elf1;
+  Elf *elf2;
+  Ebl *ebl1;
+  Ebl *ebl2;
+  GElf_Ehdr *ehdr1;
+
+  /* True iff the files have the same class and byte order, so the
+     bytes in them can be compared without converting them first.  */
+  bool raw;
+
+  size_t n;
+  struct section_pair *pairs;
+  int result;
+
+  /* Set once nothing more needs to be compared.  */
+  bool stop;
+};
+
+static void compare_section (size_t i, void *arg);
+static void output_section (size_t i, void *arg);
+
 static bool hash_content_equivalent (size_t entsize, Elf_Data *, Elf_Data *);
 
 
@@ -238,7 +288,21 @@ main (int argc, char *argv[])
     }
 
   /* Iterate over all sections.  We expect the sections in the two
-     files to match exactly.  */
+     files to match exactly.  The pairs are collected first and then
+     compared, possibly several at once.  */
+  struct section_compare cmp =
+    {
+      .fname1 = fname1,
+      .fname2 = fname2,
+      .elf1 = elf1,
+      .elf2 = elf2,
+      .ebl1 = ebl1,
+      .ebl2 = ebl2,
+      .ehdr1 = ehdr1,
+      .raw = (ehdr1->e_ident[EI_CLASS] == ehdr2->e_ident[EI_CLASS]
+	      && ehdr1->e_ident[EI_DATA] == ehdr2->e_ident[EI_DATA])
+    };
+  size_t maxpairs = 0;
   Elf_Scn *scn1 = NULL;
   Elf_Scn *scn2 = NULL;
   struct region *regions = NULL;
@@ -285,252 +349,27 @@ main (int argc, char *argv[])
 	  ++nregions;
 	}
 
-      /* Compare the headers.  We allow the name to be at a different
-	 location.  */
-      if (unlikely (strcmp (sname1, sname2) != 0))
+      if (cmp.n == maxpairs)
 	{
-	  error (0, 0, gettext ("%s %s differ: section [%zu], [%zu] name"),
-		 fname1, fname2, elf_ndxscn (scn1), elf_ndxscn (scn2));
-	  DIFFERENCE;
+	  maxpairs = 2 * maxpairs + 16;
+	  cmp.pairs = xrealloc (cmp.pairs, maxpairs * sizeof (cmp.pairs[0]));
 	}
-
-      /* We ignore certain sections.  */
-      if (strcmp (sname1, ".gnu_debuglink") == 0
-	  || strcmp (sname1, ".gnu.prelink_undo") == 0)
-	continue;
-
-      if (shdr1->sh_type != shdr2->sh_type
-	  // XXX Any flags which should be ignored?
-	  || shdr1->sh_flags != shdr2->sh_flags
-	  || shdr1->sh_addr != shdr2->sh_addr
-	  || (shdr1->sh_offset != shdr2->sh_offset
-	      && (shdr1->sh_flags & SHF_ALLOC)
-	      && ehdr1->e_type != ET_REL)
-	  || shdr1->sh_size != shdr2->sh_size
-	  || shdr1->sh_link != shdr2->sh_link
-	  || shdr1->sh_info != shdr2->sh_info
-	  || shdr1->sh_addralign != shdr2->sh_addralign
-	  || shdr1->sh_entsize != shdr2->sh_entsize)
-	{
-	  error (0, 0, gettext ("%s %s differ: section [%zu] '%s' header"),
-		 fname1, fname2, elf_ndxscn (scn1), sname1);
-	  DIFFERENCE;
-	}
-
-      Elf_Data *data1 = elf_getdata (scn1, NULL);
-      if (data1 == NULL)
-	error (2, 0,
-	       gettext ("cannot get content of section %zu in '%s': %s"),
-	       elf_ndxscn (scn1), fname1, elf_errmsg (-1));
-
-      Elf_Data *data2 = elf_getdata (scn2, NULL);
-      if (data2 == NULL)
-	error (2, 0,
-	       gettext ("cannot get content of section %zu in '%s': %s"),
-	       elf_ndxscn (scn2), fname2, elf_errmsg (-1));
-
-      switch (shdr1->sh_type)
+      cmp.pairs[cmp.n++] = (struct section_pair)
 	{
-	case SHT_DYNSYM:
-	case SHT_SYMTAB:
-	  /* Iterate over the symbol table.  We ignore the st_size
-	     value of undefined symbols.  */
-	  for (int ndx = 0; ndx < (int) (shdr1->sh_size / shdr1->sh_entsize);
-	       ++ndx)
-	    {
-	      GElf_Sym sym1_mem;
-	      GElf_Sym *sym1 = gelf_getsym (data1, ndx, &sym1_mem);
-	      if (sym1 == NULL)
-		error (2, 0,
-		       gettext ("cannot get symbol in '%s': %s"),
-		       fname1, elf_errmsg (-1));
-	      GElf_Sym sym2_mem;
-	      GElf_Sym *sym2 = gelf_getsym (data2, ndx, &sym2_mem);
-	      if (sym2 == NULL)
-		error (2, 0,
-		       gettext ("cannot get symbol in '%s': %s"),
-		       fname2, elf_errmsg (-1));
-
-	      const char *name1 = elf_strptr (elf1, shdr1->sh_link,
-					      sym1->st_name);
-	      const char *name2 = elf_strptr (elf2, shdr2->sh_link,
-					      sym2->st_name);
-	      if (unlikely (strcmp (name1, name2) != 0
-			    || sym1->st_value != sym2->st_value
-			    || (sym1->st_size != sym2->st_size
-				&& sym1->st_shndx != SHN_UNDEF)
-			    || sym1->st_info != sym2->st_info
-			    || sym1->st_other != sym2->st_other
-			    || sym1->st_shndx != sym1->st_shndx))
-		{
-		  // XXX Do we want to allow reordered symbol tables?
-		symtab_mismatch:
-		  if (! quiet)
-		    {
-		      if (elf_ndxscn (scn1) == elf_ndxscn (scn2))
-			error (0, 0,
-			       gettext ("%s %s differ: symbol table [%zu]"),
-			       fname1, fname2, elf_ndxscn (scn1));
-		      else
-			error (0, 0, gettext ("\
-%s %s differ: symbol table [%zu,%zu]"),
-			       fname1, fname2, elf_ndxscn (scn1),
-			       elf_ndxscn (scn2));
-		    }
-		  DIFFERENCE;
-		  break;
-		}
-
-	      if (sym1->st_shndx == SHN_UNDEF
-		  && sym1->st_size != sym2->st_size)
-		{
-		  /* The size of the symbol in the object defining it
-		     might have changed.  That is OK unless the symbol
-		     is used in a copy relocation.  Look over the
-		     sections in both files and determine which
-		     relocation section uses this symbol table
-		     section.  Then look through the relocations to
-		     see whether any copy relocation references this
-		     symbol.  */
-		  if (search_for_copy_reloc (ebl1, elf_ndxscn (scn1), ndx)
-		      || search_for_copy_reloc (ebl2, elf_ndxscn (scn2), ndx))
-		    goto symtab_mismatch;
-		}
-	    }
-	  break;
-
-	case SHT_NOTE:
-	  /* Parse the note format and compare the notes themselves.  */
-	  {
-	    GElf_Nhdr note1;
-	    GElf_Nhdr note2;
-
-	    size_t off1 = 0;
-	    size_t off2 = 0;
-	    size_t name_offset;
-	    size_t desc_offset;
-	    while (off1 < data1->d_size
-		   && (off1 = gelf_getnote (data1, off1, &note1,
-					    &name_offset, &desc_offset)) > 0)
-	      {
-		const char *name1 = data1->d_buf + name_offset;
-		const void *desc1 = data1->d_buf + desc_offset;
-		if (off2 >= data2->d_size)
-		  {
-		    if (! quiet)
-		      error (0, 0, gettext ("\
-%s %s differ: section [%zu] '%s' number of notes"),
-			     fname1, fname2, elf_ndxscn (scn1), sname1);
-		    DIFFERENCE;
-		  }
-		off2 = gelf_getnote (data2, off2, &note2,
-				     &name_offset, &desc_offset);
-		if (off2 == 0)
-		  error (2, 0, gettext ("\
-cannot read note section [%zu] '%s' in '%s': %s"),
-			 elf_ndxscn (scn2), sname2, fname2, elf_errmsg (-1));
-		const char *name2 = data2->d_buf + name_offset;
-		const void *desc2 = data2->d_buf + desc_offset;
-
-		if (note1.n_namesz != note2.n_namesz
-		    || memcmp (name1, name2, note1.n_namesz))
-		  {
-		    if (! quiet)
-		      error (0, 0, gettext ("\
-%s %s differ: section [%zu] '%s' note name"),
-			     fname1, fname2, elf_ndxscn (scn1), sname1);
-		    DIFFERENCE;
-		  }
-		if (note1.n_type != note2.n_type)
-		  {
-		    if (! quiet)
-		      error (0, 0, gettext ("\
-%s %s differ: section [%zu] '%s' note '%s' type"),
-			     fname1, fname2, elf_ndxscn (scn1), sname1, name1);
-		    DIFFERENCE;
-		  }
-		if (note1.n_descsz != note2.n_descsz
-		    || memcmp (desc1, desc2, note1.n_descsz))
-		  {
-		    if (note1.n_type == NT_GNU_BUILD_ID
-			&& note1.n_namesz == sizeof "GNU"
-			&& !memcmp (name1, "GNU", sizeof "GNU"))
-		      {
-			if (note1.n_descsz != note2.n_descsz)
-			  {
-			    if (! quiet)
-			      error (0, 0, gettext ("\
-%s %s differ: build ID length"),
-				     fname1, fname2);
-			    DIFFERENCE;
-			  }
-			else if (! ignore_build_id)
-			  {
-			    if (! quiet)
-			      error (0, 0, gettext ("\
-%s %s differ: build ID content"),
-				     fname1, fname2);
-			    DIFFERENCE;
-			  }
-		      }
-		    else
-		      {
-			if (! quiet)
-			  error (0, 0, gettext ("\
-%s %s differ: section [%zu] '%s' note '%s' content"),
-				 fname1, fname2, elf_ndxscn (scn1), sname1,
-				 name1);
-			DIFFERENCE;
-		      }
-		  }
-	      }
-	    if (off2 < data2->d_size)
-	      {
-		if (! quiet)
-		  error (0, 0, gettext ("\
-%s %s differ: section [%zu] '%s' number of notes"),
-			 fname1, fname2, elf_ndxscn (scn1), sname1);
-		DIFFERENCE;
-	      }
-	  }
-	  break;
-
-	default:
-	  /* Compare the section content byte for byte.  */
-	  assert (shdr1->sh_type == SHT_NOBITS
-		  || (data1->d_buf != NULL || data1->d_size == 0));
-	  assert (shdr2->sh_type == SHT_NOBITS
-		  || (data2->d_buf != NULL || data1->d_size == 0));
-
-	  if (unlikely (data1->d_size != data2->d_size
-			|| (shdr1->sh_type != SHT_NOBITS
-			    && memcmp (data1->d_buf, data2->d_buf,
-				       data1->d_size) != 0)))
-	    {
-	      if (hash_inexact
-		  && shdr1->sh_type == SHT_HASH
-		  && data1->d_size == data2->d_size
-		  && hash_content_equivalent (shdr1->sh_entsize, data1, data2))
-		break;
-
-	      if (! quiet)
-		{
-		  if (elf_ndxscn (scn1) == elf_ndxscn (scn2))
-		    error (0, 0, gettext ("\
-%s %s differ: section [%zu] '%s' content"),
-			   fname1, fname2, elf_ndxscn (scn1), sname1);
-		  else
-		    error (0, 0, gettext ("\
-%s %s differ: section [%zu,%zu] '%s' content"),
-			   fname1, fname2, elf_ndxscn (scn1),
-			   elf_ndxscn (scn2), sname1);
-		}
-	      DIFFERENCE;
-	    }
-	  break;
-	}
+	  .scn1 = scn1,
+	  .scn2 = scn2,
+	  .sname1 = sname1,
+	  .sname2 = sname2,
+	  .shdr1 = *shdr1,
+	  .shdr2 = *shdr2
+	};
     }
 
+  parallel_ordered (cmp.n, jobs, compare_section, output_section, &cmp);
+  free (cmp.pairs);
+  if (cmp.result != 0)
+    DIFFERENCE;
+
   if (unlikely (scn1 != scn2))
     {
       if (! quiet)
@@ -654,6 +493,426 @@ cannot read note section [%zu] '%s' in '%s': %s"),
 }
 
 
+/* Sections may be loaded by the threads comparing them, which libelf
+   is not prepared for.  */
+static pthread_mutex_t load_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* Return the content of section SCN of FNAME, as it is in the file if
+   RAW and converted otherwise.  */
+static Elf_Data *
+section_data (const char *fname, Elf_Scn *scn, bool raw)
+{
+  pthread_mutex_lock (&load_lock);
+  Elf_Data *data = raw ? elf_rawdata (scn, NULL) : elf_getdata (scn, NULL);
+  pthread_mutex_unlock (&load_lock);
+  if (data == NULL)
+    error (2, 0,
+	   gettext ("cannot get content of section %zu in '%s': %s"),
+	   elf_ndxscn (scn), fname, elf_errmsg (-1));
+  return data;
+}
+
+
+/* Return the offset of the first byte in which the N bytes at P1 and
+   P2 differ, or N if they do not.  memcmp goes over a block at a time
+   and only the block which differs is looked at byte by byte.  */
+static size_t
+first_difference (const unsigned char *p1, const unsigned char *p2, size_t n)
+{
+#define CMP_BLOCK	4096
+  size_t off = 0;
+  while (off < n)
+    {
+      size_t len = MIN (n - off, CMP_BLOCK);
+      if (memcmp (p1 + off, p2 + off, len) != 0)
+	{
+	  while (p1[off] == p2[off])
+	    ++off;
+	  break;
+	}
+      off += len;
+    }
+  return off;
+}
+
+
+/* Return true if SCN1 and SCN2 have the same bytes in the files.  */
+static bool
+same_raw_data (struct section_compare *cmp, Elf_Scn *scn1, Elf_Scn *scn2)
+{
+  if (scn1 == NULL || scn2 == NULL)
+    return false;
+
+  Elf_Data *data1 = section_data (cmp->fname1, scn1, true);
+  Elf_Data *data2 = section_data (cmp->fname2, scn2, true);
+  if (data1->d_size != data2->d_size)
+    return false;
+  if (data1->d_size == 0)
+    return true;
+  return (data1->d_buf != NULL && data2->d_buf != NULL
+	  && first_difference (data1->d_buf, data2->d_buf,
+			       data1->d_size) == data1->d_size);
+}
+
+
+/* Add a message like error (0, 0, ...) would print to the ones about
+   the pair of sections P.  */
+static void
+__attribute__ ((format (printf, 2, 3)))
+report (struct section_pair *p, const char *format, ...)
+{
+  if (p->out == NULL)
+    {
+      p->out = open_memstream (&p->buf, &p->len);
+      if (p->out == NULL)
+	error (2, errno, gettext ("memory exhausted"));
+    }
+
+  fprintf (p->out, "%s: ", program_invocation_name);
+  va_list ap;
+  va_start (ap, format);
+  vfprintf (p->out, format, ap);
+  va_end (ap);
+  putc ('\n', p->out);
+}
+
+
+/* Compare the pair of sections I.  */
+static void
+compare_section (size_t i, void *arg)
+{
+  struct section_compare *cmp = arg;
+  struct section_pair *p = &cmp->pairs[i];
+
+  if (__atomic_load_n (&cmp->stop, __ATOMIC_RELAXED))
+    return;
+
+  const char *const fname1 = cmp->fname1;
+  const char *const fname2 = cmp->fname2;
+  Elf_Scn *const scn1 = p->scn1;
+  Elf_Scn *const scn2 = p->scn2;
+  const char *const sname1 = p->sname1;
+  const char *const sname2 = p->sname2;
+  const GElf_Shdr *const shdr1 = &p->shdr1;
+  const GElf_Shdr *const shdr2 = &p->shdr2;
+
+#define SECTION_DIFFERENCE						      \
+  do									      \
+    {									      \
+      p->differ = true;							      \
+      if (! verbose)							      \
+	return;								      \
+    }									      \
+  while (0)
+
+  /* Compare the headers.  We allow the name to be at a different
+     location.  */
+  if (unlikely (strcmp (sname1, sname2) != 0))
+    {
+      report (p, gettext ("%s %s differ: section [%zu], [%zu] name"),
+	      fname1, fname2, elf_ndxscn (scn1), elf_ndxscn (scn2));
+      SECTION_DIFFERENCE;
+    }
+
+  /* We ignore certain sections.  */
+  if (strcmp (sname1, ".gnu_debuglink") == 0
+      || strcmp (sname1, ".gnu.prelink_undo") == 0)
+    return;
+
+  if (shdr1->sh_type != shdr2->sh_type
+      // XXX Any flags which should be ignored?
+      || shdr1->sh_flags != shdr2->sh_flags
+      || shdr1->sh_addr != shdr2->sh_addr
+      || (shdr1->sh_offset != shdr2->sh_offset
+	  && (shdr1->sh_flags & SHF_ALLOC)
+	  && cmp->ehdr1->e_type != ET_REL)
+      || shdr1->sh_size != shdr2->sh_size
+      || shdr1->sh_link != shdr2->sh_link
+      || shdr1->sh_info != shdr2->sh_info
+      || shdr1->sh_addralign != shdr2->sh_addralign
+      || shdr1->sh_entsize != shdr2->sh_entsize)
+    {
+      report (p, gettext ("%s %s differ: section [%zu] '%s' header"),
+	      fname1, fname2, elf_ndxscn (scn1), sname1);
+      SECTION_DIFFERENCE;
+    }
+
+  switch (shdr1->sh_type)
+    {
+    case SHT_DYNSYM:
+    case SHT_SYMTAB:
+      {
+	/* The same symbols with the same string tables need no closer
+	   look.  */
+	if (cmp->raw
+	    && same_raw_data (cmp, scn1, scn2)
+	    && same_raw_data (cmp, elf_getscn (cmp->elf1, shdr1->sh_link),
+			      elf_getscn (cmp->elf2, shdr2->sh_link)))
+	  break;
+
+	Elf_Data *data1 = section_data (fname1, scn1, false);
+	Elf_Data *data2 = section_data (fname2, scn2, false);
+
+	/* elf_strptr only reads the string tables once they are
+	   loaded.  */
+	pthread_mutex_lock (&load_lock);
+	(void) elf_strptr (cmp->elf1, shdr1->sh_link, 0);
+	(void) elf_strptr (cmp->elf2, shdr2->sh_link, 0);
+	pthread_mutex_unlock (&load_lock);
+
+	/* Iterate over the symbol table.  We ignore the st_size
+	   value of undefined symbols.  */
+	for (int ndx = 0; ndx < (int) (shdr1->sh_size / shdr1->sh_entsize);
+	     ++ndx)
+	  {
+	    GElf_Sym sym1_mem;
+	    GElf_Sym *sym1 = gelf_getsym (data1, ndx, &sym1_mem);
+	    if (sym1 == NULL)
+	      error (2, 0,
+		     gettext ("cannot get symbol in '%s': %s"),
+		     fname1, elf_errmsg (-1));
+	    GElf_Sym sym2_mem;
+	    GElf_Sym *sym2 = gelf_getsym (data2, ndx, &sym2_mem);
+	    if (sym2 == NULL)
+	      error (2, 0,
+		     gettext ("cannot get symbol in '%s': %s"),
+		     fname2, elf_errmsg (-1));
+
+	    const char *name1 = elf_strptr (cmp->elf1, shdr1->sh_link,
+					    sym1->st_name);
+	    const char *name2 = elf_strptr (cmp->elf2, shdr2->sh_link,
+					    sym2->st_name);
+	    if (unlikely (strcmp (name1, name2) != 0
+			  || sym1->st_value != sym2->st_value
+			  || (sym1->st_size != sym2->st_size
+			      && sym1->st_shndx != SHN_UNDEF)
+			  || sym1->st_info != sym2->st_info
+			  || sym1->st_other != sym2->st_other
+			  || sym1->st_shndx != sym1->st_shndx))
+	      {
+		// XXX Do we want to allow reordered symbol tables?
+	    symtab_mismatch:
+		if (! quiet)
+		  {
+		    if (elf_ndxscn (scn1) == elf_ndxscn (scn2))
+		      report (p, gettext ("%s %s differ: symbol table [%zu]"),
+			      fname1, fname2, elf_ndxscn (scn1));
+		    else
+		      report (p, gettext ("\
+%s %s differ: symbol table [%zu,%zu]"),
+			      fname1, fname2, elf_ndxscn (scn1),
+			      elf_ndxscn (scn2));
+		  }
+		SECTION_DIFFERENCE;
+		break;
+	      }
+
+	    if (sym1->st_shndx == SHN_UNDEF
+		&& sym1->st_size != sym2->st_size)
+	      {
+		/* The size of the symbol in the object defining it
+		   might have changed.  That is OK unless the symbol
+		   is used in a copy relocation.  Look over the
+		   sections in both files and determine which
+		   relocation section uses this symbol table
+		   section.  Then look through the relocations to
+		   see whether any copy relocation references this
+		   symbol.  */
+		if (search_for_copy_reloc (cmp->ebl1, elf_ndxscn (scn1), ndx)
+		    || search_for_copy_reloc (cmp->ebl2, elf_ndxscn (scn2),
+					      ndx))
+		  goto symtab_mismatch;
+	      }
+	  }
+      }
+      break;
+
+    case SHT_NOTE:
+      /* Parse the note format and compare the notes themselves.  */
+      {
+	Elf_Data *data1 = section_data (fname1, scn1, false);
+	Elf_Data *data2 = section_data (fname2, scn2, false);
+
+	GElf_Nhdr note1;
+	GElf_Nhdr note2;
+
+	size_t off1 = 0;
+	size_t off2 = 0;
+	size_t name_offset;
+	size_t desc_offset;
+	while (off1 < data1->d_size
+	       && (off1 = gelf_getnote (data1, off1, &note1,
+					&name_offset, &desc_offset)) > 0)
+	  {
+	    const char *name1 = data1->d_buf + name_offset;
+	    const void *desc1 = data1->d_buf + desc_offset;
+	    if (off2 >= data2->d_size)
+	      {
+		if (! quiet)
+		  report (p, gettext ("\
+%s %s differ: section [%zu] '%s' number of notes"),
+			  fname1, fname2, elf_ndxscn (scn1), sname1);
+		SECTION_DIFFERENCE;
+	      }
+	    off2 = gelf_getnote (data2, off2, &note2,
+				 &name_offset, &desc_offset);
+	    if (off2 == 0)
+	      error (2, 0, gettext ("\
+cannot read note section [%zu] '%s' in '%s': %s"),
+		     elf_ndxscn (scn2), sname2, fname2, elf_errmsg (-1));
+	    const char *name2 = data2->d_buf + name_offset;
+	    const void *desc2 = data2->d_buf + desc_offset;
+
+	    if (note1.n_namesz != note2.n_namesz
+		|| memcmp (name1, name2, note1.n_namesz))
+	      {
+		if (! quiet)
+		  report (p, gettext ("\
+%s %s differ: section [%zu] '%s' note name"),
+			  fname1, fname2, elf_ndxscn (scn1), sname1);
+		SECTION_DIFFERENCE;
+	      }
+	    if (note1.n_type != note2.n_type)
+	      {
+		if (! quiet)
+		  report (p, gettext ("\
+%s %s differ: section [%zu] '%s' note '%s' type"),
+			  fname1, fname2, elf_ndxscn (scn1), sname1, name1);
+		SECTION_DIFFERENCE;
+	      }
+	    if (note1.n_descsz != note2.n_descsz
+		|| memcmp (desc1, desc2, note1.n_descsz))
+	      {
+		if (note1.n_type == NT_GNU_BUILD_ID
+		    && note1.n_namesz == sizeof "GNU"
+		    && !memcmp (name1, "GNU", sizeof "GNU"))
+		  {
+		    if (note1.n_descsz != note2.n_descsz)
+		      {
+			if (! quiet)
+			  report (p, gettext ("\
+%s %s differ: build ID length"),
+				  fname1, fname2);
+			SECTION_DIFFERENCE;
+		      }
+		    else if (! ignore_build_id)
+		      {
+			if (! quiet)
+			  report (p, gettext ("\
+%s %s differ: build ID content"),
+				  fname1, fname2);
+			SECTION_DIFFERENCE;
+		      }
+		  }
+		else
+		  {
+		    if (! quiet)
+		      report (p, gettext ("\
+%s %s differ: section [%zu] '%s' note '%s' content"),
+			      fname1, fname2, elf_ndxscn (scn1), sname1,
+			      name1);
+		    SECTION_DIFFERENCE;
+		  }
+	      }
+	  }
+	if (off2 < data2->d_size)
+	  {
+	    if (! quiet)
+	      report (p, gettext ("\
+%s %s differ: section [%zu] '%s' number of notes"),
+		      fname1, fname2, elf_ndxscn (scn1), sname1);
+	    SECTION_DIFFERENCE;
+	  }
+      }
+      break;
+
+    default:
+      /* Compare the section content byte for byte.  If the files are
+	 of the same kind these are the bytes in the files, which need
+	 not be converted.  */
+      {
+	Elf_Data *data1 = section_data (fname1, scn1, cmp->raw);
+	Elf_Data *data2 = section_data (fname2, scn2, cmp->raw);
+	assert (shdr1->sh_type == SHT_NOBITS
+		|| (data1->d_buf != NULL || data1->d_size == 0));
+	assert (shdr2->sh_type == SHT_NOBITS
+		|| (data2->d_buf != NULL || data1->d_size == 0));
+
+	size_t off = data1->d_size;
+	if (data1->d_size == data2->d_size && shdr1->sh_type != SHT_NOBITS)
+	  off = first_difference (data1->d_buf, data2->d_buf, data1->d_size);
+
+	if (unlikely (data1->d_size != data2->d_size
+		      || off < data1->d_size))
+	  {
+	    if (hash_inexact
+		&& shdr1->sh_type == SHT_HASH
+		&& data1->d_size == data2->d_size
+		&& hash_content_equivalent (shdr1->sh_entsize,
+					    section_data (fname1, scn1,
+							  false),
+					    section_data (fname2, scn2,
+							  false)))
+	      break;
+
+	    if (! quiet)
+	      {
+		if (off < data1->d_size)
+		  {
+		    if (elf_ndxscn (scn1) == elf_ndxscn (scn2))
+		      report (p, gettext ("\
+%s %s differ: section [%zu] '%s' content at offset %#zx"),
+			      fname1, fname2, elf_ndxscn (scn1), sname1, off);
+		    else
+		      report (p, gettext ("\
+%s %s differ: section [%zu,%zu] '%s' content at offset %#zx"),
+			      fname1, fname2, elf_ndxscn (scn1),
+			      elf_ndxscn (scn2), sname1, off);
+		  }
+		else if (elf_ndxscn (scn1) == elf_ndxscn (scn2))
+		  report (p, gettext ("\
+%s %s differ: section [%zu] '%s' content"),
+			  fname1, fname2, elf_ndxscn (scn1), sname1);
+		else
+		  report (p, gettext ("\
+%s %s differ: section [%zu,%zu] '%s' content"),
+			  fname1, fname2, elf_ndxscn (scn1),
+			  elf_ndxscn (scn2), sname1);
+	      }
+	    SECTION_DIFFERENCE;
+	  }
+      }
+      break;
+    }
+}
+
+
+/* Output the messages about the pair of sections I, unless an earlier
+   difference already ended the comparison.  */
+static void
+output_section (size_t i, void *arg)
+{
+  struct section_compare *cmp = arg;
+  struct section_pair *p = &cmp->pairs[i];
+
+  if (p->out != NULL)
+    {
+      fclose (p->out);
+      if (! cmp->stop)
+	fwrite (p->buf, 1, p->len, stderr);
+      free (p->buf);
+    }
+
+  if (p->differ && ! cmp->stop)
+    {
+      cmp->result = 1;
+      if (! verbose)
+	__atomic_store_n (&cmp->stop, true, __ATOMIC_RELAXED);
+    }
+}
+
+
 /* Print the version information.  */
 static void
 print_version (FILE *stream, struct argp_state *state __attribute__ ((unused)))
@@ -670,8 +929,7 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\
 
 /* Handle program arguments.  */
 static error_t
-parse_opt (int key, char *arg,
-	   struct argp_state *state __attribute__ ((unused)))
+parse_opt (int key, char *arg, struct argp_state *state)
 {
   switch (key)
     {
@@ -707,6 +965,15 @@ parse_opt (int key, char *arg,
       ignore_build_id = true;
       break;
 
+    case 'j':
+      jobs = atoi (arg);
+      if (jobs < 0)
+	{
+	  argp_error (state, gettext ("-j JOBS should be 0 or higher."));
+	  return EINVAL;
+	}
+      break;
+
     default:
       return ARGP_ERR_UNKNOWN;
     }
@@ -725,6 +992,8 @@ open_file (const char *fname, int *fdp, Ebl **eblp)
     error (2, 0,
 	   gettext ("cannot create ELF descriptor for '%s': %s"),
 	   fname, elf_errmsg (-1));
+  /* The sections are compared in order.  */
+  (void) elf_cntl (elf, ELF_C_ADVISE_SEQUENTIAL);
   Ebl *ebl = ebl_openbackend (elf);
   if (ebl == NULL)
     error (2, 0,
@@ -753,7 +1022,9 @@ search_for_copy_reloc (Ebl *ebl, size_t scnndx, int symndx)
 	  || shdr->sh_link != scnndx)
 	continue;
 
+      pthread_mutex_lock (&load_lock);
       Elf_Data *data = elf_getdata (scn, NULL);
+      pthread_mutex_unlock (&load_lock);
       if (data == NULL)
 	error (2, 0,
 	       gettext ("cannot get content of section %zu: %s"),
@@ -805,23 +1076,11 @@ regioncompare (const void *p1, const void *p2)
 }
 
 
-static int
-compare_Elf32_Word (const void *p1, const void *p2)
-{
-  const Elf32_Word *w1 = p1;
-  const Elf32_Word *w2 = p2;
-  assert (sizeof (int) >= sizeof (*w1));
-  return (int) *w1 - (int) *w2;
-}
-
-static int
-compare_Elf64_Xword (const void *p1, const void *p2)
-{
-  const Elf64_Xword *w1 = p1;
-  const Elf64_Xword *w2 = p2;
-  return *w1 < *w2 ? -1 : *w1 > *w2 ? 1 : 0;
-}
-
+/* The SHT_HASH sections are equivalent if every symbol is chained to
+   the same bucket in both, and the chain entries of the symbols which
+   are in no chain are the same.  Which bucket a symbol is in, counting
+   from one, is recorded in arrays indexed by the symbol, on the heap
+   since there can be any number of symbols.  */
 static bool
 hash_content_equivalent (size_t entsize, Elf_Data *data1, Elf_Data *data2)
 {
@@ -840,47 +1099,34 @@ hash_content_equivalent (size_t entsize, Elf_Data *data1, Elf_Data *data2)
     const Hash_Word *const bucket2 = &hash2[2];				      \
     const Hash_Word *const chain2 = &bucket2[nbucket];			      \
 									      \
-    bool chain_ok[nchain];						      \
-    Hash_Word temp1[nchain - 1];					      \
-    Hash_Word temp2[nchain - 1];					      \
-    memset (chain_ok, 0, sizeof chain_ok);				      \
-    for (size_t i = 0; i < nbucket; ++i)				      \
+    size_t *const in1 = xcalloc (2 * nchain + 1, sizeof (size_t));	      \
+    size_t *const in2 = &in1[nchain];					      \
+    bool ok = true;							      \
+    for (size_t i = 0; ok && i < nbucket; ++i)				      \
       {									      \
-	if (bucket1[i] >= nchain || bucket2[i] >= nchain)		      \
-	  return false;							      \
-									      \
-	size_t b1 = 0;							      \
-	for (size_t p = bucket1[i]; p != STN_UNDEF; p = chain1[p])	      \
-	  if (p >= nchain || b1 >= nchain - 1)				      \
-	    return false;						      \
-	  else								      \
-	    temp1[b1++] = p;						      \
-									      \
-	size_t b2 = 0;							      \
-	for (size_t p = bucket2[i]; p != STN_UNDEF; p = chain2[p])	      \
-	  if (p >= nchain || b2 >= nchain - 1)				      \
-	    return false;						      \
-	  else								      \
-	    temp2[b2++] = p;						      \
-									      \
-	if (b1 != b2)							      \
-	  return false;							      \
-									      \
-	qsort (temp1, b1, sizeof temp1[0], compare_##Hash_Word);	      \
-	qsort (temp2, b2, sizeof temp2[0], compare_##Hash_Word);	      \
+	/* A chain running into a symbol seen before is broken.  */	      \
+	size_t p = bucket1[i];						      \
+	while (p != STN_UNDEF && p < nchain && in1[p] == 0)		      \
+	  {								      \
+	    in1[p] = i + 1;						      \
+	    p = chain1[p];						      \
+	  }								      \
+	ok = p == STN_UNDEF;						      \
 									      \
-	for (b1 = 0; b1 < b2; ++b1)					      \
-	  if (temp1[b1] != temp2[b1])					      \
-	    return false;						      \
-	  else								      \
-	    chain_ok[temp1[b1]] = true;					      \
+	p = bucket2[i];							      \
+	while (p != STN_UNDEF && p < nchain && in2[p] == 0)		      \
+	  {								      \
+	    in2[p] = i + 1;						      \
+	    p = chain2[p];						      \
+	  }								      \
+	ok = ok && p == STN_UNDEF;					      \
       }									      \
 									      \
-    for (size_t i = 0; i < nchain; ++i)					      \
-      if (!chain_ok[i] && chain1[i] != chain2[i])			      \
-	return false;							      \
+    for (size_t i = 0; ok && i < nchain; ++i)				      \
+      ok = in1[i] == in2[i] && (in1[i] != 0 || chain1[i] == chain2[i]);	      \
 									      \
-    return true;							      \
+    free (in1);								      \
+    return ok;								      \
   }
 
   switch (entsize)
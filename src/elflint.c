@@ -24,12 +24,14 @@
 #include <assert.h>
 #include <byteswap.h>
 #include <endian.h>
+#include <errno.h>
 #include <error.h>
 #include <fcntl.h>
 #include <gelf.h>
 #include <inttypes.h>
 #include <libintl.h>
 #include <locale.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -67,6 +69,8 @@ static const struct argp_option options[] =
   { "gnu-ld", ARGP_gnuld, NULL, 0,
     N_("Binary has been created with GNU ld and is therefore known to be \
 broken in certain ways"), 0 },
+  { "jobs", 'j', "JOBS", 0,
+    N_("Check up to JOBS archive members or sections at once (default 1, use 0 for one per CPU)"), 0 },
   { NULL, 0, NULL, 0, NULL, 0 }
 };
 
@@ -100,10 +104,17 @@ static void check_note_section (Ebl *ebl, GElf_Ehdr *ehdr,
 /* Report an error.  */
 #define ERROR(str, args...) \
   do {									      \
-    printf (str, ##args);						      \
+    fprintf (out, str, ##args);						      \
     ++error_count;							      \
   } while (0)
-static unsigned int error_count;
+static __thread unsigned int error_count;
+
+/* Where the messages go.  Each thread checking archive members writes
+   into its own buffer.  */
+static __thread FILE *out;
+
+/* Number of archive members to check at once.  */
+static int jobs = 1;
 
 /* True if we should perform very strict testing.  */
 static bool be_strict;
@@ -118,14 +129,14 @@ static bool is_debuginfo;
 static bool gnuld;
 
 /* Index of section header string table.  */
-static uint32_t shstrndx;
+static __thread uint32_t shstrndx;
 
 /* Array to count references in section groups.  */
-static int *scnref;
+static __thread int *scnref;
 
 /* Numbers of sections and program headers.  */
-static unsigned int shnum;
-static unsigned int phnum;
+static __thread unsigned int shnum;
+static __thread unsigned int phnum;
 
 
 int
@@ -141,6 +152,8 @@ main (int argc, char *argv[])
   int remaining;
   argp_parse (&argp, argc, argv, 0, &remaining, NULL);
 
+  out = stdout;
+
   /* Before we start tell the ELF library which version we are using.  */
   elf_version (EV_CURRENT);
 
@@ -195,8 +208,7 @@ main (int argc, char *argv[])
 
 /* Handle program arguments.  */
 static error_t
-parse_opt (int key, char *arg __attribute__ ((unused)),
-	   struct argp_state *state __attribute__ ((unused)))
+parse_opt (int key, char *arg, struct argp_state *state)
 {
   switch (key)
     {
@@ -215,6 +227,15 @@ parse_opt (int key, char *arg __attribute__ ((unused)),
       gnuld = true;
       break;
 
+    case 'j':
+      jobs = atoi (arg);
+      if (jobs < 0)
+	{
+	  argp_error (state, gettext ("-j JOBS should be 0 or higher."));
+	  return EINVAL;
+	}
+      break;
+
     case ARGP_KEY_NO_ARGS:
       fputs (gettext ("Missing file name.\n"), stderr);
       argp_help (&argp, stderr, ARGP_HELP_SEE, program_invocation_short_name);
@@ -241,6 +262,113 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\
 }
 
 
+struct member_state
+{
+  int fd;
+  Elf *elf;
+  Elf_Armember *members;
+  const char *prefix;
+  const char *suffix;
+  struct member_output
+  {
+    char *buf;
+    size_t len;
+    unsigned int error_count;
+  } *output;
+};
+
+/* Serializes creating and freeing descriptors for the members.  */
+static pthread_mutex_t member_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static void
+check_member (size_t i, void *arg)
+{
+  struct member_state *state = arg;
+  struct member_output *output = &state->output[i];
+
+  /* This might be the thread handling the archive.  */
+  FILE *saved_out = out;
+  unsigned int saved_error_count = error_count;
+
+  out = open_memstream (&output->buf, &output->len);
+  if (out == NULL)
+    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+  error_count = 0;
+
+  pthread_mutex_lock (&member_lock);
+  Elf *subelf = elf_begin_armember (state->elf, state->members[i].am_off,
+				    ELF_C_READ_MMAP);
+  pthread_mutex_unlock (&member_lock);
+
+  if (subelf == NULL)
+    ERROR (gettext ("cannot generate Elf descriptor: %s\n"),
+	   elf_errmsg (-1));
+  else
+    {
+      Elf_Kind kind = elf_kind (subelf);
+      if (kind == ELF_K_ELF || kind == ELF_K_AR)
+	process_file (state->fd, subelf, state->prefix, state->suffix,
+		      state->members[i].am_name, state->members[i].am_size,
+		      false);
+
+      pthread_mutex_lock (&member_lock);
+      if (elf_end (subelf) != 0)
+	ERROR (gettext (" error while freeing sub-ELF descriptor: %s\n"),
+	       elf_errmsg (-1));
+      pthread_mutex_unlock (&member_lock);
+    }
+
+  fclose (out);
+  output->error_count = error_count;
+
+  out = saved_out;
+  error_count = saved_error_count;
+}
+
+
+static void
+output_member (size_t i, void *arg)
+{
+  struct member_state *state = arg;
+  struct member_output *output = &state->output[i];
+
+  fwrite (output->buf, 1, output->len, stdout);
+  free (output->buf);
+  error_count += output->error_count;
+}
+
+
+/* Check the members of the archive ELF from JOBS threads, with the
+   messages in the same order as for a sequential run.  */
+static void
+process_ar_parallel (int fd, Elf *elf, const char *prefix,
+		     const char *suffix)
+{
+  size_t nmembers;
+  Elf_Armember *members = elf_getarmembers (elf, &nmembers);
+  if (members == NULL)
+    {
+      ERROR (gettext ("cannot get archive members: %s\n"), elf_errmsg (-1));
+      return;
+    }
+
+  struct member_state state =
+    {
+      .fd = fd,
+      .elf = elf,
+      .members = members,
+      .prefix = prefix,
+      .suffix = suffix,
+      .output = xcalloc (nmembers, sizeof (struct member_output))
+    };
+
+  parallel_ordered (nmembers, jobs, check_member, output_member, &state);
+
+  free (state.output);
+}
+
+
 /* Process one file.  */
 static void
 process_file (int fd, Elf *elf, const char *prefix, const char *suffix,
@@ -277,6 +405,14 @@ process_file (int fd, Elf *elf, const char *prefix, const char *suffix,
 	  new_suffix[0] = '\0';
 	memcpy (cp, fname, fname_len);
 
+	/* The members of the top-level archive can be checked in
+	   parallel.  */
+	if (jobs != 1 && prefix == NULL)
+	  {
+	    process_ar_parallel (fd, elf, new_prefix, new_suffix);
+	    break;
+	  }
+
 	/* It's an archive.  We process each file in it.  */
 	while ((subelf = elf_begin (fd, cmd, elf)) != NULL)
 	  {
@@ -1193,10 +1329,10 @@ struct loaded_segment
 
 
 /* Check whether binary has text relocation flag set.  */
-static bool textrel;
+static __thread bool textrel;
 
 /* Keep track of whether text relocation flag is needed.  */
-static bool needed_textrel;
+static __thread bool needed_textrel;
 
 
 static bool
@@ -1545,7 +1681,7 @@ section [%2d] '%s': cannot get relocation %zu: %s\n"),
 
 
 /* Number of dynamic sections.  */
-static int ndynamic;
+static __thread int ndynamic;
 
 
 static void
@@ -2683,7 +2819,7 @@ in_nobits_scn (Ebl *ebl, unsigned int shndx)
 }
 
 
-static struct version_namelist
+static __thread struct version_namelist
 {
   const char *objname;
   const char *name;
@@ -2874,7 +3010,7 @@ unknown_dependency_p (Elf *elf, const char *fname)
 }
 
 
-static unsigned int nverneed;
+static __thread unsigned int nverneed;
 
 static void
 check_verneed (Ebl *ebl, GElf_Shdr *shdr, int idx)
@@ -3003,7 +3139,7 @@ section [%2d] '%s': entry %d has invalid offset to next entry\n"),
 }
 
 
-static unsigned int nverdef;
+static __thread unsigned int nverdef;
 
 static void
 check_verdef (Ebl *ebl, GElf_Shdr *shdr, int idx)
@@ -3373,8 +3509,8 @@ section [%2d] '%s': offset %zu: extra bytes after last attribute section\n"),
 	   idx, section_name (ebl, idx), pos (p));
 }
 
-static bool has_loadable_segment;
-static bool has_interp_segment;
+static __thread bool has_loadable_segment;
+static __thread bool has_interp_segment;
 
 static const struct
 {
@@ -3436,13 +3572,192 @@ static const struct
 
 
 /* Indeces of some sections we need later.  */
-static size_t eh_frame_hdr_scnndx;
-static size_t eh_frame_scnndx;
-static size_t gcc_except_table_scnndx;
+static __thread size_t eh_frame_hdr_scnndx;
+static __thread size_t eh_frame_scnndx;
+static __thread size_t gcc_except_table_scnndx;
+
+
+/* The checks of the sections which can be big, symbol tables,
+   relocations and hash tables, run after all section headers have
+   been looked at when there are several jobs.  Each gets its messages
+   and the ones of the other checks up to the next of them in buffers
+   of its own, so they can be printed in the order of a sequential
+   run.  */
+struct section_check
+{
+  int idx;
+  char *buf;
+  size_t len;
+  char *tail;
+  size_t taillen;
+  unsigned int error_count;
+  bool textrel;
+  bool needed_textrel;
+};
+
+struct section_checks
+{
+  Ebl *ebl;
+  GElf_Ehdr *ehdr;
+  FILE *out;
+  size_t n;
+  struct section_check *check;
+
+  /* The state of the file the checks need in other threads.  */
+  unsigned int shnum;
+  unsigned int phnum;
+  uint32_t shstrndx;
+};
 
 
+/* Run the check for the contents of section IDX.  */
 static void
-check_sections (Ebl *ebl, GElf_Ehdr *ehdr)
+check_section_data (Ebl *ebl, GElf_Ehdr *ehdr, GElf_Shdr *shdr, int idx)
+{
+  switch (shdr->sh_type)
+    {
+    case SHT_DYNSYM:
+    case SHT_SYMTAB:
+      check_symtab (ebl, ehdr, shdr, idx);
+      break;
+
+    case SHT_RELA:
+      check_rela (ebl, ehdr, shdr, idx);
+      break;
+
+    case SHT_REL:
+      check_rel (ebl, ehdr, shdr, idx);
+      break;
+
+    case SHT_SYMTAB_SHNDX:
+      check_symtab_shndx (ebl, ehdr, shdr, idx);
+      break;
+
+    case SHT_HASH:
+    case SHT_GNU_HASH:
+      check_hash (shdr->sh_type, ebl, ehdr, shdr, idx);
+      break;
+
+    default:
+      abort ();
+    }
+}
+
+
+/* Remember to check section IDX later.  */
+static void
+defer_section_check (struct section_checks *checks, int idx)
+{
+  if (checks->n == 0)
+    {
+      checks->out = out;
+      checks->check = xcalloc (shnum, sizeof (checks->check[0]));
+      checks->shnum = shnum;
+      checks->phnum = phnum;
+      checks->shstrndx = shstrndx;
+    }
+  else
+    fclose (out);
+
+  struct section_check *check = &checks->check[checks->n++];
+  check->idx = idx;
+
+  out = open_memstream (&check->tail, &check->taillen);
+  if (out == NULL)
+    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+}
+
+
+static void
+run_section_check (size_t i, void *arg)
+{
+  struct section_checks *checks = arg;
+  struct section_check *check = &checks->check[i];
+
+  /* This might be the thread the other checks run in.  */
+  FILE *saved_out = out;
+  unsigned int saved_error_count = error_count;
+  bool saved_textrel = textrel;
+  bool saved_needed_textrel = needed_textrel;
+
+  shnum = checks->shnum;
+  phnum = checks->phnum;
+  shstrndx = checks->shstrndx;
+
+  out = open_memstream (&check->buf, &check->len);
+  if (out == NULL)
+    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+  error_count = 0;
+  textrel = false;
+  needed_textrel = false;
+  (void) elf_errno ();
+
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = gelf_getshdr (elf_getscn (checks->ebl->elf, check->idx),
+				  &shdr_mem);
+  check_section_data (checks->ebl, checks->ehdr, shdr, check->idx);
+
+  fclose (out);
+  check->error_count = error_count;
+  check->textrel = textrel;
+  check->needed_textrel = needed_textrel;
+
+  (void) elf_errno ();
+  out = saved_out;
+  error_count = saved_error_count;
+  textrel = saved_textrel;
+  needed_textrel = saved_needed_textrel;
+}
+
+
+static void
+output_section_check (size_t i, void *arg)
+{
+  struct section_checks *checks = arg;
+  struct section_check *check = &checks->check[i];
+
+  fwrite (check->buf, 1, check->len, out);
+  fwrite (check->tail, 1, check->taillen, out);
+  free (check->buf);
+  free (check->tail);
+
+  error_count += check->error_count;
+  textrel |= check->textrel;
+  needed_textrel |= check->needed_textrel;
+}
+
+
+/* Run the deferred checks in CHECKS from JOBS threads.  */
+static void
+run_section_checks (struct section_checks *checks)
+{
+  if (checks->n == 0)
+    return;
+
+  fclose (out);
+  out = checks->out;
+
+  /* libelf does not lock anything.  Read all sections now, so that
+     the threads only look at data which is already there.  */
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (checks->ebl->elf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      (void) elf_getdata (scn, NULL);
+      if (shdr != NULL && shdr->sh_type == SHT_STRTAB)
+	(void) elf_strptr (checks->ebl->elf, elf_ndxscn (scn), 0);
+    }
+
+  parallel_ordered (checks->n, jobs, run_section_check, output_section_check,
+		    checks);
+
+  free (checks->check);
+}
+
+
+static void
+check_sections (Ebl *ebl, GElf_Ehdr *ehdr, bool parallel)
 {
   if (ehdr->e_shoff == 0)
     /* No section header.  */
@@ -3496,6 +3811,7 @@ zeroth section has nonzero link value while ELF header does not signal overflow
   size_t gnu_hash_idx = 0;
 
   size_t versym_scnndx = 0;
+  struct section_checks checks = { .ebl = ebl, .ehdr = ehdr };
   for (size_t cnt = 1; cnt < shnum; ++cnt)
     {
       shdr = gelf_getshdr (elf_getscn (ebl->elf, cnt), &shdr_mem);
@@ -3842,33 +4158,30 @@ section [%2zu] '%s': relocatable files cannot have dynamic symbol tables\n"),
 		   cnt, section_name (ebl, cnt));
 	  /* FALLTHROUGH */
 	case SHT_SYMTAB:
-	  check_symtab (ebl, ehdr, shdr, cnt);
-	  break;
-
 	case SHT_RELA:
-	  check_rela (ebl, ehdr, shdr, cnt);
-	  break;
-
 	case SHT_REL:
-	  check_rel (ebl, ehdr, shdr, cnt);
-	  break;
-
-	case SHT_DYNAMIC:
-	  check_dynamic (ebl, ehdr, shdr, cnt);
-	  break;
-
 	case SHT_SYMTAB_SHNDX:
-	  check_symtab_shndx (ebl, ehdr, shdr, cnt);
-	  break;
-
 	case SHT_HASH:
-	  check_hash (shdr->sh_type, ebl, ehdr, shdr, cnt);
-	  hash_idx = cnt;
+	case SHT_GNU_HASH:
+	  if (shdr->sh_type == SHT_HASH)
+	    hash_idx = cnt;
+	  else if (shdr->sh_type == SHT_GNU_HASH)
+	    gnu_hash_idx = cnt;
+
+	  /* Whether the check runs now or in another thread, its
+	     libelf errors must not show up in the messages of others.  */
+	  (void) elf_errno ();
+	  if (parallel)
+	    defer_section_check (&checks, cnt);
+	  else
+	    {
+	      check_section_data (ebl, ehdr, shdr, cnt);
+	      (void) elf_errno ();
+	    }
 	  break;
 
-	case SHT_GNU_HASH:
-	  check_hash (shdr->sh_type, ebl, ehdr, shdr, cnt);
-	  gnu_hash_idx = cnt;
+	case SHT_DYNAMIC:
+	  check_dynamic (ebl, ehdr, shdr, cnt);
 	  break;
 
 	case SHT_NULL:
@@ -3910,6 +4223,8 @@ section [%2zu] '%s': relocatable files cannot have dynamic symbol tables\n"),
 	}
     }
 
+  run_section_checks (&checks);
+
   if (has_interp_segment && !dot_interp_section)
     ERROR (gettext ("INTERP program header entry but no .interp section\n"));
 
@@ -4123,7 +4438,7 @@ section [%2d] '%s': no note entries defined for the type of file\n"),
 
 
 /* Index of the PT_GNU_EH_FRAME program eader entry.  */
-static int pt_gnu_eh_frame_pndx;
+static __thread int pt_gnu_eh_frame_pndx;
 
 
 static void
@@ -4390,6 +4705,10 @@ process_elf_file (Elf *elf, const char *prefix, const char *suffix,
   needed_textrel = false;
   has_loadable_segment = false;
   has_interp_segment = false;
+  pt_gnu_eh_frame_pndx = 0;
+  eh_frame_hdr_scnndx = 0;
+  eh_frame_scnndx = 0;
+  gcc_except_table_scnndx = 0;
 
   GElf_Ehdr ehdr_mem;
   GElf_Ehdr *ehdr = gelf_getehdr (elf, &ehdr_mem);
@@ -4399,9 +4718,9 @@ process_elf_file (Elf *elf, const char *prefix, const char *suffix,
   if (!only_one)
     {
       if (prefix != NULL)
-	printf ("\n%s(%s)%s:\n", prefix, fname, suffix);
+	fprintf (out, "\n%s(%s)%s:\n", prefix, fname, suffix);
       else
-	printf ("\n%s:\n", fname);
+	fprintf (out, "\n%s:\n", fname);
     }
 
   if (ehdr == NULL)
@@ -4422,8 +4741,9 @@ process_elf_file (Elf *elf, const char *prefix, const char *suffix,
   check_program_header (ebl, ehdr);
 
   /* Next the section headers.  It is OK if there are no section
-     headers at all.  */
-  check_sections (ebl, ehdr);
+     headers at all.  The members of archives are already checked in
+     parallel, the sections of other files can be.  */
+  check_sections (ebl, ehdr, jobs != 1 && prefix == NULL);
 
   /* Check the exception handling data, if it exists.  */
   if (pt_gnu_eh_frame_pndx != 0 || eh_frame_hdr_scnndx != 0
@@ -29,7 +29,6 @@
 #include <libdw.h>
 #include <libintl.h>
 #include <locale.h>
-#include <search.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -46,6 +45,53 @@ struct segments
 };
 
 
+/* The set of source files and functions already reported, compared
+   by pointer.  */
+#define NAME known_tab
+#define TYPE const char *
+#define COMPARE(a, b) ((a) != (b))
+#define NO_UNDEF
+#include <dynamicsizehash.h>
+#undef NO_UNDEF
+#include "../lib/dynamicsizehash.c"
+#undef NAME
+#undef TYPE
+#undef COMPARE
+
+
+/* A symbol in the table of symbols sorted by address.  */
+struct sym_addr
+{
+  GElf_Addr addr;
+  GElf_Xword size;
+  GElf_Word name;
+  size_t idx;
+};
+
+
+/* What is looked up for the relocations of one file, kept from one
+   relocation to the next.  */
+struct lookup
+{
+  /* The source files and functions already reported.  */
+  known_tab known;
+
+  /* The symbols with nonzero addresses sorted by address, only the
+     first one in the symbol table for each address.  Read when first
+     needed.  */
+  struct sym_addr *syms;
+  size_t nsyms;
+  size_t strndx;
+  bool syms_read;
+
+  /* The CU DIE for the address range CU_START to CU_END.  */
+  Dwarf_Die cudie;
+  Dwarf_Addr cu_start;
+  Dwarf_Addr cu_end;
+  bool have_cu;
+};
+
+
 /* Name and version of program.  */
 static void print_version (FILE *stream, struct argp_state *state);
 ARGP_PROGRAM_VERSION_HOOK_DEF = print_version;
@@ -93,7 +139,7 @@ static int process_file (const char *fname, bool more_than_one);
 static void check_rel (size_t nsegments, struct segments segments[nsegments],
 		       GElf_Addr addr, Elf *elf, Elf_Scn *symscn, Dwarf *dw,
 		       const char *fname, bool more_than_one,
-		       void **knownsrcs);
+		       struct lookup *lookup);
 
 
 
@@ -190,17 +236,14 @@ parse_opt (int key, char *arg,
 }
 
 
-static void
-noop (void *arg __attribute__ ((unused)))
-{
-}
-
-
 static int
 process_file (const char *fname, bool more_than_one)
 {
   int result = 0;
-  void *knownsrcs = NULL;
+  struct lookup lookup = { .syms = NULL, .syms_read = false,
+			   .have_cu = false };
+  if (known_tab_init (&lookup.known, 127) != 0)
+    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
 
   size_t fname_len = strlen (fname);
   size_t rootdir_len = strlen (rootdir);
@@ -219,6 +262,7 @@ process_file (const char *fname, bool more_than_one)
   if (fd == -1)
     {
       error (0, errno, gettext ("cannot open '%s'"), fname);
+      known_tab_free (&lookup.known);
       return 1;
     }
 
@@ -241,6 +285,7 @@ process_file (const char *fname, bool more_than_one)
       elf_end (elf);
     err_close:
       close (fd);
+      known_tab_free (&lookup.known);
       return 1;
     }
 
@@ -440,7 +485,7 @@ cannot get relocation at index %d in section %zu in '%s': %s"),
 		    }
 
 		  check_rel (nsegments, segments, rel->r_offset, elf,
-			     symscn, dw, fname, more_than_one, &knownsrcs);
+			     symscn, dw, fname, more_than_one, &lookup);
 		}
 	    }
 	  else if (shdr->sh_type == SHT_RELA)
@@ -463,7 +508,7 @@ cannot get relocation at index %d in section %zu in '%s': %s"),
 		    }
 
 		  check_rel (nsegments, segments, rela->r_offset, elf,
-			     symscn, dw, fname, more_than_one, &knownsrcs);
+			     symscn, dw, fname, more_than_one, &lookup);
 		}
 	    }
 	}
@@ -478,32 +523,122 @@ cannot get relocation at index %d in section %zu in '%s': %s"),
   if (fd2 != -1)
     close (fd2);
 
-  tdestroy (knownsrcs, noop);
+  known_tab_free (&lookup.known);
+  free (lookup.syms);
 
   return result;
 }
 
 
+/* Return true if SRC has not been reported before, and remember that
+   it is now.  */
+static bool
+report_once (struct lookup *lookup, const char *src)
+{
+  if (known_tab_find (&lookup->known, (uintptr_t) src, src) != NULL)
+    return false;
+
+  if (known_tab_insert (&lookup->known, (uintptr_t) src, src) != 0)
+    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+  return true;
+}
+
+
+/* Find the CU DIE for ADDR.  */
+static Dwarf_Die *
+find_cudie (Dwarf *dw, GElf_Addr addr, struct lookup *lookup)
+{
+  /* The relocations mostly come sorted by address, so many in a row
+     fall into the same CU.  */
+  if (lookup->have_cu && addr >= lookup->cu_start && addr < lookup->cu_end)
+    return &lookup->cudie;
+
+  Dwarf_Aranges *aranges;
+  size_t naranges;
+  Dwarf_Addr start;
+  Dwarf_Word length;
+  Dwarf_Off off;
+  lookup->have_cu = (dwarf_getaranges (dw, &aranges, &naranges) == 0
+		     && dwarf_getarangeinfo (dwarf_getarange_addr (aranges,
+								   addr),
+					     &start, &length, &off) == 0
+		     && dwarf_offdie (dw, off, &lookup->cudie) != NULL);
+  if (! lookup->have_cu)
+    return NULL;
+
+  lookup->cu_start = start;
+  lookup->cu_end = start + length;
+  return &lookup->cudie;
+}
+
+
 static int
-ptrcompare (const void *p1, const void *p2)
+compare_sym_addr (const void *p1, const void *p2)
 {
-  if ((uintptr_t) p1 < (uintptr_t) p2)
-    return -1;
-  if ((uintptr_t) p1 > (uintptr_t) p2)
-    return 1;
+  const struct sym_addr *s1 = (const struct sym_addr *) p1;
+  const struct sym_addr *s2 = (const struct sym_addr *) p2;
+
+  if (s1->addr != s2->addr)
+    return s1->addr < s2->addr ? -1 : 1;
+  if (s1->idx != s2->idx)
+    return s1->idx < s2->idx ? -1 : 1;
   return 0;
 }
 
 
+/* Read the symbols of SYMSCN sorted by address.  Return false if the
+   symbol table cannot be used.  */
+static bool
+read_syms (Elf_Scn *symscn, struct lookup *lookup)
+{
+  if (lookup->syms_read)
+    return lookup->syms != NULL;
+  lookup->syms_read = true;
+
+  Elf_Data *symdata = elf_getdata (symscn, NULL);
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = gelf_getshdr (symscn, &shdr_mem);
+  if (shdr == NULL)
+    return false;
+
+  size_t nsyms = shdr->sh_size / shdr->sh_entsize;
+  struct sym_addr *syms = xmalloc ((nsyms + 1) * sizeof (syms[0]));
+  size_t n = 0;
+  for (size_t i = 0; i < nsyms; ++i)
+    {
+      GElf_Sym sym_mem;
+      GElf_Sym *sym = gelf_getsym (symdata, i, &sym_mem);
+
+      /* A symbol at address zero can never be the closest one.  */
+      if (sym != NULL && sym->st_value != 0)
+	syms[n++] = (struct sym_addr) { .addr = sym->st_value,
+					.size = sym->st_size,
+					.name = sym->st_name, .idx = i };
+    }
+
+  qsort (syms, n, sizeof (syms[0]), compare_sym_addr);
+
+  /* Of the symbols at the same address the first one is used.  */
+  size_t last = 0;
+  for (size_t i = 1; i < n; ++i)
+    if (syms[i].addr != syms[last].addr)
+      syms[++last] = syms[i];
+
+  lookup->syms = syms;
+  lookup->nsyms = n == 0 ? 0 : last + 1;
+  lookup->strndx = shdr->sh_link;
+  return true;
+}
+
+
 static void
 check_rel (size_t nsegments, struct segments segments[nsegments],
 	   GElf_Addr addr, Elf *elf, Elf_Scn *symscn, Dwarf *dw,
-	   const char *fname, bool more_than_one, void **knownsrcs)
+	   const char *fname, bool more_than_one, struct lookup *lookup)
 {
   for (size_t cnt = 0; cnt < nsegments; ++cnt)
     if (segments[cnt].from <= addr && segments[cnt].to > addr)
       {
-	Dwarf_Die die_mem;
 	Dwarf_Die *die;
 	Dwarf_Line *line;
 	const char *src;
@@ -511,100 +646,71 @@ check_rel (size_t nsegments, struct segments segments[nsegments],
 	if (more_than_one)
 	  printf ("%s: ", fname);
 
-	if ((die = dwarf_addrdie (dw, addr, &die_mem)) != NULL
+	if ((die = find_cudie (dw, addr, lookup)) != NULL
 	    && (line = dwarf_getsrc_die (die, addr)) != NULL
 	    && (src = dwarf_linesrc (line, NULL, NULL)) != NULL)
 	  {
 	    /* There can be more than one relocation against one file.
 	       Try to avoid multiple messages.  And yes, the code uses
 	       pointer comparison.  */
-	    if (tfind (src, knownsrcs, ptrcompare) == NULL)
-	      {
-		printf (gettext ("%s not compiled with -fpic/-fPIC\n"), src);
-		tsearch (src, knownsrcs, ptrcompare);
-	      }
+	    if (report_once (lookup, src))
+	      printf (gettext ("%s not compiled with -fpic/-fPIC\n"), src);
 	    return;
 	  }
-	else
+	else if (read_syms (symscn, lookup))
 	  {
 	    /* At least look at the symbol table to see which function
-	       the modified address is in.  */
-	    Elf_Data *symdata = elf_getdata (symscn, NULL);
-	    GElf_Shdr shdr_mem;
-	    GElf_Shdr *shdr = gelf_getshdr (symscn, &shdr_mem);
-	    if (shdr != NULL)
+	       the modified address is in.  Find the first symbol at
+	       ADDR or above, the closest one below comes before it.  */
+	    struct sym_addr *syms = lookup->syms;
+	    size_t l = 0;
+	    size_t u = lookup->nsyms;
+	    while (l < u)
 	      {
-		GElf_Addr lowaddr = 0;
-		int lowidx = -1;
-		GElf_Addr highaddr = ~0ul;
-		int highidx = -1;
-		GElf_Sym sym_mem;
-		GElf_Sym *sym;
-
-		for (int i = 0; (size_t) i < shdr->sh_size / shdr->sh_entsize;
-		     ++i)
-		  {
-		    sym = gelf_getsym (symdata, i, &sym_mem);
-		    if (sym == NULL)
-		      continue;
-
-		    if (sym->st_value < addr && sym->st_value > lowaddr)
-		      {
-			lowaddr = sym->st_value;
-			lowidx = i;
-		      }
-		    if (sym->st_value > addr && sym->st_value < highaddr)
-		      {
-			highaddr = sym->st_value;
-			highidx = i;
-		      }
-		  }
+		size_t idx = (l + u) / 2;
+		if (syms[idx].addr < addr)
+		  l = idx + 1;
+		else
+		  u = idx;
+	      }
+
+	    struct sym_addr *low = l > 0 ? &syms[l - 1] : NULL;
+	    if (l < lookup->nsyms && syms[l].addr == addr)
+	      ++l;
+	    struct sym_addr *high = (l < lookup->nsyms
+				     && syms[l].addr < (GElf_Addr) ~0ul
+				     ? &syms[l] : NULL);
 
-		if (lowidx != -1)
+	    if (low != NULL)
+	      {
+		const char *lowstr = elf_strptr (elf, lookup->strndx,
+						 low->name);
+
+		if (low->addr + low->size > addr)
 		  {
-		    sym = gelf_getsym (symdata, lowidx, &sym_mem);
-		    assert (sym != NULL);
-
-		    const char *lowstr = elf_strptr (elf, shdr->sh_link,
-						     sym->st_name);
-
-		    if (sym->st_value + sym->st_size > addr)
-		      {
-			/* It is this function.  */
-			if (tfind (lowstr, knownsrcs, ptrcompare) == NULL)
-			  {
-			    printf (gettext ("\
-the file containing the function '%s' is not compiled with -fpic/-fPIC\n"),
-				    lowstr);
-			    tsearch (lowstr, knownsrcs, ptrcompare);
-			  }
-		      }
-		    else if (highidx == -1)
+		    /* It is this function.  */
+		    if (report_once (lookup, lowstr))
 		      printf (gettext ("\
-the file containing the function '%s' might not be compiled with -fpic/-fPIC\n"),
+the file containing the function '%s' is not compiled with -fpic/-fPIC\n"),
 			      lowstr);
-		    else
-		      {
-			sym = gelf_getsym (symdata, highidx, &sym_mem);
-			assert (sym != NULL);
-
-			printf (gettext ("\
-either the file containing the function '%s' or the file containing the function '%s' is not compiled with -fpic/-fPIC\n"),
-				lowstr, elf_strptr (elf, shdr->sh_link,
-						    sym->st_name));
-		      }
-		    return;
 		  }
-		else if (highidx != -1)
-		  {
-		    sym = gelf_getsym (symdata, highidx, &sym_mem);
-		    assert (sym != NULL);
-
-		    printf (gettext ("\
+		else if (high == NULL)
+		  printf (gettext ("\
 the file containing the function '%s' might not be compiled with -fpic/-fPIC\n"),
-			    elf_strptr (elf, shdr->sh_link, sym->st_name));
-		    return;
-		  }
+			  lowstr);
+		else
+		  printf (gettext ("\
+either the file containing the function '%s' or the file containing the function '%s' is not compiled with -fpic/-fPIC\n"),
+			  lowstr, elf_strptr (elf, lookup->strndx,
+					      high->name));
+		return;
+	      }
+	    else if (high != NULL)
+	      {
+		printf (gettext ("\
+the file containing the function '%s' might not be compiled with -fpic/-fPIC\n"),
+			elf_strptr (elf, lookup->strndx, high->name));
+		return;
 	      }
 	  }
 
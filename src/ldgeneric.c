@@ -1860,6 +1860,183 @@ add_whole_archive (struct usedfiles *fileinfo)
 }
 
 
+/* Extract the archive member containing the definition for ARSYM and
+   add it to the input files, which is stored in *MEMBERP.  Returns -1
+   if the archive cannot be read, otherwise the result of processing
+   the member.  */
+static int
+extract_member (struct usedfiles *fileinfo, Elf_Arsym *arsym,
+		struct usedfiles **memberp)
+{
+  Elf *arelf;
+  Elf_Arhdr *arhdr;
+  struct usedfiles *newp;
+
+  /* Find the archive member for this symbol.  */
+  if (unlikely (elf_rand (fileinfo->elf, arsym->as_off) != arsym->as_off))
+    return -1;
+
+  /* Note: no test of a failing 'elf_begin' call.  That's fine
+     since 'elf'getarhdr' will report the problem.  */
+  arelf = elf_begin (fileinfo->fd, ELF_C_READ_MMAP_PRIVATE, fileinfo->elf);
+  arhdr = elf_getarhdr (arelf);
+  if (arhdr == NULL)
+    return -1;
+
+  /* We have all the information and an ELF handle for the
+     archive member.  Create the normal data structure for
+     a file now.  */
+  newp = ld_new_inputfile (obstack_strdup (&ld_state.smem, arhdr->ar_name),
+			   relocatable_file_type);
+  newp->archive_file = fileinfo;
+
+  if (unlikely (ld_state.trace_files))
+    print_file_name (stdout, newp, 1, 1);
+
+  /* This shows that this file is contained in an archive.  */
+  newp->fd = -1;
+  /* Store the ELF descriptor.  */
+  newp->elf = arelf;
+  /* Show that we are open for business.  */
+  newp->status = in_archive;
+  *memberp = newp;
+
+  /* Now read the file and add all the symbols.  */
+  return file_process2 (newp);
+}
+
+
+/* The entries of an archive index which still have to be looked at,
+   lowest first.  */
+struct arsym_heap
+{
+  Elf_Arsym **entries;
+  size_t n;
+  size_t max;
+};
+
+
+static void
+arsym_heap_push (struct arsym_heap *heap, Elf_Arsym *arsym)
+{
+  if (heap->n == heap->max)
+    {
+      heap->max = 2 * heap->max + 64;
+      heap->entries = xrealloc (heap->entries,
+				heap->max * sizeof (heap->entries[0]));
+    }
+
+  size_t i = heap->n++;
+  while (i > 0 && heap->entries[(i - 1) / 2] > arsym)
+    {
+      heap->entries[i] = heap->entries[(i - 1) / 2];
+      i = (i - 1) / 2;
+    }
+  heap->entries[i] = arsym;
+}
+
+
+static Elf_Arsym *
+arsym_heap_pop (struct arsym_heap *heap)
+{
+  if (heap->n == 0)
+    return NULL;
+
+  Elf_Arsym *result = heap->entries[0];
+  Elf_Arsym *last = heap->entries[--heap->n];
+  size_t i = 0;
+  size_t child;
+  while ((child = 2 * i + 1) < heap->n)
+    {
+      if (child + 1 < heap->n
+	  && heap->entries[child + 1] < heap->entries[child])
+	++child;
+      if (heap->entries[child] >= last)
+	break;
+      heap->entries[i] = heap->entries[child];
+      i = child;
+    }
+  heap->entries[i] = last;
+
+  return result;
+}
+
+
+/* Add the entries of the archive index of ELF after AFTER (or all if
+   AFTER is NULL) for SYM to HEAP, if SYM is still undefined.  */
+static void
+add_undefined_arsyms (struct arsym_heap *heap, Elf *elf, struct symbol *sym,
+		      Elf_Arsym *after)
+{
+  if (sym == NULL || sym->defined)
+    return;
+
+  Elf_Arsym *arsym = NULL;
+  while ((arsym = elf_findarsym (elf, sym->name, arsym)) != NULL)
+    if (after == NULL || arsym > after)
+      arsym_heap_push (heap, arsym);
+}
+
+
+/* Extract the members of the archive FILEINFO defining unresolved
+   symbols in the order a scan through the archive index would.  Only
+   the index entries for the unresolved symbols are looked at, and
+   those for the symbols the extracted members leave undefined.  Set
+   *ANY_USED if a member was extracted.  Returns -1 if the archive
+   cannot be read, otherwise the result of processing the members.  */
+static int
+extract_undefined_arsyms (struct usedfiles *fileinfo, bool *any_used)
+{
+  struct arsym_heap heap = { .entries = NULL };
+
+  if (ld_state.unresolved != NULL)
+    {
+      struct symbol *first;
+      struct symbol *s;
+
+      s = first = ld_state.unresolved->next;
+      do
+	add_undefined_arsyms (&heap, fileinfo->elf, s, NULL);
+      while ((s = s->next) != first);
+    }
+
+  int res = 0;
+  Elf_Arsym *last = NULL;
+  Elf_Arsym *arsym;
+  while ((arsym = arsym_heap_pop (&heap)) != NULL)
+    {
+      /* The same entry might have been added more than once, or it
+	 might have been defined by a member extracted since.  */
+      if (arsym == last)
+	continue;
+      last = arsym;
+
+      struct symbol search = { .name = arsym->as_name };
+      struct symbol *sym = ld_symbol_tab_find (&ld_state.symbol_tab,
+					       arsym->as_hash, &search);
+      if (sym == NULL || sym->defined)
+	continue;
+
+      struct usedfiles *member;
+      res = extract_member (fileinfo, arsym, &member);
+      if (unlikely (res != 0))
+	break;
+
+      *any_used = true;
+
+      /* The member might reference symbols defined later in the
+	 archive.  */
+      for (size_t cnt = member->nlocalsymbols; cnt < member->nsymtab; ++cnt)
+	add_undefined_arsyms (&heap, fileinfo->elf, member->symref[cnt],
+			      arsym);
+    }
+
+  free (heap.entries);
+
+  return res;
+}
+
+
 static int
 extract_from_archive (struct usedfiles *fileinfo)
 {
@@ -1904,56 +2081,37 @@ extract_from_archive (struct usedfiles *fileinfo)
     {
       any_used = false;
 
-      size_t cnt;
-      for (cnt = 0; cnt < nsyms; ++cnt)
+      if (ld_state.nunresolved < nsyms / 16)
 	{
-	  struct symbol search = { .name = syms[cnt].as_name };
-	  struct symbol *sym = ld_symbol_tab_find (&ld_state.symbol_tab,
-						   syms[cnt].as_hash, &search);
-	  if (sym != NULL && ! sym->defined)
+	  /* Only few symbols are unresolved.  Rather than going through
+	     the whole index look them up in it, in the same order.  */
+	  res = extract_undefined_arsyms (fileinfo, &any_used);
+	  if (unlikely (res < 0))
+	    goto cannot_read_archive;
+	  if (unlikely (res != 0))
+	    return res;
+	}
+      else
+	{
+	  size_t cnt;
+	  for (cnt = 0; cnt < nsyms; ++cnt)
 	    {
-	      /* The symbol is referenced and not defined.  */
-	      Elf *arelf;
-	      Elf_Arhdr *arhdr;
-	      struct usedfiles *newp;
-
-	      /* Find the archive member for this symbol.  */
-	      if (unlikely (elf_rand (fileinfo->elf, syms[cnt].as_off)
-			    != syms[cnt].as_off))
-		goto cannot_read_archive;
-
-	      /* Note: no test of a failing 'elf_begin' call.  That's fine
-		 since 'elf'getarhdr' will report the problem.  */
-	      arelf = elf_begin (fileinfo->fd, ELF_C_READ_MMAP_PRIVATE,
-				 fileinfo->elf);
-	      arhdr = elf_getarhdr (arelf);
-	      if (arhdr == NULL)
-		goto cannot_read_archive;
-
-	      /* We have all the information and an ELF handle for the
-		 archive member.  Create the normal data structure for
-		 a file now.  */
-	      newp = ld_new_inputfile (obstack_strdup (&ld_state.smem,
-						       arhdr->ar_name),
-				       relocatable_file_type);
-	      newp->archive_file = fileinfo;
-
-	      if (unlikely (ld_state.trace_files))
-		print_file_name (stdout, newp, 1, 1);
-
-	      /* This shows that this file is contained in an archive.  */
-	      newp->fd = -1;
-	      /* Store the ELF descriptor.  */
-	      newp->elf = arelf;
-	      /* Show that we are open for business.  */
-	      newp->status = in_archive;
-
-	      /* Now read the file and add all the symbols.  */
-	      res = file_process2 (newp);
-	      if (unlikely (res != 0))
-		return res;
-
-	      any_used = true;
+	      struct symbol search = { .name = syms[cnt].as_name };
+	      struct symbol *sym = ld_symbol_tab_find (&ld_state.symbol_tab,
+						       syms[cnt].as_hash,
+						       &search);
+	      if (sym != NULL && ! sym->defined)
+		{
+		  /* The symbol is referenced and not defined.  */
+		  struct usedfiles *member;
+		  res = extract_member (fileinfo, &syms[cnt], &member);
+		  if (unlikely (res < 0))
+		    goto cannot_read_archive;
+		  if (unlikely (res != 0))
+		    return res;
+
+		  any_used = true;
+		}
 	    }
 	}
 
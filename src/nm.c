@@ -35,7 +35,7 @@
 #include <locale.h>
 #include <mcheck.h>
 #include <obstack.h>
-#include <search.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdio_ext.h>
@@ -73,6 +73,8 @@ static const struct argp_option options[] =
   { "undefined-only", 'u', NULL, 0, N_("Display only undefined symbols"), 0 },
   { "print-armap", 's', NULL, 0,
     N_("Include index for symbols from archive members"), 0 },
+  { "jobs", 'j', "JOBS", 0,
+    N_("Process up to JOBS archive members at once (default 1, use 0 for one per CPU)"), 0 },
 
   { NULL, 0, NULL, 0, N_("Output format:"), 0 },
   { "print-file-name", 'A', NULL, 0,
@@ -210,6 +212,13 @@ static enum
      a '@' after the identifying letter for the symbol class and type.  */
 static bool mark_special;
 
+/* Number of archive members to handle at once.  */
+static int jobs = 1;
+
+/* Where the output goes.  Each thread handling archive members writes
+   into its own buffer.  */
+static __thread FILE *out;
+
 
 int
 main (int argc, char *argv[])
@@ -224,6 +233,7 @@ main (int argc, char *argv[])
   (void) __fsetlocking (stdin, FSETLOCKING_BYCALLER);
   (void) __fsetlocking (stdout, FSETLOCKING_BYCALLER);
   (void) __fsetlocking (stderr, FSETLOCKING_BYCALLER);
+  out = stdout;
 
   /* Set locale.  */
   (void) setlocale (LC_ALL, "");
@@ -237,6 +247,13 @@ main (int argc, char *argv[])
   /* Parse and process arguments.  */
   (void) argp_parse (&argp, argc, argv, 0, &remaining, NULL);
 
+  if (jobs != 1)
+    {
+      /* Worker threads report errors, which also flushes stdout.  */
+      (void) __fsetlocking (stdout, FSETLOCKING_INTERNAL);
+      (void) __fsetlocking (stderr, FSETLOCKING_INTERNAL);
+    }
+
   /* Tell the library which version we are expecting.  */
   (void) elf_version (EV_CURRENT);
 
@@ -273,8 +290,7 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\
 
 /* Handle program arguments.  */
 static error_t
-parse_opt (int key, char *arg,
-	   struct argp_state *state __attribute__ ((unused)))
+parse_opt (int key, char *arg, struct argp_state *state)
 {
   switch (key)
     {
@@ -363,6 +379,15 @@ parse_opt (int key, char *arg,
       reverse_sort = true;
       break;
 
+    case 'j':
+      jobs = atoi (arg);
+      if (jobs < 0)
+	{
+	  argp_error (state, gettext ("-j JOBS should be 0 or higher."));
+	  return EINVAL;
+	}
+      break;
+
     default:
       return ARGP_ERR_UNKNOWN;
     }
@@ -423,6 +448,118 @@ process_file (const char *fname, bool more_than_one)
 }
 
 
+struct member_state
+{
+  int fd;
+  Elf *elf;
+  Elf_Armember *members;
+  const char *prefix;
+  const char *suffix;
+  const char *fname;
+  struct member_output
+  {
+    char *buf;
+    size_t len;
+    int result;
+  } *output;
+};
+
+/* Serializes creating and freeing descriptors for the members.  */
+static pthread_mutex_t member_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static void
+handle_member (size_t i, void *arg)
+{
+  struct member_state *state = arg;
+  struct member_output *output = &state->output[i];
+  const char *name = state->members[i].am_name;
+
+  pthread_mutex_lock (&member_lock);
+  Elf *subelf = elf_begin_armember (state->elf, state->members[i].am_off,
+				    ELF_C_READ_MMAP);
+  pthread_mutex_unlock (&member_lock);
+
+  /* This might be the thread handling the archive.  */
+  FILE *saved_out = out;
+  out = open_memstream (&output->buf, &output->len);
+  if (out == NULL)
+    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+  (void) __fsetlocking (out, FSETLOCKING_BYCALLER);
+
+  if (subelf == NULL)
+    {
+      error (0, 0, gettext ("%s%s%s: %s"), state->prefix, name,
+	     state->suffix, elf_errmsg (-1));
+      output->result = 1;
+    }
+  else if (elf_kind (subelf) == ELF_K_ELF)
+    output->result = handle_elf (subelf, state->prefix, name, state->suffix);
+  else if (elf_kind (subelf) == ELF_K_AR)
+    output->result = handle_ar (state->fd, subelf, state->prefix, name,
+				state->suffix);
+  else
+    {
+      error (0, 0, gettext ("%s%s%s: file format not recognized"),
+	     state->prefix, name, state->suffix);
+      output->result = 1;
+    }
+
+  fclose (out);
+  out = saved_out;
+
+  pthread_mutex_lock (&member_lock);
+  if (subelf != NULL && elf_end (subelf) != 0)
+    INTERNAL_ERROR (state->fname);
+  pthread_mutex_unlock (&member_lock);
+}
+
+
+static void
+output_member (size_t i, void *arg)
+{
+  struct member_state *state = arg;
+  struct member_output *output = &state->output[i];
+
+  fwrite_unlocked (output->buf, 1, output->len, stdout);
+  free (output->buf);
+}
+
+
+static int
+handle_ar_parallel (int fd, Elf *elf, const char *prefix, const char *suffix,
+		    const char *fname)
+{
+  size_t nmembers;
+  Elf_Armember *members = elf_getarmembers (elf, &nmembers);
+  if (members == NULL)
+    {
+      error (0, 0, gettext ("%s: %s"), fname, elf_errmsg (-1));
+      return 1;
+    }
+
+  struct member_state state =
+    {
+      .fd = fd,
+      .elf = elf,
+      .members = members,
+      .prefix = prefix,
+      .suffix = suffix,
+      .fname = fname,
+      .output = xcalloc (nmembers, sizeof (struct member_output))
+    };
+
+  parallel_ordered (nmembers, jobs, handle_member, output_member, &state);
+
+  int result = 0;
+  for (size_t i = 0; i < nmembers; ++i)
+    result |= state.output[i].result;
+  free (state.output);
+
+  return result;
+}
+
+
 static int
 handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 	   const char *suffix)
@@ -457,7 +594,7 @@ handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 	  Elf_Arhdr *arhdr = NULL;
 	  size_t arhdr_off = 0;	/* Note: 0 is no valid offset.  */
 
-	  fputs_unlocked (gettext("\nArchive index:\n"), stdout);
+	  fputs_unlocked (gettext("\nArchive index:\n"), out);
 
 	  while (arsym->as_off != 0)
 	    {
@@ -471,7 +608,8 @@ handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 		  continue;
 		}
 
-	      printf (gettext ("%s in %s\n"), arsym->as_name, arhdr->ar_name);
+	      fprintf (out, gettext ("%s in %s\n"),
+		       arsym->as_name, arhdr->ar_name);
 
 	      ++arsym;
 	    }
@@ -485,6 +623,10 @@ handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 	}
     }
 
+  /* The members of the top-level archive can be handled in parallel.  */
+  if (jobs != 1 && prefix == NULL)
+    return handle_ar_parallel (fd, elf, new_prefix, new_suffix, fname);
+
   /* Process all the files contained in the archive.  */
   while ((subelf = elf_begin (fd, cmd, elf)) != NULL)
     {
@@ -493,7 +635,8 @@ handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 
       /* Skip over the index entries.  */
       if (strcmp (arhdr->ar_name, "/") != 0
-	  && strcmp (arhdr->ar_name, "//") != 0)
+	  && strcmp (arhdr->ar_name, "//") != 0
+	  && strcmp (arhdr->ar_name, "/SYM64/") != 0)
 	{
 	  if (elf_kind (subelf) == ELF_K_ELF)
 	    result |= handle_elf (subelf, new_prefix, arhdr->ar_name,
@@ -537,70 +680,85 @@ static const int length_map[2][3] =
 };
 
 
-static int
-global_compare (const void *p1, const void *p2)
-{
-  const Dwarf_Global *g1 = (const Dwarf_Global *) p1;
-  const Dwarf_Global *g2 = (const Dwarf_Global *) p2;
-
-  return strcmp (g1->name, g2->name);
-}
-
-
-static void *global_root;
-
-
-static int
-get_global (Dwarf *dbg __attribute__ ((unused)), Dwarf_Global *global,
-	    void *arg __attribute__ ((unused)))
+/* What the DWARF information says about a name: the pubnames entry
+   if there is one, and the subprograms and variables of that name
+   the CUs define, all found with one lookup in the name table.  */
+struct dwarf_name
 {
-  tsearch (memcpy (xmalloc (sizeof (Dwarf_Global)), global,
-		   sizeof (Dwarf_Global)),
-	   &global_root, global_compare);
-
-  return DWARF_CB_OK;
-}
+  const char *name;
+  bool global;
+  Dwarf_Off die_offset;
+  Dwarf_Off cu_offset;
+  struct local_name *locals;
+};
 
 
 struct local_name
 {
-  const char *name;
   const char *file;
   Dwarf_Word lineno;
   Dwarf_Addr lowpc;
   Dwarf_Addr highpc;
+  struct local_name *next;
 };
 
 
+#define NAME name_tab
+#define TYPE struct dwarf_name *
+#define COMPARE(a, b) strcmp ((a)->name, (b)->name)
+#define NO_UNDEF
+#include <dynamicsizehash.h>
+#undef NO_UNDEF
+#include "../lib/dynamicsizehash.c"
+#undef NAME
+#undef TYPE
+#undef COMPARE
+
+
+/* The DWARF names of one file.  The records are all allocated in
+   MEM and released at once.  */
+struct dwarf_names
+{
+  name_tab tab;
+  struct obstack mem;
+};
+
+
+/* Find the record for NAME, adding an empty one if CREATE.  */
+static struct dwarf_name *
+find_dwarf_name (struct dwarf_names *names, const char *name, bool create)
+{
+  struct dwarf_name fake = { .name = name };
+  unsigned long int hval = elf_hash (name);
+
+  struct dwarf_name *found = name_tab_find (&names->tab, hval, &fake);
+  if (found == NULL && create)
+    {
+      found = obstack_alloc (&names->mem, sizeof (*found));
+      *found = fake;
+      if (name_tab_insert (&names->tab, hval, found) != 0)
+	error (EXIT_FAILURE, errno, gettext ("cannot create search tree"));
+    }
+
+  return found;
+}
+
+
 static int
-local_compare (const void *p1, const void *p2)
+get_global (Dwarf *dbg __attribute__ ((unused)), Dwarf_Global *global,
+	    void *arg)
 {
-  struct local_name *g1 = (struct local_name *) p1;
-  struct local_name *g2 = (struct local_name *) p2;
-  int result;
+  struct dwarf_name *found = find_dwarf_name (arg, global->name, true);
 
-  result = strcmp (g1->name, g2->name);
-  if (result == 0)
+  /* The first entry for a name wins.  */
+  if (! found->global)
     {
-      if (g1->lowpc <= g2->lowpc && g1->highpc >= g2->highpc)
-	{
-	  /* g2 is contained in g1.  Update the data.  */
-	  g2->lowpc = g1->lowpc;
-	  g2->highpc = g1->highpc;
-	  result = 0;
-	}
-      else if (g2->lowpc <= g1->lowpc && g2->highpc >= g1->highpc)
-	{
-	  /* g1 is contained in g2.  Update the data.  */
-	  g1->lowpc = g2->lowpc;
-	  g1->highpc = g2->highpc;
-	  result = 0;
-	}
-      else
-	result = g1->lowpc < g2->lowpc ? -1 : 1;
+      found->global = true;
+      found->die_offset = global->die_offset;
+      found->cu_offset = global->cu_offset;
     }
 
-  return result;
+  return DWARF_CB_OK;
 }
 
 
@@ -630,11 +788,42 @@ get_var_range (Dwarf_Die *die, Dwarf_Word *lowpc, Dwarf_Word *highpc)
 
 
 
-static void *local_root;
+/* Add a local subprogram or variable to the ones with its name.  A
+   range containing or contained in one already known is merged into
+   it.  */
+static void
+add_local_name (struct dwarf_names *names, const char *name,
+		const char *file, Dwarf_Word lineno,
+		Dwarf_Addr lowpc, Dwarf_Addr highpc)
+{
+  struct dwarf_name *found = find_dwarf_name (names, name, true);
+
+  struct local_name **lastp = &found->locals;
+  for (struct local_name *runp = *lastp; runp != NULL; runp = *lastp)
+    {
+      if (runp->lowpc <= lowpc && runp->highpc >= highpc)
+	return;
+      if (lowpc <= runp->lowpc && highpc >= runp->highpc)
+	{
+	  runp->lowpc = lowpc;
+	  runp->highpc = highpc;
+	  return;
+	}
+      lastp = &runp->next;
+    }
+
+  struct local_name *newp = obstack_alloc (&names->mem, sizeof (*newp));
+  newp->file = file;
+  newp->lineno = lineno;
+  newp->lowpc = lowpc;
+  newp->highpc = highpc;
+  newp->next = NULL;
+  *lastp = newp;
+}
 
 
 static void
-get_local_names (Dwarf *dbg)
+get_local_names (Dwarf *dbg, struct dwarf_names *names)
 {
   Dwarf_Off offset = 0;
   Dwarf_Off old_offset;
@@ -703,19 +892,9 @@ get_local_names (Dwarf *dbg)
 	      }
 
 	    /* We have all the information.  Create a record.  */
-	    struct local_name *newp
-	      = (struct local_name *) xmalloc (sizeof (*newp));
-	    newp->name = name;
-	    newp->file = dwarf_filesrc (files, fileidx, NULL, NULL);
-	    newp->lineno = lineno;
-	    newp->lowpc = lowpc;
-	    newp->highpc = highpc;
-
-	    /* Since we cannot deallocate individual memory we do not test
-	       for duplicates in the tree.  This should not happen anyway.  */
-	    if (tsearch (newp, &local_root, local_compare) == NULL)
-	      error (EXIT_FAILURE, errno,
-		     gettext ("cannot create search tree"));
+	    add_local_name (names, name, dwarf_filesrc (files, fileidx, NULL,
+							NULL),
+			    lineno, lowpc, highpc);
 	  }
 	while (dwarf_siblingof (die, die) == 0);
     }
@@ -781,18 +960,18 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
   int digits = length_map[gelf_getclass (ebl->elf) - 1][radix];
 
   /* We always print this prolog.  */
-  printf (gettext ("\n\nSymbols from %s:\n\n"), fullname);
+  fprintf (out, gettext ("\n\nSymbols from %s:\n\n"), fullname);
 
   /* The header line.  */
-  printf (gettext ("%*s%-*s %-*s Class  Type     %-*s %*s Section\n\n"),
-	  print_file_name ? (int) strlen (fullname) + 1: 0, "",
-	  longest_name, sgettext ("sysv|Name"),
-	  /* TRANS: the "sysv|" parts makes the string unique.  */
-	  digits, sgettext ("sysv|Value"),
-	  /* TRANS: the "sysv|" parts makes the string unique.  */
-	  digits, sgettext ("sysv|Size"),
-	  /* TRANS: the "sysv|" parts makes the string unique.  */
-	  longest_where, sgettext ("sysv|Line"));
+  fprintf (out, gettext ("%*s%-*s %-*s Class  Type     %-*s %*s Section\n\n"),
+	   print_file_name ? (int) strlen (fullname) + 1: 0, "",
+	   longest_name, sgettext ("sysv|Name"),
+	   /* TRANS: the "sysv|" parts makes the string unique.  */
+	   digits, sgettext ("sysv|Value"),
+	   /* TRANS: the "sysv|" parts makes the string unique.  */
+	   digits, sgettext ("sysv|Size"),
+	   /* TRANS: the "sysv|" parts makes the string unique.  */
+	   longest_where, sgettext ("sysv|Line"));
 
 #ifdef USE_DEMANGLE
   size_t demangle_buffer_len = 0;
@@ -832,8 +1011,8 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
       /* If we have to precede the line with the file name.  */
       if (print_file_name)
 	{
-	  fputs_unlocked (fullname, stdout);
-	  putchar_unlocked (':');
+	  fputs_unlocked (fullname, out);
+	  putc_unlocked (':', out);
 	}
 
       /* Covert the address.  */
@@ -854,17 +1033,17 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
 	}
 
       /* Print the actual string.  */
-      printf ("%-*s|%s|%-6s|%-8s|%s|%*s|%s\n",
-	      longest_name, symstr, addressbuf,
-	      ebl_symbol_binding_name (ebl,
-				       GELF_ST_BIND (syms[cnt].sym.st_info),
-				       symbindbuf, sizeof (symbindbuf)),
-	      ebl_symbol_type_name (ebl, GELF_ST_TYPE (syms[cnt].sym.st_info),
-				    symtypebuf, sizeof (symtypebuf)),
-	      sizebuf, longest_where, syms[cnt].where,
-	      ebl_section_name (ebl, syms[cnt].sym.st_shndx, syms[cnt].xndx,
-				secnamebuf, sizeof (secnamebuf), scnnames,
-				shnum));
+      fprintf (out, "%-*s|%s|%-6s|%-8s|%s|%*s|%s\n",
+	       longest_name, symstr, addressbuf,
+	       ebl_symbol_binding_name (ebl,
+					GELF_ST_BIND (syms[cnt].sym.st_info),
+					symbindbuf, sizeof (symbindbuf)),
+	       ebl_symbol_type_name (ebl, GELF_ST_TYPE (syms[cnt].sym.st_info),
+				     symtypebuf, sizeof (symtypebuf)),
+	       sizebuf, longest_where, syms[cnt].where,
+	       ebl_section_name (ebl, syms[cnt].sym.st_shndx, syms[cnt].xndx,
+				 secnamebuf, sizeof (secnamebuf), scnnames,
+				 shnum));
     }
 
 #ifdef USE_DEMANGLE
@@ -924,7 +1103,7 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
   int digits = length_map[gelf_getclass (elf) - 1][radix];
 
   if (prefix != NULL && ! print_file_name)
-    printf ("\n%s:\n", fname);
+    fprintf (out, "\n%s:\n", fname);
 
 #ifdef USE_DEMANGLE
   size_t demangle_buffer_len = 0;
@@ -964,8 +1143,8 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
       /* If we have to precede the line with the file name.  */
       if (print_file_name)
 	{
-	  fputs_unlocked (fullname, stdout);
-	  putchar_unlocked (':');
+	  fputs_unlocked (fullname, out);
+	  putc_unlocked (':', out);
 	}
 
       bool is_tls = GELF_ST_TYPE (syms[cnt].sym.st_info) == STT_TLS;
@@ -986,7 +1165,7 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 		color = color_undef;
 	    }
 
-	  printf ("%*s %sU%s %s", digits, "", color, marker, symstr);
+	  fprintf (out, "%*s %sU%s %s", digits, "", color, marker, symstr);
 	}
       else
 	{
@@ -1005,15 +1184,15 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 #define HEXFMT "%6$s%2$0*1$" PRIx64 "%8$s %10$0*9$" PRIx64 " %7$s%3$c%4$s %5$s"
 #define DECFMT "%6$s%2$*1$" PRId64 "%8$s %10$*9$" PRId64 " %7$s%3$c%4$s %5$s"
 #define OCTFMT "%6$s%2$0*1$" PRIo64 "%8$s %10$0*9$" PRIo64 " %7$s%3$c%4$s %5$s"
-	      printf ((radix == radix_hex ? HEXFMT
-		       : (radix == radix_decimal ? DECFMT : OCTFMT)),
-		      digits, syms[cnt].sym.st_value,
-		      class_type_char (elf, ehdr, &syms[cnt].sym), marker,
-		      symstr,
-		      color_mode ? color_address : "",
-		      color,
-		      color_mode ? color_off : "",
-		      digits, (uint64_t) syms[cnt].sym.st_size);
+	      fprintf (out, (radix == radix_hex ? HEXFMT
+			: (radix == radix_decimal ? DECFMT : OCTFMT)),
+		       digits, syms[cnt].sym.st_value,
+		       class_type_char (elf, ehdr, &syms[cnt].sym), marker,
+		       symstr,
+		       color_mode ? color_address : "",
+		       color,
+		       color_mode ? color_off : "",
+		       digits, (uint64_t) syms[cnt].sym.st_size);
 #undef HEXFMT
 #undef DECFMT
 #undef OCTFMT
@@ -1023,14 +1202,14 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 #define HEXFMT "%6$s%2$0*1$" PRIx64 "%8$s %7$s%3$c%4$s %5$s"
 #define DECFMT "%6$s%2$*1$" PRId64 "%8$s %7$s%3$c%4$s %5$s"
 #define OCTFMT "%6$s%2$0*1$" PRIo64 "%8$s %7$s%3$c%4$s %5$s"
-	      printf ((radix == radix_hex ? HEXFMT
-		       : (radix == radix_decimal ? DECFMT : OCTFMT)),
-		      digits, syms[cnt].sym.st_value,
-		      class_type_char (elf, ehdr, &syms[cnt].sym), marker,
-		      symstr,
-		      color_mode ? color_address : "",
-		      color,
-		      color_mode ? color_off : "");
+	      fprintf (out, (radix == radix_hex ? HEXFMT
+			: (radix == radix_decimal ? DECFMT : OCTFMT)),
+		       digits, syms[cnt].sym.st_value,
+		       class_type_char (elf, ehdr, &syms[cnt].sym), marker,
+		       symstr,
+		       color_mode ? color_address : "",
+		       color,
+		       color_mode ? color_off : "");
 #undef HEXFMT
 #undef DECFMT
 #undef OCTFMT
@@ -1038,8 +1217,8 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 	}
 
       if (color_mode)
-	fputs_unlocked (color_off, stdout);
-      putchar_unlocked ('\n');
+	fputs_unlocked (color_off, out);
+      putc_unlocked ('\n', out);
     }
 
 #ifdef USE_DEMANGLE
@@ -1054,7 +1233,7 @@ show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 		    size_t nsyms)
 {
   if (prefix != NULL && ! print_file_name)
-    printf ("%s:\n", fullname);
+    fprintf (out, "%s:\n", fullname);
 
   int digits = length_map[gelf_getclass (elf) - 1][radix];
 
@@ -1092,26 +1271,26 @@ show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
       /* If we have to precede the line with the file name.  */
       if (print_file_name)
 	{
-	  fputs_unlocked (fullname, stdout);
-	  putchar_unlocked (':');
-	  putchar_unlocked (' ');
+	  fputs_unlocked (fullname, out);
+	  putc_unlocked (':', out);
+	  putc_unlocked (' ', out);
 	}
 
-      printf ((radix == radix_hex
-	       ? "%s %c%s %0*" PRIx64 " %0*" PRIx64 "\n"
-	       : (radix == radix_decimal
-		  ? "%s %c%s %*" PRId64 " %*" PRId64 "\n"
-		  : "%s %c%s %0*" PRIo64 " %0*" PRIo64 "\n")),
-	      symstr,
-	      class_type_char (elf, ehdr, &syms[cnt].sym),
-	      mark_special
-	      ? (GELF_ST_TYPE (syms[cnt].sym.st_info) == STT_TLS
-		 ? "@"
-		 : (GELF_ST_BIND (syms[cnt].sym.st_info) == STB_WEAK
-		    ? "*" : " "))
-	      : "",
-	      digits, syms[cnt].sym.st_value,
-	      digits, syms[cnt].sym.st_size);
+      fprintf (out, (radix == radix_hex
+		? "%s %c%s %0*" PRIx64 " %0*" PRIx64 "\n"
+		: (radix == radix_decimal
+		   ? "%s %c%s %*" PRId64 " %*" PRId64 "\n"
+		   : "%s %c%s %0*" PRIo64 " %0*" PRIo64 "\n")),
+	       symstr,
+	       class_type_char (elf, ehdr, &syms[cnt].sym),
+	       mark_special
+	       ? (GELF_ST_TYPE (syms[cnt].sym.st_info) == STT_TLS
+		  ? "@"
+		  : (GELF_ST_BIND (syms[cnt].sym.st_info) == STB_WEAK
+		     ? "*" : " "))
+	       : "",
+	       digits, syms[cnt].sym.st_value,
+	       digits, syms[cnt].sym.st_size);
     }
 
 #ifdef USE_DEMANGLE
@@ -1135,7 +1314,15 @@ sort_by_address (const void *p1, const void *p2)
   return reverse_sort ? -result : result;
 }
 
-static Elf_Data *sort_by_name_strtab;
+static __thread const char *sort_by_name_strtab;
+static __thread size_t sort_by_name_strtab_size;
+
+static const char *
+sort_by_name_str (const GElf_SymX *s)
+{
+  return (s->sym.st_name < sort_by_name_strtab_size
+	  ? sort_by_name_strtab + s->sym.st_name : "");
+}
 
 static int
 sort_by_name (const void *p1, const void *p2)
@@ -1143,8 +1330,8 @@ sort_by_name (const void *p1, const void *p2)
   GElf_SymX *s1 = (GElf_SymX *) p1;
   GElf_SymX *s2 = (GElf_SymX *) p2;
 
-  const char *n1 = sort_by_name_strtab->d_buf + s1->sym.st_name;
-  const char *n2 = sort_by_name_strtab->d_buf + s2->sym.st_name;
+  const char *n1 = sort_by_name_str (s1);
+  const char *n2 = sort_by_name_str (s2);
 
   int result = strcmp (n1, n2);
 
@@ -1189,14 +1376,20 @@ show_symbols (Ebl *ebl, GElf_Ehdr *ehdr, Elf_Scn *scn, Elf_Scn *xndxscn,
   /* Get a DWARF debugging descriptor.  It's no problem if this isn't
      possible.  We just won't print any line number information.  */
   Dwarf *dbg = NULL;
+  struct dwarf_names names;
   if (format == format_sysv)
     {
       dbg = dwarf_begin_elf (ebl->elf, DWARF_C_READ, NULL);
       if (dbg != NULL)
 	{
-	  (void) dwarf_getpubnames (dbg, get_global, NULL, 0);
+	  /* There are hardly more names worth knowing than symbols.  */
+	  if (name_tab_init (&names.tab, MAX (nentries, 127)) != 0)
+	    error (EXIT_FAILURE, errno, gettext ("cannot create search tree"));
+	  obstack_init (&names.mem);
+
+	  (void) dwarf_getpubnames (dbg, get_global, &names, 0);
 
-	  get_local_names (dbg);
+	  get_local_names (dbg, &names);
 	}
     }
 
@@ -1263,17 +1456,18 @@ show_symbols (Ebl *ebl, GElf_Ehdr *ehdr, Elf_Scn *scn, Elf_Scn *xndxscn,
 
 	  longest_name = MAX ((size_t) longest_name, strlen (symstr));
 
+	  struct dwarf_name *found = NULL;
+	  if (dbg != NULL)
+	    found = find_dwarf_name (&names, symstr, false);
+
 	  if (sym->st_shndx != SHN_UNDEF
 	      && GELF_ST_BIND (sym->st_info) != STB_LOCAL
-	      && global_root != NULL)
+	      && found != NULL)
 	    {
-	      Dwarf_Global fake = { .name = symstr };
-	      Dwarf_Global **found = tfind (&fake, &global_root,
-					    global_compare);
-	      if (found != NULL)
+	      if (found->global)
 		{
 		  Dwarf_Die die_mem;
-		  Dwarf_Die *die = dwarf_offdie (dbg, (*found)->die_offset,
+		  Dwarf_Die *die = dwarf_offdie (dbg, found->die_offset,
 						 &die_mem);
 
 		  Dwarf_Die cudie_mem;
@@ -1286,7 +1480,7 @@ show_symbols (Ebl *ebl, GElf_Ehdr *ehdr, Elf_Scn *scn, Elf_Scn *xndxscn,
 		      && lowpc <= sym->st_value
 		      && dwarf_highpc (die, &highpc) == 0
 		      && highpc > sym->st_value)
-		    cudie = dwarf_offdie (dbg, (*found)->cu_offset,
+		    cudie = dwarf_offdie (dbg, found->cu_offset,
 					  &cudie_mem);
 		  if (cudie != NULL)
 		    {
@@ -1316,22 +1510,19 @@ show_symbols (Ebl *ebl, GElf_Ehdr *ehdr, Elf_Scn *scn, Elf_Scn *xndxscn,
 	    }
 
 	  /* Try to find the symbol among the local symbols.  */
-	  if (sym_mem[nentries_used].where[0] == '\0')
+	  if (sym_mem[nentries_used].where[0] == '\0' && found != NULL)
 	    {
-	      struct local_name fake =
-		{
-		  .name = symstr,
-		  .lowpc = sym->st_value,
-		  .highpc = sym->st_value,
-		};
-	      struct local_name **found = tfind (&fake, &local_root,
-						 local_compare);
-	      if (found != NULL)
+	      struct local_name *local = found->locals;
+	      while (local != NULL
+		     && (local->lowpc > sym->st_value
+			 || local->highpc < sym->st_value))
+		local = local->next;
+	      if (local != NULL)
 		{
 		  /* We found the line.  */
 		  int n = obstack_printf (&whereob, "%s:%" PRIu64 "%c",
-					  basename ((*found)->file),
-					  (*found)->lineno,
+					  basename (local->file),
+					  local->lineno,
 					  '\0');
 		  sym_mem[nentries_used].where = obstack_finish (&whereob);
 
@@ -1355,8 +1546,10 @@ show_symbols (Ebl *ebl, GElf_Ehdr *ehdr, Elf_Scn *scn, Elf_Scn *xndxscn,
   /* Sort the entries according to the users wishes.  */
   if (sort == sort_name)
     {
-      sort_by_name_strtab = elf_getdata (elf_getscn (ebl->elf, shdr->sh_link),
-					 NULL);
+      sort_by_name_strtab = elf_strtab (ebl->elf, shdr->sh_link,
+					&sort_by_name_strtab_size);
+      if (sort_by_name_strtab == NULL)
+	sort_by_name_strtab_size = 0;
       qsort (sym_mem, nentries, sizeof (GElf_SymX), sort_by_name);
     }
   else if (sort == sort_numeric)
@@ -1391,11 +1584,8 @@ show_symbols (Ebl *ebl, GElf_Ehdr *ehdr, Elf_Scn *scn, Elf_Scn *xndxscn,
 
   if (dbg != NULL)
     {
-      tdestroy (global_root, free);
-      global_root = NULL;
-
-      tdestroy (local_root, free);
-      local_root = NULL;
+      name_tab_free (&names.tab);
+      obstack_free (&names.mem, NULL);
 
       (void) dwarf_end (dbg);
     }
@@ -46,6 +46,9 @@ ARGP_PROGRAM_VERSION_HOOK_DEF = print_version;
 /* Bug report address.  */
 ARGP_PROGRAM_BUG_ADDRESS_DEF = PACKAGE_BUGREPORT;
 
+/* Values for the parameters which have no short form.  */
+#define OPT_JOBS 0x100
+
 
 /* Definitions of arguments for argp functions.  */
 static const struct argp_option options[] =
@@ -56,6 +59,8 @@ static const struct argp_option options[] =
     N_("Display the full contents of all sections requested"), 0 },
   { "disassemble", 'd', NULL, 0,
     N_("Display assembler code of executable sections"), 0 },
+  { "jobs", OPT_JOBS, "JOBS", 0,
+    N_("Disassemble up to JOBS pieces of a section at once (default 1, use 0 for one per CPU)"), 0 },
 
   { NULL, 0, NULL, 0, N_("Output content selection:"), 0 },
   { "section", 'j', "NAME", 0,
@@ -127,6 +132,9 @@ static bool print_full_content;
 /* If true print disassembled output..  */
 static bool print_disasm;
 
+/* Number of pieces of a section to disassemble at once.  */
+static int jobs = 1;
+
 
 int
 main (int argc, char *argv[])
@@ -189,8 +197,7 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\
 
 /* Handle program arguments.  */
 static error_t
-parse_opt (int key, char *arg,
-	   struct argp_state *state __attribute__ ((unused)))
+parse_opt (int key, char *arg, struct argp_state *state)
 {
   /* True if any of the control options is set.  */
   static bool any_control_option;
@@ -220,6 +227,15 @@ parse_opt (int key, char *arg,
       any_control_option = true;
       break;
 
+    case OPT_JOBS:
+      jobs = atoi (arg);
+      if (jobs < 0)
+	{
+	  argp_error (state, gettext ("--jobs JOBS should be 0 or higher."));
+	  return EINVAL;
+	}
+      break;
+
     case 'r':
       print_relocs = true;
       any_control_option = true;
@@ -634,6 +650,7 @@ struct disasm_info
   const uint8_t *last_end;
   const char *address_color;
   const char *bytes_color;
+  FILE *out;
 };
 
 
@@ -645,21 +662,21 @@ disasm_output (char *buf, size_t buflen, void *arg)
   struct disasm_info *info = (struct disasm_info *) arg;
 
   if (info->address_color != NULL)
-    printf ("%s%8" PRIx64 "%s:   ",
-	    info->address_color, (uint64_t) info->addr, color_off);
+    fprintf (info->out, "%s%8" PRIx64 "%s:   ",
+	     info->address_color, (uint64_t) info->addr, color_off);
   else
-    printf ("%8" PRIx64 ":   ", (uint64_t) info->addr);
+    fprintf (info->out, "%8" PRIx64 ":   ", (uint64_t) info->addr);
 
   if (info->bytes_color != NULL)
-    fputs_unlocked (info->bytes_color, stdout);
+    fputs_unlocked (info->bytes_color, info->out);
   size_t cnt;
   for (cnt = 0; cnt < (size_t) MIN (info->cur - info->last_end, 8); ++cnt)
-    printf (" %02" PRIx8, info->last_end[cnt]);
+    fprintf (info->out, " %02" PRIx8, info->last_end[cnt]);
   if (info->bytes_color != NULL)
-    fputs_unlocked (color_off, stdout);
+    fputs_unlocked (color_off, info->out);
 
-  printf ("%*s %.*s\n",
-	  (int) (8 - cnt) * 3 + 1, "", (int) buflen, buf);
+  fprintf (info->out, "%*s %.*s\n",
+	   (int) (8 - cnt) * 3 + 1, "", (int) buflen, buf);
 
   info->addr += cnt;
 
@@ -668,18 +685,18 @@ disasm_output (char *buf, size_t buflen, void *arg)
   if (info->cur - info->last_end > 8)
     {
       if (info->address_color != NULL)
-	printf ("%s%8" PRIx64 "%s:   ",
-		info->address_color, (uint64_t) info->addr, color_off);
+	fprintf (info->out, "%s%8" PRIx64 "%s:   ",
+		 info->address_color, (uint64_t) info->addr, color_off);
       else
-	printf ("%8" PRIx64 ":   ", (uint64_t) info->addr);
+	fprintf (info->out, "%8" PRIx64 ":   ", (uint64_t) info->addr);
 
       if (info->bytes_color != NULL)
-	fputs_unlocked (info->bytes_color, stdout);
+	fputs_unlocked (info->bytes_color, info->out);
       for (; cnt < (size_t) (info->cur - info->last_end); ++cnt)
-	printf (" %02" PRIx8, info->last_end[cnt]);
+	fprintf (info->out, " %02" PRIx8, info->last_end[cnt]);
       if (info->bytes_color != NULL)
-	fputs_unlocked (color_off, stdout);
-      putchar_unlocked ('\n');
+	fputs_unlocked (color_off, info->out);
+      putc_unlocked ('\n', info->out);
       info->addr += info->cur - info->last_end - 8;
     }
 
@@ -689,6 +706,169 @@ disasm_output (char *buf, size_t buflen, void *arg)
 }
 
 
+/* Sections are split at function symbols into pieces of at least this
+   many bytes to disassemble them at once.  */
+#define DISASM_CHUNK_SIZE 65536
+
+/* A piece of an executable section starting at a function, and its
+   disassembly.  */
+struct disasm_chunk
+{
+  size_t from;
+  size_t to;
+  char *text;
+  size_t size;
+};
+
+/* The pieces of one section.  */
+struct disasm_chunks
+{
+  DisasmCtx_t *ctx;
+  const char *fmt;
+  const uint8_t *buf;
+  GElf_Addr addr;
+  const char *address_color;
+  const char *bytes_color;
+  struct disasm_chunk *chunk;
+};
+
+
+static int
+compare_offsets (const void *p1, const void *p2)
+{
+  size_t o1 = *(const size_t *) p1;
+  size_t o2 = *(const size_t *) p2;
+
+  return o1 < o2 ? -1 : o1 > o2;
+}
+
+
+/* Split the SIZE bytes of section SCN at the functions in it.  Return
+   the pieces and set *NCHUNKS, which is zero if the section has no
+   functions to split it at.  */
+static struct disasm_chunk *
+split_section (Elf *elf, Elf_Scn *scn, GElf_Shdr *shdr, size_t size,
+	       size_t *nchunks)
+{
+  *nchunks = 0;
+
+  GElf_Ehdr ehdr_mem;
+  GElf_Ehdr *ehdr = gelf_getehdr (elf, &ehdr_mem);
+  if (ehdr == NULL)
+    return NULL;
+
+  /* Function symbols in relocatable files have offsets in their
+     section, otherwise they have addresses.  */
+  GElf_Addr base = ehdr->e_type == ET_REL ? 0 : shdr->sh_addr;
+  size_t scnndx = elf_ndxscn (scn);
+
+  /* Use the full symbol table if there is one.  */
+  Elf_Scn *symscn = NULL;
+  Elf_Scn *s = NULL;
+  while ((s = elf_nextscn (elf, s)) != NULL)
+    {
+      GElf_Shdr sym_shdr_mem;
+      GElf_Shdr *sym_shdr = gelf_getshdr (s, &sym_shdr_mem);
+      if (sym_shdr != NULL
+	  && (sym_shdr->sh_type == SHT_SYMTAB
+	      || (sym_shdr->sh_type == SHT_DYNSYM && symscn == NULL)))
+	symscn = s;
+    }
+
+  GElf_Shdr sym_shdr_mem;
+  GElf_Shdr *sym_shdr = symscn == NULL ? NULL : gelf_getshdr (symscn,
+							      &sym_shdr_mem);
+  Elf_Data *data = symscn == NULL ? NULL : elf_getdata (symscn, NULL);
+  if (sym_shdr == NULL || data == NULL || sym_shdr->sh_entsize == 0)
+    return NULL;
+
+  Elf_Data *xndxdata = NULL;
+  int xndxscnidx = elf_scnshndx (symscn);
+  if (xndxscnidx > 0)
+    xndxdata = elf_getdata (elf_getscn (elf, xndxscnidx), NULL);
+
+  size_t nsyms = sym_shdr->sh_size / sym_shdr->sh_entsize;
+  size_t *offsets = xmalloc (nsyms * sizeof (offsets[0]));
+  size_t noffsets = 0;
+  for (size_t cnt = 1; cnt < nsyms; ++cnt)
+    {
+      GElf_Sym sym_mem;
+      Elf32_Word xndx;
+      GElf_Sym *sym = gelf_getsymshndx (data, xndxdata, cnt, &sym_mem,
+					&xndx);
+      if (sym == NULL || GELF_ST_TYPE (sym->st_info) != STT_FUNC)
+	continue;
+      if (sym->st_shndx != SHN_XINDEX)
+	xndx = sym->st_shndx;
+      if (xndx == scnndx && sym->st_value > base
+	  && sym->st_value - base < size)
+	offsets[noffsets++] = sym->st_value - base;
+    }
+
+  if (noffsets == 0)
+    {
+      free (offsets);
+      return NULL;
+    }
+
+  qsort (offsets, noffsets, sizeof (offsets[0]), compare_offsets);
+
+  struct disasm_chunk *chunks = xmalloc ((noffsets + 1) * sizeof (chunks[0]));
+  size_t from = 0;
+  for (size_t cnt = 0; cnt < noffsets; ++cnt)
+    if (offsets[cnt] - from >= DISASM_CHUNK_SIZE)
+      {
+	chunks[*nchunks].from = from;
+	chunks[(*nchunks)++].to = offsets[cnt];
+	from = offsets[cnt];
+      }
+  chunks[*nchunks].from = from;
+  chunks[(*nchunks)++].to = size;
+
+  free (offsets);
+  return chunks;
+}
+
+
+static void
+disasm_chunk (size_t i, void *arg)
+{
+  struct disasm_chunks *chunks = arg;
+  struct disasm_chunk *chunk = &chunks->chunk[i];
+
+  FILE *out = open_memstream (&chunk->text, &chunk->size);
+  if (out == NULL)
+    error (EXIT_FAILURE, errno, _("cannot allocate memory"));
+  __fsetlocking (out, FSETLOCKING_BYCALLER);
+
+  struct disasm_info info =
+    {
+      .addr = chunks->addr + chunk->from,
+      .cur = chunks->buf + chunk->from,
+      .last_end = chunks->buf + chunk->from,
+      .address_color = chunks->address_color,
+      .bytes_color = chunks->bytes_color,
+      .out = out
+    };
+  disasm_cb (chunks->ctx, &info.cur, chunks->buf + chunk->to, info.addr,
+	     chunks->fmt, disasm_output, &info, NULL /* XXX */);
+
+  if (fclose (out) != 0)
+    error (EXIT_FAILURE, errno, _("cannot allocate memory"));
+}
+
+
+static void
+print_chunk (size_t i, void *arg)
+{
+  struct disasm_chunks *chunks = arg;
+  struct disasm_chunk *chunk = &chunks->chunk[i];
+
+  fwrite_unlocked (chunk->text, 1, chunk->size, stdout);
+  free (chunk->text);
+}
+
+
 static int
 show_disasm (Ebl *ebl, const char *fname, uint32_t shstrndx)
 {
@@ -742,8 +922,35 @@ show_disasm (Ebl *ebl, const char *fname, uint32_t shstrndx)
 	      fmt = "%7m %.1o,%.2o,%.3o%34a %l";
 	    }
 
-	  disasm_cb (ctx, &info.cur, info.cur + data->d_size, info.addr,
-		     fmt, disasm_output, &info, NULL /* XXX */);
+	  /* Large sections are disassembled in pieces at once, which
+	     are printed in order.  */
+	  size_t nchunks = 0;
+	  struct disasm_chunk *chunk = NULL;
+	  if (jobs != 1 && data->d_size > DISASM_CHUNK_SIZE)
+	    chunk = split_section (ebl->elf, scn, shdr, data->d_size,
+				   &nchunks);
+	  if (nchunks > 1)
+	    {
+	      struct disasm_chunks chunks =
+		{
+		  .ctx = ctx,
+		  .fmt = fmt,
+		  .buf = data->d_buf,
+		  .addr = info.addr,
+		  .address_color = info.address_color,
+		  .bytes_color = info.bytes_color,
+		  .chunk = chunk
+		};
+	      parallel_ordered (nchunks, jobs, disasm_chunk, print_chunk,
+				&chunks);
+	    }
+	  else
+	    {
+	      info.out = stdout;
+	      disasm_cb (ctx, &info.cur, info.cur + data->d_size, info.addr,
+			 fmt, disasm_output, &info, NULL /* XXX */);
+	    }
+	  free (chunk);
 
 	  if (color_mode)
 	    free (fmt);
@@ -40,8 +40,10 @@
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include <sys/param.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <signal.h>
 
 #include <system.h>
@@ -65,6 +67,9 @@ ARGP_PROGRAM_BUG_ADDRESS_DEF = PACKAGE_BUGREPORT;
 /* argp key value for --elf-section, non-ascii.  */
 #define ELF_INPUT_SECTION 256
 
+/* Size of the stdout buffer unless it is a terminal.  */
+#define OUTPUT_BUFSIZ	(256 * 1024)
+
 /* Definitions of arguments for argp functions.  */
 static const struct argp_option options[] =
 {
@@ -112,6 +117,9 @@ static const struct argp_option options[] =
     N_("Display just offsets instead of resolving values to addresses in DWARF data"), 0 },
   { "wide", 'W', NULL, 0,
     N_("Ignored for compatibility (lines always wide)"), 0 },
+  { "jobs", 'j', "JOBS", 0,
+    N_("Print up to JOBS DWARF sections or parts of them at once (default 1, "
+       "use 0 for one per CPU)"), 0 },
   { NULL, 0, NULL, 0, NULL, 0 }
 };
 
@@ -214,6 +222,9 @@ static enum section_e
 		 | section_macro)
 } print_debug_sections, implicit_debug_sections;
 
+/* How many DWARF sections or parts of them to print at once.  */
+static int jobs = 1;
+
 /* Select hex dumping of sections.  */
 static struct section_argument *dump_data_sections;
 static struct section_argument **dump_data_sections_tail = &dump_data_sections;
@@ -274,6 +285,11 @@ main (int argc, char *argv[])
   /* Initialize the message catalog.  */
   textdomain (PACKAGE_TARNAME);
 
+  /* The symbol tables and DWARF sections make for a lot of output.
+     Write it in big chunks unless someone is watching.  */
+  if (! isatty (STDOUT_FILENO))
+    setvbuf (stdout, xmalloc (OUTPUT_BUFSIZ), _IOFBF, OUTPUT_BUFSIZ);
+
   /* Parse and process arguments.  */
   int remaining;
   argp_parse (&argp, argc, argv, 0, &remaining, NULL);
@@ -305,8 +321,7 @@ main (int argc, char *argv[])
 
 /* Handle program arguments.  */
 static error_t
-parse_opt (int key, char *arg,
-	   struct argp_state *state __attribute__ ((unused)))
+parse_opt (int key, char *arg, struct argp_state *state)
 {
   void add_dump_section (const char *name, bool implicit)
   {
@@ -464,6 +479,14 @@ parse_opt (int key, char *arg,
     case 'U':
       print_unresolved_addresses = true;
       break;
+    case 'j':
+      jobs = atoi (arg);
+      if (jobs < 0)
+	{
+	  argp_error (state, gettext ("-j JOBS should be 0 or higher."));
+	  return EINVAL;
+	}
+      break;
     case ARGP_KEY_NO_ARGS:
       fputs (gettext ("Missing file name.\n"), stderr);
       goto do_argp_help;
@@ -801,6 +824,10 @@ process_elf_file (Dwfl_Module *dwflmod, int fd)
       return;
     }
 
+  /* Dumping all the DWARF data reads most of the file in order.  */
+  if (print_debug_sections == section_all)
+    (void) elf_cntl (elf, ELF_C_ADVISE_SEQUENTIAL);
+
   Ebl *ebl = ebl_openbackend (elf);
   if (unlikely (ebl == NULL))
     {
@@ -1727,6 +1754,30 @@ print_relocs (Ebl *ebl, GElf_Ehdr *ehdr)
 }
 
 
+/* Print one relocation for a symbol or section, with the same output
+   as "  %#0*" PRIx64 "  %-*s %#0*" PRIx64 "  %+6" PRId64 " %s\n" or,
+   without ADDEND, "  %#0*" PRIx64 "  %-*s %#0*" PRIx64 "  %s\n".  */
+static void
+print_reloc (int class, GElf_Addr offset, const char *type, int typewidth,
+	     GElf_Addr value, const GElf_Sxword *addend, const char *name)
+{
+  fputs_unlocked ("  ", stdout);
+  put_hex (stdout, offset, class == ELFCLASS32 ? 10 : 18, PUT_ALT | PUT_ZERO);
+  fputs_unlocked ("  ", stdout);
+  put_str (stdout, type, -typewidth);
+  putc_unlocked (' ', stdout);
+  put_hex (stdout, value, class == ELFCLASS32 ? 10 : 18, PUT_ALT | PUT_ZERO);
+  fputs_unlocked ("  ", stdout);
+  if (addend != NULL)
+    {
+      put_signed (stdout, *addend, 6, PUT_PLUS);
+      putc_unlocked (' ', stdout);
+    }
+  put_str (stdout, name, 0);
+  putc_unlocked ('\n', stdout);
+}
+
+
 /* Handle a relocation section.  */
 static void
 handle_relocs_rel (Ebl *ebl, GElf_Ehdr *ehdr, Elf_Scn *scn, GElf_Shdr *shdr)
@@ -1867,17 +1918,16 @@ handle_relocs_rel (Ebl *ebl, GElf_Ehdr *ehdr, Elf_Scn *scn, GElf_Shdr *shdr)
 			(long int) GELF_R_SYM (rel->r_info));
 	    }
 	  else if (GELF_ST_TYPE (sym->st_info) != STT_SECTION)
-	    printf ("  %#0*" PRIx64 "  %-20s %#0*" PRIx64 "  %s\n",
-		    class == ELFCLASS32 ? 10 : 18, rel->r_offset,
-		    likely (ebl_reloc_type_check (ebl,
-						  GELF_R_TYPE (rel->r_info)))
-		    /* Avoid the leading R_ which isn't carrying any
-		       information.  */
-		    ? ebl_reloc_type_name (ebl, GELF_R_TYPE (rel->r_info),
-					   buf, sizeof (buf)) + 2
-		    : gettext ("<INVALID RELOC>"),
-		    class == ELFCLASS32 ? 10 : 18, sym->st_value,
-		    elf_strptr (ebl->elf, symshdr->sh_link, sym->st_name));
+	    print_reloc (class, rel->r_offset,
+			 likely (ebl_reloc_type_check (ebl,
+						       GELF_R_TYPE (rel->r_info)))
+			 /* Avoid the leading R_ which isn't carrying any
+			    information.  */
+			 ? ebl_reloc_type_name (ebl, GELF_R_TYPE (rel->r_info),
+						buf, sizeof (buf)) + 2
+			 : gettext ("<INVALID RELOC>"), 20,
+			 sym->st_value, NULL,
+			 elf_strptr (ebl->elf, symshdr->sh_link, sym->st_name));
 	  else
 	    {
 	      destshdr = gelf_getshdr (elf_getscn (ebl->elf,
@@ -1898,16 +1948,18 @@ handle_relocs_rel (Ebl *ebl, GElf_Ehdr *ehdr, Elf_Scn *scn, GElf_Shdr *shdr)
 			(long int) (sym->st_shndx == SHN_XINDEX
 				    ? xndx : sym->st_shndx));
 	      else
-		printf ("  %#0*" PRIx64 "  %-20s %#0*" PRIx64 "  %s\n",
-			class == ELFCLASS32 ? 10 : 18, rel->r_offset,
-			ebl_reloc_type_check (ebl, GELF_R_TYPE (rel->r_info))
-			/* Avoid the leading R_ which isn't carrying any
-			   information.  */
-			? ebl_reloc_type_name (ebl, GELF_R_TYPE (rel->r_info),
-					       buf, sizeof (buf)) + 2
-			: gettext ("<INVALID RELOC>"),
-			class == ELFCLASS32 ? 10 : 18, sym->st_value,
-			elf_strptr (ebl->elf, shstrndx, destshdr->sh_name));
+		print_reloc (class, rel->r_offset,
+			     ebl_reloc_type_check (ebl,
+						   GELF_R_TYPE (rel->r_info))
+			     /* Avoid the leading R_ which isn't carrying any
+				information.  */
+			     ? ebl_reloc_type_name (ebl,
+						    GELF_R_TYPE (rel->r_info),
+						    buf, sizeof (buf)) + 2
+			     : gettext ("<INVALID RELOC>"), 20,
+			     sym->st_value, NULL,
+			     elf_strptr (ebl->elf, shstrndx,
+					 destshdr->sh_name));
 	    }
 	}
     }
@@ -2042,19 +2094,16 @@ handle_relocs_rela (Ebl *ebl, GElf_Ehdr *ehdr, Elf_Scn *scn, GElf_Shdr *shdr)
 			(long int) GELF_R_SYM (rel->r_info));
 	    }
 	  else if (GELF_ST_TYPE (sym->st_info) != STT_SECTION)
-	    printf ("\
-  %#0*" PRIx64 "  %-15s %#0*" PRIx64 "  %+6" PRId64 " %s\n",
-		    class == ELFCLASS32 ? 10 : 18, rel->r_offset,
-		    likely (ebl_reloc_type_check (ebl,
-						  GELF_R_TYPE (rel->r_info)))
-		    /* Avoid the leading R_ which isn't carrying any
-		       information.  */
-		    ? ebl_reloc_type_name (ebl, GELF_R_TYPE (rel->r_info),
-					   buf, sizeof (buf)) + 2
-		    : gettext ("<INVALID RELOC>"),
-		    class == ELFCLASS32 ? 10 : 18, sym->st_value,
-		    rel->r_addend,
-		    elf_strptr (ebl->elf, symshdr->sh_link, sym->st_name));
+	    print_reloc (class, rel->r_offset,
+			 likely (ebl_reloc_type_check (ebl,
+						       GELF_R_TYPE (rel->r_info)))
+			 /* Avoid the leading R_ which isn't carrying any
+			    information.  */
+			 ? ebl_reloc_type_name (ebl, GELF_R_TYPE (rel->r_info),
+						buf, sizeof (buf)) + 2
+			 : gettext ("<INVALID RELOC>"), 15,
+			 sym->st_value, &rel->r_addend,
+			 elf_strptr (ebl->elf, symshdr->sh_link, sym->st_name));
 	  else
 	    {
 	      destshdr = gelf_getshdr (elf_getscn (ebl->elf,
@@ -2075,18 +2124,18 @@ handle_relocs_rela (Ebl *ebl, GElf_Ehdr *ehdr, Elf_Scn *scn, GElf_Shdr *shdr)
 			(long int) (sym->st_shndx == SHN_XINDEX
 				    ? xndx : sym->st_shndx));
 	      else
-		printf ("\
-  %#0*" PRIx64 "  %-15s %#0*" PRIx64 "  %+6" PRId64 " %s\n",
-			class == ELFCLASS32 ? 10 : 18, rel->r_offset,
-			ebl_reloc_type_check (ebl, GELF_R_TYPE (rel->r_info))
-			/* Avoid the leading R_ which isn't carrying any
-			   information.  */
-			? ebl_reloc_type_name (ebl, GELF_R_TYPE (rel->r_info),
-					       buf, sizeof (buf)) + 2
-			: gettext ("<INVALID RELOC>"),
-			class == ELFCLASS32 ? 10 : 18, sym->st_value,
-			rel->r_addend,
-			elf_strptr (ebl->elf, shstrndx, destshdr->sh_name));
+		print_reloc (class, rel->r_offset,
+			     ebl_reloc_type_check (ebl,
+						   GELF_R_TYPE (rel->r_info))
+			     /* Avoid the leading R_ which isn't carrying any
+				information.  */
+			     ? ebl_reloc_type_name (ebl,
+						    GELF_R_TYPE (rel->r_info),
+						    buf, sizeof (buf)) + 2
+			     : gettext ("<INVALID RELOC>"), 15,
+			     sym->st_value, &rel->r_addend,
+			     elf_strptr (ebl->elf, shstrndx,
+					 destshdr->sh_name));
 	    }
 	}
     }
@@ -2214,20 +2263,31 @@ handle_symtab (Ebl *ebl, Elf_Scn *scn, GElf_Shdr *shdr)
       if (likely (sym->st_shndx != SHN_XINDEX))
 	xndx = sym->st_shndx;
 
-      printf (gettext ("\
-%5u: %0*" PRIx64 " %6" PRId64 " %-7s %-6s %-9s %6s %s"),
-	      cnt,
-	      class == ELFCLASS32 ? 8 : 16,
-	      sym->st_value,
-	      sym->st_size,
-	      ebl_symbol_type_name (ebl, GELF_ST_TYPE (sym->st_info),
-				    typebuf, sizeof (typebuf)),
-	      ebl_symbol_binding_name (ebl, GELF_ST_BIND (sym->st_info),
-				       bindbuf, sizeof (bindbuf)),
-	      get_visibility_type (GELF_ST_VISIBILITY (sym->st_other)),
-	      ebl_section_name (ebl, sym->st_shndx, xndx, scnbuf,
-				sizeof (scnbuf), NULL, shnum),
-	      elf_strptr (ebl->elf, shdr->sh_link, sym->st_name));
+      /* %5u: %0*" PRIx64 " %6" PRId64 " %-7s %-6s %-9s %6s %s  */
+      put_unsigned (stdout, cnt, 5, 0);
+      fputs_unlocked (": ", stdout);
+      put_hex (stdout, sym->st_value, class == ELFCLASS32 ? 8 : 16,
+	       PUT_ZERO);
+      putc_unlocked (' ', stdout);
+      put_signed (stdout, (int64_t) sym->st_size, 6, 0);
+      putc_unlocked (' ', stdout);
+      put_str (stdout,
+	       ebl_symbol_type_name (ebl, GELF_ST_TYPE (sym->st_info),
+				     typebuf, sizeof (typebuf)), -7);
+      putc_unlocked (' ', stdout);
+      put_str (stdout,
+	       ebl_symbol_binding_name (ebl, GELF_ST_BIND (sym->st_info),
+					bindbuf, sizeof (bindbuf)), -6);
+      putc_unlocked (' ', stdout);
+      put_str (stdout,
+	       get_visibility_type (GELF_ST_VISIBILITY (sym->st_other)), -9);
+      putc_unlocked (' ', stdout);
+      put_str (stdout,
+	       ebl_section_name (ebl, sym->st_shndx, xndx, scnbuf,
+				 sizeof (scnbuf), NULL, shnum), 6);
+      putc_unlocked (' ', stdout);
+      put_str (stdout, elf_strptr (ebl->elf, shdr->sh_link, sym->st_name),
+	       0);
 
       if (versym_data != NULL)
 	{
@@ -3801,6 +3861,18 @@ print_block (size_t n, const void *block)
     }
 }
 
+/* Print the start of an operation line, as printf would with
+   "%*s[%4" PRIuMAX "] %s".  */
+static void
+print_op_head (int indent, Dwarf_Word offset, const char *op_name)
+{
+  put_pad (stdout, indent);
+  putc_unlocked ('[', stdout);
+  put_unsigned (stdout, offset, 4, 0);
+  fputs_unlocked ("] ", stdout);
+  put_str (stdout, op_name, 0);
+}
+
 static void
 print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	   unsigned int vers, unsigned int addrsize, unsigned int offset_size,
@@ -3850,8 +3922,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  CONSUME (addrsize);
 
 	  char *a = format_dwarf_addr (dwflmod, 0, addr, addr);
-	  printf ("%*s[%4" PRIuMAX "] %s %s\n",
-		  indent, "", (uintmax_t) offset, op_name, a);
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_str (stdout, a, 0);
+	  putc_unlocked ('\n', stdout);
 	  free (a);
 
 	  offset += 1 + addrsize;
@@ -3870,9 +3944,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  data += ref_size;
 	  CONSUME (ref_size);
 
-	  printf ("%*s[%4" PRIuMAX "] %s %#" PRIxMAX "\n",
-		  indent, "", (uintmax_t) offset,
-		  op_name, (uintmax_t) addr);
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_hex (stdout, addr, 0, PUT_ALT);
+	  putc_unlocked ('\n', stdout);
 	  offset += 1 + ref_size;
 	  break;
 
@@ -3882,9 +3957,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	case DW_OP_const1u:
 	  // XXX value might be modified by relocation
 	  NEED (1);
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRIu8 "\n",
-		  indent, "", (uintmax_t) offset,
-		  op_name, *((uint8_t *) data));
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, *((uint8_t *) data), 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  ++data;
 	  --len;
 	  offset += 2;
@@ -3893,9 +3969,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	case DW_OP_const2u:
 	  NEED (2);
 	  // XXX value might be modified by relocation
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRIu16 "\n",
-		  indent, "", (uintmax_t) offset,
-		  op_name, read_2ubyte_unaligned (dbg, data));
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, read_2ubyte_unaligned (dbg, data), 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (2);
 	  data += 2;
 	  offset += 3;
@@ -3904,9 +3981,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	case DW_OP_const4u:
 	  NEED (4);
 	  // XXX value might be modified by relocation
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRIu32 "\n",
-		  indent, "", (uintmax_t) offset,
-		  op_name, read_4ubyte_unaligned (dbg, data));
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, read_4ubyte_unaligned (dbg, data), 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (4);
 	  data += 4;
 	  offset += 5;
@@ -3915,9 +3993,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	case DW_OP_const8u:
 	  NEED (8);
 	  // XXX value might be modified by relocation
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRIu64 "\n",
-		  indent, "", (uintmax_t) offset,
-		  op_name, (uint64_t) read_8ubyte_unaligned (dbg, data));
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, read_8ubyte_unaligned (dbg, data), 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (8);
 	  data += 8;
 	  offset += 9;
@@ -3926,9 +4005,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	case DW_OP_const1s:
 	  NEED (1);
 	  // XXX value might be modified by relocation
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRId8 "\n",
-		  indent, "", (uintmax_t) offset,
-		  op_name, *((int8_t *) data));
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_signed (stdout, *((int8_t *) data), 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  ++data;
 	  --len;
 	  offset += 2;
@@ -3937,9 +4017,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	case DW_OP_const2s:
 	  NEED (2);
 	  // XXX value might be modified by relocation
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRId16 "\n",
-		  indent, "", (uintmax_t) offset,
-		  op_name, read_2sbyte_unaligned (dbg, data));
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_signed (stdout, read_2sbyte_unaligned (dbg, data), 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (2);
 	  data += 2;
 	  offset += 3;
@@ -3948,9 +4029,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	case DW_OP_const4s:
 	  NEED (4);
 	  // XXX value might be modified by relocation
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRId32 "\n",
-		  indent, "", (uintmax_t) offset,
-		  op_name, read_4sbyte_unaligned (dbg, data));
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_signed (stdout, read_4sbyte_unaligned (dbg, data), 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (4);
 	  data += 4;
 	  offset += 5;
@@ -3959,9 +4041,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	case DW_OP_const8s:
 	  NEED (8);
 	  // XXX value might be modified by relocation
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRId64 "\n",
-		  indent, "", (uintmax_t) offset,
-		  op_name, read_8sbyte_unaligned (dbg, data));
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_signed (stdout, read_8sbyte_unaligned (dbg, data), 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (8);
 	  data += 8;
 	  offset += 9;
@@ -3975,8 +4058,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  uint64_t uleb;
 	  NEED (1);
 	  get_uleb128 (uleb, data); /* XXX check overrun */
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRIu64 "\n",
-		  indent, "", (uintmax_t) offset, op_name, uleb);
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, uleb, 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (data - start);
 	  offset += 1 + (data - start);
 	  break;
@@ -3987,8 +4072,12 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  NEED (2);
 	  get_uleb128 (uleb, data); /* XXX check overrun */
 	  get_uleb128 (uleb2, data); /* XXX check overrun */
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRIu64 ", %" PRIu64 "\n",
-		  indent, "", (uintmax_t) offset, op_name, uleb, uleb2);
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, uleb, 0, 0);
+	  fputs_unlocked (", ", stdout);
+	  put_unsigned (stdout, uleb2, 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (data - start);
 	  offset += 1 + (data - start);
 	  break;
@@ -4000,8 +4089,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  int64_t sleb;
 	  NEED (1);
 	  get_sleb128 (sleb, data); /* XXX check overrun */
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRId64 "\n",
-		  indent, "", (uintmax_t) offset, op_name, sleb);
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_signed (stdout, sleb, 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (data - start);
 	  offset += 1 + (data - start);
 	  break;
@@ -4011,26 +4102,32 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  NEED (2);
 	  get_uleb128 (uleb, data); /* XXX check overrun */
 	  get_sleb128 (sleb, data); /* XXX check overrun */
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRIu64 " %" PRId64 "\n",
-		  indent, "", (uintmax_t) offset, op_name, uleb, sleb);
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, uleb, 0, 0);
+	  putc_unlocked (' ', stdout);
+	  put_signed (stdout, sleb, 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (data - start);
 	  offset += 1 + (data - start);
 	  break;
 
 	case DW_OP_call2:
 	  NEED (2);
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRIu16 "\n",
-		  indent, "", (uintmax_t) offset, op_name,
-		  read_2ubyte_unaligned (dbg, data));
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, read_2ubyte_unaligned (dbg, data), 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (2);
 	  offset += 3;
 	  break;
 
 	case DW_OP_call4:
 	  NEED (4);
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRIu32 "\n",
-		  indent, "", (uintmax_t) offset, op_name,
-		  read_4ubyte_unaligned (dbg, data));
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, read_4ubyte_unaligned (dbg, data), 0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (4);
 	  offset += 5;
 	  break;
@@ -4038,9 +4135,11 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	case DW_OP_skip:
 	case DW_OP_bra:
 	  NEED (2);
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRIuMAX "\n",
-		  indent, "", (uintmax_t) offset, op_name,
-		  (uintmax_t) (offset + read_2sbyte_unaligned (dbg, data) + 3));
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, offset + read_2sbyte_unaligned (dbg, data) + 3,
+			0, 0);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (2);
 	  data += 2;
 	  offset += 3;
@@ -4050,8 +4149,8 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  start = data;
 	  NEED (1);
 	  get_uleb128 (uleb, data); /* XXX check overrun */
-	  printf ("%*s[%4" PRIuMAX "] %s: ",
-		  indent, "", (uintmax_t) offset, op_name);
+	  print_op_head (indent, offset, op_name);
+	  fputs_unlocked (": ", stdout);
 	  NEED (uleb);
 	  print_block (uleb, data);
 	  data += uleb;
@@ -4074,9 +4173,12 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  /* Byte offset operand.  */
 	  get_sleb128 (sleb, data); /* XXX check overrun */
 
-	  printf ("%*s[%4" PRIuMAX "] %s [%6" PRIxMAX "] %+" PRId64 "\n",
-		  indent, "", (intmax_t) offset,
-		  op_name, (uintmax_t) addr, sleb);
+	  print_op_head (indent, offset, op_name);
+	  fputs_unlocked (" [", stdout);
+	  put_hex (stdout, addr, 6, 0);
+	  fputs_unlocked ("] ", stdout);
+	  put_signed (stdout, sleb, 0, PUT_PLUS);
+	  putc_unlocked ('\n', stdout);
 	  CONSUME (data - start);
 	  offset += 1 + (data - start);
 	  break;
@@ -4086,8 +4188,8 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  start = data;
 	  NEED (1);
 	  get_uleb128 (uleb, data); /* XXX check overrun */
-	  printf ("%*s[%4" PRIuMAX "] %s:\n",
-		  indent, "", (uintmax_t) offset, op_name);
+	  print_op_head (indent, offset, op_name);
+	  fputs_unlocked (":\n", stdout);
 	  NEED (uleb);
 	  print_ops (dwflmod, dbg, indent + 6, indent + 6, vers,
 		     addrsize, offset_size, cu, uleb, data);
@@ -4106,8 +4208,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	    uleb += cu->start;
 	  uint8_t usize = *(uint8_t *) data++;
 	  NEED (usize);
-	  printf ("%*s[%4" PRIuMAX "] %s [%6" PRIxMAX "] ",
-		  indent, "", (uintmax_t) offset, op_name, uleb);
+	  print_op_head (indent, offset, op_name);
+	  fputs_unlocked (" [", stdout);
+	  put_hex (stdout, uleb, 6, 0);
+	  fputs_unlocked ("] ", stdout);
 	  print_block (usize, data);
 	  data += usize;
 	  CONSUME (data - start);
@@ -4123,8 +4227,12 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  get_uleb128 (uleb2, data); /* XXX check overrun */
 	  if (! print_unresolved_addresses && cu != NULL)
 	    uleb2 += cu->start;
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRIu64 " [%6" PRIx64 "]\n",
-		  indent, "", (uintmax_t) offset, op_name, uleb, uleb2);
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, uleb, 0, 0);
+	  fputs_unlocked (" [", stdout);
+	  put_hex (stdout, uleb2, 6, 0);
+	  fputs_unlocked ("]\n", stdout);
 	  CONSUME (data - start);
 	  offset += 1 + (data - start);
 	  break;
@@ -4138,9 +4246,12 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  get_uleb128 (uleb, data); /* XXX check overrun */
 	  if (! print_unresolved_addresses && cu != NULL)
 	    uleb += cu->start;
-	  printf ("%*s[%4" PRIuMAX "] %s %" PRIu8 " [%6" PRIxMAX "]\n",
-		  indent, "", (uintmax_t) offset,
-		  op_name, usize, uleb);
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, usize, 0, 0);
+	  fputs_unlocked (" [", stdout);
+	  put_hex (stdout, uleb, 6, 0);
+	  fputs_unlocked ("]\n", stdout);
 	  CONSUME (data - start);
 	  offset += 1 + (data - start);
 	  break;
@@ -4154,8 +4265,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  get_uleb128 (uleb, data); /* XXX check overrun */
 	  if (uleb != 0 && ! print_unresolved_addresses && cu != NULL)
 	    uleb += cu->start;
-	  printf ("%*s[%4" PRIuMAX "] %s [%6" PRIxMAX "]\n",
-		  indent, "", (uintmax_t) offset, op_name, uleb);
+	  print_op_head (indent, offset, op_name);
+	  fputs_unlocked (" [", stdout);
+	  put_hex (stdout, uleb, 6, 0);
+	  fputs_unlocked ("]\n", stdout);
 	  CONSUME (data - start);
 	  offset += 1 + (data - start);
 	  break;
@@ -4167,8 +4280,10 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 	  uintmax_t param_off = (uintmax_t) read_4ubyte_unaligned (dbg, data);
 	  if (! print_unresolved_addresses && cu != NULL)
 	    param_off += cu->start;
-	  printf ("%*s[%4" PRIuMAX "] %s [%6" PRIxMAX "]\n",
-		  indent, "", (uintmax_t) offset, op_name, param_off);
+	  print_op_head (indent, offset, op_name);
+	  fputs_unlocked (" [", stdout);
+	  put_hex (stdout, param_off, 6, 0);
+	  fputs_unlocked ("]\n", stdout);
 	  CONSUME (4);
 	  data += 4;
 	  offset += 5;
@@ -4176,8 +4291,8 @@ print_ops (Dwfl_Module *dwflmod, Dwarf *dbg, int indent, int indentrest,
 
 	default:
 	  /* No Operand.  */
-	  printf ("%*s[%4" PRIuMAX "] %s\n",
-		  indent, "", (uintmax_t) offset, op_name);
+	  print_op_head (indent, offset, op_name);
+	  putc_unlocked ('\n', stdout);
 	  ++offset;
 	  break;
 	}
@@ -5534,6 +5649,18 @@ struct attrcb_args
 };
 
 
+/* Print the start of an attribute line, as printf would with
+   "           %*s%-20s (%s)".  */
+static void
+print_attr_head (int level, unsigned int attr, unsigned int form)
+{
+  put_pad (stdout, 11 + level * 2);
+  put_str (stdout, dwarf_attr_name (attr), -20);
+  fputs_unlocked (" (", stdout);
+  put_str (stdout, dwarf_form_name (form), 0);
+  putc_unlocked (')', stdout);
+}
+
 static int
 attr_callback (Dwarf_Attribute *attrp, void *arg)
 {
@@ -5574,9 +5701,10 @@ attr_callback (Dwarf_Attribute *attrp, void *arg)
 	    }
 	  char *a = format_dwarf_addr (cbargs->dwflmod, cbargs->addrsize,
 				       addr, addr);
-	  printf ("           %*s%-20s (%s) %s\n",
-		  (int) (level * 2), "", dwarf_attr_name (attr),
-		  dwarf_form_name (form), a);
+	  print_attr_head (level, attr, form);
+	  putc_unlocked (' ', stdout);
+	  put_str (stdout, a, 0);
+	  putc_unlocked ('\n', stdout);
 	  free (a);
 	}
       break;
@@ -5590,9 +5718,10 @@ attr_callback (Dwarf_Attribute *attrp, void *arg)
       const char *str = dwarf_formstring (attrp);
       if (unlikely (str == NULL))
 	goto attrval_out;
-      printf ("           %*s%-20s (%s) \"%s\"\n",
-	      (int) (level * 2), "", dwarf_attr_name (attr),
-	      dwarf_form_name (form), str);
+      print_attr_head (level, attr, form);
+      fputs_unlocked (" \"", stdout);
+      put_str (stdout, str, 0);
+      fputs_unlocked ("\"\n", stdout);
       break;
 
     case DW_FORM_ref_addr:
@@ -5608,18 +5737,20 @@ attr_callback (Dwarf_Attribute *attrp, void *arg)
       if (unlikely (dwarf_formref_die (attrp, &ref) == NULL))
 	goto attrval_out;
 
-      printf ("           %*s%-20s (%s) [%6" PRIxMAX "]\n",
-	      (int) (level * 2), "", dwarf_attr_name (attr),
-	      dwarf_form_name (form), (uintmax_t) dwarf_dieoffset (&ref));
+      print_attr_head (level, attr, form);
+      fputs_unlocked (" [", stdout);
+      put_hex (stdout, dwarf_dieoffset (&ref), 6, 0);
+      fputs_unlocked ("]\n", stdout);
       break;
 
     case DW_FORM_ref_sig8:
       if (cbargs->silent)
 	break;
-      printf ("           %*s%-20s (%s) {%6" PRIx64 "}\n",
-	      (int) (level * 2), "", dwarf_attr_name (attr),
-	      dwarf_form_name (form),
-	      (uint64_t) read_8ubyte_unaligned (attrp->cu->dbg, attrp->valp));
+      print_attr_head (level, attr, form);
+      fputs_unlocked (" {", stdout);
+      put_hex (stdout, read_8ubyte_unaligned (attrp->cu->dbg, attrp->valp),
+	       6, 0);
+      fputs_unlocked ("}\n", stdout);
       break;
 
     case DW_FORM_sec_offset:
@@ -5643,9 +5774,12 @@ attr_callback (Dwarf_Attribute *attrp, void *arg)
 		  || (form != DW_FORM_data4 && form != DW_FORM_data8)))
 	    {
 	      if (!cbargs->silent)
-		printf ("           %*s%-20s (%s) %" PRIxMAX "\n",
-			(int) (level * 2), "", dwarf_attr_name (attr),
-			dwarf_form_name (form), (uintmax_t) num);
+		{
+		  print_attr_head (level, attr, form);
+		  putc_unlocked (' ', stdout);
+		  put_hex (stdout, num, 0, 0);
+		  putc_unlocked ('\n', stdout);
+		}
 	      return DWARF_CB_OK;
 	    }
 	  /* else fallthrough */
@@ -5667,9 +5801,12 @@ attr_callback (Dwarf_Attribute *attrp, void *arg)
 			  cbargs->addrsize, cbargs->offset_size,
 			  cbargs->cu, num);
 	  if (!cbargs->silent)
-	    printf ("           %*s%-20s (%s) location list [%6" PRIxMAX "]\n",
-		    (int) (level * 2), "", dwarf_attr_name (attr),
-		    dwarf_form_name (form), (uintmax_t) num);
+	    {
+	      print_attr_head (level, attr, form);
+	      fputs_unlocked (" location list [", stdout);
+	      put_hex (stdout, num, 6, 0);
+	      fputs_unlocked ("]\n", stdout);
+	    }
 	  return DWARF_CB_OK;
 
 	case DW_AT_ranges:
@@ -5677,9 +5814,12 @@ attr_callback (Dwarf_Attribute *attrp, void *arg)
 			  cbargs->addrsize, cbargs->offset_size,
 			  cbargs->cu, num);
 	  if (!cbargs->silent)
-	    printf ("           %*s%-20s (%s) range list [%6" PRIxMAX "]\n",
-		    (int) (level * 2), "", dwarf_attr_name (attr),
-		    dwarf_form_name (form), (uintmax_t) num);
+	    {
+	      print_attr_head (level, attr, form);
+	      fputs_unlocked (" range list [", stdout);
+	      put_hex (stdout, num, 6, 0);
+	      fputs_unlocked ("]\n", stdout);
+	    }
 	  return DWARF_CB_OK;
 
 	case DW_AT_language:
@@ -5727,9 +5867,12 @@ attr_callback (Dwarf_Attribute *attrp, void *arg)
 	{
 	  char *a = format_dwarf_addr (cbargs->dwflmod, cbargs->addrsize,
 				       highpc, highpc);
-	  printf ("           %*s%-20s (%s) %" PRIuMAX " (%s)\n",
-		  (int) (level * 2), "", dwarf_attr_name (attr),
-		  dwarf_form_name (form), (uintmax_t) num, a);
+	  print_attr_head (level, attr, form);
+	  putc_unlocked (' ', stdout);
+	  put_unsigned (stdout, num, 0, 0);
+	  fputs_unlocked (" (", stdout);
+	  put_str (stdout, a, 0);
+	  fputs_unlocked (")\n", stdout);
 	  free (a);
 	}
       else
@@ -5739,26 +5882,18 @@ attr_callback (Dwarf_Attribute *attrp, void *arg)
 	    if (unlikely (dwarf_formsdata (attrp, &snum) != 0))
 	      goto attrval_out;
 
-	  if (valuestr == NULL)
+	  print_attr_head (level, attr, form);
+	  if (valuestr != NULL)
 	    {
-	      printf ("           %*s%-20s (%s)",
-		      (int) (level * 2), "", dwarf_attr_name (attr),
-		      dwarf_form_name (form));
-	      if (form == DW_FORM_sdata)
-		printf (" %" PRIdMAX "\n", (intmax_t) snum);
-	      else
-		printf (" %" PRIuMAX "\n", (uintmax_t) num);
+	      putc_unlocked (' ', stdout);
+	      put_str (stdout, valuestr, 0);
 	    }
+	  fputs_unlocked (valuestr == NULL ? " " : " (", stdout);
+	  if (form == DW_FORM_sdata)
+	    put_signed (stdout, snum, 0, 0);
 	  else
-	    {
-	      printf ("           %*s%-20s (%s) %s",
-		      (int) (level * 2), "", dwarf_attr_name (attr),
-		      dwarf_form_name (form), valuestr);
-	      if (form == DW_FORM_sdata)
-		printf (" (%" PRIdMAX ")\n", (intmax_t) snum);
-	      else
-		printf (" (%" PRIuMAX ")\n", (uintmax_t) num);
-	    }
+	    put_unsigned (stdout, num, 0, 0);
+	  fputs_unlocked (valuestr == NULL ? "\n" : ")\n", stdout);
 	}
       break;
 
@@ -5769,17 +5904,19 @@ attr_callback (Dwarf_Attribute *attrp, void *arg)
       if (unlikely (dwarf_formflag (attrp, &flag) != 0))
 	goto attrval_out;
 
-      printf ("           %*s%-20s (%s) %s\n",
-	      (int) (level * 2), "", dwarf_attr_name (attr),
-	      dwarf_form_name (form), nl_langinfo (flag ? YESSTR : NOSTR));
+      print_attr_head (level, attr, form);
+      putc_unlocked (' ', stdout);
+      put_str (stdout, nl_langinfo (flag ? YESSTR : NOSTR), 0);
+      putc_unlocked ('\n', stdout);
       break;
 
     case DW_FORM_flag_present:
       if (cbargs->silent)
 	break;
-      printf ("           %*s%-20s (%s) %s\n",
-	      (int) (level * 2), "", dwarf_attr_name (attr),
-	      dwarf_form_name (form), nl_langinfo (YESSTR));
+      print_attr_head (level, attr, form);
+      putc_unlocked (' ', stdout);
+      put_str (stdout, nl_langinfo (YESSTR), 0);
+      putc_unlocked ('\n', stdout);
       break;
 
     case DW_FORM_exprloc:
@@ -5793,9 +5930,8 @@ attr_callback (Dwarf_Attribute *attrp, void *arg)
       if (unlikely (dwarf_formblock (attrp, &block) != 0))
 	goto attrval_out;
 
-      printf ("           %*s%-20s (%s) ",
-	      (int) (level * 2), "", dwarf_attr_name (attr),
-	      dwarf_form_name (form));
+      print_attr_head (level, attr, form);
+      putc_unlocked (' ', stdout);
 
       switch (attr)
 	{
@@ -5851,6 +5987,17 @@ attr_callback (Dwarf_Attribute *attrp, void *arg)
   return DWARF_CB_OK;
 }
 
+/* Only the units of .debug_info, .debug_types and .debug_line starting
+   in [UNITS_START, UNITS_END) are printed, and the section heading only
+   with the first unit.  This lets parts of a section be printed apart.
+   UNITS_NEXT is set to where the unit after them starts when reaching
+   UNITS_END, and UNITS_STOPPED when we gave up on the section before
+   its end.  */
+static Dwarf_Off units_start;
+static Dwarf_Off units_end = (Dwarf_Off) -1;
+static Dwarf_Off units_next;
+static bool units_stopped;
+
 static void
 print_debug_units (Dwfl_Module *dwflmod,
 		   Ebl *ebl, GElf_Ehdr *ehdr,
@@ -5860,7 +6007,7 @@ print_debug_units (Dwfl_Module *dwflmod,
   const bool silent = !(print_debug_sections & section_info);
   const char *secname = section_name (ebl, ehdr, shdr);
 
-  if (!silent)
+  if (!silent && units_start == 0)
     printf (gettext ("\
 \nDWARF section [%2zu] '%s' at offset %#" PRIx64 ":\n [Offset]\n"),
 	    elf_ndxscn (scn), secname, (uint64_t) shdr->sh_offset);
@@ -5872,7 +6019,7 @@ print_debug_units (Dwfl_Module *dwflmod,
   int maxdies = 20;
   Dwarf_Die *dies = (Dwarf_Die *) xmalloc (maxdies * sizeof (Dwarf_Die));
 
-  Dwarf_Off offset = 0;
+  Dwarf_Off offset = units_start;
 
   /* New compilation unit.  */
   size_t cuhl;
@@ -5884,6 +6031,11 @@ print_debug_units (Dwfl_Module *dwflmod,
   uint64_t typesig;
   Dwarf_Off typeoff;
  next_cu:
+  if (offset >= units_end)
+    {
+      units_next = offset;
+      goto do_return;
+    }
   if (dwarf_next_unit (dbg, offset, &nextcu, &cuhl, &version,
 		       &abbroffset, &addrsize, &offsize,
 		       debug_types ? &typesig : NULL,
@@ -5930,7 +6082,7 @@ print_debug_units (Dwfl_Module *dwflmod,
 	error (0, 0, gettext ("cannot get DIE at offset %" PRIu64
 			      " in section '%s': %s"),
 	       (uint64_t) offset, secname, dwarf_errmsg (-1));
-      goto do_return;
+      goto stop;
     }
 
   args.cu = dies[0].cu;
@@ -5943,7 +6095,7 @@ print_debug_units (Dwfl_Module *dwflmod,
 	  if (!silent)
 	    error (0, 0, gettext ("cannot get DIE offset: %s"),
 		   dwarf_errmsg (-1));
-	  goto do_return;
+	  goto stop;
 	}
 
       int tag = dwarf_tag (&dies[level]);
@@ -5953,13 +6105,19 @@ print_debug_units (Dwfl_Module *dwflmod,
 	    error (0, 0, gettext ("cannot get tag of DIE at offset %" PRIu64
 				  " in section '%s': %s"),
 		   (uint64_t) offset, secname, dwarf_errmsg (-1));
-	  goto do_return;
+	  goto stop;
 	}
 
       if (!silent)
-	printf (" [%6" PRIx64 "]  %*s%s\n",
-		(uint64_t) offset, (int) (level * 2), "",
-		dwarf_tag_name (tag));
+	{
+	  /* " [%6" PRIx64 "]  %*s%s\n"  */
+	  fputs_unlocked (" [", stdout);
+	  put_hex (stdout, offset, 6, 0);
+	  fputs_unlocked ("]  ", stdout);
+	  put_pad (stdout, level * 2);
+	  put_str (stdout, dwarf_tag_name (tag), 0);
+	  putc_unlocked ('\n', stdout);
+	}
 
       /* Print the attribute values.  */
       args.level = level;
@@ -5984,7 +6142,7 @@ print_debug_units (Dwfl_Module *dwflmod,
 	      if (!silent)
 		error (0, 0, gettext ("cannot get next DIE: %s\n"),
 		       dwarf_errmsg (-1));
-	      goto do_return;
+	      goto stop;
 	    }
 	}
       else if (unlikely (res < 0))
@@ -5992,7 +6150,7 @@ print_debug_units (Dwfl_Module *dwflmod,
 	  if (!silent)
 	    error (0, 0, gettext ("cannot get next DIE: %s"),
 		   dwarf_errmsg (-1));
-	  goto do_return;
+	  goto stop;
 	}
       else
 	++level;
@@ -6005,6 +6163,11 @@ print_debug_units (Dwfl_Module *dwflmod,
 
  do_return:
   free (dies);
+  return;
+
+ stop:
+  units_stopped = true;
+  goto do_return;
 }
 
 static void
@@ -6112,10 +6275,11 @@ print_debug_line_section (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr,
       return;
     }
 
-  printf (gettext ("\
+  if (units_start == 0)
+    printf (gettext ("\
 \nDWARF section [%2zu] '%s' at offset %#" PRIx64 ":\n"),
-	  elf_ndxscn (scn), section_name (ebl, ehdr, shdr),
-	  (uint64_t) shdr->sh_offset);
+	    elf_ndxscn (scn), section_name (ebl, ehdr, shdr),
+	    (uint64_t) shdr->sh_offset);
 
   if (shdr->sh_size == 0)
     return;
@@ -6127,16 +6291,27 @@ print_debug_line_section (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr,
     {
       error (0, 0, gettext ("cannot get line data section data: %s"),
 	     elf_errmsg (-1));
+      units_stopped = true;
       return;
     }
 
   const unsigned char *linep = (const unsigned char *) data->d_buf;
   const unsigned char *lineendp;
 
+  if (units_start < data->d_size)
+    linep += units_start;
+  else
+    linep += data->d_size;
+
   while (linep
 	 < (lineendp = (const unsigned char *) data->d_buf + data->d_size))
     {
       size_t start_offset = linep - (const unsigned char *) data->d_buf;
+      if (start_offset >= units_end)
+	{
+	  units_next = start_offset;
+	  break;
+	}
 
       printf (gettext ("\nTable at offset %Zu:\n"), start_offset);
 
@@ -6149,6 +6324,7 @@ print_debug_line_section (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr,
 	    invalid_data:
 	      error (0, 0, gettext ("invalid data in section [%zu] '%s'"),
 		     elf_ndxscn (scn), section_name (ebl, ehdr, shdr));
+	      units_stopped = true;
 	      return;
 	    }
 	  unit_length = read_8ubyte_unaligned_inc (dbg, linep);
@@ -7862,6 +8038,270 @@ print_gdb_index_section (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr,
     }
 }
 
+/* A DWARF section, or a range of units in it, to be printed by a
+   process of its own.  */
+struct debug_part
+{
+  void (*fp) (Dwfl_Module *, Ebl *, GElf_Ehdr *, Elf_Scn *, GElf_Shdr *,
+	      Dwarf *);
+  enum section_e bitmask;
+  Elf_Scn *scn;
+  GElf_Shdr shdr;
+  Dwarf_Off start;
+  Dwarf_Off end;
+  bool stopped;
+};
+
+struct debug_parts
+{
+  Dwfl_Module *dwflmod;
+  Ebl *ebl;
+  GElf_Ehdr *ehdr;
+  Dwarf *dbg;
+  size_t n;
+  size_t alloc;
+  struct debug_part *parts;
+  Dwarf_Off *next;		/* Shared with the children.  */
+};
+
+/* What print_debug_part tells finish_debug_part in its exit status.  */
+#define PART_STOPPED	1
+#define PART_ERRORS	2
+
+static struct debug_part *
+add_debug_part (struct debug_parts *parts, struct debug_part *part,
+		Dwarf_Off start, Dwarf_Off end)
+{
+  if (parts->n == parts->alloc)
+    {
+      parts->alloc = parts->alloc == 0 ? 16 : parts->alloc * 2;
+      parts->parts = xrealloc (parts->parts,
+			       parts->alloc * sizeof parts->parts[0]);
+    }
+
+  struct debug_part *p = &parts->parts[parts->n++];
+  *p = *part;
+  p->start = start;
+  p->end = end;
+  return p;
+}
+
+/* Split .debug_info or .debug_types into parts of about SIZE bytes
+   each, at unit boundaries.  Whatever cannot be walked goes into the
+   last part.  */
+static void
+split_debug_units (struct debug_parts *parts, struct debug_part *part,
+		   Dwarf_Off size)
+{
+  bool debug_types = part->fp == print_debug_types_section;
+  Dwarf_Off start = 0;
+  Dwarf_Off offset = 0;
+  Dwarf_Off next;
+  size_t hsize;
+  uint64_t typesig;
+  Dwarf_Off typeoff;
+  while (dwarf_next_unit (parts->dbg, offset, &next, &hsize, NULL, NULL,
+			  NULL, NULL, debug_types ? &typesig : NULL,
+			  debug_types ? &typeoff : NULL) == 0
+	 && next > offset)
+    {
+      offset = next;
+      if (offset - start >= size)
+	{
+	  add_debug_part (parts, part, start, offset);
+	  start = offset;
+	}
+    }
+  add_debug_part (parts, part, start, (Dwarf_Off) -1);
+}
+
+/* Likewise for the line number programs in .debug_line, finding them
+   the same way print_debug_line_section does.  */
+static void
+split_debug_lines (struct debug_parts *parts, struct debug_part *part,
+		   Dwarf_Off size)
+{
+  Elf_Data *data = elf_getdata (part->scn, NULL);
+  Dwarf_Off start = 0;
+  if (data != NULL && data->d_buf != NULL)
+    {
+      Dwarf *dbg = parts->dbg;
+      const unsigned char *linep = data->d_buf;
+      const unsigned char *endp = linep + data->d_size;
+      while (endp - linep >= 4)
+	{
+	  Dwarf_Word unit_length = read_4ubyte_unaligned_inc (dbg, linep);
+	  unsigned int length = 4;
+	  if (unit_length == 0xffffffff)
+	    {
+	      if (endp - linep < 8)
+		break;
+	      unit_length = read_8ubyte_unaligned_inc (dbg, linep);
+	      length = 8;
+	    }
+	  if (unit_length < 2 + length + 5 * 1
+	      || unit_length > (Dwarf_Word) (endp - linep))
+	    break;
+	  linep += unit_length;
+
+	  Dwarf_Off offset = linep - (const unsigned char *) data->d_buf;
+	  if (offset - start >= size)
+	    {
+	      add_debug_part (parts, part, start, offset);
+	      start = offset;
+	    }
+	}
+    }
+  add_debug_part (parts, part, start, (Dwarf_Off) -1);
+}
+
+static int
+print_debug_part (size_t i, void *arg)
+{
+  struct debug_parts *parts = arg;
+  struct debug_part *part = &parts->parts[i];
+  unsigned int errors = error_message_count;
+
+  units_start = part->start;
+  units_end = part->end;
+  units_next = (Dwarf_Off) -1;
+  units_stopped = false;
+  part->fp (parts->dwflmod, parts->ebl, parts->ehdr, part->scn, &part->shdr,
+	    parts->dbg);
+  if (parts->next != NULL)
+    parts->next[i] = units_next;
+  units_start = 0;
+  units_end = (Dwarf_Off) -1;
+
+  return ((units_stopped ? PART_STOPPED : 0)
+	  | (error_message_count != errors ? PART_ERRORS : 0));
+}
+
+static bool
+finish_debug_part (size_t i, int status, void *arg)
+{
+  struct debug_parts *parts = arg;
+  struct debug_part *part = &parts->parts[i];
+
+  if (i > 0 && part[-1].scn == part->scn)
+    {
+      /* Printing the section by itself would have given up before.  */
+      if (part[-1].stopped)
+	{
+	  part->stopped = true;
+	  return false;
+	}
+
+      /* Or gone on somewhere else than where this part starts, which
+	 happens with data we do not understand.  Go on from there.  */
+      if (parts->next[i - 1] != part->start)
+	{
+	  struct debug_part rest = *part;
+	  rest.start = parts->next[i - 1];
+	  rest.end = (Dwarf_Off) -1;
+	  *part = rest;
+	  print_debug_part (i, arg);
+	  part->stopped = true;
+	  return false;
+	}
+    }
+
+  /* Without a process of our own print the part right here.  */
+  if (status == -1)
+    status = W_EXITCODE (print_debug_part (i, arg), 0);
+
+  if (WIFEXITED (status))
+    {
+      if (WEXITSTATUS (status) & PART_STOPPED)
+	part->stopped = true;
+      if (WEXITSTATUS (status) & PART_ERRORS)
+	++error_message_count;
+    }
+  else
+    {
+      part->stopped = true;
+      error (0, 0, gettext ("cannot print section [%zu] '%s': %s"),
+	     elf_ndxscn (part->scn),
+	     section_name (parts->ebl, parts->ehdr, &part->shdr),
+	     WIFSIGNALED (status) ? strsignal (WTERMSIG (status)) : "?");
+    }
+
+  return true;
+}
+
+/* Print the collected sections, several at once, with the output in
+   the same order as when printing one after the other.  The big
+   .debug_info, .debug_types and .debug_line sections are split into
+   ranges of units.  */
+static void
+print_debug_parts (struct debug_parts *sections)
+{
+  const enum section_e listptr_sections = section_loc | section_ranges;
+  bool listptr = (print_debug_sections & listptr_sections) != 0;
+
+  /* The location and range lists are printed using what was noticed
+     in the units before them.  Unless all units come first, print
+     everything in order.  */
+  if (listptr)
+    {
+      bool seen_listptr = false;
+      for (size_t i = 0; i < sections->n; ++i)
+	if (sections->parts[i].bitmask & listptr_sections)
+	  seen_listptr = true;
+	else if ((sections->parts[i].bitmask & section_info) && seen_listptr)
+	  {
+	    for (size_t j = 0; j < sections->n; ++j)
+	      print_debug_part (j, sections);
+	    return;
+	  }
+
+      /* Notice them here first so that the lists can be printed
+	 apart from the units.  */
+      enum section_e saved = print_debug_sections;
+      print_debug_sections &= ~section_info;
+      for (size_t i = 0; i < sections->n; ++i)
+	if (sections->parts[i].bitmask & section_info)
+	  print_debug_part (i, sections);
+      print_debug_sections = saved;
+    }
+
+  struct debug_parts parts = *sections;
+  parts.n = parts.alloc = 0;
+  parts.parts = NULL;
+
+  size_t njobs = parallel_jobs (jobs);
+  for (size_t i = 0; i < sections->n; ++i)
+    {
+      struct debug_part *part = &sections->parts[i];
+      Dwarf_Off size = MAX (part->shdr.sh_size / (njobs * 8), 1);
+      if (part->bitmask & section_info)
+	{
+	  /* Only needed for noticing the lists, which is done.  */
+	  if ((print_debug_sections & section_info) != 0)
+	    split_debug_units (&parts, part, size);
+	}
+      else if (part->fp == print_debug_line_section && !decodedline)
+	split_debug_lines (&parts, part, size);
+      else
+	add_debug_part (&parts, part, 0, (Dwarf_Off) -1);
+    }
+
+  if (parts.n == 0)
+    return;
+
+  size_t next_size = parts.n * sizeof parts.next[0];
+  parts.next = mmap (NULL, next_size, PROT_READ | PROT_WRITE,
+		     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (parts.next == MAP_FAILED)
+    error (EXIT_FAILURE, 0, gettext ("memory exhausted"));
+
+  parallel_ordered_fork (parts.n, jobs, print_debug_part, finish_debug_part,
+			 &parts);
+
+  munmap (parts.next, next_size);
+  free (parts.parts);
+}
+
 static void
 print_debug (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr)
 {
@@ -7889,6 +8329,14 @@ print_debug (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr)
     error (EXIT_FAILURE, 0,
 	   gettext ("cannot get section header string table index"));
 
+  struct debug_parts sections =
+    {
+      .dwflmod = dwflmod,
+      .ebl = ebl,
+      .ehdr = ehdr,
+      .dbg = dbg
+    };
+
   /* Look through all the sections for the debugging sections to print.  */
   Elf_Scn *scn = NULL;
   while ((scn = elf_nextscn (ebl->elf, scn)) != NULL)
@@ -7943,14 +8391,33 @@ print_debug (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr)
 #endif
 		)
 	      {
-		if ((print_debug_sections | implicit_debug_sections)
-		    & debug_sections[n].bitmask)
+		if (((print_debug_sections | implicit_debug_sections)
+		     & debug_sections[n].bitmask) == 0)
+		  ;
+		else if (jobs != 1)
+		  {
+		    struct debug_part part =
+		      {
+			.fp = debug_sections[n].fp,
+			.bitmask = debug_sections[n].bitmask,
+			.scn = scn,
+			.shdr = *shdr
+		      };
+		    add_debug_part (&sections, &part, 0, (Dwarf_Off) -1);
+		  }
+		else
 		  debug_sections[n].fp (dwflmod, ebl, ehdr, scn, shdr, dbg);
 		break;
 	      }
 	}
     }
 
+  if (sections.n > 0)
+    {
+      print_debug_parts (&sections);
+      free (sections.parts);
+    }
+
   reset_listptr (&known_loclistptr);
   reset_listptr (&known_rangelistptr);
 }
@@ -26,6 +26,8 @@
 #include <string.h>
 #include <locale.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
 #include ELFUTILS_HEADER(dwfl)
 
 #include <dwarf.h>
@@ -41,6 +43,9 @@ ARGP_PROGRAM_BUG_ADDRESS_DEF = PACKAGE_BUGREPORT;
 /* non-printable argp options.  */
 #define OPT_DEBUGINFO	0x100
 #define OPT_COREFILE	0x101
+#define OPT_SAMPLE	0x102
+#define OPT_DURATION	0x103
+#define OPT_FOLDED	0x104
 
 static bool show_activation = false;
 static bool show_module = false;
@@ -54,6 +59,12 @@ static bool show_debugname = false;
 static bool show_inlines = false;
 
 static int maxframes = 256;
+static int jobs = 1;
+
+/* Sample frequency in Hz for the profiler mode, zero if not sampling.  */
+static double sample_hz = 0;
+static double sample_duration = 10;
+static bool show_folded = false;
 
 struct frame
 {
@@ -68,6 +79,56 @@ struct frames
   struct frame *frame;
 };
 
+/* Backtrace of one thread collected by -j, printed later in order.  */
+struct thread_frames
+{
+  pid_t tid;
+  int err;
+  struct frames frames;
+};
+
+static pthread_mutex_t thread_frames_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct thread_frames **thread_frames;
+static size_t nthread_frames;
+
+/* A distinct stack seen while sampling and how often it was seen.  */
+struct sample
+{
+  unsigned long int count;
+  struct frames frames;
+};
+
+static int
+compare_frames (const struct frames *a, const struct frames *b)
+{
+  if (a->frames != b->frames)
+    return a->frames < b->frames ? -1 : 1;
+  for (int i = 0; i < a->frames; i++)
+    {
+      if (a->frame[i].pc != b->frame[i].pc)
+	return a->frame[i].pc < b->frame[i].pc ? -1 : 1;
+      if (a->frame[i].isactivation != b->frame[i].isactivation)
+	return a->frame[i].isactivation ? 1 : -1;
+    }
+  return 0;
+}
+
+#define NAME sample_tab
+#define TYPE struct sample *
+#define ITERATE 1
+#define COMPARE(a, b) compare_frames (&(a)->frames, &(b)->frames)
+#define NO_UNDEF
+#include <dynamicsizehash.h>
+#undef NO_UNDEF
+#include "../lib/dynamicsizehash.c"
+#undef NAME
+#undef TYPE
+#undef ITERATE
+#undef COMPARE
+
+static sample_tab samples;
+static unsigned long int nsamples;
+
 static Dwfl *dwfl = NULL;
 static pid_t pid = 0;
 static int core_fd = -1;
@@ -212,6 +273,24 @@ die_name (Dwarf_Die *die)
   return name;
 }
 
+/* The result is only valid till the next call.  */
+static const char *
+demangle (const char *symname)
+{
+#ifdef USE_DEMANGLE
+  // Require GNU v3 ABI by the "_Z" prefix.
+  if (! show_raw && symname[0] == '_' && symname[1] == 'Z')
+    {
+      int status = -1;
+      char *dsymname = __cxa_demangle (symname, demangle_buffer,
+				       &demangle_buffer_len, &status);
+      if (status == 0)
+	symname = demangle_buffer = dsymname;
+    }
+#endif
+  return symname;
+}
+
 static void
 print_frame (int nr, Dwarf_Addr pc, bool isactivation,
 	     Dwarf_Addr pc_adjusted, Dwfl_Module *mod,
@@ -225,20 +304,7 @@ print_frame (int nr, Dwarf_Addr pc, bool isactivation,
     printf ("%4s", ! isactivation ? "- 1" : "");
 
   if (symname != NULL)
-    {
-#ifdef USE_DEMANGLE
-      // Require GNU v3 ABI by the "_Z" prefix.
-      if (! show_raw && symname[0] == '_' && symname[1] == 'Z')
-	{
-	  int status = -1;
-	  char *dsymname = __cxa_demangle (symname, demangle_buffer,
-					   &demangle_buffer_len, &status);
-	  if (status == 0)
-	    symname = demangle_buffer = dsymname;
-	}
-#endif
-      printf (" %s", symname);
-    }
+    printf (" %s", demangle (symname));
 
   const char* fname;
   Dwarf_Addr start;
@@ -356,13 +422,10 @@ print_inline_frames (int *nr, Dwarf_Addr pc, bool isactivation,
   free (scopes);
 }
 
-static void
-print_frames (struct frames *frames, pid_t tid, int dwflerr, const char *what)
+/* Print FRAMES and return the number of frames printed.  */
+static int
+print_frame_list (struct frames *frames)
 {
-  if (frames->frames > 0)
-    frames_shown = true;
-
-  printf ("TID %d:\n", tid);
   int frame_nr = 0;
   for (int nr = 0; nr < frames->frames && (maxframes == 0
 					   || frame_nr < maxframes); nr++)
@@ -417,6 +480,17 @@ print_frames (struct frames *frames, pid_t tid, int dwflerr, const char *what)
 	print_frame (frame_nr++, pc, isactivation, pc_adjusted, mod, symname,
 		     NULL, NULL);
     }
+  return frame_nr;
+}
+
+static void
+print_frames (struct frames *frames, pid_t tid, int dwflerr, const char *what)
+{
+  if (frames->frames > 0)
+    frames_shown = true;
+
+  printf ("TID %d:\n", tid);
+  int frame_nr = print_frame_list (frames);
 
   if (frames->frames > 0 && frame_nr == maxframes)
     error (0, 0, "tid %d: shown max number of frames "
@@ -470,6 +544,342 @@ thread_callback (Dwfl_Thread *thread, void *thread_arg)
   return DWARF_CB_OK;
 }
 
+static void
+alloc_frames (struct frames *frames)
+{
+  /* When maxframes is zero, then 2048 is just the initial allocation
+     that will be increased using realloc in framecallback ().  */
+  frames->allocated = maxframes == 0 ? 2048 : maxframes;
+  frames->frames = 0;
+  frames->frame = malloc (sizeof (struct frame) * frames->allocated);
+  if (frames->frame == NULL)
+    error (EXIT_BAD, errno, "malloc frames.frame");
+}
+
+/* Called for -j from several threads at once.  Only unwind here, the
+   symbol lookup and printing happens in order afterwards.  */
+static int
+parallel_thread_callback (Dwfl_Thread *thread, size_t ndx,
+			  void *arg __attribute__ ((unused)))
+{
+  struct thread_frames *tf = malloc (sizeof *tf);
+  if (tf == NULL)
+    error (EXIT_BAD, errno, "malloc thread_frames");
+  tf->tid = dwfl_thread_tid (thread);
+  tf->err = 0;
+  alloc_frames (&tf->frames);
+  switch (dwfl_thread_getframes (thread, frame_callback, &tf->frames))
+    {
+    case DWARF_CB_OK:
+    case DWARF_CB_ABORT:
+      break;
+    case -1:
+      tf->err = dwfl_errno ();
+      break;
+    default:
+      abort ();
+    }
+
+  pthread_mutex_lock (&thread_frames_lock);
+  if (ndx >= nthread_frames)
+    {
+      size_t n = nthread_frames == 0 ? 64 : nthread_frames * 2;
+      if (n <= ndx)
+	n = ndx + 1;
+      thread_frames = realloc (thread_frames, n * sizeof thread_frames[0]);
+      if (thread_frames == NULL)
+	error (EXIT_BAD, errno, "realloc thread_frames");
+      memset (&thread_frames[nthread_frames], 0,
+	      (n - nthread_frames) * sizeof thread_frames[0]);
+      nthread_frames = n;
+    }
+  thread_frames[ndx] = tf;
+  pthread_mutex_unlock (&thread_frames_lock);
+  return DWARF_CB_OK;
+}
+
+static void
+record_sample (struct frames *frames)
+{
+  if (frames->frames == 0)
+    return;
+
+  unsigned long int hval = frames->frames;
+  for (int i = 0; i < frames->frames; i++)
+    hval = hval * 31 + frames->frame[i].pc;
+  /* Zero marks an empty hash table entry.  */
+  if (hval == 0)
+    hval = 1;
+
+  struct sample key = { .frames = *frames };
+  struct sample *sample = sample_tab_find (&samples, hval, &key);
+  if (sample == NULL)
+    {
+      sample = xmalloc (sizeof *sample);
+      sample->count = 0;
+      sample->frames.frames = frames->frames;
+      sample->frames.allocated = frames->frames;
+      sample->frames.frame = xmalloc (frames->frames
+				      * sizeof sample->frames.frame[0]);
+      memcpy (sample->frames.frame, frames->frame,
+	      frames->frames * sizeof frames->frame[0]);
+      if (sample_tab_insert (&samples, hval, sample) != 0)
+	error (EXIT_BAD, errno, "sample_tab_insert");
+    }
+  sample->count++;
+  nsamples++;
+}
+
+static int
+sample_thread_callback (Dwfl_Thread *thread, void *thread_arg)
+{
+  struct frames *frames = (struct frames *) thread_arg;
+  frames->frames = 0;
+  /* Threads come and go while sampling, a thread that cannot be
+     unwound (anymore) is just not part of this sample.  */
+  dwfl_thread_getframes (thread, frame_callback, thread_arg);
+  record_sample (frames);
+  return DWARF_CB_OK;
+}
+
+/* Take one sample of all threads, or just PID for -1.  Returns false
+   when the process is gone.  */
+static bool
+take_sample (struct frames *frames)
+{
+  /* Pick up libraries loaded or unloaded since the last sample.  */
+  int err = dwfl_linux_proc_refresh (dwfl, pid, NULL, NULL);
+  if (err != 0)
+    return false;
+
+  if (show_one_tid)
+    {
+      frames->frames = 0;
+      int res = dwfl_getthread_frames (dwfl, pid, frame_callback, frames);
+      if (res == -1 && frames->frames == 0)
+	return false;
+      record_sample (frames);
+    }
+  else if (jobs != 1)
+    {
+      if (dwfl_getthreads_parallel (dwfl, jobs, parallel_thread_callback,
+				    NULL) == -1)
+	return false;
+      for (size_t i = 0; i < nthread_frames; i++)
+	if (thread_frames[i] != NULL)
+	  {
+	    record_sample (&thread_frames[i]->frames);
+	    free (thread_frames[i]->frames.frame);
+	    free (thread_frames[i]);
+	    thread_frames[i] = NULL;
+	  }
+    }
+  else if (dwfl_getthreads (dwfl, sample_thread_callback, frames) == -1)
+    return false;
+
+  return true;
+}
+
+static double
+seconds_since (const struct timespec *start)
+{
+  struct timespec now;
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return ((now.tv_sec - start->tv_sec)
+	  + (now.tv_nsec - start->tv_nsec) / 1e9);
+}
+
+static int
+compare_sample_count (const void *a, const void *b)
+{
+  const struct sample *s1 = *(const struct sample **) a;
+  const struct sample *s2 = *(const struct sample **) b;
+  if (s1->count != s2->count)
+    return s1->count > s2->count ? -1 : 1;
+  return compare_frames (&s1->frames, &s2->frames);
+}
+
+/* A folded stack line, different stacks can fold into the same line.  */
+struct folded
+{
+  char *line;
+  unsigned long int count;
+};
+
+static int
+compare_folded (const void *a, const void *b)
+{
+  return strcmp (((const struct folded *) a)->line,
+		 ((const struct folded *) b)->line);
+}
+
+/* Return the outermost first, ';' separated function names of SAMPLE.  */
+static char *
+fold_sample (struct sample *sample)
+{
+  size_t len = 0;
+  size_t size = 256;
+  char *line = xmalloc (size);
+  line[0] = '\0';
+  for (int nr = sample->frames.frames - 1; nr >= 0; nr--)
+    {
+      Dwarf_Addr pc = sample->frames.frame[nr].pc;
+      bool isactivation = sample->frames.frame[nr].isactivation;
+      Dwarf_Addr pc_adjusted = pc - (isactivation ? 0 : 1);
+      Dwfl_Module *mod = dwfl_addrmodule (dwfl, pc_adjusted);
+      const char *symname = NULL;
+      if (mod != NULL && ! show_quiet)
+	symname = dwfl_module_addrname (mod, pc_adjusted);
+      char addr[32];
+      if (symname != NULL)
+	symname = demangle (symname);
+      else
+	{
+	  snprintf (addr, sizeof addr, "0x%" PRIx64, (uint64_t) pc);
+	  symname = addr;
+	}
+
+      size_t namelen = strlen (symname);
+      while (len + namelen + 2 > size)
+	line = xrealloc (line, size *= 2);
+      if (len > 0)
+	line[len++] = ';';
+      memcpy (&line[len], symname, namelen + 1);
+      len += namelen;
+    }
+  return line;
+}
+
+static void
+print_samples (void)
+{
+  size_t nstacks = samples.filled;
+  struct sample **sorted = xmalloc (nstacks * sizeof sorted[0]);
+  void *p = NULL;
+  size_t n = 0;
+  struct sample *sample;
+  while ((sample = sample_tab_iterate (&samples, &p)) != NULL)
+    sorted[n++] = sample;
+  assert (n == nstacks);
+
+  if (show_folded)
+    {
+      struct folded *folded = xmalloc (nstacks * sizeof folded[0]);
+      for (size_t i = 0; i < nstacks; i++)
+	{
+	  folded[i].line = fold_sample (sorted[i]);
+	  folded[i].count = sorted[i]->count;
+	}
+      qsort (folded, nstacks, sizeof folded[0], compare_folded);
+      for (size_t i = 0; i < nstacks; i++)
+	{
+	  unsigned long int count = folded[i].count;
+	  while (i + 1 < nstacks
+		 && strcmp (folded[i].line, folded[i + 1].line) == 0)
+	    {
+	      free (folded[i].line);
+	      count += folded[++i].count;
+	    }
+	  printf ("%s %lu\n", folded[i].line, count);
+	  free (folded[i].line);
+	}
+      free (folded);
+    }
+  else
+    {
+      qsort (sorted, nstacks, sizeof sorted[0], compare_sample_count);
+      for (size_t i = 0; i < nstacks; i++)
+	{
+	  printf ("%lu samples (%.2f%%):\n", sorted[i]->count,
+		  100.0 * sorted[i]->count / nsamples);
+	  print_frame_list (&sorted[i]->frames);
+	}
+    }
+
+  for (size_t i = 0; i < nstacks; i++)
+    {
+      free (sorted[i]->frames.frame);
+      free (sorted[i]);
+    }
+  free (sorted);
+}
+
+/* Sample the stacks of the process at SAMPLE_HZ for SAMPLE_DURATION
+   seconds.  The Dwfl with its modules, debuginfo and CFI is set up only
+   once and shared by all samples.  */
+static void
+sample_process (struct frames *frames)
+{
+  if (sample_tab_init (&samples, 1021) != 0)
+    error (EXIT_BAD, errno, "sample_tab_init");
+
+  const double period = 1.0 / sample_hz;
+  unsigned long int nticks = sample_duration * sample_hz;
+  if (nticks == 0)
+    nticks = 1;
+
+  struct timespec start;
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  unsigned long int ntaken = 0;
+  unsigned long int nmissed = 0;
+  double busy = 0;
+  double busy_max = 0;
+  for (unsigned long int tick = 0; tick < nticks; tick++)
+    {
+      double due = tick * period;
+      double now = seconds_since (&start);
+      if (now >= due + period)
+	{
+	  /* The previous sample took too long, skip this one.  */
+	  nmissed++;
+	  continue;
+	}
+      if (now < due)
+	{
+	  struct timespec wakeup = start;
+	  wakeup.tv_sec += (time_t) due;
+	  wakeup.tv_nsec += (due - (time_t) due) * 1e9;
+	  if (wakeup.tv_nsec >= 1000000000)
+	    {
+	      wakeup.tv_sec++;
+	      wakeup.tv_nsec -= 1000000000;
+	    }
+	  while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME,
+				  &wakeup, NULL) == EINTR)
+	    ;
+	}
+
+      struct timespec sample_start;
+      clock_gettime (CLOCK_MONOTONIC, &sample_start);
+      bool alive = take_sample (frames);
+      double cost = seconds_since (&sample_start);
+      if (! alive)
+	break;
+      ntaken++;
+      busy += cost;
+      if (cost > busy_max)
+	busy_max = cost;
+    }
+  double elapsed = seconds_since (&start);
+
+  if (nsamples > 0)
+    frames_shown = true;
+
+  if (! show_folded)
+    printf ("PID %d - %lu samples of %lu stacks\n", pid, ntaken, nsamples);
+  print_samples ();
+  sample_tab_free (&samples);
+  free (thread_frames);
+
+  /* Report the cost of sampling so the frequency can be tuned.  */
+  fprintf (stderr, N_("\
+%lu samples in %.3fs, %lu missed; %.1f us per sample (max %.1f us), \
+%.2f%% of the time spent sampling\n"),
+	   ntaken, elapsed, nmissed,
+	   ntaken > 0 ? busy * 1e6 / ntaken : 0.0, busy_max * 1e6,
+	   elapsed > 0 ? 100.0 * busy / elapsed : 0.0);
+}
+
 static void
 print_version (FILE *stream, struct argp_state *state __attribute__ ((unused)))
 {
@@ -560,6 +970,37 @@ parse_opt (int key, char *arg __attribute__ ((unused)),
       show_modules = true;
       break;
 
+    case OPT_SAMPLE:
+      sample_hz = strtod (arg, NULL);
+      if (sample_hz <= 0)
+	{
+	  argp_error (state, N_("--sample HZ should be higher than 0."));
+	  return EINVAL;
+	}
+      break;
+
+    case OPT_DURATION:
+      sample_duration = strtod (arg, NULL);
+      if (sample_duration <= 0)
+	{
+	  argp_error (state, N_("--duration SECONDS should be higher than 0."));
+	  return EINVAL;
+	}
+      break;
+
+    case OPT_FOLDED:
+      show_folded = true;
+      break;
+
+    case 'j':
+      jobs = atoi (arg);
+      if (jobs < 0)
+	{
+	  argp_error (state, N_("-j JOBS should be 0 or higher."));
+	  return EINVAL;
+	}
+      break;
+
     case ARGP_KEY_END:
       if (core == NULL && exec != NULL)
 	argp_error (state,
@@ -569,6 +1010,10 @@ parse_opt (int key, char *arg __attribute__ ((unused)),
 	argp_error (state,
 		    N_("-1 needs a thread id given by -p."));
 
+      if (pid == 0 && sample_hz > 0)
+	argp_error (state,
+		    N_("--sample needs a process given by -p."));
+
       if ((pid == 0 && core == NULL) || (pid != 0 && core != NULL))
 	argp_error (state,
 		    N_("One of -p PID or --core COREFILE should be given."));
@@ -674,6 +1119,16 @@ main (int argc, char **argv)
 	N_("Show at most MAXFRAMES per thread (default 256, use 0 for unlimited)"), 0 },
       { "list-modules", 'l', NULL, 0,
 	N_("Show module memory map with build-id, elf and debug files detected"), 0 },
+      { "jobs", 'j', "JOBS", 0,
+	N_("Unwind up to JOBS threads at once (default 1, use 0 for one per CPU)"), 0 },
+
+      { NULL, 0, NULL, 0, N_("Profiling options:"), 0 },
+      { "sample", OPT_SAMPLE, "HZ", 0,
+	N_("Sample the stacks of process PID HZ times per second and show how often each stack was seen"), 0 },
+      { "duration", OPT_DURATION, "SECONDS", 0,
+	N_("Sample for SECONDS (default 10)"), 0 },
+      { "folded", OPT_FOLDED, NULL, 0,
+	N_("Show the samples as folded stacks for flame graph tools"), 0 },
       { NULL, 0, NULL, 0, NULL, 0 }
     };
 
@@ -701,15 +1156,11 @@ invoked with bad or missing arguments it will exit with return code 64.")
     }
 
   struct frames frames;
-  /* When maxframes is zero, then 2048 is just the initial allocation
-     that will be increased using realloc in framecallback ().  */
-  frames.allocated = maxframes == 0 ? 2048 : maxframes;
-  frames.frames = 0;
-  frames.frame = malloc (sizeof (struct frame) * frames.allocated);
-  if (frames.frame == NULL)
-    error (EXIT_BAD, errno, "malloc frames.frame");
+  alloc_frames (&frames);
 
-  if (show_one_tid)
+  if (sample_hz > 0)
+    sample_process (&frames);
+  else if (show_one_tid)
     {
       int err = 0;
       switch (dwfl_getthread_frames (dwfl, pid, frame_callback, &frames))
@@ -725,6 +1176,32 @@ invoked with bad or missing arguments it will exit with return code 64.")
 	}
       print_frames (&frames, pid, err, "dwfl_getthread_frames");
     }
+  else if (jobs != 1)
+    {
+      printf ("PID %d - %s\n", dwfl_pid (dwfl), pid != 0 ? "process" : "core");
+      switch (dwfl_getthreads_parallel (dwfl, jobs, parallel_thread_callback,
+					NULL))
+	{
+	case DWARF_CB_OK:
+	case DWARF_CB_ABORT:
+	  break;
+	case -1:
+	  error (0, 0, "dwfl_getthreads_parallel: %s", dwfl_errmsg (-1));
+	  break;
+	default:
+	  abort ();
+	}
+      for (size_t i = 0; i < nthread_frames; i++)
+	if (thread_frames[i] != NULL)
+	  {
+	    struct thread_frames *tf = thread_frames[i];
+	    print_frames (&tf->frames, tf->tid, tf->err,
+			  "dwfl_thread_getframes");
+	    free (tf->frames.frame);
+	    free (tf);
+	  }
+      free (thread_frames);
+    }
   else
     {
       printf ("PID %d - %s\n", dwfl_pid (dwfl), pid != 0 ? "process" : "core");
@@ -40,10 +40,19 @@
 #include <sys/mman.h>
 #include <sys/param.h>
 #include <sys/stat.h>
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
 
 #include <system.h>
 
 
+/* Size of the stdout buffer unless it is a terminal.  */
+#define OUTPUT_BUFSIZ	(256 * 1024)
+
+/* Size of the pieces of a buffer scanned by separate threads.  */
+#define PIECE_SIZE	(1024 * 1024)
+
 /* Prototypes of local functions.  */
 static int read_fd (int fd, const char *fname, off64_t fdlen);
 static int read_elf (Elf *elf, int fd, const char *fname, off64_t fdlen);
@@ -73,6 +82,8 @@ Select character size and endianess: s = 7-bit, S = 8-bit, {b,l} = 16-bit, {B,L}
   { NULL, 'o', NULL, 0, N_("Alias for --radix=o"), 0 },
 
   { NULL, 0, NULL, 0, N_("Miscellaneous:"), 0 },
+  { "jobs", 'j', "JOBS", 0,
+    N_("Scan large files in up to JOBS pieces at once (default 1, use 0 for one per CPU)"), 0 },
   { NULL, 0, NULL, 0, NULL, 0 }
 };
 
@@ -116,6 +127,16 @@ static bool char_7bit;
 /* True if file names should be printed before strings.  */
 static bool print_file_name;
 
+/* Number of pieces of a file to scan at once.  */
+static int jobs = 1;
+
+/* Classification of the bytes, true for the printable ones.  */
+static bool printable[256];
+
+/* True if PRINTABLE holds exactly the ASCII graphic characters,
+   space, and tab.  The vector code only knows about those.  */
+static bool printable_ascii;
+
 /* Radix for printed numbers.  */
 static enum
 {
@@ -140,10 +161,14 @@ static off64_t elfmap_off;
 int
 main (int argc, char *argv[])
 {
-  /* We use no threads.  */
+  /* Only this thread uses the standard streams.  */
   __fsetlocking (stdin, FSETLOCKING_BYCALLER);
   __fsetlocking (stdout, FSETLOCKING_BYCALLER);
 
+  /* Write the strings in big chunks unless someone is watching.  */
+  if (! isatty (STDOUT_FILENO))
+    setvbuf (stdout, xmalloc (OUTPUT_BUFSIZ), _IOFBF, OUTPUT_BUFSIZ);
+
   /* Set locale.  */
   (void) setlocale (LC_ALL, "");
 
@@ -232,10 +257,23 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\
 }
 
 
+/* Fill in the PRINTABLE table for the current locale and options.  */
+static void
+init_printable (void)
+{
+  printable_ascii = true;
+  for (int c = 0; c < 256; ++c)
+    {
+      printable[c] = (isprint (c) || c == '\t') && (! char_7bit || c <= 127);
+      if (printable[c] != ((c >= ' ' && c < '\177') || c == '\t'))
+	printable_ascii = false;
+    }
+}
+
+
 /* Handle program arguments.  */
 static error_t
-parse_opt (int key, char *arg,
-	   struct argp_state *state __attribute__ ((unused)))
+parse_opt (int key, char *arg, struct argp_state *state)
 {
   switch (key)
     {
@@ -279,6 +317,15 @@ parse_opt (int key, char *arg,
       min_len = atoi (arg);
       break;
 
+    case 'j':
+      jobs = atoi (arg);
+      if (jobs < 0)
+	{
+	  argp_error (state, gettext ("-j JOBS should be 0 or higher."));
+	  return EINVAL;
+	}
+      break;
+
     case 'o':
       goto octfmt;
 
@@ -312,6 +359,7 @@ parse_opt (int key, char *arg,
 	error (EXIT_FAILURE, 0,
 	       gettext ("invalid minimum length of matched string size"));
       min_len_bytes = min_len * bytes_per_char;
+      init_printable ();
       break;
 
     default:
@@ -398,66 +446,255 @@ process_chunk_mb (const char *fname, const unsigned char *buf, off64_t to,
 }
 
 
-static void
-process_chunk (const char *fname, const unsigned char *buf, off64_t to,
-	       size_t len, char **unprinted)
+/* A buffer of single byte characters to look for strings in.  */
+struct chunk
 {
-  /* We are not going to slow the check down for the 2- and 4-byte
-     encodings.  Handle them special.  */
-  if (unlikely (bytes_per_char != 1))
+  const char *fname;
+  const unsigned char *buf;
+  size_t len;
+  off64_t to;			/* File offset of BUF + LEN.  */
+  const char *prefix;		/* Unprinted start of a string before BUF.  */
+  size_t prefixlen;
+};
+
+
+/* Return a mask with bit I set if P[I] is printable, for 64 bytes.  */
+static inline uint64_t
+printable_mask (const unsigned char *p)
+{
+  uint64_t mask = 0;
+
+#ifdef __SSE2__
+  if (likely (printable_ascii))
     {
-      process_chunk_mb (fname, buf, to, len, unprinted);
-      return;
+      /* Bytes from space to '~' end up below LIMIT, as signed values.  */
+      const __m128i bias = _mm_set1_epi8 ((char) (' ' + 0x80));
+      const __m128i limit = _mm_set1_epi8 ((char) ('\177' - ' ' - 0x80));
+      const __m128i tab = _mm_set1_epi8 ('\t');
+      for (int i = 0; i < 4; ++i)
+	{
+	  __m128i v = _mm_loadu_si128 ((const __m128i *) p + i);
+	  __m128i m = _mm_or_si128 (_mm_cmplt_epi8 (_mm_sub_epi8 (v, bias),
+						    limit),
+				    _mm_cmpeq_epi8 (v, tab));
+	  mask |= (uint64_t) (uint16_t) _mm_movemask_epi8 (m) << (16 * i);
+	}
+      return mask;
     }
+#endif
 
-  size_t curlen = *unprinted == NULL ? 0 : strlen (*unprinted);
-  const unsigned char *start = buf;
-  while (len > 0)
+  for (int i = 63; i >= 0; --i)
+    mask = mask << 1 | printable[p[i]];
+  return mask;
+}
+
+
+/* Position in a chunk, with the printable mask of the bytes around it.  */
+struct cursor
+{
+  const unsigned char *buf;
+  size_t len;
+  size_t base;			/* Position of bit 0 of MASK.  */
+  size_t nbits;			/* Number of valid bits in MASK.  */
+  uint64_t mask;
+};
+
+
+/* Return the first position from POS on with a printable byte if
+   PRINT, a non-printable one otherwise, or the length if there is
+   none.  */
+static size_t
+find_class (struct cursor *cur, size_t pos, bool print)
+{
+  while (pos < cur->len)
     {
-      if ((isprint (*buf) || *buf == '\t') && (! char_7bit || *buf <= 127))
+      if (pos < cur->base || pos >= cur->base + cur->nbits)
 	{
-	  ++buf;
-	  ++curlen;
+	  cur->base = pos;
+	  if (cur->len - pos >= 64)
+	    {
+	      cur->nbits = 64;
+	      cur->mask = printable_mask (cur->buf + pos);
+	    }
+	  else
+	    {
+	      cur->nbits = cur->len - pos;
+	      cur->mask = 0;
+	      for (size_t i = cur->nbits; i-- > 0; )
+		cur->mask = cur->mask << 1 | printable[cur->buf[pos + i]];
+	    }
 	}
+
+      size_t skip = pos - cur->base;
+      size_t left = cur->nbits - skip;
+      uint64_t m = (print ? cur->mask : ~cur->mask) >> skip;
+      if (m != 0 && (size_t) __builtin_ctzll (m) < left)
+	return pos + __builtin_ctzll (m);
+      pos += left;
+    }
+
+  return cur->len;
+}
+
+
+/* Print the string from START to END of C, after the prefix of C if
+   PREFIXLEN is not zero.  */
+static void
+print_string (FILE *out, const struct chunk *c, size_t start,
+	      size_t prefixlen, size_t end)
+{
+  if (likely (c->fname != NULL))
+    {
+      fputs_unlocked (c->fname, out);
+      fputs_unlocked (": ", out);
+    }
+
+  if (likely (radix != radix_none))
+    {
+      int64_t offset = c->to - c->len + start - prefixlen;
+      if (radix == radix_octal)
+	fprintf (out, "%7" PRIo64, offset);
+      else if (radix == radix_decimal)
+	put_signed (out, offset, 7, 0);
       else
-	{
-	  if (curlen >= min_len)
-	    {
-	      /* We found a match.  */
-	      if (likely (fname != NULL))
-		{
-		  fputs_unlocked (fname, stdout);
-		  fputs_unlocked (": ", stdout);
-		}
+	put_hex (out, offset, 7, 0);
+      putc_unlocked (' ', out);
+    }
 
-	      if (likely (radix != radix_none))
-		printf ((radix == radix_octal ? "%7" PRIo64 " "
-			 : (radix == radix_decimal ? "%7" PRId64 " "
-			    : "%7" PRIx64 " ")),
-			(int64_t) to - len - (buf - start));
+  if (unlikely (prefixlen != 0))
+    fwrite_unlocked (c->prefix, 1, prefixlen, out);
+  fwrite_unlocked (c->buf + start, 1, end - start, out);
+  putc_unlocked ('\n', out);
+}
 
-	      if (unlikely (*unprinted != NULL))
-		{
-		  fputs_unlocked (*unprinted, stdout);
-		  free (*unprinted);
-		  *unprinted = NULL;
-		}
-	      fwrite_unlocked (start, 1, buf - start, stdout);
-	      putc_unlocked ('\n', stdout);
-	    }
 
-	  start = ++buf;
-	  curlen =  0;
+/* Print the strings of C which end between FROM and END.  If
+   UNPRINTED is not NULL, END is the end of C and the characters
+   after the last string are stored in *UNPRINTED.  */
+static void
+scan_chunk (FILE *out, const struct chunk *c, size_t from, size_t end,
+	    char **unprinted)
+{
+  /* The string going on at FROM might have started earlier.  */
+  size_t start = from;
+  while (start > 0 && printable[c->buf[start - 1]])
+    --start;
+  size_t prefixlen = start == 0 ? c->prefixlen : 0;
+
+  struct cursor cur = { .buf = c->buf, .len = c->len };
+  size_t stop;
+  while ((stop = find_class (&cur, start, false)) < end)
+    {
+      if (stop - start + prefixlen >= min_len)
+	/* We found a match.  */
+	print_string (out, c, start, prefixlen, stop);
+      prefixlen = 0;
+
+      /* There cannot be another match in the last bytes.  They will
+	 be looked at again with the next buffer, if there is one.  */
+      if (c->len - stop <= min_len)
+	return;
+
+      start = find_class (&cur, stop + 1, true);
+      if (start > stop + 1 && c->len - (start - 1) <= min_len)
+	return;
+    }
 
-	  if (len <= min_len)
-	    break;
-	}
+  if (unprinted != NULL && end - start + prefixlen != 0)
+    {
+      char *cp = *unprinted = xmalloc (end - start + prefixlen + 1);
+      if (prefixlen != 0)
+	cp = mempcpy (cp, c->prefix, prefixlen);
+      *((char *) mempcpy (cp, c->buf + start, end - start)) = '\0';
+    }
+}
 
-      --len;
+
+/* A buffer split into pieces of PIECE_SIZE bytes, and what was found
+   in each.  The last piece takes the rest.  */
+struct pieces
+{
+  const struct chunk *c;
+  size_t n;
+  struct piece
+  {
+    char *text;
+    size_t size;
+  } *piece;
+  char **unprinted;
+};
+
+
+static void
+scan_piece (size_t i, void *arg)
+{
+  struct pieces *pieces = arg;
+  struct piece *piece = &pieces->piece[i];
+
+  FILE *out = open_memstream (&piece->text, &piece->size);
+  if (out == NULL)
+    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+  __fsetlocking (out, FSETLOCKING_BYCALLER);
+
+  size_t from = i * PIECE_SIZE;
+  if (i + 1 < pieces->n)
+    scan_chunk (out, pieces->c, from, from + PIECE_SIZE, NULL);
+  else
+    scan_chunk (out, pieces->c, from, pieces->c->len, pieces->unprinted);
+
+  if (fclose (out) != 0)
+    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+}
+
+
+static void
+print_piece (size_t i, void *arg)
+{
+  struct pieces *pieces = arg;
+  struct piece *piece = &pieces->piece[i];
+
+  fwrite_unlocked (piece->text, 1, piece->size, stdout);
+  free (piece->text);
+}
+
+
+static void
+process_chunk (const char *fname, const unsigned char *buf, off64_t to,
+	       size_t len, char **unprinted)
+{
+  /* We are not going to slow the check down for the 2- and 4-byte
+     encodings.  Handle them special.  */
+  if (unlikely (bytes_per_char != 1))
+    {
+      process_chunk_mb (fname, buf, to, len, unprinted);
+      return;
     }
 
-  if (curlen != 0)
-    *unprinted = xstrndup ((const char *) start, curlen);
+  struct chunk c =
+    {
+      .fname = fname,
+      .buf = buf,
+      .len = len,
+      .to = to,
+      .prefix = *unprinted,
+      .prefixlen = *unprinted == NULL ? 0 : strlen (*unprinted)
+    };
+  *unprinted = NULL;
+
+  /* Each piece has to be longer than any match it might not see the
+     end of.  */
+  struct pieces pieces = { .c = &c, .n = len / PIECE_SIZE,
+			   .unprinted = unprinted };
+  if (jobs != 1 && pieces.n > 1 && PIECE_SIZE > min_len)
+    {
+      pieces.piece = xmalloc (pieces.n * sizeof (pieces.piece[0]));
+      parallel_ordered (pieces.n, jobs, scan_piece, print_piece, &pieces);
+      free (pieces.piece);
+    }
+  else
+    scan_chunk (stdout, &c, 0, len, unprinted);
+
+  free ((char *) c.prefix);
 }
 
 
@@ -564,7 +801,7 @@ read_block_no_mmap (int fd, const char *fname, off64_t from, off64_t fdlen)
 
 	  memmove (buf, buf + nb - to_keep, to_keep);
 	  ntrailer = to_keep;
-	  from += nb;
+	  from += nb - to_keep;
 	}
       else
 	ntrailer = nb;
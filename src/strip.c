@@ -40,6 +40,7 @@
 #include <sys/param.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/wait.h>
 
 #include <elf-knowledge.h>
 #include <libebl.h>
@@ -86,6 +87,9 @@ static const struct argp_option options[] =
   { "remove-section", 'R', "SECTION", OPTION_HIDDEN, NULL, 0 },
   { "permissive", OPT_PERMISSIVE, NULL, 0,
     N_("Relax a few rules to handle slightly broken ELF files"), 0 },
+  { "jobs", 'j', "JOBS", 0,
+    N_("Strip up to JOBS files at once (default 1, use 0 for one per CPU)"),
+    0 },
   { NULL, 0, NULL, 0, NULL, 0 }
 };
 
@@ -108,6 +112,9 @@ static struct argp argp =
 /* Print symbols in file named FNAME.  */
 static int process_file (const char *fname);
 
+/* Strip all the NFILES files in FNAMES, several at once.  */
+static int process_files_parallel (char **fnames, size_t nfiles);
+
 /* Handle one ELF file.  */
 static int handle_elf (int fd, Elf *elf, const char *prefix,
 		       const char *fname, mode_t mode, struct timeval tvp[2]);
@@ -116,6 +123,12 @@ static int handle_elf (int fd, Elf *elf, const char *prefix,
 static int handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 		      struct timeval tvp[2]);
 
+/* Let libelf copy the contents of sections we never change directly
+   from the input file, or make sure it does not for the others.  This
+   is the same as in unstrip.c.  */
+static void copy_source (Elf_Data *outdata, Elf_Scn *inscn,
+			 GElf_Word sh_type);
+
 #define INTERNAL_ERROR(fname) \
   error (EXIT_FAILURE, 0, gettext ("%s: INTERNAL ERROR %d (%s-%s): %s"),      \
 	 fname, __LINE__, PACKAGE_VERSION, __DATE__, elf_errmsg (-1))
@@ -148,6 +161,9 @@ static bool permissive;
 /* If true perform relocations between debug sections.  */
 static bool reloc_debug;
 
+/* Number of input files to strip at once.  */
+static int jobs = 1;
+
 
 int
 main (int argc, char *argv[])
@@ -196,9 +212,12 @@ main (int argc, char *argv[])
 Only one input file allowed together with '-o' and '-f'"));
 
       /* Process all the remaining files.  */
-      do
-	result |= process_file (argv[remaining]);
-      while (++remaining < argc);
+      if (jobs != 1 && remaining + 1 < argc)
+	result = process_files_parallel (&argv[remaining], argc - remaining);
+      else
+	do
+	  result |= process_file (argv[remaining]);
+	while (++remaining < argc);
     }
 
   return result;
@@ -292,6 +311,15 @@ parse_opt (int key, char *arg, struct argp_state *state)
     case 's':			/* Ignored for compatibility.  */
       break;
 
+    case 'j':
+      jobs = atoi (arg);
+      if (jobs < 0)
+	{
+	  argp_error (state, gettext ("-j JOBS should be 0 or higher."));
+	  return EINVAL;
+	}
+      break;
+
     default:
       return ARGP_ERR_UNKNOWN;
     }
@@ -349,8 +377,10 @@ process_file (const char *fname)
     }
 
   /* Now get the ELF descriptor.  */
-  Elf *elf = elf_begin (fd, output_fname == NULL ? ELF_C_RDWR : ELF_C_READ,
-			NULL);
+  Elf *elf = elf_begin (fd, (output_fname == NULL
+			     ? ELF_C_RDWR : ELF_C_READ_MMAP_PRIVATE), NULL);
+  /* Most of the file is copied in order.  */
+  (void) elf_cntl (elf, ELF_C_ADVISE_SEQUENTIAL);
   int result;
   switch (elf_kind (elf))
     {
@@ -387,6 +417,52 @@ process_file (const char *fname)
 }
 
 
+struct file_state
+{
+  char **fnames;
+  int result;
+};
+
+
+/* Strip one file in a child process, so that a fatal error only loses
+   that file.  */
+static int
+strip_file (size_t i, void *arg)
+{
+  struct file_state *state = arg;
+  return process_file (state->fnames[i]);
+}
+
+
+static bool
+output_file (size_t i, int status, void *arg)
+{
+  struct file_state *state = arg;
+
+  if (status == -1)
+    error (0, errno, gettext ("cannot strip '%s'"), state->fnames[i]);
+  else if (WIFSIGNALED (status))
+    error (0, 0, gettext ("%s: %s"), state->fnames[i],
+	   strsignal (WTERMSIG (status)));
+
+  if (status == -1 || ! WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    state->result = 1;
+
+  return true;
+}
+
+
+static int
+process_files_parallel (char **fnames, size_t nfiles)
+{
+  struct file_state state = { .fnames = fnames, .result = 0 };
+
+  parallel_ordered_fork (nfiles, jobs, strip_file, output_file, &state);
+
+  return state.result;
+}
+
+
 /* Maximum size of array allocated on stack.  */
 #define MAX_STACK_ALLOC	(400 * 1024)
 
@@ -971,6 +1047,11 @@ handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
 	      debugdata->d_buf = memcpy (xmalloc (debugdata->d_size),
 					 debugdata->d_buf, debugdata->d_size);
 	    }
+	  else if (ehdr->e_type != ET_REL)
+	    /* Debug sections of relocatable files might get relocated
+	       below.  */
+	    copy_source (debugdata, shdr_info[cnt].scn,
+			 shdr_info[cnt].shdr.sh_type);
 	}
 
       /* Finish the ELF header.  Fill in the fields not handled by
@@ -1180,6 +1261,8 @@ handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
 
 	    /* Copy the structure.  */
 	    *newdata = *shdr_info[cnt].data;
+	    copy_source (newdata, shdr_info[cnt].scn,
+			 shdr_info[cnt].shdr.sh_type);
 
 	    /* We know the size.  */
 	    shdr_info[cnt].shdr.sh_size = shdr_info[cnt].data->d_size;
@@ -1959,8 +2042,9 @@ while computing checksum for debug information"));
       return 1;
     }
 
-  /* We have everything from the old file.  */
-  if (elf_cntl (elf, ELF_C_FDDONE) != 0)
+  /* We have everything from the old file.  Unless we write to another
+     file, it must not be read while being overwritten.  */
+  if (output_fname == NULL && elf_cntl (elf, ELF_C_FDDONE) != 0)
     {
       error (0, 0, gettext ("%s: error while reading the file: %s"),
 	     fname, elf_errmsg (-1));
@@ -1980,6 +2064,9 @@ while computing checksum for debug information"));
 	     fname, elf_errmsg (-1));
       result = 1;
     }
+  else
+    /* Everything of the input is copied now.  */
+    (void) elf_cntl (elf, ELF_C_ADVISE_DONTNEED);
 
   if (remove_shdrs)
     {
@@ -2103,6 +2190,30 @@ cannot set access and modification date of '%s'"),
 }
 
 
+static void
+copy_source (Elf_Data *outdata, Elf_Scn *inscn, GElf_Word sh_type)
+{
+  switch (sh_type)
+    {
+    case SHT_PROGBITS:
+    case SHT_NOTE:
+    case SHT_INIT_ARRAY:
+    case SHT_FINI_ARRAY:
+    case SHT_PREINIT_ARRAY:
+      /* If this fails libelf just writes the buffer.  */
+      (void) elf_setdata_source (outdata, inscn);
+      break;
+
+    default:
+      /* The symbol tables, relocations, groups, hash and version
+	 tables might be adjusted in place.  A source OUTDATA got
+	 earlier must not be used for them either.  */
+      (void) elf_setdata_source (outdata, NULL);
+      break;
+    }
+}
+
+
 static int
 handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 	   struct timeval tvp[2])
@@ -34,6 +34,7 @@
 #include <error.h>
 #include <fcntl.h>
 #include <fnmatch.h>
+#include <fts.h>
 #include <libintl.h>
 #include <locale.h>
 #include <mcheck.h>
@@ -43,8 +44,10 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 
 #include <gelf.h>
 #include <libebl.h>
@@ -62,6 +65,9 @@ ARGP_PROGRAM_VERSION_HOOK_DEF = print_version;
 /* Bug report address.  */
 ARGP_PROGRAM_BUG_ADDRESS_DEF = PACKAGE_BUGREPORT;
 
+/* Values for the parameters which have no short form.  */
+#define OPT_DEBUG_DIR	0x100
+
 /* Definitions of arguments for argp functions.  */
 static const struct argp_option options[] =
 {
@@ -82,6 +88,19 @@ static const struct argp_option options[] =
     N_("Apply relocations to section contents in ET_REL files"), 0 },
   { "list-only", 'n', NULL, 0,
     N_("Only list module and file names, build IDs"), 0 },
+
+  { NULL, 0, NULL, 0, N_("Batch options:"), 0 },
+  { "batch", 'b', NULL, 0,
+    N_("Combine each stripped FILE, and each file under a DIRECTORY, with the debug file found for its build ID"),
+    0 },
+  { "debug-dir", OPT_DEBUG_DIR, "DIRECTORY", 0,
+    N_("Find debug files for -b under DIRECTORY/.build-id (default /usr/lib/debug)"),
+    0 },
+  { "jobs", 'j', "JOBS", 0,
+    N_("Combine up to JOBS pairs of files at once with -b (default 1, use 0 for one per CPU)"),
+    0 },
+  { "verbose", 'v', NULL, 0,
+    N_("Print the files combined with -b and the time each pair took"), 0 },
   { NULL, 0, NULL, 0, NULL, 0 }
 };
 
@@ -97,8 +116,23 @@ struct arg_info
   bool modnames;
   bool match_files;
   bool relocate;
+  bool batch;
+  bool verbose;
+  const char *debug_dir;
+  int jobs;
 };
 
+/* Return true if FILE has a ".." component, so that it can name a
+   file outside of the directory it is appended to.  */
+static bool
+has_dotdot (const char *file)
+{
+  for (const char *p = file; (p = strstr (p, "..")) != NULL; p += 2)
+    if ((p == file || p[-1] == '/') && (p[2] == '\0' || p[2] == '/'))
+      return true;
+  return false;
+}
+
 /* Handle program arguments.  */
 static error_t
 parse_opt (int key, char *arg, struct argp_state *state)
@@ -148,6 +182,25 @@ parse_opt (int key, char *arg, struct argp_state *state)
       info->relocate = true;
       break;
 
+    case 'b':
+      info->batch = true;
+      break;
+    case OPT_DEBUG_DIR:
+      info->debug_dir = arg;
+      break;
+    case 'v':
+      info->verbose = true;
+      break;
+
+    case 'j':
+      info->jobs = atoi (arg);
+      if (info->jobs < 0)
+	{
+	  argp_error (state, _("-j JOBS should be 0 or higher."));
+	  return EINVAL;
+	}
+      break;
+
     case ARGP_KEY_ARGS:
     case ARGP_KEY_NO_ARGS:
       /* We "consume" all the arguments here.  */
@@ -184,6 +237,45 @@ parse_opt (int key, char *arg, struct argp_state *state)
 	    }
 	}
 
+      if (info->batch)
+	{
+	  if (info->dwfl != NULL || info->list)
+	    {
+	      argp_error (state,
+			  _("-b cannot be used with implicit files or -n"));
+	      return EINVAL;
+	    }
+	  if (state->next == state->argc)
+	    {
+	      argp_error (state, _("-b requires file arguments"));
+	      return EINVAL;
+	    }
+	  if (info->output_dir == NULL)
+	    {
+	      argp_error (state, _("-d is required when using -b"));
+	      return EINVAL;
+	    }
+	  if (info->all || info->modnames || info->relocate
+	      || info->match_files)
+	    {
+	      argp_error (state, _("\
+-m, -a, -R, and -f options not allowed with -b"));
+	      return EINVAL;
+	    }
+	  /* The output files are named by appending the input names to
+	     the -d directory.  */
+	  for (int i = state->next; i < state->argc; ++i)
+	    if (has_dotdot (state->argv[i]))
+	      {
+		argp_error (state, _("\
+'%s' must not contain '..' with -b"), state->argv[i]);
+		return EINVAL;
+	      }
+
+	  /* Bail out like for explicit files.  */
+	  return ENOSYS;
+	}
+
       if (info->dwfl == NULL)
 	{
 	  if (state->next + 2 != state->argc)
@@ -238,6 +330,32 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\
 	error (EXIT_FAILURE, 0, msg, elf_errmsg (-1));			      \
     } while (0)
 
+/* Let libelf copy the contents of sections we never change directly
+   from the input file, or make sure it does not for the others.  This
+   is the same as in strip.c.  */
+static void
+copy_source (Elf_Data *outdata, Elf_Scn *inscn, GElf_Word sh_type)
+{
+  switch (sh_type)
+    {
+    case SHT_PROGBITS:
+    case SHT_NOTE:
+    case SHT_INIT_ARRAY:
+    case SHT_FINI_ARRAY:
+    case SHT_PREINIT_ARRAY:
+      /* If this fails libelf just writes the buffer.  */
+      (void) elf_setdata_source (outdata, inscn);
+      break;
+
+    default:
+      /* The symbol tables, relocations, groups, hash and version
+	 tables might be adjusted in place.  A source OUTDATA got
+	 earlier must not be used for them either.  */
+      (void) elf_setdata_source (outdata, NULL);
+      break;
+    }
+}
+
 /* Copy INELF to newly-created OUTELF, exit via error for any problems.  */
 static void
 copy_elf (Elf *outelf, Elf *inelf)
@@ -277,6 +395,7 @@ copy_elf (Elf *outelf, Elf *inelf)
       ELF_CHECK (newdata != NULL, _("cannot copy section data: %s"));
       *newdata = *data;
       elf_flagdata (newdata, ELF_C_SET, ELF_F_DIRTY);
+      copy_source (newdata, scn, shdr_mem.sh_type);
     }
 }
 
@@ -1503,6 +1622,7 @@ more sections in stripped file than debug file -- arguments reversed?"));
 	ELF_CHECK (outdata != NULL, _("cannot copy section data: %s"));
 	*outdata = *indata;
 	elf_flagdata (outdata, ELF_C_SET, ELF_F_DIRTY);
+	copy_source (outdata, sec->scn, shdr_mem.sh_type);
 
 	/* Preserve the file layout of the allocated sections.  */
 	if (stripped_ehdr->e_type != ET_REL && (shdr_mem.sh_flags & SHF_ALLOC))
@@ -1933,6 +2053,24 @@ open_file (const char *file, bool writable)
   return fd;
 }
 
+/* Make sure the debug file UNSTRIPPED can go with a stripped file.  */
+static void
+check_explicit_pair (const char *stripped_file,
+		     const GElf_Ehdr *stripped_ehdr,
+		     const char *unstripped_file, Elf *unstripped)
+{
+  GElf_Ehdr unstripped_ehdr;
+  ELF_CHECK (gelf_getehdr (unstripped, &unstripped_ehdr),
+	     _("cannot create ELF descriptor: %s"));
+
+  if (memcmp (stripped_ehdr->e_ident, unstripped_ehdr.e_ident, EI_NIDENT)
+      || stripped_ehdr->e_type != unstripped_ehdr.e_type
+      || stripped_ehdr->e_machine != unstripped_ehdr.e_machine
+      || stripped_ehdr->e_phnum != unstripped_ehdr.e_phnum)
+    error (EXIT_FAILURE, 0, _("'%s' and '%s' do not seem to match"),
+	   stripped_file, unstripped_file);
+}
+
 /* Handle a pair of files we need to open by name.  */
 static void
 handle_explicit_files (const char *output_file, bool create_dirs,
@@ -1952,16 +2090,8 @@ handle_explicit_files (const char *output_file, bool create_dirs,
       unstripped = elf_begin (unstripped_fd,
 			      (output_file == NULL ? ELF_C_RDWR : ELF_C_READ),
 			      NULL);
-      GElf_Ehdr unstripped_ehdr;
-      ELF_CHECK (gelf_getehdr (unstripped, &unstripped_ehdr),
-		 _("cannot create ELF descriptor: %s"));
-
-      if (memcmp (stripped_ehdr.e_ident, unstripped_ehdr.e_ident, EI_NIDENT)
-	  || stripped_ehdr.e_type != unstripped_ehdr.e_type
-	  || stripped_ehdr.e_machine != unstripped_ehdr.e_machine
-	  || stripped_ehdr.e_phnum != unstripped_ehdr.e_phnum)
-	error (EXIT_FAILURE, 0, _("'%s' and '%s' do not seem to match"),
-	       stripped_file, unstripped_file);
+      check_explicit_pair (stripped_file, &stripped_ehdr,
+			   unstripped_file, unstripped);
     }
 
   handle_file (output_file, create_dirs, stripped, &stripped_ehdr, unstripped);
@@ -2212,6 +2342,346 @@ handle_implicit_modules (const struct arg_info *info)
     while ((offset = next (offset)) > 0);
 }
 
+/* Why a stripped file given to -b cannot be combined.  */
+enum batch_problem
+{
+  batch_ok = 0,
+  batch_unreadable,
+  batch_not_elf,
+  batch_no_build_id,
+  batch_no_debug_file
+};
+
+/* A stripped file for -b and the debug file found for its build ID.  */
+struct batch_pair
+{
+  char *file;
+  char *debug_file;
+  enum batch_problem problem;
+  int error;			/* errno for batch_unreadable.  */
+  Elf *debug;			/* Set if the debug file is shared.  */
+};
+
+struct batch
+{
+  const struct arg_info *info;
+  struct batch_pair *pairs;
+  size_t n;
+  size_t max;
+  Elf **shared;
+  size_t nshared;
+  int result;
+};
+
+/* Return the length of the build ID note in ELF and point *ID to its
+   bits, or return zero if there is none.  */
+static size_t
+find_build_id (Elf *elf, const unsigned char **id)
+{
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL || shdr->sh_type != SHT_NOTE)
+	continue;
+
+      Elf_Data *data = elf_getdata (scn, NULL);
+      if (data == NULL)
+	continue;
+
+      GElf_Nhdr nhdr;
+      size_t name_offset;
+      size_t desc_offset;
+      size_t off = 0;
+      while (off < data->d_size
+	     && (off = gelf_getnote (data, off, &nhdr,
+				     &name_offset, &desc_offset)) > 0)
+	if (nhdr.n_type == NT_GNU_BUILD_ID
+	    && nhdr.n_namesz == sizeof "GNU"
+	    && memcmp (data->d_buf + name_offset, "GNU", sizeof "GNU") == 0)
+	  {
+	    *id = data->d_buf + desc_offset;
+	    return nhdr.n_descsz;
+	  }
+    }
+
+  return 0;
+}
+
+/* Add FILE to the pairs for -b, with the name its debug file has in
+   the build ID index.  Files which are not ELF files are skipped
+   unless they were NAMED.  */
+static void
+add_batch_file (struct batch *batch, const char *file, bool named)
+{
+  struct batch_pair pair = { .file = NULL };
+
+  int fd = open64 (file, O_RDONLY);
+  Elf *elf = NULL;
+  if (fd < 0)
+    {
+      pair.problem = batch_unreadable;
+      pair.error = errno;
+    }
+  else
+    {
+      elf = elf_begin (fd, ELF_C_READ_MMAP, NULL);
+      if (elf == NULL || elf_kind (elf) != ELF_K_ELF)
+	pair.problem = batch_not_elf;
+    }
+
+  if (pair.problem == batch_ok)
+    {
+      const unsigned char *id;
+      size_t id_len = find_build_id (elf, &id);
+      if (id_len == 0)
+	pair.problem = batch_no_build_id;
+      else
+	{
+	  const char *dir = batch->info->debug_dir ?: "/usr/lib/debug";
+	  pair.debug_file = xmalloc (strlen (dir) + sizeof "/.build-id/"
+				     + 2 * id_len + sizeof ".debug");
+	  char *cp = stpcpy (stpcpy (pair.debug_file, dir), "/.build-id/");
+	  for (size_t i = 0; i < id_len; ++i)
+	    {
+	      cp += sprintf (cp, "%02" PRIx8, id[i]);
+	      if (i == 0)
+		*cp++ = '/';
+	    }
+	  strcpy (cp, ".debug");
+
+	  if (access (pair.debug_file, R_OK) != 0)
+	    pair.problem = batch_no_debug_file;
+	}
+    }
+
+  elf_end (elf);
+  if (fd >= 0)
+    close (fd);
+
+  if (pair.problem == batch_not_elf && !named)
+    {
+      free (pair.debug_file);
+      return;
+    }
+
+  if (batch->n == batch->max)
+    {
+      batch->max = 2 * batch->max + 16;
+      batch->pairs = xrealloc (batch->pairs,
+			       batch->max * sizeof (batch->pairs[0]));
+    }
+  pair.file = xstrdup (file);
+  batch->pairs[batch->n++] = pair;
+}
+
+static int
+compare_fts_names (const FTSENT **a, const FTSENT **b)
+{
+  return strcmp ((*a)->fts_name, (*b)->fts_name);
+}
+
+/* Add the file ARG to the pairs for -b, or the files under ARG if it
+   is a directory, in the order of their names.  */
+static void
+add_batch_arg (struct batch *batch, const char *arg)
+{
+  struct stat64 st;
+  if (stat64 (arg, &st) != 0 || !S_ISDIR (st.st_mode))
+    {
+      add_batch_file (batch, arg, true);
+      return;
+    }
+
+  char *dirs[] = { (char *) arg, NULL };
+  FTS *fts = fts_open (dirs, FTS_PHYSICAL | FTS_NOCHDIR, compare_fts_names);
+  if (fts == NULL)
+    error (EXIT_FAILURE, errno, _("cannot read directory '%s'"), arg);
+
+  FTSENT *f;
+  while ((f = fts_read (fts)) != NULL)
+    switch (f->fts_info)
+      {
+      case FTS_F:
+	add_batch_file (batch, f->fts_path, false);
+	break;
+
+      case FTS_DNR:
+      case FTS_ERR:
+      case FTS_NS:
+	error (0, f->fts_errno, _("cannot read '%s'"), f->fts_path);
+	batch->result = EXIT_FAILURE;
+	break;
+      }
+
+  fts_close (fts);
+}
+
+static int
+compare_debug_files (const void *a, const void *b)
+{
+  const struct batch_pair *const *p1 = a;
+  const struct batch_pair *const *p2 = b;
+  return strcmp ((*p1)->debug_file, (*p2)->debug_file);
+}
+
+/* Open the debug files which go with several stripped files here, so
+   the processes combining them share what libelf read of them.  */
+static void
+share_debug_files (struct batch *batch)
+{
+  struct batch_pair **sorted = xmalloc ((batch->n + 1) * sizeof sorted[0]);
+  size_t n = 0;
+  for (size_t i = 0; i < batch->n; ++i)
+    if (batch->pairs[i].problem == batch_ok)
+      sorted[n++] = &batch->pairs[i];
+  qsort (sorted, n, sizeof sorted[0], compare_debug_files);
+
+  size_t next;
+  for (size_t i = 0; i < n; i = next)
+    {
+      next = i + 1;
+      while (next < n
+	     && strcmp (sorted[i]->debug_file, sorted[next]->debug_file) == 0)
+	++next;
+      if (next - i < 2)
+	continue;
+
+      int fd = open64 (sorted[i]->debug_file, O_RDONLY);
+      if (fd < 0)
+	continue;
+      Elf *debug = elf_begin (fd, ELF_C_READ_MMAP_PRIVATE, NULL);
+      if (debug != NULL && elf_cntl (debug, ELF_C_FDREAD) == 0)
+	{
+	  batch->shared = xrealloc (batch->shared, ((batch->nshared + 1)
+						    * sizeof (Elf *)));
+	  batch->shared[batch->nshared++] = debug;
+	  for (size_t j = i; j < next; ++j)
+	    sorted[j]->debug = debug;
+	}
+      else
+	elf_end (debug);
+      close (fd);
+    }
+
+  free (sorted);
+}
+
+/* Combine the pair of files I for -b in a child process of its own, so
+   that a fatal error only loses that pair.  */
+static int
+unstrip_batch_pair (size_t i, void *arg)
+{
+  struct batch *batch = arg;
+  const struct arg_info *info = batch->info;
+  struct batch_pair *pair = &batch->pairs[i];
+
+  switch (pair->problem)
+    {
+    case batch_ok:
+      break;
+    case batch_unreadable:
+      error (0, pair->error, _("cannot open '%s'"), pair->file);
+      return EXIT_FAILURE;
+    case batch_not_elf:
+      error (0, 0, _("'%s' is not an ELF file"), pair->file);
+      return EXIT_FAILURE;
+    case batch_no_build_id:
+      if (info->ignore)
+	return 0;
+      error (0, 0, _("'%s' has no build ID"), pair->file);
+      return EXIT_FAILURE;
+    case batch_no_debug_file:
+      if (info->ignore)
+	return 0;
+      error (0, 0, _("cannot find debug file '%s' for '%s'"),
+	     pair->debug_file, pair->file);
+      return EXIT_FAILURE;
+    }
+
+  struct timespec start;
+  clock_gettime (CLOCK_MONOTONIC, &start);
+
+  char *output_file;
+  if (asprintf (&output_file, "%s/%s", info->output_dir, pair->file) < 0)
+    error (EXIT_FAILURE, 0, _("memory exhausted"));
+
+  if (pair->debug == NULL)
+    handle_explicit_files (output_file, true, pair->file, pair->debug_file);
+  else
+    {
+      int stripped_fd = open_file (pair->file, false);
+      Elf *stripped = elf_begin (stripped_fd, ELF_C_READ, NULL);
+      GElf_Ehdr stripped_ehdr;
+      ELF_CHECK (gelf_getehdr (stripped, &stripped_ehdr),
+		 _("cannot create ELF descriptor: %s"));
+      check_explicit_pair (pair->file, &stripped_ehdr,
+			   pair->debug_file, pair->debug);
+
+      handle_file (output_file, true, stripped, &stripped_ehdr, pair->debug);
+
+      elf_end (stripped);
+      close (stripped_fd);
+    }
+
+  if (info->verbose)
+    {
+      struct timespec end;
+      clock_gettime (CLOCK_MONOTONIC, &end);
+      printf ("%s %s %.3f ms\n", pair->file, pair->debug_file,
+	      ((end.tv_sec - start.tv_sec) * 1e3
+	       + (end.tv_nsec - start.tv_nsec) / 1e6));
+    }
+
+  free (output_file);
+  return 0;
+}
+
+static bool
+batch_pair_done (size_t i, int status, void *arg)
+{
+  struct batch *batch = arg;
+
+  if (status == -1)
+    error (0, errno, _("cannot process '%s'"), batch->pairs[i].file);
+  else if (WIFSIGNALED (status))
+    error (0, 0, "%s: %s", batch->pairs[i].file,
+	   strsignal (WTERMSIG (status)));
+
+  if (status == -1 || ! WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    batch->result = EXIT_FAILURE;
+
+  return true;
+}
+
+/* Handle the stripped files and directories given with -b.  */
+static int
+handle_batch (const struct arg_info *info)
+{
+  struct batch batch = { .info = info };
+
+  for (char **arg = info->args; *arg != NULL; ++arg)
+    add_batch_arg (&batch, *arg);
+
+  share_debug_files (&batch);
+
+  parallel_ordered_fork (batch.n, info->jobs, unstrip_batch_pair,
+			 batch_pair_done, &batch);
+
+  for (size_t i = 0; i < batch.nshared; ++i)
+    elf_end (batch.shared[i]);
+  free (batch.shared);
+  for (size_t i = 0; i < batch.n; ++i)
+    {
+      free (batch.pairs[i].file);
+      free (batch.pairs[i].debug_file);
+    }
+  free (batch.pairs);
+
+  return batch.result;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -2276,7 +2746,7 @@ or - if no debuginfo was found, or . if FILE contains the debug information.\
     };
 
   int remaining;
-  struct arg_info info = { .args = NULL };
+  struct arg_info info = { .args = NULL, .jobs = 1 };
   error_t result = argp_parse (&argp, argc, argv, 0, &remaining, &info);
   if (result == ENOSYS)
     assert (info.dwfl == NULL);
@@ -2287,6 +2757,9 @@ or - if no debuginfo was found, or . if FILE contains the debug information.\
   /* Tell the library which version we are expecting.  */
   elf_version (EV_CURRENT);
 
+  if (info.batch)
+    return handle_batch (&info);
+
   if (info.dwfl == NULL)
     {
       assert (result == ENOSYS);
@@ -78,6 +78,12 @@ main (int argc, char *argv[])
       exit (1);
     }
 
+  if (elf_findarsym (elf, "no such symbol", NULL) != NULL)
+    {
+      printf ("Found a nonexisting symbol in archive index\n");
+      exit (1);
+    }
+
   /* If there is no element in the index do nothing.  There always is
      an empty entry at the end which is included in the count and
      which we want to skip.  */
@@ -113,6 +119,19 @@ main (int argc, char *argv[])
 	/* Now print what we actually want.  */
 	fprintf (fp, "%s in %s\n", arsym[narsym].as_name, arhdr->ar_name);
 
+	/* The entry must be found by name, after all earlier ones with
+	   the same name.  */
+	Elf_Arsym *found = NULL;
+	do
+	  found = elf_findarsym (elf, arsym[narsym].as_name, found);
+	while (found != NULL && found < &arsym[narsym]);
+	if (found != &arsym[narsym])
+	  {
+	    printf ("Cannot find symbol `%s' in archive index\n",
+		    arsym[narsym].as_name);
+	    exit (1);
+	  }
+
 	/* Free the ELF descriptor.  */
 	if (elf_end (subelf) != 0)
 	  {
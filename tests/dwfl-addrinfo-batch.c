@@ -0,0 +1,146 @@
+/* Test program for dwfl_addrinfo_batch.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <inttypes.h>
+#include ELFUTILS_HEADER(dw)
+#include ELFUTILS_HEADER(dwfl)
+#include <argp.h>
+#include <error.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static Dwfl_Addrinfo *infos;
+static size_t ninfos;
+static size_t nalloc;
+
+static void
+add_addr (Dwarf_Addr addr)
+{
+  if (ninfos == nalloc)
+    {
+      nalloc = nalloc == 0 ? 256 : nalloc * 2;
+      infos = realloc (infos, nalloc * sizeof infos[0]);
+      if (infos == NULL)
+	error (EXIT_FAILURE, 0, "out of memory");
+    }
+  memset (&infos[ninfos], 0, sizeof infos[0]);
+  infos[ninfos++].addr = addr;
+}
+
+/* Collect addresses at, inside and just past every symbol.  */
+static int
+collect_addrs (Dwfl_Module *mod, void **userdata __attribute__ ((unused)),
+	       const char *name __attribute__ ((unused)),
+	       Dwarf_Addr start __attribute__ ((unused)),
+	       void *arg __attribute__ ((unused)))
+{
+  int syms = dwfl_module_getsymtab (mod);
+  for (int i = 0; i < syms; i++)
+    {
+      GElf_Sym sym;
+      GElf_Addr value;
+      if (dwfl_module_getsym_info (mod, i, &sym, &value,
+				   NULL, NULL, NULL) == NULL
+	  || value == 0)
+	continue;
+      add_addr (value);
+      add_addr (value + 1);
+      add_addr (value + sym.st_size / 2);
+      add_addr (value + sym.st_size);
+    }
+  return DWARF_CB_OK;
+}
+
+static void
+check_one (Dwfl *dwfl, const Dwfl_Addrinfo *info)
+{
+  Dwfl_Module *mod = dwfl_addrmodule (dwfl, info->addr);
+  assert (info->mod == mod);
+  if (mod == NULL)
+    return;
+
+  GElf_Off offset;
+  GElf_Sym sym;
+  const char *name = dwfl_module_addrinfo (mod, info->addr, &offset, &sym,
+					   NULL, NULL, NULL);
+  if (name != info->name)
+    error (EXIT_FAILURE, 0, "%#" PRIx64 ": symbol %s, batch %s",
+	   info->addr, name ?: "<none>", info->name ?: "<none>");
+  if (name != NULL)
+    {
+      assert (offset == info->offset);
+      assert (memcmp (&sym, &info->sym, sizeof sym) == 0);
+    }
+
+  assert (dwfl_module_getsrc (mod, info->addr) == info->line);
+
+  Dwarf_Addr bias;
+  Dwarf_Die *cudie = dwfl_module_addrdie (mod, info->addr, &bias);
+  Dwarf_Die *scopes = NULL;
+  int nscopes = (cudie == NULL ? 0
+		 : dwarf_getscopes (cudie, info->addr - bias, &scopes));
+  if (nscopes <= 0)
+    assert (info->nscopes == 0 && info->scopes == NULL);
+  else
+    {
+      assert (info->nscopes == nscopes);
+      for (int i = 0; i < nscopes; i++)
+	assert (dwarf_dieoffset (&scopes[i])
+		== dwarf_dieoffset (&info->scopes[i]));
+      free (scopes);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  int remaining;
+  Dwfl *dwfl = NULL;
+  (void) argp_parse (dwfl_standard_argp (), argc, argv, 0, &remaining,
+		     &dwfl);
+  assert (dwfl != NULL);
+
+  if (dwfl_getmodules (dwfl, &collect_addrs, NULL, 0) != 0)
+    error (EXIT_FAILURE, 0, "dwfl_getmodules: %s", dwfl_errmsg (-1));
+
+  /* Make sure the input is not sorted and has duplicates.  */
+  size_t n = ninfos;
+  for (size_t i = 0; i < n; i += 3)
+    add_addr (infos[i].addr);
+  for (size_t i = 0; i < ninfos / 2; i++)
+    {
+      Dwfl_Addrinfo tmp = infos[i];
+      infos[i] = infos[ninfos - 1 - i];
+      infos[ninfos - 1 - i] = tmp;
+    }
+
+  if (dwfl_addrinfo_batch (dwfl, infos, ninfos, true) != 0)
+    error (EXIT_FAILURE, 0, "dwfl_addrinfo_batch: %s", dwfl_errmsg (-1));
+
+  for (size_t i = 0; i < ninfos; i++)
+    {
+      check_one (dwfl, &infos[i]);
+      free (infos[i].scopes);
+    }
+
+  free (infos);
+  dwfl_end (dwfl);
+
+  return 0;
+}
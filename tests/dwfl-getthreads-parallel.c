@@ -0,0 +1,238 @@
+/* Test program for dwfl_getthreads_parallel.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <dirent.h>
+#include <errno.h>
+#include <error.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include ELFUTILS_HEADER(dwfl)
+
+#define NTHREADS 8
+#define MAXFRAMES 64
+
+struct thread_frames
+{
+  pid_t tid;
+  size_t nframes;
+  Dwarf_Addr pc[MAXFRAMES];
+};
+
+static void *
+sleeper (void *arg __attribute__ ((unused)))
+{
+  for (;;)
+    pause ();
+  return NULL;
+}
+
+static void
+child (void)
+{
+  pthread_t thread;
+  for (int i = 0; i < NTHREADS; i++)
+    if (pthread_create (&thread, NULL, sleeper, NULL) != 0)
+      _exit (1);
+  sleeper (NULL);
+}
+
+/* Return true if task TID is blocked in pause, so its backtrace does
+   not change anymore.  */
+static bool
+task_paused (pid_t pid, pid_t tid)
+{
+  char fname[64];
+  snprintf (fname, sizeof fname, "/proc/%ld/task/%ld/syscall", (long) pid,
+	    (long) tid);
+  FILE *f = fopen (fname, "r");
+  if (f == NULL)
+    /* Without permission to look we cannot attach either.  */
+    return true;
+  long nr;
+  bool paused = fscanf (f, "%ld", &nr) == 1;
+#ifdef SYS_pause
+  paused = paused && nr == SYS_pause;
+#else
+  paused = paused && nr >= 0;
+#endif
+  fclose (f);
+  return paused;
+}
+
+/* Count the tasks of PID which are blocked in pause.  */
+static int
+count_tasks (pid_t pid)
+{
+  char dirname[64];
+  snprintf (dirname, sizeof dirname, "/proc/%ld/task", (long) pid);
+  DIR *dir = opendir (dirname);
+  if (dir == NULL)
+    return -1;
+  int n = 0;
+  struct dirent *d;
+  while ((d = readdir (dir)) != NULL)
+    if (d->d_name[0] != '.' && task_paused (pid, atoi (d->d_name)))
+      n++;
+  closedir (dir);
+  return n;
+}
+
+static int
+frame_callback (Dwfl_Frame *state, void *arg)
+{
+  struct thread_frames *tf = arg;
+  Dwarf_Addr pc;
+  if (! dwfl_frame_pc (state, &pc, NULL))
+    return DWARF_CB_ABORT;
+  tf->pc[tf->nframes++] = pc;
+  return tf->nframes < MAXFRAMES ? DWARF_CB_OK : DWARF_CB_ABORT;
+}
+
+static void
+get_frames (Dwfl_Thread *thread, struct thread_frames *tf)
+{
+  tf->tid = dwfl_thread_tid (thread);
+  tf->nframes = 0;
+  /* Errors at the end of the backtrace are expected.  */
+  dwfl_thread_getframes (thread, frame_callback, tf);
+}
+
+static struct thread_frames serial[NTHREADS + 1];
+static size_t nserial;
+
+static int
+serial_callback (Dwfl_Thread *thread, void *arg __attribute__ ((unused)))
+{
+  assert (nserial < NTHREADS + 1);
+  get_frames (thread, &serial[nserial++]);
+  return DWARF_CB_OK;
+}
+
+static int
+parallel_callback (Dwfl_Thread *thread, size_t ndx, void *arg)
+{
+  struct thread_frames *parallel = arg;
+  assert (ndx < NTHREADS + 1);
+  get_frames (thread, &parallel[ndx]);
+  return DWARF_CB_OK;
+}
+
+/* The traced child, killed however the test ends.  */
+static pid_t child_pid;
+
+static void
+kill_child (void)
+{
+  kill (child_pid, SIGKILL);
+  waitpid (child_pid, NULL, 0);
+}
+
+/* A failed assert does not run the atexit handlers.  */
+static void
+kill_child_on_abort (int sig __attribute__ ((unused)))
+{
+  kill_child ();
+}
+
+static int
+abort_callback (Dwfl_Thread *thread __attribute__ ((unused)), size_t ndx,
+		void *arg __attribute__ ((unused)))
+{
+  /* The lowest failing index has to win.  */
+  return ndx >= 2 ? (int) ndx + 10 : DWARF_CB_OK;
+}
+
+int
+main (void)
+{
+  pid_t pid = fork ();
+  if (pid < 0)
+    error (2, errno, "fork");
+  if (pid == 0)
+    child ();
+  child_pid = pid;
+  atexit (kill_child);
+  signal (SIGABRT, kill_child_on_abort);
+
+  while (count_tasks (pid) < NTHREADS + 1)
+    usleep (1000);
+
+  static char *debuginfo_path;
+  static const Dwfl_Callbacks proc_callbacks =
+    {
+      .find_debuginfo = dwfl_standard_find_debuginfo,
+      .debuginfo_path = &debuginfo_path,
+
+      .find_elf = dwfl_linux_proc_find_elf,
+    };
+  Dwfl *dwfl = dwfl_begin (&proc_callbacks);
+  if (dwfl == NULL)
+    error (2, 0, "dwfl_begin: %s", dwfl_errmsg (-1));
+  int result = dwfl_linux_proc_report (dwfl, pid);
+  if (result < 0)
+    error (2, 0, "dwfl_linux_proc_report: %s", dwfl_errmsg (-1));
+  else if (result > 0)
+    error (2, result, "dwfl_linux_proc_report");
+  if (dwfl_report_end (dwfl, NULL, NULL) != 0)
+    error (2, 0, "dwfl_report_end: %s", dwfl_errmsg (-1));
+  result = dwfl_linux_proc_attach (dwfl, pid, false);
+  if (result < 0)
+    error (2, 0, "dwfl_linux_proc_attach: %s", dwfl_errmsg (-1));
+  else if (result > 0)
+    /* No ptrace permission here, nothing to test.  */
+    return 77;
+
+  if (dwfl_getthreads (dwfl, serial_callback, NULL) != 0)
+    error (2, 0, "dwfl_getthreads: %s", dwfl_errmsg (-1));
+  assert (nserial == NTHREADS + 1);
+
+  /* Without a backtrace of the main thread there is nothing to compare.  */
+  for (size_t i = 0; i < nserial; i++)
+    if (serial[i].tid == pid && serial[i].nframes == 0)
+      return 77;
+
+  struct thread_frames parallel[NTHREADS + 1];
+  memset (parallel, 0, sizeof parallel);
+  if (dwfl_getthreads_parallel (dwfl, 4, parallel_callback, parallel) != 0)
+    error (2, 0, "dwfl_getthreads_parallel: %s", dwfl_errmsg (-1));
+
+  for (size_t i = 0; i < nserial; i++)
+    {
+      assert (parallel[i].tid == serial[i].tid);
+      if (parallel[i].nframes != serial[i].nframes
+	  || memcmp (parallel[i].pc, serial[i].pc,
+		     serial[i].nframes * sizeof serial[i].pc[0]) != 0)
+	error (1, 0, "thread %ld: parallel backtrace differs",
+	       (long) serial[i].tid);
+      assert (serial[i].nframes > 0);
+    }
+
+  /* Default worker count too, stopping early.  */
+  assert (dwfl_getthreads_parallel (dwfl, 0, abort_callback, NULL) == 12);
+
+  dwfl_end (dwfl);
+
+  return 0;
+}
@@ -0,0 +1,139 @@
+/* Test program for dwfl_linux_proc_refresh.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <error.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include ELFUTILS_HEADER(dwfl)
+
+
+static int
+count_module (Dwfl_Module *mod __attribute__ ((unused)),
+	      void **userdata __attribute__ ((unused)),
+	      const char *name __attribute__ ((unused)),
+	      Dwarf_Addr start __attribute__ ((unused)), void *arg)
+{
+  ++*(int *) arg;
+  return DWARF_CB_OK;
+}
+
+static int
+count_modules (Dwfl *dwfl)
+{
+  int n = 0;
+  if (dwfl_getmodules (dwfl, &count_module, &n, 0) != 0)
+    error (2, 0, "dwfl_getmodules: %s", dwfl_errmsg (-1));
+  return n;
+}
+
+static int
+note_removed (Dwfl_Module *mod __attribute__ ((unused)),
+	      void *userdata __attribute__ ((unused)),
+	      const char *name __attribute__ ((unused)),
+	      Dwarf_Addr base __attribute__ ((unused)), void *arg)
+{
+  ++*(int *) arg;
+  return 0;
+}
+
+static void
+refresh (Dwfl *dwfl, int *nremoved)
+{
+  int result = dwfl_linux_proc_refresh (dwfl, getpid (),
+					&note_removed, nremoved);
+  if (result < 0)
+    error (2, 0, "dwfl_linux_proc_refresh: %s", dwfl_errmsg (-1));
+  else if (result > 0)
+    error (2, result, "dwfl_linux_proc_refresh");
+}
+
+int
+main (void)
+{
+  static char *debuginfo_path;
+  static const Dwfl_Callbacks proc_callbacks =
+    {
+      .find_debuginfo = dwfl_standard_find_debuginfo,
+      .debuginfo_path = &debuginfo_path,
+
+      .find_elf = dwfl_linux_proc_find_elf,
+    };
+  Dwfl *dwfl = dwfl_begin (&proc_callbacks);
+  if (dwfl == NULL)
+    error (2, 0, "dwfl_begin: %s", dwfl_errmsg (-1));
+
+  int result = dwfl_linux_proc_report (dwfl, getpid ());
+  if (result < 0)
+    error (2, 0, "dwfl_linux_proc_report: %s", dwfl_errmsg (-1));
+  else if (result > 0)
+    error (2, result, "dwfl_linux_proc_report");
+  if (dwfl_report_end (dwfl, NULL, NULL) != 0)
+    error (2, 0, "dwfl_report_end: %s", dwfl_errmsg (-1));
+
+  const int nmods = count_modules (dwfl);
+  Dwfl_Module *mainmod = dwfl_addrmodule (dwfl, (uintptr_t) &main);
+  assert (mainmod != NULL);
+
+  /* Nothing changed, everything must stay as it is.  */
+  int nremoved = 0;
+  refresh (dwfl, &nremoved);
+  assert (nremoved == 0);
+  assert (count_modules (dwfl) == nmods);
+  assert (dwfl_addrmodule (dwfl, (uintptr_t) &main) == mainmod);
+
+  /* Map a new file, it must show up as one more module.  */
+  char tmpname[] = "/tmp/dwfl-proc-refresh.XXXXXX";
+  int fd = mkstemp (tmpname);
+  if (fd < 0)
+    error (2, errno, "mkstemp");
+  long pagesize = sysconf (_SC_PAGESIZE);
+  if (ftruncate (fd, pagesize) != 0)
+    error (2, errno, "ftruncate");
+  void *map = mmap (NULL, pagesize, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED)
+    error (2, errno, "mmap");
+
+  refresh (dwfl, &nremoved);
+  assert (nremoved == 0);
+  assert (count_modules (dwfl) == nmods + 1);
+  assert (dwfl_addrmodule (dwfl, (uintptr_t) &main) == mainmod);
+  Dwfl_Module *tmpmod = dwfl_addrmodule (dwfl, (uintptr_t) map);
+  assert (tmpmod != NULL);
+  const char *name = dwfl_module_info (tmpmod, NULL, NULL, NULL,
+				      NULL, NULL, NULL, NULL);
+  assert (strcmp (name, tmpname) == 0);
+
+  /* And unmapping it removes just that module again.  */
+  munmap (map, pagesize);
+  close (fd);
+  unlink (tmpname);
+
+  refresh (dwfl, &nremoved);
+  assert (nremoved == 1);
+  assert (count_modules (dwfl) == nmods);
+  assert (dwfl_addrmodule (dwfl, (uintptr_t) &main) == mainmod);
+
+  dwfl_end (dwfl);
+
+  return 0;
+}
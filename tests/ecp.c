@@ -19,34 +19,38 @@
 #include <error.h>
 #include <fcntl.h>
 #include <gelf.h>
+#include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <sys/stat.h>
 
-int
-main (int argc, char *argv[])
+/* Copy FROMNAME to TONAME, letting libelf copy the section contents
+   directly from the input file if SOURCE and using mmap if USE_MMAP.  */
+static void
+copy (const char *fromname, const char *toname, bool source, bool use_mmap)
 {
-  if (argc < 3)
-    error (EXIT_FAILURE, 0, "usage: %s FROMNAME TONAME", argv[0]);
-
-  elf_version (EV_CURRENT);
-
-  int infd = open (argv[1], O_RDONLY);
+  int infd = open (fromname, O_RDONLY);
   if (infd == -1)
-    error (EXIT_FAILURE, errno, "cannot open input file '%s'", argv[1]);
+    error (EXIT_FAILURE, errno, "cannot open input file '%s'", fromname);
 
-  Elf *inelf = elf_begin (infd, ELF_C_READ, NULL);
+  Elf *inelf = elf_begin (infd, use_mmap ? ELF_C_READ_MMAP : ELF_C_READ,
+			  NULL);
   if (inelf == NULL)
     error (EXIT_FAILURE, 0, "problems opening '%s' as ELF file: %s",
-	   argv[1], elf_errmsg (-1));
+	   fromname, elf_errmsg (-1));
 
-  int outfd = creat (argv[2], 0666);
+  int outfd = open (toname, O_RDWR | O_CREAT | O_TRUNC, 0666);
   if (outfd == -1)
-    error (EXIT_FAILURE, errno, "cannot open output file '%s'", argv[2]);
+    error (EXIT_FAILURE, errno, "cannot open output file '%s'", toname);
 
-  Elf *outelf = elf_begin (outfd, ELF_C_WRITE, NULL);
+  Elf *outelf = elf_begin (outfd, use_mmap ? ELF_C_WRITE_MMAP : ELF_C_WRITE,
+			   NULL);
   if (outelf == NULL)
     error (EXIT_FAILURE, 0, "problems opening '%s' as ELF file: %s",
-	   argv[2], elf_errmsg (-1));
+	   toname, elf_errmsg (-1));
 
   gelf_newehdr (outelf, gelf_getclass (inelf));
 
@@ -78,7 +82,13 @@ main (int argc, char *argv[])
       GElf_Shdr shdr_mem;
       gelf_update_shdr (newscn, gelf_getshdr (scn, &shdr_mem));
 
-      *elf_newdata (newscn) = *elf_getdata (scn, NULL);
+      Elf_Data *newdata = elf_newdata (newscn);
+      *newdata = *elf_getdata (scn, NULL);
+
+      if (source && shdr_mem.sh_type != SHT_NOBITS
+	  && elf_setdata_source (newdata, scn) != 0)
+	error (EXIT_FAILURE, 0, "elf_setdata_source failed: %s",
+	       elf_errmsg (-1));
     }
 
   elf_flagelf (outelf, ELF_C_SET, ELF_F_LAYOUT);
@@ -90,6 +100,60 @@ main (int argc, char *argv[])
   close (outfd);
 
   elf_end (inelf);
+  close (infd);
+}
+
+int
+main (int argc, char *argv[])
+{
+  bool source = false;
+  bool use_mmap = false;
+  int repeat = 0;
+
+  /* --source uses elf_setdata_source, --mmap reads and writes the files
+     through mmap, --repeat=N copies N times and reports the throughput.  */
+  while (argc > 1 && strncmp (argv[1], "--", 2) == 0)
+    {
+      if (strcmp (argv[1], "--source") == 0)
+	source = true;
+      else if (strcmp (argv[1], "--mmap") == 0)
+	use_mmap = true;
+      else if (strncmp (argv[1], "--repeat=", 9) == 0)
+	repeat = atoi (argv[1] + 9);
+      else
+	break;
+      --argc;
+      ++argv;
+    }
+
+  if (argc < 3)
+    error (EXIT_FAILURE, 0,
+	   "usage: %s [--source] [--mmap] [--repeat=N] FROMNAME TONAME",
+	   argv[0]);
+
+  elf_version (EV_CURRENT);
+
+  if (repeat <= 0)
+    {
+      copy (argv[1], argv[2], source, use_mmap);
+      return 0;
+    }
+
+  struct stat st;
+  if (stat (argv[1], &st) != 0)
+    error (EXIT_FAILURE, errno, "cannot stat '%s'", argv[1]);
+
+  struct timespec start, end;
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < repeat; ++i)
+    copy (argv[1], argv[2], source, use_mmap);
+  clock_gettime (CLOCK_MONOTONIC, &end);
+
+  double secs = ((end.tv_sec - start.tv_sec)
+		 + (end.tv_nsec - start.tv_nsec) / 1e9);
+  printf ("%d copies of %lld bytes in %.3fs, %.1f MB/s\n",
+	  repeat, (long long int) st.st_size, secs,
+	  repeat * (double) st.st_size / secs / 1e6);
 
   return 0;
 }
@@ -0,0 +1,183 @@
+/* Benchmark and test for allocating ELF descriptors in an arena.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <errno.h>
+#include <error.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include ELFUTILS_HEADER(elf)
+#include <gelf.h>
+
+/* Usage: elf-arena COUNT FILE...
+
+   Open and close COUNT descriptors for the contents of the FILEs in
+   turn, reading all section headers and the members of archives.
+   This is done with descriptors of their own, in an arena with
+   elf_end for each descriptor, and in an arena released in bulk
+   every BATCH descriptors.  The last arena is ended with descriptors
+   still in use.  Print the time each way took and fail if
+   they see different contents.  */
+
+#define BATCH 100
+
+enum mode
+{
+  mode_malloc,
+  mode_arena,
+  mode_bulk
+};
+
+static const char *const mode_names[] =
+  {
+    [mode_malloc] = "malloc",
+    [mode_arena] = "arena",
+    [mode_bulk] = "arena, bulk release"
+  };
+
+struct image
+{
+  char *buf;
+  size_t size;
+};
+
+
+static uint64_t
+sum_elf (Elf *elf, enum mode mode)
+{
+  uint64_t sum = elf_kind (elf);
+
+  if (elf_kind (elf) == ELF_K_AR)
+    {
+      Elf *sub;
+      while ((sub = elf_begin (-1, ELF_C_READ_MMAP, elf)) != NULL)
+	{
+	  sum = sum * 31 + sum_elf (sub, mode);
+	  elf_next (sub);
+	  if (mode != mode_bulk)
+	    elf_end (sub);
+	}
+      return sum;
+    }
+
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL)
+	error (EXIT_FAILURE, 0, "gelf_getshdr: %s", elf_errmsg (-1));
+      sum = sum * 31 + shdr->sh_type + shdr->sh_size;
+    }
+
+  return sum;
+}
+
+
+static uint64_t
+run (struct image *images, int nimages, unsigned long count, enum mode mode)
+{
+  Elf_Arena *arena = NULL;
+  uint64_t sum = 0;
+
+  for (unsigned long n = 0; n < count; ++n)
+    {
+      if (mode != mode_malloc && arena == NULL)
+	{
+	  arena = elf_arena_begin ();
+	  if (arena == NULL)
+	    error (EXIT_FAILURE, 0, "elf_arena_begin: %s", elf_errmsg (-1));
+	  elf_arena_use (arena);
+	}
+
+      struct image *image = &images[n % nimages];
+      Elf *elf = elf_memory (image->buf, image->size);
+      if (elf == NULL)
+	error (EXIT_FAILURE, 0, "elf_memory: %s", elf_errmsg (-1));
+      sum = sum * 31 + sum_elf (elf, mode);
+
+      if (mode != mode_bulk)
+	elf_end (elf);
+      else if ((n + 1) % BATCH == 0 && n + 1 < count
+	       && elf_arena_release (arena) != 0)
+	error (EXIT_FAILURE, 0, "elf_arena_release failed");
+    }
+
+  if (arena != NULL)
+    {
+      elf_arena_use (NULL);
+      if (elf_arena_end (arena) != 0)
+	error (EXIT_FAILURE, 0, "elf_arena_end failed");
+    }
+
+  return sum;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  if (argc < 3)
+    error (EXIT_FAILURE, 0, "usage: %s COUNT FILE...", argv[0]);
+
+  unsigned long count = strtoul (argv[1], NULL, 0);
+
+  elf_version (EV_CURRENT);
+
+  int nimages = argc - 2;
+  struct image images[nimages];
+  for (int i = 0; i < nimages; ++i)
+    {
+      FILE *f = fopen (argv[2 + i], "r");
+      if (f == NULL)
+	error (EXIT_FAILURE, errno, "cannot open '%s'", argv[2 + i]);
+      fseek (f, 0, SEEK_END);
+      images[i].size = ftell (f);
+      images[i].buf = malloc (images[i].size);
+      rewind (f);
+      if (images[i].buf == NULL
+	  || fread (images[i].buf, 1, images[i].size, f) != images[i].size)
+	error (EXIT_FAILURE, errno, "cannot read '%s'", argv[2 + i]);
+      fclose (f);
+    }
+
+  uint64_t expect = 0;
+  for (enum mode mode = mode_malloc; mode <= mode_bulk; ++mode)
+    {
+      struct timespec start, end;
+      clock_gettime (CLOCK_MONOTONIC, &start);
+
+      uint64_t sum = run (images, nimages, count, mode);
+
+      clock_gettime (CLOCK_MONOTONIC, &end);
+      printf ("%s: %.3f ms\n", mode_names[mode],
+	      ((end.tv_sec - start.tv_sec) * 1e3
+	       + (end.tv_nsec - start.tv_nsec) / 1e6));
+
+      if (mode == mode_malloc)
+	expect = sum;
+      else if (sum != expect)
+	error (EXIT_FAILURE, 0, "%s saw different contents",
+	       mode_names[mode]);
+    }
+
+  for (int i = 0; i < nimages; ++i)
+    free (images[i].buf);
+
+  return 0;
+}
@@ -0,0 +1,187 @@
+/* Benchmark and test for reading one ELF file from several threads.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(elf)
+#include <gelf.h>
+
+/* Usage: elf-getdata-threads MAXTHREADS ROUNDS FILE...
+
+   For 1, 2, 4, ... up to MAXTHREADS threads, open each FILE ROUNDS
+   times and let all threads get the headers and the data of all
+   sections of the same descriptor, each starting at a different
+   section.  Do the same once more with all the data loaded by one
+   thread before the others start.  Print the time each step took and
+   fail if a thread sees different contents than a single thread does.
+   Without a thread-safe libelf only the preloaded case is run.  */
+
+struct job
+{
+  Elf *elf;
+  size_t shnum;
+  size_t start;
+  uint64_t sum;
+};
+
+
+static uint64_t
+sum_scn (Elf_Scn *scn)
+{
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+  if (shdr == NULL)
+    error (EXIT_FAILURE, 0, "gelf_getshdr: %s", elf_errmsg (-1));
+
+  uint64_t sum = shdr->sh_type;
+  Elf_Data *data = elf_getdata (scn, NULL);
+  if (data == NULL)
+    /* Broken sections are fine, as long as all threads agree.  */
+    return sum;
+
+  sum += data->d_size + data->d_type;
+  if (data->d_buf != NULL)
+    for (size_t i = 0; i < data->d_size; i += 64)
+      sum += ((unsigned char *) data->d_buf)[i];
+
+  return sum;
+}
+
+
+static void *
+run_job (void *arg)
+{
+  struct job *job = arg;
+
+  job->sum = 0;
+  for (size_t n = 0; n < job->shnum; ++n)
+    {
+      size_t ndx = (job->start + n) % job->shnum;
+      Elf_Scn *scn = elf_getscn (job->elf, ndx);
+      if (scn == NULL)
+	error (EXIT_FAILURE, 0, "elf_getscn: %s", elf_errmsg (-1));
+      job->sum += sum_scn (scn) * (ndx + 1);
+    }
+
+  return NULL;
+}
+
+
+static uint64_t
+read_file (const char *fname, unsigned int nthreads, uint64_t expect,
+	   bool preload)
+{
+  int fd = open (fname, O_RDONLY);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "cannot open '%s'", fname);
+
+  /* Not mapped, so the data has to be read and maybe converted.  */
+  Elf *elf = elf_begin (fd, ELF_C_READ, NULL);
+  if (elf == NULL)
+    error (EXIT_FAILURE, 0, "elf_begin '%s': %s", fname, elf_errmsg (-1));
+
+  size_t shnum;
+  if (elf_getshdrnum (elf, &shnum) != 0)
+    error (EXIT_FAILURE, 0, "elf_getshdrnum '%s': %s", fname,
+	   elf_errmsg (-1));
+
+  struct job jobs[nthreads];
+  pthread_t threads[nthreads];
+  for (unsigned int i = 0; i < nthreads; ++i)
+    {
+      jobs[i].elf = elf;
+      jobs[i].shnum = shnum;
+      jobs[i].start = shnum * i / nthreads;
+    }
+
+  /* Once everything is loaded the threads only look at it.  */
+  if (preload)
+    run_job (&jobs[0]);
+
+  for (unsigned int i = 0; i < nthreads; ++i)
+    {
+      if (i > 0 && pthread_create (&threads[i], NULL, run_job, &jobs[i]) != 0)
+	error (EXIT_FAILURE, 0, "pthread_create failed");
+    }
+  run_job (&jobs[0]);
+  for (unsigned int i = 1; i < nthreads; ++i)
+    pthread_join (threads[i], NULL);
+
+  for (unsigned int i = 0; i < nthreads; ++i)
+    if (expect != 0 && jobs[i].sum != expect)
+      error (EXIT_FAILURE, 0, "%s: thread %u of %u saw different data",
+	     fname, i, nthreads);
+
+  elf_end (elf);
+  close (fd);
+
+  return jobs[0].sum;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  if (argc < 4)
+    error (EXIT_FAILURE, 0,
+	   "usage: %s MAXTHREADS ROUNDS FILE...", argv[0]);
+
+  unsigned int maxthreads = atoi (argv[1]);
+  unsigned int rounds = atoi (argv[2]);
+
+  elf_version (EV_CURRENT);
+
+  int nfiles = argc - 3;
+  uint64_t sums[nfiles];
+  for (int f = 0; f < nfiles; ++f)
+    sums[f] = read_file (argv[3 + f], 1, 0, false);
+
+  for (int preload = 0; preload < 2; ++preload)
+    {
+#ifndef USE_LOCKS
+      /* Loading the data is only safe in one thread at a time.  */
+      if (! preload)
+	continue;
+#endif
+
+      for (unsigned int nthreads = 1; nthreads <= maxthreads; nthreads *= 2)
+	{
+	  struct timespec start, end;
+	  clock_gettime (CLOCK_MONOTONIC, &start);
+
+	  for (unsigned int r = 0; r < rounds; ++r)
+	    for (int f = 0; f < nfiles; ++f)
+	      read_file (argv[3 + f], nthreads, sums[f], preload);
+
+	  clock_gettime (CLOCK_MONOTONIC, &end);
+	  printf ("%u threads%s: %.3f ms\n", nthreads,
+		  preload ? ", preloaded" : "",
+		  ((end.tv_sec - start.tv_sec) * 1e3
+		   + (end.tv_nsec - start.tv_nsec) / 1e6));
+	}
+    }
+
+  return 0;
+}
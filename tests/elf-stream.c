@@ -0,0 +1,123 @@
+/* Test program for reading ELF files from pipes and streams.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(elf)
+#include <gelf.h>
+
+/* Usage: elf-stream FILE < FILE
+
+   Read FILE directly, from standard input, which should be a pipe,
+   and through elf_begin_stream in small pieces.  Fail if they do not
+   all see the same section headers and contents.  */
+
+
+static uint64_t
+sum_elf (Elf *elf)
+{
+  if (elf == NULL)
+    error (EXIT_FAILURE, 0, "elf_begin: %s", elf_errmsg (-1));
+  assert (elf_kind (elf) == ELF_K_ELF);
+
+  uint64_t sum = 0;
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL)
+	error (EXIT_FAILURE, 0, "gelf_getshdr: %s", elf_errmsg (-1));
+      sum = sum * 31 + shdr->sh_type + shdr->sh_size;
+
+      Elf_Data *data = elf_rawdata (scn, NULL);
+      if (data == NULL)
+	error (EXIT_FAILURE, 0, "elf_rawdata: %s", elf_errmsg (-1));
+      if (shdr->sh_type != SHT_NOBITS)
+	for (size_t i = 0; i < data->d_size; ++i)
+	  sum = sum * 31 + ((unsigned char *) data->d_buf)[i];
+    }
+
+  if (elf_end (elf) != 0)
+    error (EXIT_FAILURE, 0, "elf_end: %s", elf_errmsg (-1));
+  return sum;
+}
+
+
+/* Hand out the file in odd sized pieces.  */
+static ssize_t
+read_pieces (void *arg, void *buf, size_t size)
+{
+  int fd = *(int *) arg;
+  return read (fd, buf, size < 1000 ? size : 1000);
+}
+
+static ssize_t
+read_nothing (void *arg __attribute__ ((unused)),
+	      void *buf __attribute__ ((unused)),
+	      size_t size __attribute__ ((unused)))
+{
+  return 0;
+}
+
+static ssize_t
+read_error (void *arg __attribute__ ((unused)),
+	    void *buf __attribute__ ((unused)),
+	    size_t size __attribute__ ((unused)))
+{
+  errno = EIO;
+  return -1;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  if (argc != 2)
+    error (EXIT_FAILURE, 0, "usage: %s FILE < FILE", argv[0]);
+
+  elf_version (EV_CURRENT);
+
+  int fd = open (argv[1], O_RDONLY);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "cannot open '%s'", argv[1]);
+  uint64_t expect = sum_elf (elf_begin (fd, ELF_C_READ, NULL));
+
+  if (sum_elf (elf_begin (STDIN_FILENO, ELF_C_READ, NULL)) != expect)
+    error (EXIT_FAILURE, 0, "standard input differs");
+
+  if (lseek (fd, 0, SEEK_SET) != 0)
+    error (EXIT_FAILURE, errno, "lseek");
+  if (sum_elf (elf_begin_stream (read_pieces, &fd, ELF_C_READ)) != expect)
+    error (EXIT_FAILURE, 0, "elf_begin_stream differs");
+  close (fd);
+
+  Elf *elf = elf_begin_stream (read_nothing, NULL, ELF_C_READ_MMAP);
+  assert (elf != NULL && elf_kind (elf) == ELF_K_NONE);
+  elf_end (elf);
+
+  assert (elf_begin_stream (read_error, NULL, ELF_C_READ) == NULL);
+  assert (elf_begin_stream (read_pieces, &fd, ELF_C_WRITE) == NULL);
+
+  return 0;
+}
@@ -0,0 +1,153 @@
+/* Test and benchmark for printing numbers and strings without printf.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <error.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <system.h>
+
+/* Usage: printout COUNT
+
+   Print COUNT lines of numbers and strings of all sizes in columns,
+   once with fprintf and once with the put_* functions, and fail unless
+   they come out the same.  Print how many MB per second each way
+   produced.  */
+
+
+/* One line, alike to what readelf prints for symbols, relocations and
+   DWARF attributes.  */
+static void
+line_printf (FILE *fp, unsigned long n, uintmax_t u, intmax_t i,
+	     const char *s)
+{
+  fprintf (fp, "%5lu: %0*jx %6jd %-7s %6s %#0*jx  %+6jd [%6jx] %#jx %ju"
+	   " %*s%s%-20s|%jd\n",
+	   n, (int) (n % 17), u, i, s, s, (int) (n % 19), u, i, u, u, u,
+	   (int) (n % 5), "", s, s, i);
+}
+
+static void
+line_put (FILE *fp, unsigned long n, uintmax_t u, intmax_t i,
+	  const char *s)
+{
+  put_unsigned (fp, n, 5, 0);
+  fputs_unlocked (": ", fp);
+  put_hex (fp, u, n % 17, PUT_ZERO);
+  putc_unlocked (' ', fp);
+  put_signed (fp, i, 6, 0);
+  putc_unlocked (' ', fp);
+  put_str (fp, s, -7);
+  putc_unlocked (' ', fp);
+  put_str (fp, s, 6);
+  putc_unlocked (' ', fp);
+  put_hex (fp, u, n % 19, PUT_ALT | PUT_ZERO);
+  fputs_unlocked ("  ", fp);
+  put_signed (fp, i, 6, PUT_PLUS);
+  fputs_unlocked (" [", fp);
+  put_hex (fp, u, 6, 0);
+  fputs_unlocked ("] ", fp);
+  put_hex (fp, u, 0, PUT_ALT);
+  putc_unlocked (' ', fp);
+  put_unsigned (fp, u, 0, 0);
+  putc_unlocked (' ', fp);
+  put_pad (fp, n % 5);
+  put_str (fp, s, 0);
+  put_str (fp, s, -20);
+  putc_unlocked ('|', fp);
+  put_signed (fp, i, 0, 0);
+  putc_unlocked ('\n', fp);
+}
+
+
+static char *
+run (const char *name, unsigned long count,
+     void (*line) (FILE *, unsigned long, uintmax_t, intmax_t, const char *),
+     size_t *size)
+{
+  static const char *const strings[] =
+    {
+      "", "x", "FUNC", "GLOBAL", "DEFAULT", "R_X86_64_JUMP_SLOT",
+      "a_rather_long_symbol_name_for_the_columns", NULL
+    };
+  const size_t nstrings = sizeof strings / sizeof strings[0];
+
+  char *buf;
+  FILE *fp = open_memstream (&buf, size);
+  if (fp == NULL)
+    error (EXIT_FAILURE, 0, "open_memstream failed");
+
+  struct timespec start, end;
+  clock_gettime (CLOCK_MONOTONIC, &start);
+
+  uint64_t val = 0x123456789abcdef;
+  for (unsigned long n = 0; n < count; ++n)
+    {
+      /* All sizes of numbers, including the extremes.  */
+      val = val * 6364136223846793005ULL + 1442695040888963407ULL;
+      uintmax_t u = val >> (n % 64);
+      intmax_t i = n % 7 == 0 ? INTMAX_MIN : (intmax_t) val >> (n % 63);
+      if (n % 11 == 0)
+	u = n % 2 ? UINTMAX_MAX : 0;
+      line (fp, n, u, i, strings[n % nstrings]);
+    }
+
+  if (fclose (fp) != 0)
+    error (EXIT_FAILURE, 0, "fclose failed");
+
+  clock_gettime (CLOCK_MONOTONIC, &end);
+  double secs = ((end.tv_sec - start.tv_sec)
+		 + (end.tv_nsec - start.tv_nsec) / 1e9);
+  printf ("%s: %.3f ms, %.1f MB/s\n", name, secs * 1e3,
+	  *size / (secs > 0 ? secs : 1e-9) / 1e6);
+
+  return buf;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  if (argc != 2)
+    error (EXIT_FAILURE, 0, "usage: %s COUNT", argv[0]);
+
+  unsigned long count = strtoul (argv[1], NULL, 0);
+
+  size_t expect_size;
+  char *expect = run ("fprintf", count, line_printf, &expect_size);
+  size_t size;
+  char *buf = run ("put", count, line_put, &size);
+
+  if (size != expect_size || memcmp (buf, expect, size) != 0)
+    {
+      size_t n = 0;
+      while (n < size && n < expect_size && buf[n] == expect[n])
+	++n;
+      size_t line = n;
+      while (line > 0 && expect[line - 1] != '\n')
+	--line;
+      error (EXIT_FAILURE, 0, "output differs at byte %zu, line:\n%.*s",
+	     n, (int) strcspn (&expect[line], "\n"), &expect[line]);
+    }
+
+  free (buf);
+  free (expect);
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+/* Test program for elf_getdata_rawchunk and elf_rawchunk.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(elf)
+#include <gelf.h>
+
+
+static void
+check (const char *fname, Elf_Cmd cmd)
+{
+  int fd = open (fname, O_RDONLY);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "cannot open '%s'", fname);
+
+  Elf *elf = elf_begin (fd, cmd, NULL);
+  if (elf == NULL)
+    error (EXIT_FAILURE, 0, "elf_begin '%s': %s", fname, elf_errmsg (-1));
+
+  GElf_Ehdr ehdr_mem;
+  GElf_Ehdr *ehdr = gelf_getehdr (elf, &ehdr_mem);
+  assert (ehdr != NULL);
+  size_t phsize = gelf_fsize (elf, ELF_T_PHDR, ehdr->e_phnum, EV_CURRENT);
+
+  /* The same request gives the same result.  */
+  Elf_Data *bytes = elf_getdata_rawchunk (elf, ehdr->e_phoff, phsize,
+					  ELF_T_BYTE);
+  Elf_Data *phdrs = elf_getdata_rawchunk (elf, ehdr->e_phoff, phsize,
+					  ELF_T_PHDR);
+  assert (bytes != NULL && phdrs != NULL);
+  assert (bytes != phdrs);
+  assert (elf_getdata_rawchunk (elf, ehdr->e_phoff, phsize,
+				ELF_T_BYTE) == bytes);
+  assert (elf_getdata_rawchunk (elf, ehdr->e_phoff, phsize,
+				ELF_T_PHDR) == phdrs);
+  assert (elf_getdata_rawchunk (elf, ehdr->e_phoff, phsize - 1,
+				ELF_T_BYTE) != bytes);
+
+  /* Many different requests have to be told apart.  */
+  Elf_Data *chunks[256];
+  for (size_t i = 0; i < 256; ++i)
+    {
+      chunks[i] = elf_getdata_rawchunk (elf, i, 1, ELF_T_BYTE);
+      assert (chunks[i] != NULL);
+    }
+  for (size_t i = 0; i < 256; ++i)
+    assert (elf_getdata_rawchunk (elf, i, 1, ELF_T_BYTE) == chunks[i]);
+
+  /* Borrowing is only possible from a mapped file and then gives the
+     same contents.  */
+  const void *raw = elf_rawchunk (elf, ehdr->e_phoff, phsize, ELF_T_BYTE);
+  if (cmd == ELF_C_READ)
+    assert (raw == NULL);
+  else
+    {
+      assert (raw != NULL);
+      assert (memcmp (raw, bytes->d_buf, phsize) == 0);
+    }
+  raw = elf_rawchunk (elf, ehdr->e_phoff, phsize, ELF_T_PHDR);
+  if (raw != NULL)
+    assert (memcmp (raw, phdrs->d_buf, phsize) == 0);
+
+  assert (elf_rawchunk (elf, -1, 1, ELF_T_BYTE) == NULL);
+  assert (elf_getdata_rawchunk (elf, -1, 1, ELF_T_BYTE) == NULL);
+
+  elf_end (elf);
+  close (fd);
+}
+
+int
+main (int argc, char *argv[])
+{
+  elf_version (EV_CURRENT);
+
+  for (int i = 1; i < argc; ++i)
+    {
+      check (argv[i], ELF_C_READ);
+      check (argv[i], ELF_C_READ_MMAP);
+    }
+
+  return 0;
+}
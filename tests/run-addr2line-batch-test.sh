@@ -0,0 +1,42 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+testfiles testfile-inlines
+tempfiles addrs out.plain out.batch
+
+# Every address of the file, in descending and then ascending order so
+# the batch has to sort and finds each address cached the second time.
+# A symbol and an unparsable line must keep their place in the output.
+(i=3000; while [ $i -ge 0 ]; do printf '%#x\n' $i; i=$((i - 1)); done
+ echo _Z3barv
+ echo ??
+ i=0; while [ $i -le 3000 ]; do printf '%#x\n' $i; i=$((i + 1)); done
+) > addrs
+
+for opts in "-f -i -s" "-S -x -F"; do
+  testrun ${abs_top_builddir}/src/addr2line -e testfile-inlines $opts \
+    < addrs > out.plain 2>/dev/null || true
+  testrun ${abs_top_builddir}/src/addr2line -e testfile-inlines $opts \
+    --batch < addrs > out.batch 2>/dev/null || true
+  cmp out.plain out.batch
+  testrun ${abs_top_builddir}/src/addr2line -e testfile-inlines $opts \
+    --batch=2500 --threads=3 < addrs > out.batch 2>/dev/null || true
+  cmp out.plain out.batch
+done
+
+exit 0
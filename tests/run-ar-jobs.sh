@@ -0,0 +1,47 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Archive members handled in parallel have to produce the same output,
+# in the same order, as when handled one after the other.
+testfiles testarchive64.a
+
+for ar in testarchive64.a ${abs_top_builddir}/libdw/libdw.a; do
+  testrun_out nm.out ${abs_top_builddir}/src/nm -s $ar
+  testrun_out elflint.out ${abs_top_builddir}/src/elflint --gnu-ld $ar
+  for jobs in 2 0; do
+    testrun_out nm-jobs.out ${abs_top_builddir}/src/nm -s -j $jobs $ar
+    cmp nm.out nm-jobs.out
+    testrun_out elflint-jobs.out \
+      ${abs_top_builddir}/src/elflint --gnu-ld -j $jobs $ar
+    cmp elflint.out elflint-jobs.out
+  done
+done
+
+# A single member is handled in the thread handling the archive, which
+# has to go on printing what comes after the archive.
+tempfiles one.a
+testrun ${abs_top_builddir}/src/ar rc one.a ${abs_top_builddir}/src/size.o
+files="one.a testarchive64.a one.a"
+testrun_out nm.out ${abs_top_builddir}/src/nm -s $files
+testrun_out nm-jobs.out ${abs_top_builddir}/src/nm -s -j 2 $files
+cmp nm.out nm-jobs.out
+testrun_out elflint.out ${abs_top_builddir}/src/elflint --gnu-ld $files
+testrun_out elflint-jobs.out ${abs_top_builddir}/src/elflint --gnu-ld -j 2 $files
+cmp elflint.out elflint-jobs.out
+
+exit 0
@@ -0,0 +1,27 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# dwfl_addrinfo_batch must give the same answers as looking up every
+# address on its own.  See run-addr2line-i-test.sh for testfile-inlines.
+testfiles testfile testfile-inlines testfile52-64.so testfile52-64.so.debug
+
+testrun ${abs_builddir}/dwfl-addrinfo-batch -e testfile
+testrun ${abs_builddir}/dwfl-addrinfo-batch -e testfile-inlines
+testrun ${abs_builddir}/dwfl-addrinfo-batch -e testfile52-64.so
+
+exit 0
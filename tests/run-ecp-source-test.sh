@@ -0,0 +1,33 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Copying the section contents directly from the input file must give
+# the same output as writing the buffers, for both byte orders and
+# both ways of writing the file.
+testfiles testfile2 testfile11 testfile23
+tempfiles ecp.buf ecp.src
+
+for file in testfile2 testfile11 testfile23; do
+  for mode in "" --mmap; do
+    testrun ${abs_builddir}/ecp $mode $file ecp.buf
+    testrun ${abs_builddir}/ecp --source $mode $file ecp.src
+    cmp ecp.buf ecp.src
+  done
+done
+
+exit 0
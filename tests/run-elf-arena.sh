@@ -0,0 +1,28 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Descriptors in an arena must see the same as those of their own,
+# also when the arena is released with descriptors still open.  Only a
+# short run here, the timings are not checked.  The benchmark proper
+# is elf-arena 100000 on a set of small files.
+testfiles testfile hello_s390.ko testarchive64.a
+
+testrun ${abs_builddir}/elf-arena 3000 testfile hello_s390.ko \
+  testarchive64.a > /dev/null
+
+exit 0
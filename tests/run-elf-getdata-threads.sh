@@ -0,0 +1,26 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Threads sharing one descriptor must all see the same section data.
+# Only a short run here, the timings are not checked.
+testfiles testfile backtrace.s390x.core
+
+testrun ${abs_builddir}/elf-getdata-threads 4 2 testfile \
+  backtrace.s390x.core ${abs_top_builddir}/libdw/libdw.so > /dev/null
+
+exit 0
@@ -0,0 +1,46 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# elf_begin on a pipe and elf_begin_stream see the same file.
+testfiles testfile hello_s390.ko
+
+for file in testfile hello_s390.ko; do
+  cat $file | testrun ${abs_builddir}/elf-stream $file
+done
+
+# Also when there is no directory for the temporary file.
+(TMPDIR=$PWD/no-such-dir; export TMPDIR
+ cat testfile | testrun ${abs_builddir}/elf-stream testfile)
+
+# libdwfl decompresses through elf_begin_stream.
+testfiles testfilebaztab
+tempfiles dwflsyms.out dwflsyms.z.out testfilebaztab.z
+
+testrun ${abs_builddir}/dwflsyms -e testfilebaztab > dwflsyms.out
+for z in gzip bzip2 xz; do
+  if type $z > /dev/null 2>&1; then
+    $z -c testfilebaztab > testfilebaztab.z
+    testrun ${abs_builddir}/dwflsyms -e testfilebaztab.z > dwflsyms.z.out
+    cmp dwflsyms.out dwflsyms.z.out
+    (TMPDIR=$PWD/no-such-dir; export TMPDIR
+     testrun ${abs_builddir}/dwflsyms -e testfilebaztab.z > dwflsyms.z.out)
+    cmp dwflsyms.out dwflsyms.z.out
+  fi
+done
+
+exit 0
@@ -0,0 +1,73 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Comparing sections several at once has to find the same differences
+# as comparing them one after the other, reported in the same order.
+testfiles testfile hello_s390.ko
+tempfiles elfcmp.a elfcmp.b elfcmp.out elfcmp-jobs.out
+
+cp ${abs_top_builddir}/libdw/libdw.so elfcmp.a
+cp elfcmp.a elfcmp.b
+testrun ${abs_top_builddir}/src/elfcmp elfcmp.a elfcmp.b
+testrun ${abs_top_builddir}/src/elfcmp -j 0 elfcmp.a elfcmp.b
+testrun ${abs_top_builddir}/src/elfcmp -j 3 -l elfcmp.a elfcmp.b
+
+patch()
+{
+  file=$1
+  shift
+  cp $file elfcmp.b
+  for off; do
+    printf 'x' | dd of=elfcmp.b bs=1 seek=$(($off)) conv=notrunc 2> /dev/null
+  done
+}
+
+compare()
+{
+  for opts in "" "-l" "-q" "-l --gaps=match" "-l --ignore-build-id"; do
+    status=0
+    testrun ${abs_top_builddir}/src/elfcmp $opts $1 elfcmp.b \
+      > elfcmp.out 2>&1 || status=$?
+    test $status -eq 1
+    for jobs in 0 2 5; do
+      status=0
+      testrun ${abs_top_builddir}/src/elfcmp -j $jobs $opts $1 elfcmp.b \
+	> elfcmp-jobs.out 2>&1 || status=$?
+      test $status -eq 1
+      cmp elfcmp.out elfcmp-jobs.out
+    done
+  done
+}
+
+# The build ID, .text and .modinfo of a big-endian file.
+patch hello_s390.ko 0x54 0x74 0x168
+compare hello_s390.ko
+
+# A symbol, .text and .data.  The first byte of the content which
+# differs is reported.
+patch testfile 0x17c 0x350 0x351 0x4e8
+compare testfile
+testrun_out elfcmp.out ${abs_top_builddir}/src/elfcmp -j 2 -l testfile elfcmp.b
+sed 's/^.*elfcmp: //' elfcmp.out > elfcmp-jobs.out
+diff -u elfcmp-jobs.out - <<\EOF
+testfile elfcmp.b differ: symbol table [4]
+testfile elfcmp.b differ: section [12] '.text' content at offset 0x20
+testfile elfcmp.b differ: section [15] '.data' content at offset 0x4
+EOF
+
+exit 0
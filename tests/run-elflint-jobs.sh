@@ -0,0 +1,38 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Sections checked in parallel have to give the same messages, in the
+# same order, as when checked one after the other.
+files="testfile testfile2 testfile8 testfile17 testfile17.debug \
+       testfile19.index testfile48.debug hello_x86_64.ko"
+testfiles $files
+tempfiles elflint.out elflint-jobs.out
+
+files="$files ${abs_top_builddir}/libelf/libelf.so \
+       ${abs_top_builddir}/libdw/libdw.so ${abs_top_builddir}/src/elflint"
+for opts in "--gnu-ld" "--strict" "-d"; do
+  testrun_out elflint.out ${abs_top_builddir}/src/elflint $opts $files
+  test -s elflint.out
+  for jobs in 2 0; do
+    testrun_out elflint-jobs.out \
+      ${abs_top_builddir}/src/elflint -j $jobs $opts $files
+    cmp elflint.out elflint-jobs.out
+  done
+done
+
+exit 0
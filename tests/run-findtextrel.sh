@@ -0,0 +1,45 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Text relocations are blamed on the function containing them, or on
+# the closest functions around them, through the symbol table.
+testfiles testfile52-32.so testfile52-32.prelink.so testfile54-64.so
+testfiles testfile54-32.prelink.so
+
+testrun_compare ${abs_top_builddir}/src/findtextrel testfile52-32.prelink.so <<\EOF
+the file containing the function 'foo' is not compiled with -fpic/-fPIC
+EOF
+
+testrun_compare ${abs_top_builddir}/src/findtextrel testfile52-32.so \
+  testfile54-64.so testfile54-32.prelink.so <<\EOF
+testfile52-32.so: the file containing the function 'foo' is not compiled with -fpic/-fPIC
+testfile54-64.so: the file containing the function '_end' might not be compiled with -fpic/-fPIC
+testfile54-32.prelink.so: the file containing the function '_end' might not be compiled with -fpic/-fPIC
+EOF
+
+# With the debug files found for files given by absolute name, the
+# source files are named instead.
+testfiles testfile52-32.so.debug testfile54-64.so.debug
+
+testrun_compare ${abs_top_builddir}/src/findtextrel --debuginfo=. \
+  $PWD/testfile52-32.so $PWD/testfile54-64.so <<EOF
+$PWD/testfile52-32.so: /home/jistone/src/elfutils/tests/testfile52-32.c not compiled with -fpic/-fPIC
+$PWD/testfile54-64.so: the file containing the function '_end' might not be compiled with -fpic/-fPIC
+EOF
+
+exit 0
@@ -0,0 +1,92 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Sections disassembled in pieces at once come out the same as when
+# disassembled from start to end.  This only holds as long as no
+# instruction decoded from the start of a section runs across a
+# function symbol, where a piece starts decoding afresh.  Compiled
+# code like in the files below has none of those.
+case "`uname -m`" in
+  x86_64)
+    tempfiles objdump.out objdump-jobs.out
+    for file in ${abs_top_builddir}/libelf/libelf.so \
+		${abs_top_builddir}/libdw/libdw.so; do
+      testrun ${abs_top_builddir}/src/objdump -d $file > objdump.out
+      for jobs in 0 3; do
+	testrun ${abs_top_builddir}/src/objdump -d --jobs=$jobs $file \
+	  > objdump-jobs.out
+	cmp objdump.out objdump-jobs.out
+      done
+    done
+
+    tempfiles testfile45.o
+    testfiles testfile45.S testfile45.expect
+    gcc -m64 -c -o testfile45.o testfile45.S
+    testrun_compare ${abs_top_builddir}/src/objdump -d --jobs=2 testfile45.o < testfile45.expect
+    ;;
+esac
+
+# Symbols of shared objects and executables name the addresses operands
+# refer to, and such a name is not repeated as the label of the next
+# instruction.  testfile72.so is built with
+# gcc -m64 -nostdlib -shared -Wl,--build-id=none -Wl,--hash-style=gnu
+# from
+#	.text
+#	.globl	get
+#	.type	get, @function
+# get:
+#	movl	counter(%rip), %eax
+#	leaq	table(%rip), %rdx
+#	addl	(%rdx), %eax
+#	ret
+#	.size	get, .-get
+#	.globl	put
+#	.type	put, @function
+# put:
+#	movl	%edi, counter(%rip)
+#	ret
+#	.size	put, .-put
+#
+#	.data
+#	.type	counter, @object
+#	.size	counter, 4
+# counter:
+#	.long	0
+#	.type	table, @object
+#	.size	table, 4
+# table:
+#	.long	1
+testfiles testfile72.so
+
+for jobs in 1 2; do
+  testrun_compare ${abs_top_builddir}/src/objdump -d --jobs=$jobs \
+    testfile72.so <<\EOF
+testfile72.so: elf64-elf_x86_64
+
+Disassembly of section .text:
+
+    1000:    8b 05 fa 1f 00 00        mov     0x1ffa(%rip),%eax          # <counter>
+    1006:    48 8d 15 f7 1f 00 00     lea     0x1ff7(%rip),%rdx          # <table>
+    100d:    03 02                    add     (%rdx),%eax
+    100f:    c3                       retq
+    1010:    89 3d ea 1f 00 00        mov     %edi,0x1fea(%rip)          # <counter>
+    1016:    c3                       retq
+EOF
+done
+
+exit 0
@@ -0,0 +1,24 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+# Identical elf_getdata_rawchunk requests must share one result, and
+# elf_rawchunk must agree with it.  One file of each byte order.
+testfiles testfile backtrace.s390x.core
+
+testrun ${abs_builddir}/rawchunk testfile backtrace.s390x.core
+
+exit 0
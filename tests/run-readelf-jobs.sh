@@ -0,0 +1,45 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# DWARF printed several sections and units at once has to come out the
+# same as when printed one after the other, including the diagnostics.
+# Our own libraries have line tables we cannot fully read, which makes
+# the parts of .debug_line go on from elsewhere than where they start.
+testfiles testfileloc testfilemacro testfilefoobarbaz
+
+tempfiles serial.out serial.err jobs.out jobs.err
+
+for file in testfileloc testfilemacro testfilefoobarbaz \
+	    ${abs_top_builddir}/libelf/libelf.so \
+	    ${abs_top_builddir}/libdw/libdw.so; do
+  for what in "" =info =line =decodedline =loc =ranges =frame; do
+    status=0
+    testrun ${abs_top_builddir}/src/readelf --debug-dump$what $file \
+      > serial.out 2> serial.err || status=$?
+    for jobs in 0 3 16; do
+      jobs_status=0
+      testrun ${abs_top_builddir}/src/readelf -j $jobs --debug-dump$what \
+	$file > jobs.out 2> jobs.err || jobs_status=$?
+      test $status = $jobs_status
+      cmp serial.out jobs.out
+      cmp serial.err jobs.err
+    done
+  done
+done
+
+exit 0
@@ -0,0 +1,49 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+tempfiles stack.out stack.err
+
+# Sample a sleeping child a few times, it always has the same stack.
+sleep 30 &
+child=$!
+trap "kill $child 2>/dev/null; exit_cleanup" 0
+
+# Skip when we are not allowed to ptrace the child.
+if ! testrun ${abs_top_builddir}/src/stack -p $child -1 -q >/dev/null 2>&1;
+then
+  exit 77
+fi
+
+testrun ${abs_top_builddir}/src/stack -p $child --sample 50 --duration 0.2 \
+  --folded >stack.out 2>stack.err
+cat stack.out stack.err
+
+# All samples of the single thread fold into one line ending in the count.
+# Samples can be missed on a busy machine, so take the number reported.
+samples=`sed -n 's/^\([0-9]*\) samples in .* per sample .*$/\1/p' stack.err`
+test -n "$samples"
+test `wc -l < stack.out` -eq 1
+grep -q " $samples\$" stack.out
+
+testrun ${abs_top_builddir}/src/stack -p $child --sample 50 --duration 0.2 \
+  -j 2 >stack.out 2>stack.err
+cat stack.out stack.err
+grep -q "^PID $child - [0-9]* samples of [0-9]* stacks" stack.out
+grep -q '^[0-9]* samples (100.00%):' stack.out
+
+exit 0
@@ -0,0 +1,56 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Scanning pieces of a file at once has to find the same strings as
+# scanning it in one go, and so has reading it from a pipe.  Also
+# prints how long scanning takes each way.
+tempfiles strings.in strings.out strings-jobs.out
+
+for file in ${abs_top_builddir}/libdw/libdw.so ${abs_top_builddir}/src/readelf \
+	    ${abs_top_builddir}/libelf/libelf.so ${abs_top_builddir}/libdw/libdw.so; do
+  cat $file >> strings.in
+done
+
+now()
+{
+  date +%s%N | cut -c1-13
+}
+
+for opts in "-tx" "-td -f" "-n 1" "-n 20 -to" "-es" "-eS -tx"; do
+  start=$(now)
+  testrun ${abs_top_builddir}/src/strings -a $opts strings.in > strings.out
+  middle=$(now)
+  testrun ${abs_top_builddir}/src/strings -a -j 0 $opts strings.in \
+    > strings-jobs.out
+  end=$(now)
+  echo "strings $opts -j 1: $((middle - start)) ms, -j 0: $((end - middle)) ms"
+  test -s strings.out
+  cmp strings.out strings-jobs.out
+
+  testrun ${abs_top_builddir}/src/strings -a -j 5 $opts strings.in \
+    > strings-jobs.out
+  cmp strings.out strings-jobs.out
+
+  if [ "$opts" != "-td -f" ]; then
+    cat strings.in \
+      | testrun ${abs_top_builddir}/src/strings $opts > strings-jobs.out
+    cmp strings.out strings-jobs.out
+  fi
+done
+
+exit 0
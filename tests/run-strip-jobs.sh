@@ -0,0 +1,77 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Files stripped several at once have to come out the same as when
+# stripped one after the other, with the diagnostics in the same order.
+# Also prints how long stripping a corpus of copies of our own programs
+# and libraries takes each way.
+testfiles testfile hello_i386.ko hello_x86_64.ko
+
+inputs="${abs_top_builddir}/src/readelf ${abs_top_builddir}/src/elflint \
+	${abs_top_builddir}/src/nm ${abs_top_builddir}/src/addr2line \
+	${abs_top_builddir}/libelf/libelf.so ${abs_top_builddir}/libdw/libdw.so"
+copies=8
+serial=
+parallel=
+for file in $inputs; do
+  n=0
+  while [ $n -lt $copies ]; do
+    name=$n-${file##*/}
+    cp $file s-$name
+    cp $file p-$name
+    serial="$serial s-$name"
+    parallel="$parallel p-$name"
+    n=$((n + 1))
+  done
+done
+tempfiles $serial $parallel
+tempfiles junk stripped strip.out strip-jobs.out
+
+now()
+{
+  date +%s%N | cut -c1-13
+}
+
+start=$(now)
+testrun ${abs_top_builddir}/src/strip -j 1 $serial
+middle=$(now)
+testrun ${abs_top_builddir}/src/strip -j 0 $parallel
+end=$(now)
+echo "strip -j 1: $((middle - start)) ms, strip -j 0: $((end - middle)) ms"
+
+for file in $serial; do
+  cmp $file p-${file#s-}
+done
+
+# One bad file does not keep the others from being stripped.
+echo junk > junk
+files="testfile junk hello_i386.ko nonexistent hello_x86_64.ko"
+testrun_out strip.out ${abs_top_builddir}/src/strip $files
+for file in testfile hello_i386.ko hello_x86_64.ko; do
+  mv $file $file.stripped
+  bunzip2 -c ${abs_srcdir}/$file.bz2 > $file
+  tempfiles $file.stripped
+done
+testrun_out strip-jobs.out ${abs_top_builddir}/src/strip -j 3 $files
+test -s strip.out
+cmp strip.out strip-jobs.out
+for file in testfile hello_i386.ko hello_x86_64.ko; do
+  cmp $file $file.stripped
+done
+
+exit 0
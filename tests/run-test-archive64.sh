@@ -40,4 +40,16 @@ Archive member 'ccc.o' contains:
 	ccc3
 EOF
 
+# The symbols must be found by name in the 64-bit index, too.
+tempfiles arsymtest64.out
+testrun ${abs_builddir}/arsymtest testarchive64.a arsymtest64.out
+testrun_compare sort arsymtest64.out <<\EOF
+aaa in aaa.o
+bbb in bbb.o
+bbb2 in bbb.o
+ccc in ccc.o
+ccc2 in ccc.o
+ccc3 in ccc.o
+EOF
+
 exit 0
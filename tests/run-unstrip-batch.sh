@@ -0,0 +1,81 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Stripped files found under a directory are combined with the debug
+# files for their build IDs the same way as when each pair is given
+# explicitly, also several at once.  Two of the stripped files share
+# a debug file, and there is no debug file for the third.
+tempfiles nm.debug readelf.debug size.debug nm.unstrip readelf.unstrip
+tempfiles unstrip.out unstrip-jobs.out
+
+build_id_path()
+{
+  id=$(testrun ${abs_top_builddir}/src/readelf -n $1 \
+       | sed -n 's/^ *Build ID: //p')
+  test -n "$id"
+  echo debug/.build-id/$(echo $id | cut -c1-2)/$(echo $id | cut -c3-).debug
+}
+
+mkdir -p in/sub out out-jobs
+for file in nm readelf size; do
+  testrun ${abs_top_builddir}/src/strip -f $file.debug -o in/$file \
+    ${abs_top_builddir}/src/$file
+done
+cp in/nm in/sub/nm
+echo 'not an ELF file' > in/sub/text
+
+for file in nm readelf; do
+  debug=$(build_id_path $file.debug)
+  mkdir -p ${debug%/*}
+  cp $file.debug $debug
+done
+
+testrun ${abs_top_builddir}/src/unstrip -o nm.unstrip in/nm nm.debug
+testrun ${abs_top_builddir}/src/unstrip -o readelf.unstrip \
+  in/readelf readelf.debug
+
+status=0
+testrun ${abs_top_builddir}/src/unstrip -b -d out --debug-dir=debug in \
+  > unstrip.out 2>&1 || status=$?
+test $status -eq 1
+echo "cannot find debug file '$(build_id_path size.debug)' for 'in/size'" \
+  > unstrip-jobs.out
+sed 's/^[^:]*unstrip: //' unstrip.out | cmp unstrip-jobs.out -
+
+testrun ${abs_top_builddir}/src/unstrip -b -i -j 3 -d out-jobs \
+  --debug-dir=debug in > unstrip-jobs.out 2>&1
+test ! -s unstrip-jobs.out
+
+for dir in out out-jobs; do
+  cmp nm.unstrip $dir/in/nm
+  cmp nm.unstrip $dir/in/sub/nm
+  cmp readelf.unstrip $dir/in/readelf
+  test ! -f $dir/in/size
+  test ! -f $dir/in/sub/text
+done
+
+# The output files must stay inside the -d directory.
+status=0
+testrun ${abs_top_builddir}/src/unstrip -b -d out/in --debug-dir=debug \
+  in/../in > unstrip.out 2>&1 || status=$?
+test $status -ne 0
+grep -q "'in/../in' must not contain '..' with -b" unstrip.out
+
+rm -rf in debug out out-jobs
+
+exit 0
@@ -0,0 +1,129 @@
+/* Test program for the ELF_C_ADVISE_* commands.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(elf)
+#include <gelf.h>
+
+
+static const Elf_Cmd advice[] =
+  {
+    ELF_C_ADVISE_NORMAL, ELF_C_ADVISE_SEQUENTIAL, ELF_C_ADVISE_RANDOM,
+    ELF_C_ADVISE_WILLNEED, ELF_C_ADVISE_DONTNEED
+  };
+#define NADVICE (sizeof advice / sizeof advice[0])
+
+
+static uint64_t
+sum_data (Elf *elf)
+{
+  uint64_t sum = 0;
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      Elf_Data *data = elf_getdata (scn, NULL);
+      if (data != NULL && data->d_buf != NULL)
+	for (size_t i = 0; i < data->d_size; ++i)
+	  sum = sum * 31 + ((unsigned char *) data->d_buf)[i];
+    }
+  return sum;
+}
+
+
+/* All advice is accepted, and even after ELF_C_ADVISE_DONTNEED the
+   contents are still the same.  */
+static void
+check (Elf *elf)
+{
+  uint64_t sum = sum_data (elf);
+
+  for (size_t i = 0; i < NADVICE; ++i)
+    {
+      assert (elf_cntl (elf, advice[i]) == 0);
+
+      Elf_Scn *scn = NULL;
+      while ((scn = elf_nextscn (elf, scn)) != NULL)
+	{
+	  assert (elf_scncntl (scn, advice[i], 0, 0) == 0);
+	  assert (elf_scncntl (scn, advice[i], 1, 1) == 0);
+	  assert (elf_scncntl (scn, advice[i], (size_t) -1, 1) == 0);
+	}
+
+      assert (sum_data (elf) == sum);
+    }
+
+  assert (elf_cntl (elf, ELF_C_SET) == -1);
+  assert (elf_scncntl (elf_getscn (elf, 0), ELF_C_READ, 0, 0) == -1);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  static const Elf_Cmd cmds[] =
+    {
+      ELF_C_READ, ELF_C_READ_MMAP, ELF_C_READ_MMAP_PRIVATE
+    };
+
+  elf_version (EV_CURRENT);
+
+  for (int i = 1; i < argc; ++i)
+    {
+      for (size_t c = 0; c < sizeof cmds / sizeof cmds[0]; ++c)
+	{
+	  int fd = open (argv[i], O_RDONLY);
+	  if (fd < 0)
+	    error (EXIT_FAILURE, errno, "cannot open '%s'", argv[i]);
+
+	  Elf *elf = elf_begin (fd, cmds[c], NULL);
+	  if (elf == NULL)
+	    error (EXIT_FAILURE, 0, "elf_begin '%s': %s", argv[i],
+		   elf_errmsg (-1));
+	  check (elf);
+
+	  /* Without the file descriptor only the mapping is advised.  */
+	  if (elf_cntl (elf, ELF_C_FDREAD) != 0)
+	    error (EXIT_FAILURE, 0, "elf_cntl: %s", elf_errmsg (-1));
+	  check (elf);
+
+	  elf_end (elf);
+	  close (fd);
+	}
+
+      /* Memory passed in by the caller is never touched.  */
+      size_t size;
+      int fd = open (argv[i], O_RDONLY);
+      Elf *elf = elf_begin (fd, ELF_C_READ, NULL);
+      char *raw = elf_rawfile (elf, &size);
+      assert (raw != NULL);
+      Elf *memelf = elf_memory (raw, size);
+      assert (memelf != NULL);
+      check (memelf);
+      elf_end (memelf);
+      elf_end (elf);
+      close (fd);
+    }
+
+  return 0;
+}
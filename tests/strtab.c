@@ -0,0 +1,148 @@
+/* Test program for elf_strtab and elf_strptr.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(elf)
+#include <gelf.h>
+
+
+static void
+check_file (const char *fname, Elf_Cmd cmd)
+{
+  int fd = open (fname, O_RDONLY);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "cannot open '%s'", fname);
+
+  Elf *elf = elf_begin (fd, cmd, NULL);
+  if (elf == NULL)
+    error (EXIT_FAILURE, 0, "elf_begin '%s': %s", fname, elf_errmsg (-1));
+
+  size_t shstrndx;
+  if (elf_getshdrstrndx (elf, &shstrndx) != 0)
+    error (EXIT_FAILURE, 0, "elf_getshdrstrndx: %s", elf_errmsg (-1));
+
+  /* Twice, the second round uses the tables checked in the first.  */
+  for (int round = 0; round < 2; ++round)
+    {
+      size_t size;
+      const char *names = elf_strtab (elf, shstrndx, &size);
+      if (names == NULL)
+	error (EXIT_FAILURE, 0, "elf_strtab: %s", elf_errmsg (-1));
+      assert (size > 0 && names[size - 1] == '\0');
+
+      Elf_Scn *scn = NULL;
+      while ((scn = elf_nextscn (elf, scn)) != NULL)
+	{
+	  GElf_Shdr shdr_mem;
+	  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+	  assert (shdr != NULL);
+	  assert (elf_strptr (elf, shstrndx, shdr->sh_name)
+		  == names + shdr->sh_name);
+
+	  size_t ndx = elf_ndxscn (scn);
+	  const char *str = elf_strtab (elf, ndx, &size);
+	  if (shdr->sh_type != SHT_STRTAB)
+	    assert (str == NULL && elf_strptr (elf, ndx, 0) == NULL);
+	  else if (str != NULL)
+	    {
+	      assert (size <= shdr->sh_size && str[size - 1] == '\0');
+	      assert (elf_strptr (elf, ndx, size - 1) == str + size - 1);
+	      assert (elf_strptr (elf, ndx, size) == NULL);
+	    }
+	}
+    }
+
+  if (elf_end (elf) != 0)
+    error (EXIT_FAILURE, 0, "elf_end: %s", elf_errmsg (-1));
+  close (fd);
+}
+
+
+/* A string table created in memory, with and without the final NUL.  */
+static void
+check_new (void)
+{
+  int fd = open ("/dev/null", O_WRONLY);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "cannot open /dev/null");
+
+  Elf *elf = elf_begin (fd, ELF_C_WRITE, NULL);
+  if (elf == NULL || gelf_newehdr (elf, ELFCLASS64) == 0)
+    error (EXIT_FAILURE, 0, "cannot create ELF file: %s", elf_errmsg (-1));
+
+  static char good[] = "\0one\0two";
+  static char bad[] = { '\0', 'b', 'a', 'd' };
+  struct
+  {
+    char *buf;
+    size_t size;
+    size_t ndx;
+  } tabs[] = { { good, sizeof good, 0 }, { bad, sizeof bad, 0 } };
+
+  for (size_t i = 0; i < sizeof tabs / sizeof tabs[0]; ++i)
+    {
+      Elf_Scn *scn = elf_newscn (elf);
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      assert (shdr != NULL);
+      shdr->sh_type = SHT_STRTAB;
+      shdr->sh_size = tabs[i].size;
+      assert (gelf_update_shdr (scn, shdr));
+
+      Elf_Data *data = elf_newdata (scn);
+      assert (data != NULL);
+      data->d_buf = tabs[i].buf;
+      data->d_size = tabs[i].size;
+      tabs[i].ndx = elf_ndxscn (scn);
+    }
+
+  size_t size;
+  const char *str = elf_strtab (elf, tabs[0].ndx, &size);
+  assert (str == good && size == sizeof good);
+  assert (strcmp (elf_strptr (elf, tabs[0].ndx, 5), "two") == 0);
+
+  assert (elf_strtab (elf, tabs[1].ndx, &size) == NULL);
+  assert (elf_strptr (elf, tabs[1].ndx, 0) == bad);
+  assert (elf_strptr (elf, tabs[1].ndx, 1) == NULL);
+
+  elf_end (elf);
+  close (fd);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  elf_version (EV_CURRENT);
+
+  for (int i = 1; i < argc; ++i)
+    {
+      check_file (argv[i], ELF_C_READ);
+      check_file (argv[i], ELF_C_READ_MMAP);
+    }
+
+  check_new ();
+
+  return 0;
+}